@@ -0,0 +1,154 @@
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include "parser.hpp"
+#include "logger.hpp"
+#include "equational_interpreter.hpp"
+#include "program_generator.hpp"
+
+/**
+ * End-to-end scaling benchmark of the equational interpreter on synthetic programs.
+ *
+ * For every requested program size, a program is generated, parsed and analyzed, and one line is
+ * reported with the time spent in each phase. Sizes are run in the given order in a single process,
+ * so the peak RSS of a line also covers the sizes before it.
+ */
+
+static long peak_rss_kb()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+static std::vector<std::size_t> parse_sizes(const std::string& list)
+{
+    std::vector<std::size_t> sizes;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ','))
+    {
+        sizes.push_back(std::stoull(item));
+    }
+    return sizes;
+}
+
+int main(int argc, char** argv) {
+    GeneratorConfig config;
+    std::vector<std::size_t> sizes = {10, 100, 1000, 10000};
+    long loops = -1;
+    std::size_t repeat = 1;
+    bool emit = false;
+    SolverMode solver_mode = SolverMode::WORKLIST;
+    bool sparse = false;
+    std::size_t jobs = std::thread::hardware_concurrency();
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg(argv[i]);
+        auto value = arg.substr(arg.find('=') + 1);
+        if (arg.rfind("--statements=", 0) == 0) {
+            sizes = parse_sizes(value);
+        }
+        else if (arg.rfind("--variables=", 0) == 0) {
+            config.variables = std::stoull(value);
+        }
+        else if (arg.rfind("--depth=", 0) == 0) {
+            config.max_depth = std::stoull(value);
+        }
+        else if (arg.rfind("--loops=", 0) == 0) {
+            loops = std::stol(value);
+        }
+        else if (arg.rfind("--loop-bound=", 0) == 0) {
+            config.loop_bound = std::stoull(value);
+        }
+        else if (arg.rfind("--seed=", 0) == 0) {
+            config.seed = static_cast<std::uint32_t>(std::stoul(value));
+        }
+        else if (arg.rfind("--repeat=", 0) == 0) {
+            repeat = std::max<std::size_t>(1, std::stoull(value));
+        }
+        else if (arg == "--solver=jacobi") {
+            solver_mode = SolverMode::JACOBI;
+        }
+        else if (arg == "--solver=wto") {
+            solver_mode = SolverMode::WTO;
+        }
+        else if (arg == "--solver=worklist") {
+            solver_mode = SolverMode::WORKLIST;
+        }
+        else if (arg == "--solver=parallel") {
+            solver_mode = SolverMode::PARALLEL;
+        }
+        else if (arg.rfind("--jobs=", 0) == 0) {
+            jobs = std::stoull(value);
+        }
+        else if (arg == "--sparse") {
+            sparse = true;
+        }
+        else if (arg.rfind("--parser=", 0) == 0) {
+            ParserKind parser_kind;
+            if (!AbstractInterpreterParser::parse_kind(value, parser_kind)) {
+                std::cerr << "[ERROR] unknown parser `" << value << "`." << std::endl;
+                return 1;
+            }
+            AbstractInterpreterParser::set_kind(parser_kind);
+        }
+        else if (arg == "--emit") {
+            emit = true;
+        }
+        else {
+            std::cout << "usage: " << argv[0] << " [--statements=10,100,...] [--variables=N] [--depth=N] [--loops=N]"
+                      << " [--loop-bound=N] [--seed=N] [--repeat=N] [--solver=worklist|wto|jacobi|parallel] [--jobs=N] [--sparse] [--parser=descent|peg|differential] [--emit]" << std::endl;
+            return 1;
+        }
+    }
+
+    Logger::set_level(LogLevel::QUIET);
+    // Compile the grammar before timing the first parse
+    if (AbstractInterpreterParser::kind() != ParserKind::DESCENT) {
+        AbstractInterpreterParser::instance();
+    }
+
+    if (!emit) {
+        std::printf("%10s %10s %8s %10s %10s %10s %12s %10s %12s\n", "statements", "locations", "loops", "parse_ms",
+                    "build_ms", "iterations", "evaluations", "solve_ms", "peak_rss_kb");
+    }
+    for (auto size : sizes) {
+        config.statements = size;
+        // By default, one loop every 25 statements
+        config.loops = loops >= 0 ? static_cast<std::size_t>(loops) : size / 25;
+
+        ProgramGenerator generator(config);
+        auto program = generator.generate();
+        if (emit) {
+            std::cout << program;
+            continue;
+        }
+
+        for (std::size_t r = 0; r < repeat; ++r) {
+            auto parse_start = std::chrono::steady_clock::now();
+            auto ast = AbstractInterpreterParser::parse_program(program);
+            auto parse_end = std::chrono::steady_clock::now();
+
+            EquationalInterpreter<int64_t> EI(std::move(ast));
+            EI.set_solver_mode(solver_mode);
+            EI.set_solver_threads(jobs);
+            EI.set_sparse(sparse);
+            EI.run();
+
+            const auto& statistics = EI.statistics();
+            std::printf("%10zu %10zu %8zu %10.3f %10.3f %10zu %12zu %10.3f %12ld\n", size, statistics.locations,
+                        generator.loops_generated(),
+                        std::chrono::duration<double, std::milli>(parse_end - parse_start).count(),
+                        statistics.build_ms, statistics.iterations, statistics.location_evaluations,
+                        statistics.solve_ms, peak_rss_kb());
+        }
+    }
+    return 0;
+}
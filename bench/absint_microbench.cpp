@@ -0,0 +1,314 @@
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "equational_interpreter.hpp"
+#include "interval.hpp"
+#include "interval_store.hpp"
+#include "logger.hpp"
+#include "variable_table.hpp"
+
+/**
+ * Microbenchmarks of the kernels that the fixpoint iteration spends its time in: the lattice and
+ * arithmetic operations of Interval, the accesses and joins of IntervalStore, and the widening and
+ * condition filtering of the interpreter. The store kernels run over 8 to 4096 variables, and every
+ * kernel for both int32_t and int64_t.
+ *
+ * The results are compared with a baseline by bench/compare_microbench.py.
+ */
+
+namespace {
+
+constexpr std::size_t INTERVALS = 1024;
+
+// Random intervals with small bounds, so that the arithmetic neither overflows nor divides by zero
+template <typename T>
+std::vector<Interval<T>> random_intervals(std::size_t count, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int> bound(1, 1000);
+    std::vector<Interval<T>> intervals;
+    intervals.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        T lb = static_cast<T>(bound(generator));
+        T ub = static_cast<T>(lb + bound(generator));
+        intervals.emplace_back(lb, ub);
+    }
+    return intervals;
+}
+
+std::shared_ptr<VariableTable> variables(std::size_t count)
+{
+    auto table = std::make_shared<VariableTable>();
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        table->intern("v" + std::to_string(i));
+    }
+    return table;
+}
+
+template <typename T>
+IntervalStore<T> random_store(const std::shared_ptr<VariableTable>& table, unsigned seed)
+{
+    IntervalStore<T> store(table);
+    auto intervals = random_intervals<T>(table->size(), seed);
+    for (std::size_t id = 0; id < intervals.size(); ++id)
+    {
+        store.set(id, intervals[id]);
+    }
+    return store;
+}
+
+// An interpreter whose widening thresholds are those of a counting loop, built once per type
+template <typename T>
+EquationalInterpreter<T>& interpreter()
+{
+    static auto instance = [] {
+        Logger::set_level(LogLevel::QUIET);
+        auto interpreter = std::make_unique<EquationalInterpreter<T>>(
+            "int x;\n\nvoid main(){\n    x = 0;\n    while(x < 100){\n        x = x + 1;\n    }\n}\n");
+        interpreter->run();
+        return interpreter;
+    }();
+    return *instance;
+}
+
+// ===============================================================================
+// INTERVAL
+// ===============================================================================
+
+template <typename T>
+void interval_join(benchmark::State& state)
+{
+    auto intervals = random_intervals<T>(INTERVALS, 1);
+    std::size_t i = 0;
+    for (auto _ : state)
+    {
+        auto result = intervals[i % INTERVALS];
+        result.join(intervals[(i + 1) % INTERVALS]);
+        benchmark::DoNotOptimize(result);
+        ++i;
+    }
+}
+
+template <typename T>
+void interval_meet(benchmark::State& state)
+{
+    auto intervals = random_intervals<T>(INTERVALS, 1);
+    std::size_t i = 0;
+    for (auto _ : state)
+    {
+        auto result = intervals[i % INTERVALS];
+        result.meet(intervals[(i + 1) % INTERVALS]);
+        benchmark::DoNotOptimize(result);
+        ++i;
+    }
+}
+
+template <typename T>
+void interval_add(benchmark::State& state)
+{
+    auto intervals = random_intervals<T>(INTERVALS, 1);
+    std::size_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(intervals[i % INTERVALS] + intervals[(i + 1) % INTERVALS]);
+        ++i;
+    }
+}
+
+template <typename T>
+void interval_mul(benchmark::State& state)
+{
+    auto intervals = random_intervals<T>(INTERVALS, 1);
+    std::size_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(intervals[i % INTERVALS] * intervals[(i + 1) % INTERVALS]);
+        ++i;
+    }
+}
+
+template <typename T>
+void interval_div(benchmark::State& state)
+{
+    auto intervals = random_intervals<T>(INTERVALS, 1);
+    std::size_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(intervals[i % INTERVALS] / intervals[(i + 1) % INTERVALS]);
+        ++i;
+    }
+}
+
+template <typename T>
+void interval_normalize(benchmark::State& state)
+{
+    auto intervals = random_intervals<T>(INTERVALS, 1);
+    for (auto& interval : intervals)
+    {
+        // Half of them have their bounds swapped
+        if (interval.lb() % 2 == 0) std::swap(interval.lb(), interval.ub());
+    }
+    std::size_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(intervals[i % INTERVALS].normalize());
+        ++i;
+    }
+}
+
+// ===============================================================================
+// INTERVAL STORE
+// ===============================================================================
+
+template <typename T>
+void store_get(benchmark::State& state)
+{
+    auto size = static_cast<std::size_t>(state.range(0));
+    auto store = random_store<T>(variables(size), 1);
+    for (auto _ : state)
+    {
+        for (std::size_t id = 0; id < size; ++id)
+        {
+            benchmark::DoNotOptimize(store.get(id));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * size);
+}
+
+template <typename T>
+void store_set(benchmark::State& state)
+{
+    auto size = static_cast<std::size_t>(state.range(0));
+    auto store = random_store<T>(variables(size), 1);
+    auto intervals = random_intervals<T>(size, 2);
+    for (auto _ : state)
+    {
+        for (std::size_t id = 0; id < size; ++id)
+        {
+            store.set(id, intervals[id]);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * size);
+}
+
+template <typename T>
+void store_join_all(benchmark::State& state)
+{
+    auto size = static_cast<std::size_t>(state.range(0));
+    auto table = variables(size);
+    auto store = random_store<T>(table, 1);
+    auto other = random_store<T>(table, 2);
+    for (auto _ : state)
+    {
+        auto joined = store;
+        joined.joinAll(other);
+        benchmark::DoNotOptimize(joined);
+    }
+    state.SetItemsProcessed(state.iterations() * size);
+}
+
+template <typename T>
+void store_equals(benchmark::State& state)
+{
+    auto size = static_cast<std::size_t>(state.range(0));
+    auto table = variables(size);
+    auto store = random_store<T>(table, 1);
+    // Equal contents in distinct pages, so that every slot is compared
+    auto other = random_store<T>(table, 1);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(store.equals(other));
+    }
+    state.SetItemsProcessed(state.iterations() * size);
+}
+
+template <typename T>
+void store_copy(benchmark::State& state)
+{
+    auto size = static_cast<std::size_t>(state.range(0));
+    auto store = random_store<T>(variables(size), 1);
+    Interval<T> interval(0, 1);
+    for (auto _ : state)
+    {
+        // A copy shares the pages of the original until one of them is written
+        auto copy = store;
+        copy.set(size / 2, interval);
+        benchmark::DoNotOptimize(copy);
+    }
+}
+
+// ===============================================================================
+// INTERPRETER
+// ===============================================================================
+
+template <typename T>
+void interpreter_widen(benchmark::State& state)
+{
+    auto size = static_cast<std::size_t>(state.range(0));
+    auto table = variables(size);
+    auto previous = random_store<T>(table, 1);
+    auto current = previous;
+    current.joinAll(random_store<T>(table, 2));
+    auto& analysis = interpreter<T>();
+    for (auto _ : state)
+    {
+        auto widened = current;
+        analysis.widen(previous, widened);
+        benchmark::DoNotOptimize(widened);
+    }
+    state.SetItemsProcessed(state.iterations() * size);
+}
+
+template <typename T>
+void interpreter_apply_command(benchmark::State& state)
+{
+    auto size = static_cast<std::size_t>(state.range(0));
+    auto store = random_store<T>(variables(size), 1);
+    auto& analysis = interpreter<T>();
+    Interval<T> bound(500, 500);
+    LogicOp ops[] = {LogicOp::LEQ, LogicOp::LE, LogicOp::GEQ, LogicOp::GE, LogicOp::EQ, LogicOp::NEQ};
+    std::size_t i = 0;
+    for (auto _ : state)
+    {
+        auto restricted = store;
+        analysis.apply_command_to_store(restricted, i % size, bound, ops[i % 6]);
+        benchmark::DoNotOptimize(restricted);
+        ++i;
+    }
+}
+
+}
+
+#define INTERVAL_BENCHMARK(kernel) \
+    BENCHMARK_TEMPLATE(kernel, std::int32_t); \
+    BENCHMARK_TEMPLATE(kernel, std::int64_t)
+
+#define STORE_BENCHMARK(kernel) \
+    BENCHMARK_TEMPLATE(kernel, std::int32_t)->RangeMultiplier(8)->Range(8, 4096); \
+    BENCHMARK_TEMPLATE(kernel, std::int64_t)->RangeMultiplier(8)->Range(8, 4096)
+
+INTERVAL_BENCHMARK(interval_join);
+INTERVAL_BENCHMARK(interval_meet);
+INTERVAL_BENCHMARK(interval_add);
+INTERVAL_BENCHMARK(interval_mul);
+INTERVAL_BENCHMARK(interval_div);
+INTERVAL_BENCHMARK(interval_normalize);
+
+STORE_BENCHMARK(store_get);
+STORE_BENCHMARK(store_set);
+STORE_BENCHMARK(store_join_all);
+STORE_BENCHMARK(store_equals);
+STORE_BENCHMARK(store_copy);
+
+STORE_BENCHMARK(interpreter_widen);
+STORE_BENCHMARK(interpreter_apply_command);
+
+BENCHMARK_MAIN();
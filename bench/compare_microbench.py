@@ -0,0 +1,52 @@
+#!/usr/bin/env python3
+"""Compares two runs of absint_microbench written with --benchmark_out=FILE --benchmark_out_format=json.
+
+Prints the ratio of the CPU time of every benchmark of the baseline, and exits with status 1 if one of them
+is slower than the baseline by more than the threshold, or is missing from the current run.
+
+    compare_microbench.py BASELINE CURRENT [--threshold=0.10]
+"""
+
+import json
+import sys
+
+
+def cpu_times(path):
+    with open(path) as report:
+        benchmarks = json.load(report)["benchmarks"]
+    # With --benchmark_repetitions, only the medians are compared
+    if any(b.get("run_type") == "aggregate" for b in benchmarks):
+        benchmarks = [b for b in benchmarks if b.get("aggregate_name") == "median"]
+        return {b["run_name"]: b["cpu_time"] for b in benchmarks}
+    return {b["name"]: b["cpu_time"] for b in benchmarks}
+
+
+def main(argv):
+    threshold = 0.10
+    paths = []
+    for arg in argv[1:]:
+        if arg.startswith("--threshold="):
+            threshold = float(arg.split("=", 1)[1])
+        else:
+            paths.append(arg)
+    if len(paths) != 2:
+        print(__doc__, file=sys.stderr)
+        return 2
+
+    baseline, current = (cpu_times(path) for path in paths)
+    regressions = 0
+    for name, time in baseline.items():
+        if name not in current:
+            print(f"{name:60} missing")
+            regressions += 1
+            continue
+        ratio = current[name] / time
+        slower = ratio > 1 + threshold
+        regressions += slower
+        print(f"{name:60} {time:12.1f} {current[name]:12.1f} {ratio:6.2f}{'  SLOWER' if slower else ''}")
+    print(f"{regressions} of {len(baseline)} benchmarks slower than the baseline by more than {threshold:.0%}")
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
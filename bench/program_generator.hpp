@@ -0,0 +1,281 @@
+#ifndef PROGRAM_GENERATOR_HPP
+#define PROGRAM_GENERATOR_HPP
+
+#include <cstdint>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Shape of the programs built by the ProgramGenerator
+ *
+ */
+struct GeneratorConfig {
+    std::size_t variables = 8;      // data variables, bounded by preconditions
+    std::size_t statements = 100;   // assignments, not counting the updates of the loop counters
+    std::size_t max_depth = 2;      // maximal nesting of if-else and while statements
+    std::size_t loops = 4;          // while loops
+    std::size_t loop_bound = 4;     // iterations of every loop
+    std::uint32_t seed = 1;
+};
+
+/**
+ * @brief Generates random programs in the language accepted by AbstractInterpreterParser.
+ *
+ * The programs reach a fixpoint without widening: every loop runs over its own counter, and inside
+ * loops the assignments only read loop counters, constants and variables that no loop writes. Expressions
+ * have at most two operands.
+ *
+ */
+class ProgramGenerator
+{
+private:
+    GeneratorConfig m_config;
+    std::mt19937 m_rng;
+    std::ostringstream m_out;
+
+    std::size_t m_statements_left = 0;
+    std::size_t m_loops_left = 0;
+    std::size_t m_loops_generated = 0;
+
+    // Counters of the loops that enclose the statement being generated
+    std::vector<std::string> m_active_counters;
+
+    // Average number of statements in the body of a loop
+    static constexpr std::size_t LOOP_BODY = 4;
+
+public:
+    explicit ProgramGenerator(GeneratorConfig config)
+    : m_config(config)
+    , m_rng(config.seed)
+    {
+        if (m_config.variables == 0)
+        {
+            m_config.variables = 1;
+        }
+    }
+
+    /**
+     * @brief Generates a new program
+     *
+     * @return std::string
+     */
+    std::string generate()
+    {
+        m_out.str("");
+        m_statements_left = m_config.statements;
+        m_loops_left = m_config.loops;
+        m_loops_generated = 0;
+        m_active_counters.clear();
+
+        std::ostringstream body;
+        std::swap(m_out, body);
+        generate_block(m_config.statements, 0, 0);
+        std::swap(m_out, body);
+
+        m_out << "int ";
+        for (std::size_t i = 0; i < m_config.variables; ++i)
+        {
+            m_out << (i == 0 ? "" : ", ") << variable(i);
+        }
+        m_out << ";\n";
+        if (m_loops_generated > 0)
+        {
+            m_out << "int ";
+            for (std::size_t i = 0; i < m_loops_generated; ++i)
+            {
+                m_out << (i == 0 ? "" : ", ") << counter(i);
+            }
+            m_out << ";\n";
+        }
+
+        m_out << "\nvoid main() {\n";
+        for (std::size_t i = 0; i < m_config.variables; ++i)
+        {
+            m_out << "  /*!npk " << variable(i) << " between 0 and 100 */\n";
+        }
+        m_out << body.str();
+        for (std::size_t i = 0; i < std::min<std::size_t>(m_config.variables, 4); ++i)
+        {
+            m_out << "  assert(" << variable(i) << " >= 0);\n";
+        }
+        m_out << "}\n";
+        return m_out.str();
+    }
+
+    std::size_t loops_generated() const
+    {
+        return m_loops_generated;
+    }
+
+private:
+    std::size_t random(std::size_t bound)
+    {
+        return bound == 0 ? 0 : m_rng() % bound;
+    }
+
+    static std::string variable(std::size_t i)
+    {
+        return "v" + std::to_string(i);
+    }
+
+    static std::string counter(std::size_t i)
+    {
+        return "l" + std::to_string(i);
+    }
+
+    // The first half of the variables is never assigned inside a loop
+    std::size_t loop_invariant_variables() const
+    {
+        return m_config.variables / 2;
+    }
+
+    void indent(std::size_t level)
+    {
+        for (std::size_t i = 0; i <= level; ++i)
+        {
+            m_out << "  ";
+        }
+    }
+
+    void generate_block(std::size_t budget, std::size_t depth, std::size_t indentation)
+    {
+        while (budget > 0)
+        {
+            bool can_nest = depth < m_config.max_depth && budget >= 2;
+            if (can_nest && m_loops_left > 0 && random(m_statements_left) < m_loops_left * LOOP_BODY)
+            {
+                auto body = 1 + random(std::min(budget - 1, 2 * LOOP_BODY));
+                generate_loop(body, depth, indentation);
+                budget -= body;
+            }
+            else if (can_nest && random(5) == 0)
+            {
+                auto body = 1 + random(std::min(budget - 1, 2 * LOOP_BODY));
+                generate_ifelse(body, depth, indentation);
+                budget -= body;
+            }
+            else
+            {
+                generate_assignment(indentation);
+                budget--;
+            }
+        }
+    }
+
+    void generate_assignment(std::size_t indentation)
+    {
+        m_statements_left -= m_statements_left > 0 ? 1 : 0;
+
+        std::size_t target;
+        if (m_active_counters.empty())
+        {
+            target = random(m_config.variables);
+        }
+        else
+        {
+            auto first = loop_invariant_variables();
+            target = first + random(m_config.variables - first);
+        }
+
+        indent(indentation);
+        m_out << variable(target) << " = " << operand();
+        switch (random(3))
+        {
+            case 0:
+            {
+                m_out << " + " << random(10);
+                break;
+            }
+            case 1:
+            {
+                m_out << " - " << random(10);
+                break;
+            }
+            default:
+            {
+                break;
+            }
+        }
+        m_out << ";\n";
+    }
+
+    // A variable or a constant that an assignment can read
+    std::string operand()
+    {
+        auto choice = random(4);
+        if (choice == 0)
+        {
+            return std::to_string(random(100));
+        }
+        if (m_active_counters.empty())
+        {
+            return variable(random(m_config.variables));
+        }
+        if (choice == 1 || loop_invariant_variables() == 0)
+        {
+            return m_active_counters[random(m_active_counters.size())];
+        }
+        return variable(random(loop_invariant_variables()));
+    }
+
+    std::string condition()
+    {
+        static const char* ops[] = {"<=", ">=", "<", ">"};
+        std::string var;
+        if (!m_active_counters.empty() && random(2) == 0)
+        {
+            var = m_active_counters[random(m_active_counters.size())];
+        }
+        else
+        {
+            var = variable(random(m_config.variables));
+        }
+        return var + " " + ops[random(4)] + " " + std::to_string(random(100));
+    }
+
+    void generate_ifelse(std::size_t budget, std::size_t depth, std::size_t indentation)
+    {
+        indent(indentation);
+        m_out << "if (" << condition() << ") {\n";
+        auto if_budget = budget;
+        std::size_t else_budget = 0;
+        if (budget >= 2 && random(2) == 0)
+        {
+            if_budget = 1 + random(budget - 1);
+            else_budget = budget - if_budget;
+        }
+        generate_block(if_budget, depth + 1, indentation + 1);
+        indent(indentation);
+        m_out << "}\n";
+        if (else_budget > 0)
+        {
+            indent(indentation);
+            m_out << "else {\n";
+            generate_block(else_budget, depth + 1, indentation + 1);
+            indent(indentation);
+            m_out << "}\n";
+        }
+    }
+
+    void generate_loop(std::size_t budget, std::size_t depth, std::size_t indentation)
+    {
+        m_loops_left--;
+        auto name = counter(m_loops_generated++);
+
+        indent(indentation);
+        m_out << name << " = 0;\n";
+        indent(indentation);
+        m_out << "while (" << name << " < " << m_config.loop_bound << ") {\n";
+        m_active_counters.push_back(name);
+        generate_block(budget, depth + 1, indentation + 1);
+        m_active_counters.pop_back();
+        indent(indentation + 1);
+        m_out << name << " = " << name << " + 1;\n";
+        indent(indentation);
+        m_out << "}\n";
+    }
+};
+
+#endif // PROGRAM_GENERATOR_HPP
@@ -0,0 +1,299 @@
+#ifndef ABSINT_HPP
+#define ABSINT_HPP
+
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "analysis_executor.hpp"
+#include "cost_estimator.hpp"
+#include "equational_interpreter.hpp"
+#include "logger.hpp"
+#include "parser.hpp"
+
+/**
+ * @brief Settings of the analyses of an AnalysisContext, with the defaults of the command line
+ *
+ */
+struct AnalysisOptions {
+    SolverMode solver = SolverMode::WORKLIST;
+    std::size_t threads = 1;                        // threads of SolverMode::PARALLEL
+    std::optional<std::size_t> widening_delay;      // EquationalInterpreter::DEFAULT_WIDENING_DELAY if unset
+    std::optional<std::size_t> narrowing_passes;    // EquationalInterpreter::DEFAULT_NARROWING_PASSES if unset
+    bool sparse = false;
+    bool slice = false;
+    bool prefilter = false;
+    bool diagnostics = true;                        // collect the diagnostics of the evaluations
+    bool profile = false;                           // measure the locations (see EquationalInterpreter::set_profile)
+    bool anytime = false;                           // stop once the postconditions are decided (see EquationalInterpreter::set_anytime)
+    AnalysisBudget budget;
+    std::size_t async_workers = 1;                  // threads of AnalysisContext::analyze_async
+};
+
+/**
+ * @brief Interval of a variable at the end of the program
+ *
+ * @tparam T
+ */
+template <typename T>
+struct VariableInvariant {
+    std::string name;
+    Interval<T> interval;
+};
+
+/**
+ * @brief Everything an analysis computes, as data
+ *
+ * @tparam T
+ */
+template <typename T>
+struct AnalysisResult {
+    bool parsed = false;
+    bool cancelled = false;                         // stopped by its token, without invariant nor verdicts
+    std::string error;                              // why a parsed program cannot be analyzed, without invariant nor verdicts
+    std::vector<VariableInvariant<T>> invariant;    // final invariant, in the order of the variables, empty if sliced or anytime
+    std::vector<PostconditionVerdict> verdicts;     // in program order
+    std::vector<Diagnostic> diagnostics;
+    AnalysisStatistics statistics;
+    std::vector<ProfiledLocation> profile;          // empty unless profiling
+    std::string output;                             // what the command line prints at the current log level
+    std::string warnings;                           // what it prints on the error stream, syntax errors included
+
+    /**
+     * @brief Tells if the program was parsed and analyzed, its analysis was not cancelled and all of its
+     * postconditions hold
+     *
+     */
+    bool satisfied() const
+    {
+        if (!parsed || cancelled || !error.empty())
+        {
+            return false;
+        }
+        for (const auto& verdict : verdicts)
+        {
+            if (!verdict.satisfied)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief Entry point of the library: analyzes programs given as source text or as an AST with the same
+ * settings, without printing anything. Each call runs its own analysis, so a context can be shared by
+ * threads. A program that is parsed but cannot be analyzed (a function reading a global variable, for
+ * instance) gets a result whose `error` tells why, and the host goes on.
+ *
+ * The analyses can also run on the executor of the context (see analyze_async), which its copies share
+ * and which the last of them joins once the analyses submitted are done.
+ *
+ * libabsint holds explicit instantiations for `int32_t` and `int64_t`, which the consumers link instead
+ * of instantiating the interpreter again.
+ *
+ * @tparam T
+ */
+template <typename T>
+class AnalysisContext
+{
+public:
+    using Progress = std::function<void(const AnalysisProgress&)>;
+
+private:
+    AnalysisOptions m_options;
+    std::shared_ptr<AnalysisExecutor> m_executor;
+
+public:
+    explicit AnalysisContext(AnalysisOptions options = {})
+    : m_options(std::move(options))
+    , m_executor(std::make_shared<AnalysisExecutor>(m_options.async_workers))
+    {}
+
+    const AnalysisOptions& options() const
+    {
+        return m_options;
+    }
+
+    AnalysisResult<T> analyze(std::string_view source) const
+    {
+        return analyze_tree(m_options, source);
+    }
+
+    AnalysisResult<T> analyze(FlatAST ast) const
+    {
+        return analyze_tree(m_options, std::move(ast));
+    }
+
+    AnalysisResult<T> analyze(const ASTNode& ast) const
+    {
+        return analyze_tree(m_options, ast);
+    }
+
+    /**
+     * @brief Analyzes a program on the executor of the context and returns at once. Once a stop is
+     * requested on the token, the analysis stops before its next location evaluation and its interpreter is
+     * destroyed, with its stores and their pages, before the result is ready, with `cancelled` set; an
+     * analysis stopped before it starts is not even parsed. The progress is reported on the thread of the
+     * executor, at the end of every iteration of the solver (see EquationalInterpreter::set_progress).
+     * Superseding an analysis is thus requesting its stop and submitting the new one.
+     *
+     * @param source
+     * @param token
+     * @param progress
+     * @return std::future<AnalysisResult<T>>
+     */
+    std::future<AnalysisResult<T>> analyze_async(std::string source, std::stop_token token = {}, Progress progress = {}) const
+    {
+        return submit(std::move(source), std::move(token), std::move(progress));
+    }
+
+    std::future<AnalysisResult<T>> analyze_async(FlatAST ast, std::stop_token token = {}, Progress progress = {}) const
+    {
+        return submit(std::move(ast), std::move(token), std::move(progress));
+    }
+
+    /**
+     * @brief Estimates the cost of the analysis of a program without analyzing it (see AnalysisCostEstimator),
+     * to schedule the analyses of many programs
+     *
+     * @param source
+     * @return std::optional<AnalysisCostEstimate> nothing if the source cannot be parsed
+     */
+    std::optional<AnalysisCostEstimate> estimate(std::string_view source) const
+    {
+        auto ast = AbstractInterpreterParser::parse_program(source);
+        if (ast.size() == 0 || ast.root().size() == 0)
+        {
+            return std::nullopt;
+        }
+        return AnalysisCostEstimator::estimate(ast);
+    }
+
+    AnalysisCostEstimate estimate(const FlatAST& ast) const
+    {
+        return AnalysisCostEstimator::estimate(ast);
+    }
+
+private:
+    /**
+     * @brief Queues the analysis of a program on the executor. The task holds a copy of the options and not
+     * the context, which may be destroyed before it runs.
+     *
+     */
+    template <typename Tree>
+    std::future<AnalysisResult<T>> submit(Tree tree, std::stop_token token, Progress progress) const
+    {
+        std::packaged_task<AnalysisResult<T>()> task(
+            [options = m_options, tree = std::move(tree), token = std::move(token), progress = std::move(progress)]() mutable {
+                if (token.stop_requested())
+                {
+                    AnalysisResult<T> result;
+                    result.cancelled = true;
+                    return result;
+                }
+                if constexpr (std::is_same_v<Tree, std::string>)
+                {
+                    return analyze_tree(options, std::string_view(tree), token, progress);
+                }
+                else
+                {
+                    return analyze_tree(options, std::move(tree), token, progress);
+                }
+            });
+        auto future = task.get_future();
+        m_executor->submit(std::move(task));
+        return future;
+    }
+
+    /**
+     * @brief Parses or converts the program inside the interpreter, with the messages of the analysis
+     * captured in the result
+     *
+     */
+    template <typename Tree>
+    static AnalysisResult<T> analyze_tree(const AnalysisOptions& options, Tree&& tree, std::stop_token token = {}, const Progress& progress = {})
+    {
+        AnalysisResult<T> result;
+        std::ostringstream out, err;
+        {
+            Logger::Capture capture(out, err);
+            EquationalInterpreter<T> EI(std::forward<Tree>(tree));
+            EI.set_stop_token(std::move(token));
+            EI.set_progress(progress);
+            run(options, EI, result);
+        }
+        result.output = out.str();
+        result.warnings = err.str();
+        return result;
+    }
+
+    static void run(const AnalysisOptions& options, EquationalInterpreter<T>& EI, AnalysisResult<T>& result)
+    {
+        result.parsed = EI.parsed();
+        if (!result.parsed)
+        {
+            return;
+        }
+        EI.set_solver_mode(options.solver);
+        EI.set_solver_threads(options.threads);
+        EI.set_sparse(options.sparse);
+        EI.set_slice(options.slice);
+        EI.set_prefilter(options.prefilter);
+        EI.set_diagnostics(options.diagnostics);
+        EI.set_profile(options.profile);
+        EI.set_anytime(options.anytime);
+        EI.set_budget(options.budget);
+        if (options.widening_delay)
+        {
+            EI.set_widening_delay(*options.widening_delay);
+        }
+        if (options.narrowing_passes)
+        {
+            EI.set_narrowing_passes(*options.narrowing_passes);
+        }
+        try
+        {
+            EI.run();
+        }
+        catch (const AnalysisError& error)
+        {
+            result.error = error.what();
+            return;
+        }
+        result.statistics = EI.statistics();
+        result.cancelled = EI.cancelled();
+        if (result.cancelled)
+        {
+            return;
+        }
+
+        if (EI.final_store_complete())
+        {
+            auto store = EI.final_store();
+            result.invariant.reserve(store->size());
+            for (std::size_t id = 0; id < store->size(); ++id)
+            {
+                result.invariant.push_back({store->name(id), std::as_const(*store).get(id)});
+            }
+        }
+        result.verdicts = EI.verdicts();
+        result.diagnostics = EI.diagnostics();
+        result.profile = EI.profile();
+    }
+};
+
+extern template class EquationalInterpreter<int32_t>;
+extern template class EquationalInterpreter<int64_t>;
+extern template class AnalysisContext<int32_t>;
+extern template class AnalysisContext<int64_t>;
+
+#endif // ABSINT_HPP
@@ -0,0 +1,468 @@
+#ifndef ABSTRACT_DOMAIN_HPP
+#define ABSTRACT_DOMAIN_HPP
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <type_traits>
+
+#include "flat_ast.hpp"
+#include "interval.hpp"
+
+/**
+ * @brief Non-relational abstract domain over the values of the integer type D::Bound, as operations on its
+ * abstract values D::Value. The operations are static so that an analysis templated over the domain is
+ * fully specialized by the compiler.
+ *
+ * - top, bottom, and abstract(lb, ub) the abstraction of the values from lb to ub;
+ * - join, meet, widen and leq, the order of the lattice;
+ * - arithmetic(op, a, b), an abstraction of the saturating arithmetic of the interval analysis;
+ * - filter(op, a, b), the values of a that are `op` some value of b, used for the guards;
+ * - holds(op, a, b), true if every value of a is `op` every value of b, and neither of them is bottom.
+ *
+ * @tparam D
+ */
+template <typename D>
+concept AbstractDomain = std::integral<typename D::Bound>
+    && requires(const typename D::Value& a, const typename D::Value& b, typename D::Bound bound, BinOp op, LogicOp guard) {
+        { D::top() } -> std::same_as<typename D::Value>;
+        { D::bottom() } -> std::same_as<typename D::Value>;
+        { D::abstract(bound, bound) } -> std::same_as<typename D::Value>;
+        { D::join(a, b) } -> std::same_as<typename D::Value>;
+        { D::meet(a, b) } -> std::same_as<typename D::Value>;
+        { D::widen(a, b) } -> std::same_as<typename D::Value>;
+        { D::leq(a, b) } -> std::same_as<bool>;
+        { D::is_bottom(a) } -> std::same_as<bool>;
+        { D::arithmetic(op, a, b) } -> std::same_as<typename D::Value>;
+        { D::filter(guard, a, b) } -> std::same_as<typename D::Value>;
+        { D::holds(guard, a, b) } -> std::same_as<bool>;
+    };
+
+/**
+ * @brief A variable of a pack of a RelationalDomain, by its position in the pack, or its opposite
+ *
+ */
+struct PackTerm {
+    std::size_t variable;
+    bool negated = false;
+};
+
+/**
+ * @brief Relational abstract domain over a pack of variables of the integer type D::Bound, as operations on
+ * its abstract values D::Value, which relate the variables of a pack by some linear constraints. The
+ * operations are static, as those of an AbstractDomain, and the ones that update a value take it by
+ * reference, so that an analysis does not copy the value of a pack at every statement.
+ *
+ * - top(size) and bottom(size), over `size` variables;
+ * - join, widen and leq, the order of the lattice;
+ * - forget(a, x), which drops what is known of x;
+ * - assign(a, x, y, c), the assignment x = y + c of a term of the pack plus a constant, and
+ *   assign_range(a, x, lb, ub), the assignment of some value from lb to ub;
+ * - constrain(a, x, y, c), the meet with x + y <= c, or x <= c without y, used for the guards;
+ * - entails(a, x, y, c), true if x + y <= c, or x <= c, holds for every value of the pack;
+ * - range(a, x), the values of x, empty for bottom.
+ *
+ * @tparam D
+ */
+template <typename D>
+concept RelationalDomain = std::integral<typename D::Bound>
+    && requires(typename D::Value& value, const typename D::Value& a, const typename D::Value& b, std::size_t variable,
+                PackTerm x, std::optional<PackTerm> y, typename D::Bound bound) {
+        { D::top(variable) } -> std::same_as<typename D::Value>;
+        { D::bottom(variable) } -> std::same_as<typename D::Value>;
+        { D::join(a, b) } -> std::same_as<typename D::Value>;
+        { D::widen(a, b) } -> std::same_as<typename D::Value>;
+        { D::leq(a, b) } -> std::same_as<bool>;
+        { D::is_bottom(a) } -> std::same_as<bool>;
+        { D::forget(value, variable) } -> std::same_as<void>;
+        { D::assign(value, variable, x, bound) } -> std::same_as<void>;
+        { D::assign_range(value, variable, bound, bound) } -> std::same_as<void>;
+        { D::constrain(value, x, y, bound) } -> std::same_as<void>;
+        { D::entails(a, x, y, bound) } -> std::same_as<bool>;
+        { D::range(a, variable) } -> std::same_as<Interval<typename D::Bound>>;
+    };
+
+/**
+ * @brief Signs of the values: a subset of {negative, zero, positive}, as a bitmask. The lattice has finite
+ * height, so widening is the join.
+ *
+ * @tparam T
+ */
+template <typename T>
+struct SignDomain
+{
+    using Bound = T;
+    using Value = std::uint8_t;
+
+    static constexpr Value NEGATIVE = 1;
+    static constexpr Value ZERO = 2;
+    static constexpr Value POSITIVE = 4;
+
+    static Value top() { return NEGATIVE | ZERO | POSITIVE; }
+    static Value bottom() { return 0; }
+
+    static Value abstract(T lb, T ub)
+    {
+        if (lb > ub)
+        {
+            return bottom();
+        }
+        Value value = 0;
+        if (lb < 0) value |= NEGATIVE;
+        if (lb <= 0 && ub >= 0) value |= ZERO;
+        if (ub > 0) value |= POSITIVE;
+        return value;
+    }
+
+    static Value join(Value a, Value b) { return a | b; }
+    static Value meet(Value a, Value b) { return a & b; }
+    static Value widen(Value a, Value b) { return a | b; }
+    static bool leq(Value a, Value b) { return (a & ~b) == 0; }
+    static bool is_bottom(Value a) { return a == 0; }
+
+    static Value arithmetic(BinOp op, Value a, Value b)
+    {
+        // Union of the signs of the results for every pair of signs of the operands
+        Value result = 0;
+        for (Value x = NEGATIVE; x <= POSITIVE; x <<= 1)
+        {
+            for (Value y = NEGATIVE; y <= POSITIVE; y <<= 1)
+            {
+                if ((a & x) && (b & y))
+                {
+                    result |= combine(op, x, y);
+                }
+            }
+        }
+        return result;
+    }
+
+    static Value filter(LogicOp op, Value a, Value b)
+    {
+        if (is_bottom(b))
+        {
+            return bottom();
+        }
+        switch (op)
+        {
+            case LogicOp::LE: return a & below(highest(b), false);
+            case LogicOp::LEQ: return a & below(highest(b), true);
+            case LogicOp::GE: return a & above(lowest(b), false);
+            case LogicOp::GEQ: return a & above(lowest(b), true);
+            case LogicOp::EQ: return a & b;
+            case LogicOp::NEQ: return b == ZERO ? static_cast<Value>(a & ~ZERO) : a;
+        }
+        return a;
+    }
+
+    static bool holds(LogicOp op, Value a, Value b)
+    {
+        if (is_bottom(a) || is_bottom(b))
+        {
+            return false;
+        }
+        switch (op)
+        {
+            case LogicOp::LE: return highest(a) < lowest(b);
+            case LogicOp::LEQ: return highest(a) < lowest(b) || (highest(a) == ZERO && lowest(b) == ZERO);
+            case LogicOp::GE: return lowest(a) > highest(b);
+            case LogicOp::GEQ: return lowest(a) > highest(b) || (lowest(a) == ZERO && highest(b) == ZERO);
+            case LogicOp::EQ: return a == ZERO && b == ZERO;
+            case LogicOp::NEQ: return (a & b) == 0;
+        }
+        return false;
+    }
+
+private:
+    // Signs are ordered as their bits: negative < zero < positive
+    static Value lowest(Value a) { return static_cast<Value>(a & -a); }
+    static Value highest(Value a) { return a & POSITIVE ? POSITIVE : a & ZERO ? ZERO : static_cast<Value>(a & NEGATIVE); }
+
+    // Signs of the values below (or at) some value of the given sign
+    static Value below(Value sign, bool strict_or_equal)
+    {
+        if (sign == POSITIVE) return top();
+        if (sign == ZERO) return strict_or_equal ? NEGATIVE | ZERO : NEGATIVE;
+        return NEGATIVE;
+    }
+
+    static Value above(Value sign, bool strict_or_equal)
+    {
+        if (sign == NEGATIVE) return top();
+        if (sign == ZERO) return strict_or_equal ? ZERO | POSITIVE : POSITIVE;
+        return POSITIVE;
+    }
+
+    static Value negate(Value sign)
+    {
+        return sign == NEGATIVE ? POSITIVE : sign == POSITIVE ? NEGATIVE : ZERO;
+    }
+
+    static Value combine(BinOp op, Value x, Value y)
+    {
+        switch (op)
+        {
+            case BinOp::ADD:
+            {
+                if (x == ZERO) return y;
+                if (y == ZERO || x == y) return x;
+                return top();
+            }
+            case BinOp::SUB:
+            {
+                // Saturated at 0 for the unsigned types
+                if constexpr (!std::is_signed_v<T>)
+                {
+                    return y == ZERO ? x : x == ZERO ? ZERO : ZERO | POSITIVE;
+                }
+                return combine(BinOp::ADD, x, negate(y));
+            }
+            case BinOp::MUL:
+            {
+                if (x == ZERO || y == ZERO) return ZERO;
+                return x == y ? POSITIVE : NEGATIVE;
+            }
+            case BinOp::DIV:
+            {
+                // Dividing by an interval that contains 0 gives the whole range, and divisions truncate
+                if (y == ZERO) return top();
+                if (x == ZERO) return ZERO;
+                return ZERO | (x == y ? POSITIVE : NEGATIVE);
+            }
+        }
+        return top();
+    }
+};
+
+/**
+ * @brief Constant propagation: a value is bottom, a single constant or top. An operation that overflows T
+ * or divides by zero gives top.
+ *
+ * @tparam T
+ */
+template <typename T>
+struct ConstantDomain
+{
+    using Bound = T;
+
+    struct Value {
+        enum class Kind : std::uint8_t { BOTTOM, CONSTANT, TOP } kind = Kind::TOP;
+        T constant = 0;
+
+        bool operator==(const Value&) const = default;
+    };
+
+    static Value top() { return {Value::Kind::TOP, 0}; }
+    static Value bottom() { return {Value::Kind::BOTTOM, 0}; }
+
+    static Value abstract(T lb, T ub)
+    {
+        if (lb > ub) return bottom();
+        if (lb == ub) return {Value::Kind::CONSTANT, lb};
+        return top();
+    }
+
+    static Value join(const Value& a, const Value& b)
+    {
+        if (is_bottom(a)) return b;
+        if (is_bottom(b) || a == b) return a;
+        return top();
+    }
+
+    static Value meet(const Value& a, const Value& b)
+    {
+        if (a.kind == Value::Kind::TOP) return b;
+        if (b.kind == Value::Kind::TOP || a == b) return a;
+        return bottom();
+    }
+
+    static Value widen(const Value& a, const Value& b) { return join(a, b); }
+    static bool leq(const Value& a, const Value& b) { return is_bottom(a) || b.kind == Value::Kind::TOP || a == b; }
+    static bool is_bottom(const Value& a) { return a.kind == Value::Kind::BOTTOM; }
+
+    static Value arithmetic(BinOp op, const Value& a, const Value& b)
+    {
+        if (is_bottom(a) || is_bottom(b))
+        {
+            return bottom();
+        }
+        if (op == BinOp::MUL && (is_zero(a) || is_zero(b)))
+        {
+            return {Value::Kind::CONSTANT, 0};
+        }
+        if (a.kind != Value::Kind::CONSTANT || b.kind != Value::Kind::CONSTANT)
+        {
+            return top();
+        }
+        bool overflow = false;
+        T result = 0;
+        switch (op)
+        {
+            case BinOp::ADD: result = BoundArithmetic<T>::add(a.constant, b.constant, overflow); break;
+            case BinOp::SUB: result = BoundArithmetic<T>::sub(a.constant, b.constant, overflow); break;
+            case BinOp::MUL: result = BoundArithmetic<T>::mul(a.constant, b.constant, overflow); break;
+            case BinOp::DIV:
+            {
+                if (b.constant == 0 || (std::is_signed_v<T> && a.constant == std::numeric_limits<T>::min() && b.constant == T(-1)))
+                {
+                    return top();
+                }
+                result = a.constant / b.constant;
+                break;
+            }
+        }
+        return overflow ? top() : Value{Value::Kind::CONSTANT, result};
+    }
+
+    static Value filter(LogicOp op, const Value& a, const Value& b)
+    {
+        if (is_bottom(a) || is_bottom(b))
+        {
+            return bottom();
+        }
+        if (op == LogicOp::EQ)
+        {
+            return meet(a, b);
+        }
+        if (a.kind == Value::Kind::CONSTANT && b.kind == Value::Kind::CONSTANT && !compare(op, a.constant, b.constant))
+        {
+            return bottom();
+        }
+        return a;
+    }
+
+    static bool holds(LogicOp op, const Value& a, const Value& b)
+    {
+        return a.kind == Value::Kind::CONSTANT && b.kind == Value::Kind::CONSTANT && compare(op, a.constant, b.constant);
+    }
+
+private:
+    static bool is_zero(const Value& a)
+    {
+        return a.kind == Value::Kind::CONSTANT && a.constant == 0;
+    }
+
+    static bool compare(LogicOp op, T a, T b)
+    {
+        switch (op)
+        {
+            case LogicOp::LE: return a < b;
+            case LogicOp::LEQ: return a <= b;
+            case LogicOp::GE: return a > b;
+            case LogicOp::GEQ: return a >= b;
+            case LogicOp::EQ: return a == b;
+            case LogicOp::NEQ: return a != b;
+        }
+        return false;
+    }
+};
+
+/**
+ * @brief The intervals of the equational interpreter as an AbstractDomain, with the widening to the ends
+ * of the range of T and the arithmetic of Interval<T>
+ *
+ * @tparam T
+ */
+template <typename T>
+struct IntervalDomain
+{
+    using Bound = T;
+    using Value = Interval<T>;
+
+    static constexpr T min_T = std::numeric_limits<T>::min();
+    static constexpr T max_T = std::numeric_limits<T>::max();
+
+    static Value top() { return Value(min_T, max_T); }
+    static Value bottom() { return Value::empty(); }
+    static Value abstract(T lb, T ub) { return lb > ub ? bottom() : Value(lb, ub); }
+
+    static Value join(Value a, Value b)
+    {
+        a.join(b);
+        return a;
+    }
+
+    static Value meet(Value a, Value b)
+    {
+        a.meet(b);
+        return a;
+    }
+
+    static Value widen(const Value& a, const Value& b)
+    {
+        if (a.is_empty()) return b;
+        if (b.is_empty()) return a;
+        return Value(b.lb() < a.lb() ? min_T : a.lb(), b.ub() > a.ub() ? max_T : a.ub());
+    }
+
+    static bool leq(const Value& a, const Value& b)
+    {
+        return a.is_empty() || (!b.is_empty() && b.lb() <= a.lb() && a.ub() <= b.ub());
+    }
+
+    static bool is_bottom(const Value& a) { return a.is_empty(); }
+
+    static Value arithmetic(BinOp op, Value a, Value b)
+    {
+        switch (op)
+        {
+            case BinOp::ADD: return a + b;
+            case BinOp::SUB: return a - b;
+            case BinOp::MUL: return a * b;
+            case BinOp::DIV: return a / b;
+        }
+        return top();
+    }
+
+    static Value filter(LogicOp op, const Value& a, const Value& b)
+    {
+        if (a.is_empty() || b.is_empty())
+        {
+            return bottom();
+        }
+        switch (op)
+        {
+            case LogicOp::LE: return b.ub() == min_T ? bottom() : meet(a, Value(min_T, b.ub() - 1));
+            case LogicOp::LEQ: return meet(a, Value(min_T, b.ub()));
+            case LogicOp::GE: return b.lb() == max_T ? bottom() : meet(a, Value(b.lb() + 1, max_T));
+            case LogicOp::GEQ: return meet(a, Value(b.lb(), max_T));
+            case LogicOp::EQ: return meet(a, b);
+            case LogicOp::NEQ:
+            {
+                if (b.lb() != b.ub() || (a.lb() == a.ub() && a.lb() != b.lb())) return a;
+                if (a.lb() == a.ub()) return bottom();
+                if (a.lb() == b.lb()) return Value(a.lb() + 1, a.ub());
+                if (a.ub() == b.lb()) return Value(a.lb(), a.ub() - 1);
+                return a;
+            }
+        }
+        return a;
+    }
+
+    static bool holds(LogicOp op, const Value& a, const Value& b)
+    {
+        if (a.is_empty() || b.is_empty())
+        {
+            return false;
+        }
+        switch (op)
+        {
+            case LogicOp::LE: return a.ub() < b.lb();
+            case LogicOp::LEQ: return a.ub() <= b.lb();
+            case LogicOp::GE: return a.lb() > b.ub();
+            case LogicOp::GEQ: return a.lb() >= b.ub();
+            case LogicOp::EQ: return a.lb() == a.ub() && b.lb() == b.ub() && a.lb() == b.lb();
+            case LogicOp::NEQ: return a.ub() < b.lb() || b.ub() < a.lb();
+        }
+        return false;
+    }
+};
+
+static_assert(AbstractDomain<SignDomain<std::int64_t>>);
+static_assert(AbstractDomain<ConstantDomain<std::int64_t>>);
+static_assert(AbstractDomain<IntervalDomain<std::int64_t>>);
+
+#endif // ABSTRACT_DOMAIN_HPP
@@ -0,0 +1,22 @@
+#ifndef ANALYSIS_ERROR_HPP
+#define ANALYSIS_ERROR_HPP
+
+#include <stdexcept>
+#include <string>
+
+/**
+ * @brief Error of a program that is parsed but cannot be analyzed, such as a condition the interpreter does
+ * not support. It is thrown while the equational system is built, or while a function summary is built
+ * during the solve, and leaves the interpreter unusable. The drivers catch it and report the program as an
+ * error: the command line exits with an error, a batch or a server goes on with the next program.
+ *
+ */
+class AnalysisError : public std::runtime_error
+{
+public:
+    explicit AnalysisError(const std::string& message)
+    : std::runtime_error(message)
+    {}
+};
+
+#endif // ANALYSIS_ERROR_HPP
@@ -0,0 +1,96 @@
+#ifndef ANALYSIS_EXECUTOR_HPP
+#define ANALYSIS_EXECUTOR_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Threads that run the asynchronous analyses of an AnalysisContext (see
+ * AnalysisContext::analyze_async), in the order they were submitted. The threads are started by the first
+ * submission, so that a context that only analyzes synchronously starts none, and are joined once the
+ * tasks already submitted are done: the owner cancels them first not to wait for their fixpoints.
+ *
+ */
+class AnalysisExecutor
+{
+private:
+    std::size_t m_workers;
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    std::deque<std::move_only_function<void()>> m_tasks;
+    bool m_stop = false;
+
+public:
+    explicit AnalysisExecutor(std::size_t workers)
+    : m_workers(workers == 0 ? 1 : workers)
+    {}
+
+    AnalysisExecutor(const AnalysisExecutor&) = delete;
+    AnalysisExecutor& operator=(const AnalysisExecutor&) = delete;
+
+    ~AnalysisExecutor()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wakeup.notify_all();
+        for (auto& thread : m_threads)
+        {
+            thread.join();
+        }
+    }
+
+    std::size_t workers() const
+    {
+        return m_workers;
+    }
+
+    /**
+     * @brief Queues a task, which runs on the first thread that is free
+     *
+     * @param task
+     */
+    void submit(std::move_only_function<void()> task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tasks.push_back(std::move(task));
+            if (m_threads.empty())
+            {
+                for (std::size_t i = 0; i < m_workers; ++i)
+                {
+                    m_threads.emplace_back([this]() { work(); });
+                }
+            }
+        }
+        m_wakeup.notify_one();
+    }
+
+private:
+    void work()
+    {
+        while (true)
+        {
+            std::move_only_function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wakeup.wait(lock, [this]() { return m_stop || !m_tasks.empty(); });
+                if (m_tasks.empty())
+                {
+                    return;
+                }
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+            }
+            task();
+        }
+    }
+};
+
+#endif // ANALYSIS_EXECUTOR_HPP
@@ -0,0 +1,191 @@
+#ifndef ANALYSIS_REPORT_HPP
+#define ANALYSIS_REPORT_HPP
+
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "equational_interpreter.hpp"
+
+/**
+ * @brief Appends a string to a buffer as a JSON string literal
+ *
+ * @param out
+ * @param value
+ */
+inline void append_json_string(std::string& out, std::string_view value)
+{
+    static const char* hex = "0123456789abcdef";
+    out += '"';
+    for (unsigned char c : value)
+    {
+        switch (c)
+        {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            case '\r': out += "\\r"; break;
+            default:
+            {
+                if (c < 0x20)
+                {
+                    out += "\\u00";
+                    out += hex[c >> 4];
+                    out += hex[c & 0xf];
+                }
+                else
+                {
+                    out += static_cast<char>(c);
+                }
+            }
+        }
+    }
+    out += '"';
+}
+
+/**
+ * @brief Writes a string as a JSON string literal
+ *
+ * @param out
+ * @param value
+ */
+inline void write_json_string(std::ostream& out, const std::string& value)
+{
+    std::string literal;
+    append_json_string(literal, value);
+    out << literal;
+}
+
+/**
+ * @brief Writes the counters of an analysis as a JSON object, with a member per phase, or `null` if they
+ * were not measured. A hardware event that was not counted is `null` in every phase.
+ *
+ * @param out
+ * @param counters
+ */
+inline void write_json_counters(std::ostream& out, const AnalysisCounters& counters)
+{
+    if (counters.source == CounterSource::NONE)
+    {
+        out << "null";
+        return;
+    }
+    out << "{\"source\": \"" << counter_source_name(counters.source) << '"';
+    for (std::size_t phase = 0; phase < ANALYSIS_PHASES; ++phase)
+    {
+        const auto& measured = counters.phases[phase];
+        out << ", \"" << analysis_phase_name(static_cast<AnalysisPhase>(phase)) << "\": {\"measurements\": " << measured.measurements
+            << ", \"cpu_ms\": " << measured.cpu_ns / 1e6
+            << ", \"page_faults\": " << measured.page_faults
+            << ", \"context_switches\": " << measured.context_switches;
+        for (std::size_t event = 0; event < HARDWARE_EVENTS; ++event)
+        {
+            out << ", \"" << hardware_event_name(static_cast<HardwareEvent>(event)) << "\": ";
+            if (counters.has(static_cast<HardwareEvent>(event)))
+            {
+                out << measured.events[event];
+            }
+            else
+            {
+                out << "null";
+            }
+        }
+        out << "}";
+    }
+    out << "}";
+}
+
+/**
+ * @brief Writes the metrics of an analysis as a JSON object. The fields are stable across versions, so
+ * that the reports of different builds can be compared.
+ *
+ * @param out
+ * @param statistics
+ */
+inline void write_json_metrics(std::ostream& out, const AnalysisStatistics& statistics)
+{
+    out << "{\"cached\": " << (statistics.cached ? "true" : "false")
+        << ", \"budget_exceeded\": ";
+    if (statistics.budget_exceeded == BudgetExceeded::NONE)
+    {
+        out << "null";
+    }
+    else
+    {
+        out << '"' << budget_name(statistics.budget_exceeded) << '"';
+    }
+    out << ", \"locations\": " << statistics.locations
+        << ", \"iterations\": " << statistics.iterations
+        << ", \"ascending_iterations\": " << statistics.ascending_iterations
+        << ", \"narrowing_iterations\": " << statistics.narrowing_iterations
+        << ", \"location_evaluations\": " << statistics.location_evaluations
+        << ", \"estimated_evaluations\": " << statistics.estimated_evaluations
+        << ", \"reused_locations\": " << statistics.reused_locations
+        << ", \"simplifications\": " << statistics.simplifications
+        << ", \"sliced_statements\": " << statistics.sliced_statements
+        << ", \"accelerated_loops\": " << statistics.accelerated_loops
+        << ", \"discharged_postconditions\": " << statistics.discharged_postconditions
+        << ", \"function_summaries\": " << statistics.function_summaries
+        << ", \"summary_reuses\": " << statistics.summary_reuses
+        << ", \"shared_subterms\": " << statistics.shared_subterms
+        << ", \"subterm_reuses\": " << statistics.subterm_reuses
+        << ", \"diagnostics\": " << statistics.diagnostics
+        << ", \"evaluations_by_type\": {";
+    for (std::size_t type = 0; type < LOCATION_TYPES; ++type)
+    {
+        out << (type == 0 ? "" : ", ") << '"' << location_type_name(static_cast<LocationType>(type)) << "\": "
+            << statistics.evaluations_by_type[type];
+    }
+    out << "}, \"widenings\": " << statistics.widenings
+        << ", \"narrowings\": " << statistics.narrowings
+        << ", \"stores_allocated\": " << statistics.stores_allocated
+        << ", \"page_allocations\": " << statistics.page_allocations
+        << ", \"page_copies\": " << statistics.page_copies
+        << ", \"bytes_copied\": " << statistics.bytes_copied
+        << ", \"time_ms\": {\"parse\": " << statistics.parse_ms
+        << ", \"build\": " << statistics.build_ms
+        << ", \"solve\": " << statistics.solve_ms
+        << ", \"stability\": " << statistics.stability_ms
+        << ", \"postconditions\": " << statistics.postconditions_ms << "}"
+        << ", \"counters\": ";
+    write_json_counters(out, statistics.counters);
+    out << "}";
+}
+
+/**
+ * @brief Writes the report of the analysis of one file: its path, the verdicts of its postconditions and
+ * the metrics of the analysis. An error replaces the verdicts and the metrics.
+ *
+ * @param out
+ * @param path
+ * @param statistics
+ * @param verdicts
+ * @param error
+ */
+inline void write_json_report(std::ostream& out, const std::string& path, const AnalysisStatistics& statistics,
+                              const std::vector<PostconditionVerdict>& verdicts, const std::string& error = "")
+{
+    out << "{\"file\": ";
+    write_json_string(out, path);
+    if (!error.empty())
+    {
+        out << ", \"error\": ";
+        write_json_string(out, error);
+        out << "}";
+        return;
+    }
+
+    out << ", \"verdicts\": [";
+    for (std::size_t i = 0; i < verdicts.size(); ++i)
+    {
+        out << (i == 0 ? "" : ", ") << "{\"location\": " << verdicts[i].location
+            << ", \"satisfied\": " << (verdicts[i].satisfied ? "true" : "false") << (verdicts[i].decided ? "" : ", \"decided\": false") << "}";
+    }
+    out << "], \"metrics\": ";
+    write_json_metrics(out, statistics);
+    out << "}";
+}
+
+#endif // ANALYSIS_REPORT_HPP
@@ -0,0 +1,390 @@
+#ifndef ANALYSIS_SERVER_HPP
+#define ANALYSIS_SERVER_HPP
+
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "analysis_error.hpp"
+#include "analysis_report.hpp"
+#include "incremental_analysis.hpp"
+#include "logger.hpp"
+#include "result_cache.hpp"
+
+/**
+ * @brief Buffered reads of lines and of blocks of a given size from a file descriptor, and complete writes
+ * to another one
+ *
+ */
+class FramedConnection
+{
+private:
+    int m_in;
+    int m_out;
+    std::string m_buffer;
+    std::size_t m_position = 0;
+
+public:
+    FramedConnection(int in, int out)
+    : m_in(in)
+    , m_out(out)
+    {}
+
+    /**
+     * @brief Reads a line, without its end
+     *
+     * @param line
+     * @return false at the end of the input
+     */
+    bool read_line(std::string& line)
+    {
+        while (true)
+        {
+            auto end = m_buffer.find('\n', m_position);
+            if (end != std::string::npos)
+            {
+                line.assign(m_buffer, m_position, end - m_position);
+                m_position = end + 1;
+                return true;
+            }
+            if (!fill())
+            {
+                return false;
+            }
+        }
+    }
+
+    /**
+     * @brief Reads exactly size bytes
+     *
+     * @param size
+     * @param block
+     * @return false if the input ends before
+     */
+    bool read_block(std::size_t size, std::string& block)
+    {
+        while (m_buffer.size() - m_position < size)
+        {
+            if (!fill())
+            {
+                return false;
+            }
+        }
+        block.assign(m_buffer, m_position, size);
+        m_position += size;
+        return true;
+    }
+
+    bool write(const std::string& data)
+    {
+        std::size_t written = 0;
+        while (written < data.size())
+        {
+            auto result = ::write(m_out, data.data() + written, data.size() - written);
+            if (result < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (result <= 0)
+            {
+                return false;
+            }
+            written += result;
+        }
+        return true;
+    }
+
+private:
+    bool fill()
+    {
+        // Drop what was already consumed before reading more
+        m_buffer.erase(0, m_position);
+        m_position = 0;
+        char chunk[65536];
+        while (true)
+        {
+            auto result = ::read(m_in, chunk, sizeof(chunk));
+            if (result < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (result <= 0)
+            {
+                return false;
+            }
+            m_buffer.append(chunk, result);
+            return true;
+        }
+    }
+};
+
+/**
+ * @brief Long-running analysis service. It keeps the parser of its thread, the incremental analysis of
+ * every file it was asked about and the result cache, so that a request only pays for the statements that
+ * changed since the last request about the same file.
+ *
+ * The requests are read from the standard input or from the connections to a Unix socket, and served one at
+ * a time. A request is a line `analyze SIZE NAME` followed by SIZE bytes of source, and is answered by a line
+ * holding the size of the answer, followed by the answer: the JSON report of the analysis (see
+ * write_json_report) on a single line, reporting `"parsing failed"` as error if the source is not a
+ * program, or the reason why it cannot be analyzed. `quit` ends the connection, and `shutdown` also stops the server. The analyses run quietly.
+ *
+ * @tparam T
+ */
+template <typename T>
+class AnalysisServer
+{
+public:
+    // Files whose incremental analysis is kept; the least recently analyzed one is dropped beyond it
+    static constexpr std::size_t MAX_SESSIONS = 256;
+
+private:
+    struct Session {
+        std::unique_ptr<IncrementalAnalysis<T>> analysis;
+        std::uint64_t last_use;
+    };
+
+    std::function<void(EquationalInterpreter<T>&)> m_configure;
+    std::optional<ResultCache<T>> m_cache;
+    EquationalInterpreter<T> m_settings;    // configured like the analyses, only read for the cache keys
+    std::map<std::string, Session> m_sessions;
+    std::uint64_t m_requests = 0;
+
+public:
+    /**
+     * @brief Creates a server whose analyses are all set up by the given function
+     *
+     * @param configure
+     * @param cache_path if not empty, directory of the ResultCache of the results
+     */
+    explicit AnalysisServer(std::function<void(EquationalInterpreter<T>&)> configure, const std::string& cache_path = "")
+    : m_configure(std::move(configure))
+    {
+        if (!cache_path.empty())
+        {
+            m_cache.emplace(cache_path);
+        }
+        if (m_configure)
+        {
+            m_configure(m_settings);
+        }
+    }
+
+    /**
+     * @brief Analyzes a version of a file
+     *
+     * @param name identifies the file across requests
+     * @param source
+     * @return std::string the JSON report of the analysis
+     */
+    std::string analyze(const std::string& name, const std::string& source)
+    {
+        std::ostringstream report;
+        ResultCacheKey key;
+        if (m_cache)
+        {
+            key = ResultCacheKey::make<T>(source, m_settings.solver_mode(), m_settings.widening_delay(),
+                                          m_settings.narrowing_passes(), m_settings.sparse(), m_settings.slice(),
+                                          m_settings.prefilter());
+            if (auto cached = m_cache->lookup(key))
+            {
+                write_json_report(report, name, cached->statistics(), cached->verdicts());
+                return report.str();
+            }
+        }
+
+        EquationalInterpreter<T>* interpreter;
+        try
+        {
+            interpreter = session(name).analyze(source);
+        }
+        catch (const AnalysisError& error)
+        {
+            return error_report(name, error.what());
+        }
+        if (interpreter == nullptr)
+        {
+            return error_report(name, "parsing failed");
+        }
+        if (m_cache && !m_cache->store(key, *interpreter))
+        {
+            WARN_SUMMARY << "[WARNING] cannot write the result of `" << name << "` to the cache" << std::endl;
+        }
+        write_json_report(report, name, interpreter->statistics(), interpreter->verdicts());
+        return report.str();
+    }
+
+    /**
+     * @brief Serves the requests of a connection until it ends
+     *
+     * @param connection
+     * @return true if the server was asked to shut down
+     */
+    bool serve(FramedConnection& connection)
+    {
+        std::string line;
+        std::string source;
+        while (connection.read_line(line))
+        {
+            if (line == "quit")
+            {
+                return false;
+            }
+            if (line == "shutdown")
+            {
+                return true;
+            }
+
+            std::istringstream request(line);
+            std::string command;
+            std::size_t size = 0;
+            std::string name;
+            request >> command >> size;
+            std::getline(request >> std::ws, name);
+            if (command != "analyze" || request.fail() || name.empty())
+            {
+                // The size of the source is unknown: the rest of the connection cannot be read
+                connection.write(frame(error_report(name, "malformed request `" + line + "`")));
+                return false;
+            }
+            if (!connection.read_block(size, source))
+            {
+                return false;
+            }
+            if (!connection.write(frame(analyze(name, source))))
+            {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Serves the requests read from the standard input, answering on the standard output
+     *
+     * @return int the exit code of the process
+     */
+    int serve_standard_streams()
+    {
+        Logger::set_level(LogLevel::QUIET);
+        std::cout.flush();
+        FramedConnection connection(STDIN_FILENO, STDOUT_FILENO);
+        serve(connection);
+        return 0;
+    }
+
+    /**
+     * @brief Serves the connections to a Unix socket created at the given path, until one of them asks to
+     * shut down. A socket left at the path by a previous server is replaced.
+     *
+     * @param path
+     * @return int the exit code of the process
+     */
+    int serve_socket(const std::string& path)
+    {
+        sockaddr_un address{};
+        if (path.size() >= sizeof(address.sun_path))
+        {
+            std::cerr << "[ERROR] the socket path `" << path << "` is too long." << std::endl;
+            return 1;
+        }
+        address.sun_family = AF_UNIX;
+        std::strcpy(address.sun_path, path.c_str());
+        Logger::set_level(LogLevel::QUIET);
+        // A client that disconnects before its answer must not stop the server
+        std::signal(SIGPIPE, SIG_IGN);
+
+        struct stat info;
+        if (::lstat(path.c_str(), &info) == 0 && S_ISSOCK(info.st_mode))
+        {
+            ::unlink(path.c_str());
+        }
+        int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listener < 0 || ::bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0
+            || ::listen(listener, 16) != 0)
+        {
+            std::cerr << "[ERROR] cannot listen on `" << path << "`: " << std::strerror(errno) << "." << std::endl;
+            if (listener >= 0)
+            {
+                ::close(listener);
+            }
+            return 1;
+        }
+
+        bool shutdown = false;
+        while (!shutdown)
+        {
+            int client = ::accept(listener, nullptr, nullptr);
+            if (client < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                std::cerr << "[ERROR] cannot accept a connection: " << std::strerror(errno) << "." << std::endl;
+                break;
+            }
+            FramedConnection connection(client, client);
+            shutdown = serve(connection);
+            ::close(client);
+        }
+        ::close(listener);
+        ::unlink(path.c_str());
+        return shutdown ? 0 : 1;
+    }
+
+private:
+    IncrementalAnalysis<T>& session(const std::string& name)
+    {
+        auto it = m_sessions.find(name);
+        if (it == m_sessions.end())
+        {
+            if (m_sessions.size() >= MAX_SESSIONS)
+            {
+                auto oldest = m_sessions.begin();
+                for (auto candidate = m_sessions.begin(); candidate != m_sessions.end(); ++candidate)
+                {
+                    if (candidate->second.last_use < oldest->second.last_use)
+                    {
+                        oldest = candidate;
+                    }
+                }
+                m_sessions.erase(oldest);
+            }
+            it = m_sessions.emplace(name, Session{std::make_unique<IncrementalAnalysis<T>>(m_configure), 0}).first;
+        }
+        it->second.last_use = ++m_requests;
+        return *it->second.analysis;
+    }
+
+    static std::string error_report(const std::string& name, const std::string& error)
+    {
+        std::ostringstream report;
+        write_json_report(report, name, {}, {}, error);
+        return report.str();
+    }
+
+    /**
+     * @brief Frames an answer: its size on a line, then the answer and the end of its line
+     *
+     */
+    static std::string frame(const std::string& answer)
+    {
+        return std::to_string(answer.size() + 1) + "\n" + answer + "\n";
+    }
+};
+
+#endif // ANALYSIS_SERVER_HPP
@@ -5,9 +5,10 @@
 
 #include <variant>
 #include <cmath>
+#include <cstdint>
 
 enum class BinOp {ADD, SUB, MUL, DIV};
-std::ostream& operator<<(std::ostream& os, BinOp op) {
+inline std::ostream& operator<<(std::ostream& os, BinOp op) {
     switch (op) {
         case BinOp::ADD: os << "+"; break;
         case BinOp::SUB: os << "-"; break;
@@ -18,7 +19,7 @@ std::ostream& operator<<(std::ostream& os, BinOp op) {
 }
 
 enum class LogicOp {LE, LEQ, GE, GEQ, EQ, NEQ};
-std::ostream& operator<<(std::ostream& os, LogicOp lop){
+inline std::ostream& operator<<(std::ostream& os, LogicOp lop){
     switch (lop){
         case LogicOp::LE: os << "<"; break;
         case LogicOp::LEQ: os << "<="; break;
@@ -30,8 +31,8 @@ std::ostream& operator<<(std::ostream& os, LogicOp lop){
     return os;
 }
 
-enum class NodeType {VARIABLE, INTEGER, PRE_CON, POST_CON, ARITHM_OP, LOGIC_OP, DECLARATION, ASSIGNMENT, IFELSE, WHILELOOP, SEQUENCE};
-std::ostream& operator<<(std::ostream& os, NodeType type) {
+enum class NodeType {VARIABLE, INTEGER, PRE_CON, POST_CON, ARITHM_OP, LOGIC_OP, DECLARATION, ASSIGNMENT, IFELSE, WHILELOOP, SEQUENCE, FUNCTION, CALL};
+inline std::ostream& operator<<(std::ostream& os, NodeType type) {
     switch (type) {
         case NodeType::VARIABLE: os << "Variable"; break;
         case NodeType::INTEGER: os << "Integer"; break;
@@ -44,6 +45,8 @@ std::ostream& operator<<(std::ostream& os, NodeType type) {
         case NodeType::IFELSE: os << "If-Else"; break;
         case NodeType::WHILELOOP: os << "While-Loop"; break;
         case NodeType::SEQUENCE: os << "Sequence"; break;
+        case NodeType::FUNCTION: os << "Function"; break;
+        case NodeType::CALL: os << "Call"; break;
     }
     return os;
 }
@@ -79,6 +82,35 @@ struct ASTNode {
         }, value);
     }
 
+    // Structural hash of the subtree (FNV-1a over the types, values and children), stable across runs
+    std::uint64_t hash() const {
+        std::uint64_t h = 0xcbf29ce484222325ull;
+        auto mix = [&h](std::uint64_t word) {
+            for (int byte = 0; byte < 8; ++byte) {
+                h = (h ^ ((word >> (8 * byte)) & 0xff)) * 0x100000001b3ull;
+            }
+        };
+        mix(static_cast<std::uint64_t>(type));
+        mix(value.index());
+        std::visit([&](const auto& v) {
+            using V = std::decay_t<decltype(v)>;
+            if constexpr (std::is_same_v<V, std::string>) {
+                mix(v.size());
+                for (unsigned char c : v) {
+                    h = (h ^ c) * 0x100000001b3ull;
+                }
+            }
+            else {
+                mix(static_cast<std::uint64_t>(v));
+            }
+        }, value);
+        mix(children.size());
+        for (const auto& child : children) {
+            mix(child.hash());
+        }
+        return h;
+    }
+
     void print(int depth = 0) const {
         std::string indent(depth * 2, ' ');
         std::cout << indent << "NodeType: " << type << ", Value: ";
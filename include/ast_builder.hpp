@@ -0,0 +1,252 @@
+#ifndef AST_BUILDER_HPP
+#define AST_BUILDER_HPP
+
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "flat_ast.hpp"
+
+/**
+ * @brief Builds the nodes of the rules of the grammar of AbstractInterpreterParser in an arena, from the
+ * values of the parts of a rule in the order in which the rule matches them. The PEG parser and the
+ * recursive-descent parser both build their trees through it, so that they build the same trees.
+ *
+ */
+class FlatASTBuilder
+{
+public:
+    using Index = FlatAST::Index;
+    using Items = std::span<const Index>;
+    using Value = FlatAST::Value;
+
+    // The value of a comment, which the lists of statements skip
+    static constexpr Index COMMENT = std::numeric_limits<Index>::max();
+
+private:
+    FlatAST& m_ast;
+
+public:
+    explicit FlatASTBuilder(FlatAST& ast)
+    : m_ast(ast)
+    {}
+
+    Index integer(std::int64_t value)
+    {
+        return m_ast.add(NodeType::INTEGER, Value::integer(value));
+    }
+
+    Index identifier(std::string_view name)
+    {
+        return m_ast.add(NodeType::VARIABLE, m_ast.text(name));
+    }
+
+    Index seq_op(bool minus)
+    {
+        return m_ast.add(NodeType::ARITHM_OP, Value::op(minus ? BinOp::SUB : BinOp::ADD));
+    }
+
+    Index pre_op(bool divide)
+    {
+        return m_ast.add(NodeType::ARITHM_OP, Value::op(divide ? BinOp::DIV : BinOp::MUL));
+    }
+
+    /**
+     * @brief Comparison operator, given the choice of the LogicOp rule
+     *
+     */
+    Index logic_op(std::size_t choice)
+    {
+        // in the order of the alternatives of the rule
+        static constexpr LogicOp ops[] = {LogicOp::LEQ, LogicOp::GEQ, LogicOp::EQ, LogicOp::NEQ, LogicOp::LE, LogicOp::GE};
+        return m_ast.add(NodeType::LOGIC_OP, Value::op(ops[choice]));
+    }
+
+    /**
+     * @brief Program, from its top-level statements. The root is always made, even over a single
+     * statement, so that its children are the declarations, the functions and the main block
+     *
+     */
+    Index program(Items statements)
+    {
+        return m_ast.add(NodeType::INTEGER, Value::integer(0), without_comments(statements));
+    }
+
+    Index decl_var(Items items)
+    {
+        return m_ast.add(NodeType::DECLARATION, m_ast.text("int"), std::vector<Index>(items.begin(), items.end()));
+    }
+
+    Index pre_con(Index var, Index lb, Index ub)
+    {
+        // the variable is shared by both bounds
+        Index lower = m_ast.add(NodeType::LOGIC_OP, m_ast.text("<="), {lb, var});
+        Index upper = m_ast.add(NodeType::LOGIC_OP, m_ast.text(">="), {ub, var});
+        return m_ast.add(NodeType::PRE_CON, m_ast.text("PreCon"), {lower, upper});
+    }
+
+    Index post_con(Index expression)
+    {
+        return m_ast.add(NodeType::POST_CON, m_ast.text("PostCon"), {expression});
+    }
+
+    /**
+     * @brief Expression, from its terms with the operators in between. The additions and subtractions are
+     * chained from the left into binary nodes, and so are the comparisons of their results, which bind less
+     * tightly: `a - b + c < d` is `((a - b) + c) < d`
+     *
+     */
+    Index expr(Items items)
+    {
+        std::vector<Index> sums;
+        std::vector<Index> comparisons;
+        Index sum = items[0];
+        for (std::size_t i = 1; i + 1 < items.size(); i += 2)
+        {
+            if (m_ast.type(items[i]) == NodeType::LOGIC_OP)
+            {
+                sums.push_back(sum);
+                comparisons.push_back(items[i]);
+                sum = items[i + 1];
+            }
+            else
+            {
+                sum = m_ast.add(NodeType::ARITHM_OP, m_ast.value(items[i]), {sum, items[i + 1]});
+            }
+        }
+        if (sums.empty())
+        {
+            return sum;
+        }
+        sums.push_back(sum);
+        Index result = sums[0];
+        for (std::size_t i = 0; i < comparisons.size(); ++i)
+        {
+            result = m_ast.add(NodeType::LOGIC_OP, m_ast.value(comparisons[i]), {result, sums[i + 1]});
+        }
+        return result;
+    }
+
+    /**
+     * @brief Term, from its factors with the operators in between, chained from the left into binary nodes:
+     * `a / b * c` is `(a / b) * c`
+     *
+     */
+    Index term(Items items)
+    {
+        Index result = items[0];
+        for (std::size_t i = 1; i + 1 < items.size(); i += 2)
+        {
+            result = m_ast.add(NodeType::ARITHM_OP, m_ast.value(items[i]), {result, items[i + 1]});
+        }
+        return result;
+    }
+
+    Index negation(Index factor)
+    {
+        // for the case: x = -y;
+        // we're going to transform it into x = 0 - y;
+        Index zero = m_ast.add(NodeType::INTEGER, Value::integer(0));
+        return m_ast.add(NodeType::ARITHM_OP, m_ast.text("-"), {zero, factor});
+    }
+
+    /**
+     * @brief Function definition
+     *
+     * @param name
+     * @param parameters
+     * @param statements the statements of the body, comments included
+     * @param result the returned expression
+     */
+    Index function(Index name, Items parameters, Items statements, Index result)
+    {
+        Index declaration = m_ast.add(NodeType::DECLARATION, m_ast.text("int"), std::vector<Index>(parameters.begin(), parameters.end()));
+        Index body = m_ast.add(NodeType::SEQUENCE, m_ast.text(";"), without_comments(statements));
+        return m_ast.add(NodeType::FUNCTION, m_ast.value(name), {declaration, body, result});
+    }
+
+    Index call(Index name, Items arguments)
+    {
+        return m_ast.add(NodeType::CALL, m_ast.value(name), std::vector<Index>(arguments.begin(), arguments.end()));
+    }
+
+    /**
+     * @brief Records the line of a statement, unless a statement it is made of already starts there: a
+     * block of a single statement is that statement, and keeps its line
+     *
+     */
+    void at_line(Index statement, std::size_t line)
+    {
+        if (statement != COMMENT && m_ast.line(statement) == 0)
+        {
+            m_ast.set_line(statement, static_cast<std::uint32_t>(line));
+        }
+    }
+
+    Index assign(Index var, Index expression)
+    {
+        return m_ast.add(NodeType::ASSIGNMENT, m_ast.text("="), {var, expression});
+    }
+
+    Index increment(Index var)
+    {
+        Index one = m_ast.add(NodeType::INTEGER, Value::integer(1));
+        Index plus_op = m_ast.add(NodeType::ARITHM_OP, m_ast.text("+"), {var, one});
+        return m_ast.add(NodeType::ASSIGNMENT, m_ast.text("="), {var, plus_op});
+    }
+
+    /**
+     * @brief Block, from its statements. The main block is always a sequence, whose first statements
+     * are the preconditions; any other block of a single statement is that statement
+     *
+     */
+    Index block(Items statements, bool main = false)
+    {
+        if (!main && statements.size() == 1 && statements[0] != COMMENT)
+        {
+            return statements[0];
+        }
+        return m_ast.add(NodeType::SEQUENCE, m_ast.text(";"), without_comments(statements));
+    }
+
+    /**
+     * @brief If-else statement, from its condition, its body and the body of its else branch if any
+     *
+     */
+    Index ifelse(Items parts)
+    {
+        static const char* names[] = {"Condition", "If-Body", "Else-Body"};
+        std::vector<Index> children;
+        for (std::size_t i = 0; i < parts.size(); ++i)
+        {
+            children.push_back(m_ast.add(NodeType::IFELSE, m_ast.text(names[i]), {parts[i]}));
+        }
+        return m_ast.add(NodeType::IFELSE, m_ast.text("IfElse"), children);
+    }
+
+    Index whileloop(Index condition, Index body)
+    {
+        Index parts[] = {m_ast.add(NodeType::WHILELOOP, m_ast.text("Condition"), {condition}),
+                         m_ast.add(NodeType::WHILELOOP, m_ast.text("While-Body"), {body})};
+        return m_ast.add(NodeType::WHILELOOP, m_ast.text("WhileLoop"), {parts[0], parts[1]});
+    }
+
+private:
+    static std::vector<Index> without_comments(Items statements)
+    {
+        std::vector<Index> children;
+        children.reserve(statements.size());
+        for (auto statement : statements)
+        {
+            if (statement != COMMENT)
+            {
+                children.push_back(statement);
+            }
+        }
+        return children;
+    }
+};
+
+#endif // AST_BUILDER_HPP
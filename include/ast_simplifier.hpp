@@ -0,0 +1,261 @@
+#ifndef AST_SIMPLIFIER_HPP
+#define AST_SIMPLIFIER_HPP
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#include "flat_ast.hpp"
+#include "interval.hpp"
+
+/**
+ * @brief Simplifies the arithmetic expressions of a tree before the equational system is built from it,
+ * copying the tree into a new arena. Every rewrite gives the same interval as the original expression
+ * in every store:
+ *
+ * - an operation between two constants is folded, unless it overflows T or divides by zero, so that the
+ *   overflow and division warnings of the analysis are kept;
+ * - `x + 0`, `0 + x`, `x - 0`, `x * 1`, `1 * x` and `x / 1` become `x`;
+ * - negations, which the parser writes `0 - y`, are cancelled against the operation that uses them:
+ *   `0 - (0 - y)` becomes `y`, `x + (0 - y)` and `(0 - y) + x` become `x - y`, `x - (0 - y)` becomes
+ *   `x + y`, and `x * -1` becomes `0 - x`.
+ *
+ * The operators of the rewritten expressions are BinOp values, including the ones that the parser writes
+ * as text for unary minus and increments. Shared subtrees stay shared.
+ *
+ * @tparam T
+ */
+template <typename T>
+class ASTSimplifier
+{
+private:
+    using Index = FlatAST::Index;
+    static constexpr Index NONE = std::numeric_limits<Index>::max();
+
+    const FlatAST& m_source;
+    FlatAST m_target;
+    std::vector<Index> m_copies;    // index in m_target of every node of m_source already copied
+    std::size_t m_rewrites = 0;
+
+public:
+    explicit ASTSimplifier(const FlatAST& source)
+    : m_source(source)
+    , m_copies(source.size(), NONE)
+    {
+        m_target.reserve(source.size());
+    }
+
+    /**
+     * @brief Copies the tree, simplifying its expressions
+     *
+     * @return FlatAST
+     */
+    FlatAST simplify()
+    {
+        if (m_source.size() > 0)
+        {
+            m_target.set_root(copy(m_source.root()));
+        }
+        return std::move(m_target);
+    }
+
+    /**
+     * @brief Number of rewrites applied by simplify
+     *
+     */
+    std::size_t rewrites() const
+    {
+        return m_rewrites;
+    }
+
+private:
+    Index copy(FlatAST::Node node)
+    {
+        if (m_copies[node.index()] != NONE)
+        {
+            return m_copies[node.index()];
+        }
+
+        std::vector<Index> children;
+        children.reserve(node.size());
+        for (auto child : node.children())
+        {
+            children.push_back(copy(child));
+        }
+
+        Index index;
+        auto op = arithmetic_op(node);
+        if (op.has_value() && children.size() == 2)
+        {
+            index = combine(*op, children[0], children[1]);
+        }
+        else
+        {
+            auto value = m_source.value(node.index());
+            if (value.kind == FlatAST::ValueKind::TEXT)
+            {
+                value = m_target.text(node.text());
+            }
+            index = m_target.add(node.type(), value, children);
+            m_target.set_line(index, m_source.line(node.index()));
+        }
+        m_copies[node.index()] = index;
+        return index;
+    }
+
+    /**
+     * @brief Builds the operation between two simplified operands of m_target, rewriting it if possible
+     *
+     * @param op
+     * @param lhs
+     * @param rhs
+     * @return Index
+     */
+    Index combine(BinOp op, Index lhs, Index rhs)
+    {
+        auto lhs_constant = constant(lhs);
+        auto rhs_constant = constant(rhs);
+        if (lhs_constant.has_value() && rhs_constant.has_value())
+        {
+            if (auto folded = fold(op, *lhs_constant, *rhs_constant))
+            {
+                return rewritten(m_target.add(NodeType::INTEGER, FlatAST::Value::integer(static_cast<std::int64_t>(*folded))));
+            }
+        }
+
+        switch (op)
+        {
+            case BinOp::ADD:
+            {
+                if (rhs_constant == T(0)) return rewritten(lhs);
+                if (lhs_constant == T(0)) return rewritten(rhs);
+                if (auto negated = negation(rhs)) return rewritten(combine(BinOp::SUB, lhs, *negated));
+                if (auto negated = negation(lhs)) return rewritten(combine(BinOp::SUB, rhs, *negated));
+                break;
+            }
+            case BinOp::SUB:
+            {
+                if (rhs_constant == T(0)) return rewritten(lhs);
+                if (auto negated = negation(rhs)) return rewritten(combine(BinOp::ADD, lhs, *negated));
+                break;
+            }
+            case BinOp::MUL:
+            {
+                if (rhs_constant == T(1)) return rewritten(lhs);
+                if (lhs_constant == T(1)) return rewritten(rhs);
+                if constexpr (std::is_signed_v<T>)
+                {
+                    if (rhs_constant == T(-1)) return rewritten(combine(BinOp::SUB, zero(), lhs));
+                    if (lhs_constant == T(-1)) return rewritten(combine(BinOp::SUB, zero(), rhs));
+                }
+                break;
+            }
+            case BinOp::DIV:
+            {
+                if (rhs_constant == T(1)) return rewritten(lhs);
+                break;
+            }
+        }
+        return m_target.add(NodeType::ARITHM_OP, FlatAST::Value::op(op), {lhs, rhs});
+    }
+
+    Index rewritten(Index index)
+    {
+        m_rewrites++;
+        return index;
+    }
+
+    Index zero()
+    {
+        return m_target.add(NodeType::INTEGER, FlatAST::Value::integer(0));
+    }
+
+    /**
+     * @brief Result of an operation between two constants, if it is exact
+     *
+     */
+    static std::optional<T> fold(BinOp op, T lhs, T rhs)
+    {
+        if constexpr (!std::is_integral_v<T>)
+        {
+            // The integers of the tree cannot hold the result
+            return std::nullopt;
+        }
+        else
+        {
+            bool overflow = false;
+            T result = 0;
+            switch (op)
+            {
+                case BinOp::ADD: result = BoundArithmetic<T>::add(lhs, rhs, overflow); break;
+                case BinOp::SUB: result = BoundArithmetic<T>::sub(lhs, rhs, overflow); break;
+                case BinOp::MUL: result = BoundArithmetic<T>::mul(lhs, rhs, overflow); break;
+                case BinOp::DIV:
+                {
+                    if (rhs == 0 || (std::is_signed_v<T> && lhs == std::numeric_limits<T>::min() && rhs == T(-1)))
+                    {
+                        return std::nullopt;
+                    }
+                    result = lhs / rhs;
+                    break;
+                }
+            }
+            if (overflow)
+            {
+                return std::nullopt;
+            }
+            return result;
+        }
+    }
+
+    // Value of an integer node, as the compiled expression reads it
+    std::optional<T> constant(Index index) const
+    {
+        if (m_target.type(index) != NodeType::INTEGER)
+        {
+            return std::nullopt;
+        }
+        return static_cast<T>(m_target.value(index).payload);
+    }
+
+    // Operand of a node of the form `0 - y`
+    std::optional<Index> negation(Index index) const
+    {
+        auto node = m_target.node(index);
+        if (node.type() != NodeType::ARITHM_OP || node.kind() != FlatAST::ValueKind::BIN_OP || node.bin_op() != BinOp::SUB
+            || node.size() != 2 || constant(node.child(0).index()) != T(0))
+        {
+            return std::nullopt;
+        }
+        return node.child(1).index();
+    }
+
+    /**
+     * @brief Operator of an arithmetic node, whether the parser wrote it as a BinOp or as text
+     *
+     */
+    static std::optional<BinOp> arithmetic_op(FlatAST::Node node)
+    {
+        if (node.type() != NodeType::ARITHM_OP)
+        {
+            return std::nullopt;
+        }
+        if (node.kind() == FlatAST::ValueKind::BIN_OP)
+        {
+            return node.bin_op();
+        }
+        if (node.kind() == FlatAST::ValueKind::TEXT)
+        {
+            const auto& op = node.text();
+            if (op == "+") return BinOp::ADD;
+            if (op == "-") return BinOp::SUB;
+            if (op == "*") return BinOp::MUL;
+            if (op == "/") return BinOp::DIV;
+        }
+        return std::nullopt;
+    }
+};
+
+#endif // AST_SIMPLIFIER_HPP
@@ -0,0 +1,700 @@
+#ifndef BATCH_ANALYSIS_HPP
+#define BATCH_ANALYSIS_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "analysis_error.hpp"
+#include "analysis_report.hpp"
+#include "bounded_queue.hpp"
+#include "cost_estimator.hpp"
+#include "equational_interpreter.hpp"
+#include "logger.hpp"
+#include "mapped_file.hpp"
+#include "parser.hpp"
+#include "result_cache.hpp"
+#include "result_writer.hpp"
+#include "thread_pool.hpp"
+
+/**
+ * @brief Verdict of the analysis of one file of a batch
+ *
+ */
+struct FileVerdict {
+    std::string path;
+    std::string error;      // empty when the file was analyzed
+    std::size_t postconditions = 0;
+    std::size_t satisfied = 0;
+    AnalysisStatistics statistics;
+    std::vector<PostconditionVerdict> verdicts;
+    std::string results;    // the encoded records of the file, when its results are streamed
+    bool done = false;
+};
+
+/**
+ * @brief Expands the inputs of a batch into the list of files to analyze: directories are replaced by
+ * the `.c` files they contain, in lexicographic order, and every non-empty line of the manifest that does
+ * not start with `#` is a path.
+ *
+ * @param inputs
+ * @param manifest
+ * @return std::vector<std::string>
+ */
+inline std::vector<std::string> collect_batch_inputs(const std::vector<std::string>& inputs, const std::string& manifest)
+{
+    std::vector<std::string> paths;
+    auto add = [&paths](const std::string& input) {
+        if (std::filesystem::is_directory(input))
+        {
+            std::vector<std::string> files;
+            for (const auto& entry : std::filesystem::directory_iterator(input))
+            {
+                if (entry.is_regular_file() && entry.path().extension() == ".c")
+                {
+                    files.push_back(entry.path().string());
+                }
+            }
+            std::sort(files.begin(), files.end());
+            paths.insert(paths.end(), files.begin(), files.end());
+        }
+        else
+        {
+            paths.push_back(input);
+        }
+    };
+
+    if (!manifest.empty())
+    {
+        std::ifstream f(manifest);
+        if (!f.is_open())
+        {
+            std::cerr << "[ERROR] cannot open the manifest `" << manifest << "`." << std::endl;
+        }
+        std::string line;
+        while (std::getline(f, line))
+        {
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.pop_back();
+            }
+            if (!line.empty() && line[0] != '#')
+            {
+                add(line);
+            }
+        }
+    }
+    for (const auto& input : inputs)
+    {
+        add(input);
+    }
+    return paths;
+}
+
+/**
+ * @brief File of a batch on its way through the stages of the analysis
+ *
+ */
+struct BatchJob {
+    std::size_t index = 0;      // in the list of the batch
+    FileVerdict verdict;
+    SourceFile source;          // released once parsed
+    ResultCacheKey key;
+    FlatAST ast;                // moved into the interpreter once built
+    double parse_ms = 0;
+    AnalysisCounters parse_counters;
+    std::uint64_t cost = 0;     // estimated once parsed, see AnalysisCostEstimator
+    std::unique_ptr<EquationalInterpreter<int64_t>> interpreter;
+};
+
+/**
+ * @brief Records that the analysis of a file failed
+ *
+ * @param verdict
+ * @param error
+ * @param results if set, the error is also encoded in this format into verdict.results
+ */
+inline void fail_batch_file(FileVerdict& verdict, const char* error, std::optional<ResultFormat> results)
+{
+    verdict.error = error;
+    if (results)
+    {
+        ResultEncoder<int64_t> encoder(*results);
+        encoder.error(verdict.path, verdict.error);
+        verdict.results = encoder.take();
+    }
+}
+
+/**
+ * @brief First stage of the analysis of a file: reads the file and looks its results up in the cache
+ *
+ * @param job
+ * @param solver_mode
+ * @param cache if not null, results are read from it
+ * @param results
+ * @return true if the file still has to be analyzed
+ */
+inline bool load_batch_file(BatchJob& job, SolverMode solver_mode, const ResultCache<int64_t>* cache, std::optional<ResultFormat> results)
+{
+    auto& verdict = job.verdict;
+    job.source = SourceFile(verdict.path);
+    if (!job.source.is_open())
+    {
+        fail_batch_file(verdict, "cannot open the file", results);
+        return false;
+    }
+    job.source.prefetch();
+
+    if (cache != nullptr)
+    {
+        job.key = ResultCacheKey::make<int64_t>(job.source.text(), solver_mode, EquationalInterpreter<int64_t>::DEFAULT_WIDENING_DELAY,
+                                                EquationalInterpreter<int64_t>::DEFAULT_NARROWING_PASSES);
+        if (auto cached = cache->lookup(job.key))
+        {
+            verdict.verdicts = cached->verdicts();
+            verdict.statistics = cached->statistics();
+            for (const auto& postcondition : verdict.verdicts)
+            {
+                verdict.postconditions++;
+                verdict.satisfied += postcondition.satisfied ? 1 : 0;
+            }
+            if (results)
+            {
+                ResultEncoder<int64_t> encoder(*results);
+                encode_results(encoder, verdict.path, *cached);
+                verdict.results = encoder.take();
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Second stage: parses the file and estimates the cost of its analysis
+ *
+ * @param job
+ * @param results
+ * @return true if the file was parsed
+ */
+inline bool parse_batch_file(BatchJob& job, std::optional<ResultFormat> results)
+{
+    PerfCounters::Measurement measurement(job.parse_counters, AnalysisPhase::PARSE);
+    auto parse_start = std::chrono::steady_clock::now();
+    job.ast = AbstractInterpreterParser::parse_program(job.source.text());
+    auto parse_end = std::chrono::steady_clock::now();
+    measurement.stop();
+    job.parse_ms = std::chrono::duration<double, std::milli>(parse_end - parse_start).count();
+    job.source = SourceFile();
+    if (job.ast.root().size() == 0)
+    {
+        fail_batch_file(job.verdict, "parsing failed", results);
+        return false;
+    }
+    job.cost = AnalysisCostEstimator::estimate(job.ast).cost;
+    return true;
+}
+
+/**
+ * @brief Third stage: builds the equational system of the program (see EquationalInterpreter::build)
+ *
+ * @param job
+ * @param solver_mode
+ * @param budget
+ * @param results
+ * @return true if the program can be analyzed (see AnalysisError)
+ */
+inline bool build_batch_file(BatchJob& job, SolverMode solver_mode, const AnalysisBudget& budget, std::optional<ResultFormat> results)
+{
+    job.interpreter = std::make_unique<EquationalInterpreter<int64_t>>(std::move(job.ast));
+    job.interpreter->set_solver_mode(solver_mode);
+    job.interpreter->set_budget(budget);
+    job.interpreter->set_diagnostics(results.has_value());
+    try
+    {
+        job.interpreter->build();
+    }
+    catch (const AnalysisError& error)
+    {
+        job.interpreter.reset();
+        fail_batch_file(job.verdict, error.what(), results);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Last stage: computes the fixpoint, then fills the verdict and the cache
+ *
+ * @param job
+ * @param cache if not null, results are written to it
+ * @param results
+ */
+inline void solve_batch_file(BatchJob& job, const ResultCache<int64_t>* cache, std::optional<ResultFormat> results)
+{
+    auto& EI = *job.interpreter;
+    auto& verdict = job.verdict;
+    try
+    {
+        EI.solve();
+    }
+    catch (const AnalysisError& error)
+    {
+        // Raised by the summary of a function called in the program
+        job.interpreter.reset();
+        fail_batch_file(verdict, error.what(), results);
+        return;
+    }
+    for (const auto& postcondition : EI.verdicts())
+    {
+        verdict.postconditions++;
+        verdict.satisfied += postcondition.satisfied ? 1 : 0;
+    }
+    verdict.statistics = EI.statistics();
+    verdict.statistics.parse_ms = job.parse_ms;
+    verdict.statistics.counters.add(job.parse_counters);
+    verdict.verdicts = EI.verdicts();
+    if (results)
+    {
+        ResultEncoder<int64_t> encoder(*results);
+        encode_results(encoder, verdict.path, EI, verdict.statistics);
+        verdict.results = encoder.take();
+    }
+    if (cache != nullptr)
+    {
+        cache->store(job.key, EI);
+    }
+    job.interpreter.reset();
+}
+
+/**
+ * @brief Analyzes a single file of a batch, running all the stages one after the other
+ *
+ * @param verdict
+ * @param solver_mode
+ * @param cache if not null, results are read from and written to it
+ * @param budget
+ * @param results if set, the records of the file are encoded in this format into verdict.results
+ */
+inline void analyze_batch_file(FileVerdict& verdict, SolverMode solver_mode, const ResultCache<int64_t>* cache = nullptr,
+                               const AnalysisBudget& budget = {}, std::optional<ResultFormat> results = std::nullopt)
+{
+    BatchJob job;
+    job.verdict = std::move(verdict);
+    if (load_batch_file(job, solver_mode, cache, results) && parse_batch_file(job, results) && build_batch_file(job, solver_mode, budget, results))
+    {
+        solve_batch_file(job, cache, results);
+    }
+    verdict = std::move(job.verdict);
+}
+
+/**
+ * @brief Analyzes the files of a batch on a pool, longest job first: every file is read and parsed, then the
+ * files left to analyze are built and solved in the decreasing order of their estimated cost, so that the
+ * most expensive analyses start first instead of keeping a single worker busy once the others are done.
+ * The parsed trees are all kept until their file is solved. The completed files are handed to done by the
+ * workers, in any order, and done returning false drops the files not started yet.
+ *
+ * @param pool
+ * @param paths
+ * @param solver_mode
+ * @param cache
+ * @param budget
+ * @param results
+ * @param done
+ */
+inline void run_batch_longest_first(WorkStealingPool& pool, const std::vector<std::string>& paths, SolverMode solver_mode,
+                                    const ResultCache<int64_t>* cache, const AnalysisBudget& budget, std::optional<ResultFormat> results,
+                                    const std::function<bool(BatchJob&)>& done)
+{
+    std::vector<BatchJob> jobs(paths.size());
+    std::vector<std::uint8_t> parsed(paths.size(), 0);
+    std::atomic<bool> stopped{false};
+    auto complete = [&](BatchJob& job) {
+        if (!done(job))
+        {
+            stopped.store(true, std::memory_order_relaxed);
+            pool.stop();
+        }
+    };
+    pool.run(paths.size(), [&](std::size_t index) {
+        auto& job = jobs[index];
+        job.index = index;
+        job.verdict.path = paths[index];
+        if (load_batch_file(job, solver_mode, cache, results) && parse_batch_file(job, results))
+        {
+            parsed[index] = 1;
+            return;
+        }
+        complete(job);
+    });
+    if (stopped.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    std::vector<std::size_t> order;
+    for (std::size_t index = 0; index < paths.size(); ++index)
+    {
+        if (parsed[index] != 0)
+        {
+            order.push_back(index);
+        }
+    }
+    std::stable_sort(order.begin(), order.end(), [&jobs](std::size_t a, std::size_t b) { return jobs[a].cost > jobs[b].cost; });
+    // The pool deals the tasks in turn to its workers, which start from the lowest: each starts with one of the longest
+    pool.run(order.size(), [&](std::size_t rank) {
+        auto& job = jobs[order[rank]];
+        if (build_batch_file(job, solver_mode, budget, results))
+        {
+            solve_batch_file(job, cache, results);
+        }
+        complete(job);
+    });
+}
+
+/**
+ * @brief Workers of the stages of a pipelined batch (see run_batch)
+ *
+ */
+struct BatchPipeline {
+    std::size_t load = 1;
+    std::size_t parse = 1;
+    std::size_t build = 1;
+    std::size_t solve = 1;
+    std::size_t depth = 4;      // files each queue between two stages holds
+
+    std::size_t workers() const
+    {
+        return load + parse + build + solve;
+    }
+};
+
+/**
+ * @brief Reads the workers of a pipeline written as `LOAD,PARSE,BUILD,SOLVE`, each at least 1
+ *
+ * @param text
+ * @param pipeline
+ * @return true if the text is valid
+ */
+inline bool parse_batch_pipeline(const std::string& text, BatchPipeline& pipeline)
+{
+    std::istringstream fields(text);
+    std::size_t* stages[] = {&pipeline.load, &pipeline.parse, &pipeline.build, &pipeline.solve};
+    std::string field;
+    std::size_t count = 0;
+    while (std::getline(fields, field, ','))
+    {
+        if (count == 4 || field.empty() || field.find_first_not_of("0123456789") != std::string::npos)
+        {
+            return false;
+        }
+        *stages[count] = std::stoull(field);
+        if (*stages[count] == 0)
+        {
+            return false;
+        }
+        count++;
+    }
+    return count == 4;
+}
+
+/**
+ * @brief Runs the stages of the files of a batch on their own workers, connected by bounded queues, so that
+ * the files after the ones being solved are read and parsed in the meantime. The completed files go through
+ * a last queue to the calling thread, which hands them to done in any order.
+ *
+ * @param paths
+ * @param pipeline
+ * @param solver_mode
+ * @param cache
+ * @param budget
+ * @param results
+ * @param done
+ */
+inline void run_batch_pipeline(const std::vector<std::string>& paths, const BatchPipeline& pipeline, SolverMode solver_mode,
+                               const ResultCache<int64_t>* cache, const AnalysisBudget& budget, std::optional<ResultFormat> results,
+                               const std::function<void(BatchJob&)>& done)
+{
+    BoundedQueue<BatchJob> to_load(paths.size() + 1, 1);
+    BoundedQueue<BatchJob> to_parse(pipeline.depth, pipeline.load);
+    BoundedQueue<BatchJob> to_build(pipeline.depth, pipeline.parse);
+    BoundedQueue<BatchJob> to_solve(pipeline.depth, pipeline.build);
+    // Every stage can complete a file, and the calling thread consumes them all: this queue never blocks them
+    BoundedQueue<BatchJob> completed(paths.size() + 1, pipeline.workers());
+    for (std::size_t index = 0; index < paths.size(); ++index)
+    {
+        BatchJob job;
+        job.index = index;
+        job.verdict.path = paths[index];
+        to_load.push(std::move(job));
+    }
+    to_load.close();
+
+    auto stage = [&completed](auto& input, auto& output, std::size_t workers, auto step, std::vector<std::thread>& threads) {
+        for (std::size_t i = 0; i < workers; ++i)
+        {
+            threads.emplace_back([&input, &output, &completed, step]() {
+                while (auto job = input.pop())
+                {
+                    if (step(*job))
+                    {
+                        output.push(std::move(*job));
+                    }
+                    else
+                    {
+                        completed.push(std::move(*job));
+                    }
+                }
+                output.close();
+                if (&output != &completed)
+                {
+                    completed.close();
+                }
+            });
+        }
+    };
+
+    std::vector<std::thread> threads;
+    stage(to_load, to_parse, pipeline.load, [solver_mode, cache, results](BatchJob& job) {
+        return load_batch_file(job, solver_mode, cache, results);
+    }, threads);
+    stage(to_parse, to_build, pipeline.parse, [results](BatchJob& job) { return parse_batch_file(job, results); }, threads);
+    stage(to_build, to_solve, pipeline.build, [&budget, solver_mode, results](BatchJob& job) {
+        return build_batch_file(job, solver_mode, budget, results);
+    }, threads);
+    stage(to_solve, completed, pipeline.solve, [cache, results](BatchJob& job) {
+        solve_batch_file(job, cache, results);
+        return true;
+    }, threads);
+
+    while (auto job = completed.pop())
+    {
+        done(*job);
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+/**
+ * @brief Output of a batch: one line per file, printed in the order of the list as soon as the files
+ * before it are completed, the records of the files streamed in the same order, then the metrics and a
+ * summary once every file is completed
+ *
+ */
+class BatchReport
+{
+private:
+    std::vector<FileVerdict> m_verdicts;
+    std::string m_results_path;
+    std::optional<ResultSink<int64_t>> m_results;
+    std::optional<ResultFormat> m_encoding;
+    std::ostream& m_text;
+    std::mutex m_mutex;
+    std::size_t m_next_to_print = 0;
+
+public:
+    /**
+     * @brief Creates the report of a list of files
+     *
+     * @param paths
+     * @param results_path if not empty, file where the records of all the files are streamed ("-" for the
+     * standard output, the lines of the files then go to the standard error)
+     * @param results_format
+     */
+    BatchReport(const std::vector<std::string>& paths, const std::string& results_path, ResultFormat results_format)
+    : m_verdicts(paths.size())
+    , m_results_path(results_path)
+    , m_text(results_path == "-" ? std::cerr : std::cout)
+    {
+        for (std::size_t i = 0; i < paths.size(); ++i)
+        {
+            m_verdicts[i].path = paths[i];
+        }
+        if (!results_path.empty())
+        {
+            m_results.emplace(results_path, results_format);
+            m_encoding = results_format;
+            if (!m_results->good())
+            {
+                std::cerr << "[ERROR] cannot open the results file `" << results_path << "`." << std::endl;
+            }
+        }
+    }
+
+    /**
+     * @brief Format in which the records of every file are to be encoded into its verdict, if streamed
+     *
+     */
+    std::optional<ResultFormat> encoding() const
+    {
+        return m_encoding;
+    }
+
+    std::ostream& text()
+    {
+        return m_text;
+    }
+
+    /**
+     * @brief Records the verdict of a file, from any thread, and prints the files that are now ready
+     *
+     * @param index in the list
+     * @param verdict
+     */
+    void complete(std::size_t index, FileVerdict verdict)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        verdict.done = true;
+        m_verdicts[index] = std::move(verdict);
+        while (m_next_to_print < m_verdicts.size() && m_verdicts[m_next_to_print].done)
+        {
+            auto& ready = m_verdicts[m_next_to_print++];
+            m_text << ready.path << ": ";
+            if (!ready.error.empty())
+            {
+                m_text << "error (" << ready.error << ")";
+            }
+            else if (ready.postconditions == 0)
+            {
+                m_text << "no postconditions";
+            }
+            else
+            {
+                m_text << (ready.satisfied == ready.postconditions ? "satisfied" : "not satisfied")
+                       << " (" << ready.satisfied << "/" << ready.postconditions << " postconditions)";
+            }
+            if (ready.statistics.budget_exceeded != BudgetExceeded::NONE)
+            {
+                m_text << " [" << budget_name(ready.statistics.budget_exceeded) << " budget exceeded]";
+            }
+            m_text << '\n';
+            if (m_results)
+            {
+                m_results->write(ready.results);
+                std::string().swap(ready.results);
+            }
+        }
+        m_text.flush();
+    }
+
+    /**
+     * @brief Writes the metrics and the summary, once every file is completed
+     *
+     * @param metrics_path if not empty, file where the JSON reports of all the files are written, as an
+     * array in the order of the list ("-" for the standard output)
+     * @param workers reported in the summary
+     * @return int 0 if every postcondition of every file is satisfied, 1 otherwise
+     */
+    int finish(const std::string& metrics_path, std::size_t workers)
+    {
+        if (m_results)
+        {
+            m_results->flush();
+            if (!m_results->good())
+            {
+                std::cerr << "[ERROR] cannot write the results file `" << m_results_path << "`." << std::endl;
+            }
+        }
+
+        std::size_t satisfied = 0, not_satisfied = 0, without = 0, errors = 0;
+        for (const auto& verdict : m_verdicts)
+        {
+            if (!verdict.error.empty()) errors++;
+            else if (verdict.postconditions == 0) without++;
+            else if (verdict.satisfied == verdict.postconditions) satisfied++;
+            else not_satisfied++;
+        }
+        if (!metrics_path.empty())
+        {
+            std::ofstream file;
+            if (metrics_path != "-")
+            {
+                file.open(metrics_path);
+                if (!file.is_open())
+                {
+                    std::cerr << "[ERROR] cannot open the metrics file `" << metrics_path << "`." << std::endl;
+                }
+            }
+            std::ostream& out = metrics_path == "-" ? std::cout : file;
+            out << "[";
+            for (std::size_t i = 0; i < m_verdicts.size(); ++i)
+            {
+                out << (i == 0 ? "\n  " : ",\n  ");
+                write_json_report(out, m_verdicts[i].path, m_verdicts[i].statistics, m_verdicts[i].verdicts, m_verdicts[i].error);
+            }
+            out << "\n]" << std::endl;
+        }
+
+        m_text << "Analyzed " << m_verdicts.size() << " files with " << workers << " workers: " << satisfied << " satisfied, "
+               << not_satisfied << " not satisfied, " << without << " without postconditions, " << errors << " errors" << std::endl;
+        return (not_satisfied == 0 && errors == 0) ? 0 : 1;
+    }
+};
+
+/**
+ * @brief Analyzes a list of files with a pool of workers, longest job first (see run_batch_longest_first).
+ * The analyses themselves run quietly, and one line is printed per file, in the order of the list, as soon
+ * as the files before it are completed.
+ *
+ * @param paths
+ * @param jobs number of workers
+ * @param solver_mode
+ * @param metrics_path if not empty, file where the JSON reports of all the files are written, as an array
+ * in the order of the list ("-" for the standard output)
+ * @param cache_path if not empty, directory of the ResultCache shared by the workers
+ * @param budget limits of the analysis of every file
+ * @param results_path if not empty, file where the records of all the files are streamed, in the order of the
+ * list ("-" for the standard output, the lines of the files then go to the standard error)
+ * @param results_format
+ * @param pipeline if set, the stages of the files run on their own workers (see run_batch_pipeline), in the
+ * order of the list, instead of the jobs workers analyzing whole files
+ * @return int 0 if every postcondition of every file is satisfied, 1 otherwise
+ */
+inline int run_batch(const std::vector<std::string>& paths, std::size_t jobs, SolverMode solver_mode, const std::string& metrics_path = "",
+                     const std::string& cache_path = "", const AnalysisBudget& budget = {}, const std::string& results_path = "",
+                     ResultFormat results_format = ResultFormat::NDJSON, const std::optional<BatchPipeline>& pipeline = std::nullopt)
+{
+    Logger::set_level(LogLevel::QUIET);
+    std::optional<ResultCache<int64_t>> cache;
+    if (!cache_path.empty())
+    {
+        cache.emplace(cache_path);
+    }
+    BatchReport report(paths, results_path, results_format);
+
+    std::size_t workers = 0;
+    if (pipeline)
+    {
+        workers = pipeline->workers();
+        run_batch_pipeline(paths, *pipeline, solver_mode, cache ? &*cache : nullptr, budget, report.encoding(), [&](BatchJob& job) {
+            report.complete(job.index, std::move(job.verdict));
+        });
+    }
+    else
+    {
+        WorkStealingPool pool(jobs);
+        workers = pool.workers();
+        run_batch_longest_first(pool, paths, solver_mode, cache ? &*cache : nullptr, budget, report.encoding(), [&](BatchJob& job) {
+            report.complete(job.index, std::move(job.verdict));
+            return true;
+        });
+    }
+    return report.finish(metrics_path, workers);
+}
+
+#endif // BATCH_ANALYSIS_HPP
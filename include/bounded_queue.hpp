@@ -0,0 +1,88 @@
+#ifndef BOUNDED_QUEUE_HPP
+#define BOUNDED_QUEUE_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+/**
+ * @brief Queue of a fixed capacity between the stages of a pipeline: the producers wait while it is full,
+ * the consumers while it is empty. Once every producer has called close, the consumers take what is left
+ * and then get nothing.
+ *
+ * @tparam T
+ */
+template <typename T>
+class BoundedQueue
+{
+private:
+    std::size_t m_capacity;
+    std::size_t m_producers;
+    std::deque<T> m_items;
+    std::mutex m_mutex;
+    std::condition_variable m_not_full;
+    std::condition_variable m_not_empty;
+
+public:
+    /**
+     * @brief Creates an empty queue
+     *
+     * @param capacity number of items it holds before the producers wait
+     * @param producers number of calls to close that end the queue
+     */
+    BoundedQueue(std::size_t capacity, std::size_t producers)
+    : m_capacity(capacity == 0 ? 1 : capacity)
+    , m_producers(producers)
+    {}
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    void push(T item)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_not_full.wait(lock, [this]() { return m_items.size() < m_capacity; });
+        m_items.push_back(std::move(item));
+        lock.unlock();
+        m_not_empty.notify_one();
+    }
+
+    /**
+     * @brief Takes the oldest item, waiting for one if the queue is empty
+     *
+     * @return std::optional<T> nothing once the queue is empty and closed
+     */
+    std::optional<T> pop()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_not_empty.wait(lock, [this]() { return !m_items.empty() || m_producers == 0; });
+        if (m_items.empty())
+        {
+            return std::nullopt;
+        }
+        T item = std::move(m_items.front());
+        m_items.pop_front();
+        lock.unlock();
+        m_not_full.notify_one();
+        return item;
+    }
+
+    /**
+     * @brief Tells that one of the producers will not push anymore
+     *
+     */
+    void close()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_producers > 0 && --m_producers == 0)
+        {
+            lock.unlock();
+            m_not_empty.notify_all();
+        }
+    }
+};
+
+#endif // BOUNDED_QUEUE_HPP
@@ -0,0 +1,568 @@
+#ifndef COMPILED_EXPRESSION_HPP
+#define COMPILED_EXPRESSION_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+#include "analysis_error.hpp"
+#include "diagnostics.hpp"
+#include "flat_ast.hpp"
+#include "interval_store.hpp"
+#include "variable_table.hpp"
+
+/**
+ * @brief Instructions of the postfix programs that expressions are compiled into
+ *
+ */
+enum class OpCode : std::uint8_t {
+    PUSH_CONST,
+    PUSH_VAR,
+    ADD,
+    SUB,
+    MUL,
+    DIV,
+    PUSH_SHARED
+};
+
+/**
+ * @brief A single instruction. The operand is an index in the constant pool for PUSH_CONST,
+ * the identifier of a variable for PUSH_VAR, the subterm of a SharedSubterms table for PUSH_SHARED,
+ * and is unused for the arithmetic operations.
+ *
+ */
+struct Instruction {
+    OpCode op;
+    std::uint32_t operand;
+};
+
+template <typename T>
+class SharedSubterms;
+
+/**
+ * @brief Arithmetic expression lowered into a postfix program over the identifiers of a VariableTable.
+ * Evaluating the program does not touch the AST, nor does it look up variables by name.
+ *
+ * @tparam T
+ */
+template <typename T>
+class CompiledExpression
+{
+    friend class SharedSubterms<T>;
+
+private:
+    std::vector<Instruction> m_code;
+    std::vector<T> m_constants;
+    std::size_t m_max_depth = 0;
+    SharedSubterms<T>* m_shared = nullptr;     // table of the PUSH_SHARED instructions, if any
+
+    // Evaluation stack, sized once at compilation time
+    mutable std::vector<Interval<T>> m_stack;
+
+public:
+    CompiledExpression() = default;
+    ~CompiledExpression() = default;
+
+    /**
+     * @brief Compiles an expression of the AST, interning the variables that it reads
+     *
+     * @param node
+     * @param variables
+     * @return CompiledExpression<T>
+     */
+    static CompiledExpression<T> compile(FlatAST::Node node, VariableTable& variables)
+    {
+        CompiledExpression<T> expression;
+        std::size_t depth = 0;
+        expression.emit(node, variables, depth);
+        expression.m_stack.resize(expression.m_max_depth);
+        return expression;
+    }
+
+    /**
+     * @brief Evaluates the expression in the given store. Overflows and divisions by an interval that
+     * contains 0 are recorded at the site, if it has a collector.
+     *
+     * @param store
+     * @param site
+     * @param offset added to the identifiers of the variables, to read them in a lane of a sweep
+     * @return Interval<T>
+     */
+    Interval<T> evaluate(const IntervalStore<T>& store, DiagnosticSite site = {}, std::size_t offset = 0) const
+    {
+        return run(store, site, [&site](DiagnosticKind kind) { site.record(kind); }, offset);
+    }
+
+    /**
+     * @brief Tells if the expression is a single constant, the first of its constant pool
+     *
+     */
+    bool is_constant() const
+    {
+        return m_code.size() == 1 && m_code[0].op == OpCode::PUSH_CONST;
+    }
+
+    /**
+     * @brief Postfix program of the expression. Once the subterms of a system are shared, it may contain
+     * PUSH_SHARED instructions, which stand for whole subterms.
+     *
+     */
+    const std::vector<Instruction>& code() const
+    {
+        return m_code;
+    }
+
+    const std::vector<T>& constants() const
+    {
+        return m_constants;
+    }
+
+private:
+    /**
+     * @brief Runs the program, reporting its diagnostics to `report`
+     *
+     */
+    template <typename Report>
+    Interval<T> run(const IntervalStore<T>& store, DiagnosticSite site, Report&& report, std::size_t offset) const
+    {
+        auto& stack = m_stack;
+        std::size_t top = 0;
+        for (const auto& instruction : m_code)
+        {
+            switch (instruction.op)
+            {
+                case OpCode::PUSH_CONST:
+                {
+                    auto value = m_constants[instruction.operand];
+                    stack[top++] = Interval<T>(value, value);
+                    break;
+                }
+                case OpCode::PUSH_VAR:
+                {
+                    stack[top++] = store.get(instruction.operand + offset);
+                    break;
+                }
+                case OpCode::PUSH_SHARED:
+                {
+                    stack[top++] = m_shared->evaluate(instruction.operand, store, site, offset);
+                    break;
+                }
+                case OpCode::ADD:
+                {
+                    top--;
+                    stack[top - 1] = stack[top - 1] + stack[top];
+                    if (stack[top - 1].overflowed())
+                    {
+                        report(DiagnosticKind::ADDITION_OVERFLOW);
+                    }
+                    break;
+                }
+                case OpCode::SUB:
+                {
+                    top--;
+                    stack[top - 1] = stack[top - 1] - stack[top];
+                    if (stack[top - 1].overflowed())
+                    {
+                        report(DiagnosticKind::SUBTRACTION_OVERFLOW);
+                    }
+                    break;
+                }
+                case OpCode::MUL:
+                {
+                    top--;
+                    stack[top - 1] = stack[top - 1] * stack[top];
+                    if (stack[top - 1].overflowed())
+                    {
+                        report(DiagnosticKind::MULTIPLICATION_OVERFLOW);
+                    }
+                    break;
+                }
+                case OpCode::DIV:
+                {
+                    top--;
+                    if (stack[top].contains(static_cast<T>(0)))
+                    {
+                        report(DiagnosticKind::DIVISION_BY_ZERO);
+                    }
+                    stack[top - 1] = stack[top - 1] / stack[top];
+                    if (stack[top - 1].overflowed())
+                    {
+                        report(DiagnosticKind::DIVISION_OVERFLOW);
+                    }
+                    break;
+                }
+            }
+        }
+        return stack[0];
+    }
+
+    void emit(FlatAST::Node node, VariableTable& variables, std::size_t& depth)
+    {
+        switch (node.type())
+        {
+            case NodeType::INTEGER:
+            {
+                m_code.push_back({OpCode::PUSH_CONST, static_cast<std::uint32_t>(m_constants.size())});
+                m_constants.push_back(static_cast<T>(node.integer()));
+                push(depth);
+                break;
+            }
+            case NodeType::VARIABLE:
+            {
+                auto id = variables.intern(node.text());
+                m_code.push_back({OpCode::PUSH_VAR, static_cast<std::uint32_t>(id)});
+                push(depth);
+                break;
+            }
+            case NodeType::ARITHM_OP:
+            {
+                if (node.size() < 2)
+                {
+                    throw AnalysisError("malformed arithmetic operation: an operation has two operands");
+                }
+                emit(node.child(0), variables, depth);
+                emit(node.child(1), variables, depth);
+                m_code.push_back({arithmetic_opcode(node), 0});
+                depth--;
+                break;
+            }
+            default:
+            {
+                throw AnalysisError("unexpected expression");
+            }
+        }
+    }
+
+    void push(std::size_t& depth)
+    {
+        depth++;
+        m_max_depth = std::max(m_max_depth, depth);
+    }
+
+    /**
+     * @brief Maps the operator of an arithmetic node onto its opcode. The parser represents the
+     * operators introduced by unary minus and increments as strings rather than BinOp values.
+     *
+     */
+    static OpCode arithmetic_opcode(FlatAST::Node node)
+    {
+        if (node.kind() == FlatAST::ValueKind::TEXT)
+        {
+            const auto& op = node.text();
+            if (op == "+") return OpCode::ADD;
+            if (op == "-") return OpCode::SUB;
+            if (op == "*") return OpCode::MUL;
+            if (op == "/") return OpCode::DIV;
+        }
+        else if (node.kind() == FlatAST::ValueKind::BIN_OP)
+        {
+            switch (node.bin_op())
+            {
+                case BinOp::ADD: return OpCode::ADD;
+                case BinOp::SUB: return OpCode::SUB;
+                case BinOp::MUL: return OpCode::MUL;
+                case BinOp::DIV: return OpCode::DIV;
+            }
+        }
+        throw AnalysisError("unknown binary operation");
+    }
+};
+
+/**
+ * @brief Subterms shared by the expressions of an equational system. The subterms that occur more than once
+ * are hash-consed into the table, and the expressions read them through PUSH_SHARED instructions. A subterm
+ * keeps its value with the intervals of the variables it reads, so that it is evaluated again only when one
+ * of them changed, whichever location reads it. The table is not thread-safe.
+ *
+ * @tparam T
+ */
+template <typename T>
+class SharedSubterms
+{
+private:
+    static constexpr std::size_t NONE = static_cast<std::size_t>(-1);
+
+    struct Subterm {
+        CompiledExpression<T> expression;
+        std::vector<std::uint32_t> variables;   // read by the subterm, without repetitions
+        std::vector<Interval<T>> inputs;        // their intervals at the last evaluation
+        Interval<T> value;
+        std::array<std::uint32_t, DIAGNOSTIC_KINDS> diagnostics{};     // recorded by the last evaluation, by kind
+        bool evaluated = false;
+    };
+
+    // A subterm, as the opcodes of its program with the operands resolved
+    using Key = std::vector<std::int64_t>;
+
+    struct KeyHash {
+        std::size_t operator()(const Key& key) const
+        {
+            std::uint64_t h = 0xcbf29ce484222325ull;
+            for (auto word : key)
+            {
+                h = (h ^ static_cast<std::uint64_t>(word)) * 0x100000001b3ull;
+            }
+            return h;
+        }
+    };
+
+    struct Occurrences {
+        std::size_t count = 0;
+        std::size_t subterm = NONE;
+    };
+
+    std::vector<Subterm> m_subterms;
+    std::size_t m_reuses = 0;
+
+public:
+    SharedSubterms() = default;
+    SharedSubterms(const SharedSubterms&) = delete;
+    SharedSubterms& operator=(const SharedSubterms&) = delete;
+
+    /**
+     * @brief Replaces the subterms that occur more than once in the expressions, and that read a variable,
+     * by PUSH_SHARED instructions. Where shared subterms are nested, the outermost one is shared.
+     *
+     * @param expressions
+     */
+    void share(const std::vector<CompiledExpression<T>*>& expressions)
+    {
+        std::unordered_map<Key, Occurrences, KeyHash> occurrences;
+        // For every expression, the occurrences of the subterm that ends at each instruction, if any
+        std::vector<std::vector<Occurrences*>> ends(expressions.size());
+        std::vector<std::vector<std::size_t>> starts(expressions.size());
+        for (std::size_t e = 0; e < expressions.size(); ++e)
+        {
+            const auto& code = expressions[e]->m_code;
+            ends[e].assign(code.size(), nullptr);
+            starts[e].assign(code.size(), 0);
+            std::vector<std::pair<std::size_t, bool>> operands;     // start, and whether it reads a variable
+            for (std::size_t i = 0; i < code.size(); ++i)
+            {
+                if (code[i].op == OpCode::PUSH_CONST || code[i].op == OpCode::PUSH_VAR || code[i].op == OpCode::PUSH_SHARED)
+                {
+                    operands.push_back({i, code[i].op != OpCode::PUSH_CONST});
+                    continue;
+                }
+                auto right = operands.back();
+                operands.pop_back();
+                auto& left = operands.back();
+                left.second = left.second || right.second;
+                starts[e][i] = left.first;
+                if (left.second)
+                {
+                    auto& entry = occurrences[key(*expressions[e], left.first, i)];
+                    entry.count++;
+                    ends[e][i] = &entry;
+                }
+            }
+        }
+
+        for (std::size_t e = 0; e < expressions.size(); ++e)
+        {
+            auto& expression = *expressions[e];
+            // The outermost shared subterm that starts at each instruction
+            std::vector<std::size_t> outermost(expression.m_code.size(), NONE);
+            for (std::size_t i = 0; i < expression.m_code.size(); ++i)
+            {
+                if (ends[e][i] != nullptr && ends[e][i]->count > 1)
+                {
+                    outermost[starts[e][i]] = i;
+                }
+            }
+            if (std::all_of(outermost.begin(), outermost.end(), [](auto end) { return end == NONE; }))
+            {
+                continue;
+            }
+            std::vector<Instruction> code;
+            std::vector<T> constants;
+            for (std::size_t i = 0; i < expression.m_code.size(); ++i)
+            {
+                if (outermost[i] != NONE)
+                {
+                    auto end = outermost[i];
+                    auto& entry = *ends[e][end];
+                    if (entry.subterm == NONE)
+                    {
+                        entry.subterm = add(expression, i, end);
+                    }
+                    code.push_back({OpCode::PUSH_SHARED, static_cast<std::uint32_t>(entry.subterm)});
+                    i = end;
+                }
+                else if (expression.m_code[i].op == OpCode::PUSH_CONST)
+                {
+                    code.push_back({OpCode::PUSH_CONST, static_cast<std::uint32_t>(constants.size())});
+                    constants.push_back(expression.m_constants[expression.m_code[i].operand]);
+                }
+                else
+                {
+                    code.push_back(expression.m_code[i]);
+                }
+            }
+            expression.m_code = std::move(code);
+            expression.m_constants = std::move(constants);
+            expression.m_shared = this;
+        }
+    }
+
+    /**
+     * @brief Value of a subterm in the given store, evaluated again only if the intervals of its variables
+     * changed since its last evaluation. Its diagnostics are recorded at the site either way.
+     *
+     * @param id
+     * @param store
+     * @param site
+     * @param offset of the lane of the variables
+     * @return Interval<T>
+     */
+    Interval<T> evaluate(std::uint32_t id, const IntervalStore<T>& store, DiagnosticSite site, std::size_t offset = 0)
+    {
+        auto& subterm = m_subterms[id];
+        if (subterm.evaluated && unchanged(subterm, store, offset))
+        {
+            m_reuses++;
+            for (std::size_t kind = 0; kind < subterm.diagnostics.size(); ++kind)
+            {
+                for (std::uint32_t i = 0; i < subterm.diagnostics[kind]; ++i)
+                {
+                    site.record(static_cast<DiagnosticKind>(kind));
+                }
+            }
+            return subterm.value;
+        }
+        for (std::size_t k = 0; k < subterm.variables.size(); ++k)
+        {
+            subterm.inputs[k] = store.get(subterm.variables[k] + offset);
+        }
+        subterm.diagnostics = {};
+        subterm.value = subterm.expression.run(store, site, [&](DiagnosticKind kind) {
+            site.record(kind);
+            subterm.diagnostics[static_cast<std::size_t>(kind)]++;
+        }, offset);
+        subterm.evaluated = true;
+        return subterm.value;
+    }
+
+    /**
+     * @brief Number of shared subterms
+     *
+     */
+    std::size_t size() const
+    {
+        return m_subterms.size();
+    }
+
+    /**
+     * @brief Number of evaluations of a subterm that reused its last value
+     *
+     */
+    std::size_t reuses() const
+    {
+        return m_reuses;
+    }
+
+private:
+    static Key key(const CompiledExpression<T>& expression, std::size_t begin, std::size_t end)
+    {
+        Key key;
+        key.reserve(2 * (end - begin + 1));
+        for (std::size_t i = begin; i <= end; ++i)
+        {
+            const auto& instruction = expression.m_code[i];
+            key.push_back(static_cast<std::int64_t>(instruction.op));
+            if (instruction.op == OpCode::PUSH_CONST)
+            {
+                key.push_back(static_cast<std::int64_t>(expression.m_constants[instruction.operand]));
+            }
+            else if (instruction.op == OpCode::PUSH_VAR || instruction.op == OpCode::PUSH_SHARED)
+            {
+                key.push_back(instruction.operand);
+            }
+        }
+        return key;
+    }
+
+    /**
+     * @brief Adds the subterm of the instructions from begin to end of an expression
+     *
+     */
+    std::size_t add(const CompiledExpression<T>& expression, std::size_t begin, std::size_t end)
+    {
+        Subterm subterm;
+        std::size_t depth = 0;
+        for (std::size_t i = begin; i <= end; ++i)
+        {
+            auto instruction = expression.m_code[i];
+            switch (instruction.op)
+            {
+                case OpCode::PUSH_CONST:
+                {
+                    subterm.expression.m_constants.push_back(expression.m_constants[instruction.operand]);
+                    instruction.operand = static_cast<std::uint32_t>(subterm.expression.m_constants.size() - 1);
+                    subterm.expression.push(depth);
+                    break;
+                }
+                case OpCode::PUSH_VAR:
+                {
+                    subterm.variables.push_back(instruction.operand);
+                    subterm.expression.push(depth);
+                    break;
+                }
+                default:
+                {
+                    depth--;
+                    break;
+                }
+            }
+            subterm.expression.m_code.push_back(instruction);
+        }
+        subterm.expression.m_stack.resize(subterm.expression.m_max_depth);
+        std::sort(subterm.variables.begin(), subterm.variables.end());
+        subterm.variables.erase(std::unique(subterm.variables.begin(), subterm.variables.end()), subterm.variables.end());
+        subterm.inputs.resize(subterm.variables.size());
+        m_subterms.push_back(std::move(subterm));
+        return m_subterms.size() - 1;
+    }
+
+    static bool unchanged(const Subterm& subterm, const IntervalStore<T>& store, std::size_t offset)
+    {
+        for (std::size_t k = 0; k < subterm.variables.size(); ++k)
+        {
+            if (!(store.get(subterm.variables[k] + offset) == subterm.inputs[k]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief Condition of the form `variable op expression`, as found in if-else and while statements
+ *
+ * @tparam T
+ */
+template <typename T>
+struct CompiledCondition {
+    std::size_t variable = 0;
+    LogicOp op = LogicOp::EQ;
+    CompiledExpression<T> rhs;
+
+    static CompiledCondition<T> compile(FlatAST::Node condition, VariableTable& variables)
+    {
+        if (condition.kind() != FlatAST::ValueKind::LOGIC_OP || condition.child(0).type() != NodeType::VARIABLE)
+        {
+            throw AnalysisError("unsupported condition: a condition compares a variable with an expression");
+        }
+        CompiledCondition<T> compiled;
+        compiled.variable = variables.intern(condition.child(0).text());
+        compiled.op = condition.logic_op();
+        compiled.rhs = CompiledExpression<T>::compile(condition.child(1), variables);
+        return compiled;
+    }
+};
+
+#endif // COMPILED_EXPRESSION_HPP
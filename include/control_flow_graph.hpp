@@ -0,0 +1,280 @@
+#ifndef CONTROL_FLOW_GRAPH_HPP
+#define CONTROL_FLOW_GRAPH_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <limits>
+#include <vector>
+
+#include "location_base.hpp"
+
+/**
+ * @brief Links an output store of a source location to an input of a dependent location. A source
+ * equal to ENTRY_LOCATION denotes the store obtained from the preconditions.
+ *
+ */
+struct StoreDependency {
+    static constexpr std::size_t ENTRY_LOCATION = std::numeric_limits<std::size_t>::max();
+
+    std::size_t source;
+    StorePort port;
+    InputSlot slot;
+};
+
+/**
+ * @brief Control-flow graph of the equational system. Nodes are the indices of the locations, and every
+ * edge carries the output port of its source and the input slot of its target, so that the graph alone
+ * describes which store flows into which location.
+ *
+ */
+class ControlFlowGraph
+{
+private:
+    std::vector<std::vector<StoreDependency>> m_predecessors;
+    std::vector<std::vector<std::size_t>> m_successors;
+
+public:
+    ControlFlowGraph() = default;
+    ~ControlFlowGraph() = default;
+
+    /**
+     * @brief Adds an edge from dependency.source to the given target
+     *
+     * @param target
+     * @param dependency
+     */
+    void add_edge(std::size_t target, StoreDependency dependency)
+    {
+        if (m_predecessors.size() <= target)
+        {
+            m_predecessors.resize(target + 1);
+        }
+        m_predecessors[target].push_back(dependency);
+    }
+
+    /**
+     * @brief Sets the number of nodes and computes the successors of every node from the edges
+     *
+     * @param nodes
+     */
+    void finalize(std::size_t nodes)
+    {
+        m_predecessors.resize(nodes);
+        m_successors.assign(nodes, {});
+        for (std::size_t target = 0; target < nodes; ++target)
+        {
+            for (const auto& dependency : m_predecessors[target])
+            {
+                if (dependency.source == StoreDependency::ENTRY_LOCATION)
+                {
+                    continue;
+                }
+                auto& successors = m_successors[dependency.source];
+                if (std::find(successors.begin(), successors.end(), target) == successors.end())
+                {
+                    successors.push_back(target);
+                }
+            }
+        }
+    }
+
+    std::size_t size() const
+    {
+        return m_predecessors.size();
+    }
+
+    const std::vector<StoreDependency>& predecessors(std::size_t node) const
+    {
+        return m_predecessors[node];
+    }
+
+    const std::vector<std::size_t>& successors(std::size_t node) const
+    {
+        return m_successors[node];
+    }
+
+    /**
+     * @brief Tells if an edge goes backwards in program order, that is, if it closes a loop
+     *
+     * @param target
+     * @param dependency
+     * @return true
+     * @return false
+     */
+    static bool is_back_edge(std::size_t target, const StoreDependency& dependency)
+    {
+        return dependency.source != StoreDependency::ENTRY_LOCATION && dependency.source >= target;
+    }
+};
+
+/**
+ * @brief Weak topological order of a control-flow graph (Bourdoncle, 1993): a topological order of the
+ * nodes in which every cycle is enclosed in a component whose first node, the head, is the only entry of
+ * the cycle. Components nest like the loops of the program.
+ *
+ * The order is stored flat: the nodes in order and, for every position that holds the head of a
+ * component, the position just past the end of that component.
+ *
+ */
+class WeakTopologicalOrder
+{
+private:
+    static constexpr std::size_t NOT_A_HEAD = std::numeric_limits<std::size_t>::max();
+
+    struct Element {
+        std::size_t node;
+        bool is_component;
+        std::deque<Element> body;
+    };
+
+    std::vector<std::size_t> m_nodes;
+    std::vector<std::size_t> m_component_end;
+
+public:
+    /**
+     * @brief Computes the weak topological order of the nodes reachable from the root, followed by the
+     * order of any node that is not
+     *
+     * @param cfg
+     * @param root
+     * @return WeakTopologicalOrder
+     */
+    static WeakTopologicalOrder compute(const ControlFlowGraph& cfg, std::size_t root)
+    {
+        WeakTopologicalOrder wto;
+        if (cfg.size() == 0)
+        {
+            return wto;
+        }
+
+        Builder builder(cfg);
+        std::deque<Element> partition;
+        builder.visit(root, partition);
+        for (std::size_t node = 0; node < cfg.size(); ++node)
+        {
+            if (builder.m_dfn[node] == 0)
+            {
+                std::deque<Element> rest;
+                builder.visit(node, rest);
+                partition.insert(partition.end(), rest.begin(), rest.end());
+            }
+        }
+        wto.flatten(partition);
+        return wto;
+    }
+
+    std::size_t size() const
+    {
+        return m_nodes.size();
+    }
+
+    std::size_t node(std::size_t position) const
+    {
+        return m_nodes[position];
+    }
+
+    bool is_head(std::size_t position) const
+    {
+        return m_component_end[position] != NOT_A_HEAD;
+    }
+
+    /**
+     * @brief Returns the position just past the end of the component whose head is at the given position
+     *
+     * @param position
+     * @return std::size_t
+     */
+    std::size_t component_end(std::size_t position) const
+    {
+        return m_component_end[position];
+    }
+
+private:
+    /**
+     * @brief Recursive construction of the order, with the depth-first numbering of Bourdoncle's algorithm
+     *
+     */
+    struct Builder {
+        static constexpr std::size_t DONE = std::numeric_limits<std::size_t>::max();
+
+        const ControlFlowGraph& m_cfg;
+        std::vector<std::size_t> m_dfn;
+        std::vector<std::size_t> m_stack;
+        std::size_t m_num = 0;
+
+        explicit Builder(const ControlFlowGraph& cfg)
+        : m_cfg(cfg)
+        , m_dfn(cfg.size(), 0)
+        {}
+
+        std::size_t visit(std::size_t vertex, std::deque<Element>& partition)
+        {
+            m_stack.push_back(vertex);
+            m_dfn[vertex] = ++m_num;
+            auto head = m_dfn[vertex];
+            auto loop = false;
+            for (auto successor : m_cfg.successors(vertex))
+            {
+                auto min = m_dfn[successor] == 0 ? visit(successor, partition) : m_dfn[successor];
+                if (min <= head)
+                {
+                    head = min;
+                    loop = true;
+                }
+            }
+
+            if (head == m_dfn[vertex])
+            {
+                m_dfn[vertex] = DONE;
+                auto element = m_stack.back();
+                m_stack.pop_back();
+                if (loop)
+                {
+                    while (element != vertex)
+                    {
+                        m_dfn[element] = 0;
+                        element = m_stack.back();
+                        m_stack.pop_back();
+                    }
+                    partition.push_front(component(vertex));
+                }
+                else
+                {
+                    partition.push_front({vertex, false, {}});
+                }
+            }
+            return head;
+        }
+
+        Element component(std::size_t vertex)
+        {
+            Element element{vertex, true, {}};
+            for (auto successor : m_cfg.successors(vertex))
+            {
+                if (m_dfn[successor] == 0)
+                {
+                    visit(successor, element.body);
+                }
+            }
+            return element;
+        }
+    };
+
+    void flatten(const std::deque<Element>& elements)
+    {
+        for (const auto& element : elements)
+        {
+            auto position = m_nodes.size();
+            m_nodes.push_back(element.node);
+            m_component_end.push_back(NOT_A_HEAD);
+            if (element.is_component)
+            {
+                flatten(element.body);
+                m_component_end[position] = m_nodes.size();
+            }
+        }
+    }
+};
+
+#endif // CONTROL_FLOW_GRAPH_HPP
@@ -0,0 +1,734 @@
+#ifndef DESCENT_PARSER_HPP
+#define DESCENT_PARSER_HPP
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <iostream>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "ast_builder.hpp"
+#include "flat_ast.hpp"
+#include "logger.hpp"
+
+/**
+ * @brief Hand-written recursive-descent parser of the grammar of AbstractInterpreterParser, which builds
+ * the arena directly in a single pass over the input, without semantic values.
+ *
+ * It accepts the same programs and builds the same trees as the PEG parser, which remains the reference
+ * (see ParserKind::DIFFERENTIAL). It therefore follows the semantics of the grammar rather than those of C:
+ * a literal such as `int` or `else` matches a prefix of an identifier, the alternatives of a statement are
+ * tried in the order of the grammar, and a repetition stops before the first element that does not match
+ * entirely. The alternatives are selected on their first characters, so a statement is only matched again
+ * from its start when a declaration turns out to be an assignment (`intx = y;`).
+ *
+ */
+class DescentParser
+{
+private:
+    using Index = FlatAST::Index;
+
+    std::string_view m_input;
+    std::size_t m_position = 0;
+    std::size_t m_furthest = 0;     // furthest position at which a token was expected, for the error
+    FlatAST m_ast;
+    FlatASTBuilder m_builder{m_ast};
+    std::vector<Index> m_items;     // values of the lists being parsed, nested lists on top of the others
+    std::size_t m_line_start = 0;   // position up to which the lines are counted, and its line
+    std::size_t m_line = 1;
+
+public:
+    DescentParser() = default;
+
+    // The builder refers to the arena of this object, which therefore cannot be copied or moved
+    DescentParser(const DescentParser&) = delete;
+    DescentParser& operator=(const DescentParser&) = delete;
+
+    /**
+     * @brief Parses a program into an arena. On failure, the tree has a single node.
+     *
+     * @param input
+     * @return FlatAST
+     */
+    FlatAST parse(std::string_view input)
+    {
+        m_input = input;
+        m_position = 0;
+        m_furthest = 0;
+        m_line_start = 0;
+        m_line = 1;
+        m_ast = FlatAST();
+        m_ast.reserve(input.size() / 8);
+        m_items.clear();
+
+        skip_whitespace();
+        auto base = m_items.size();
+        Index statement;
+        while (this->statement(statement))
+        {
+            m_items.push_back(statement);
+        }
+        if (m_position == m_input.size())
+        {
+            m_ast.set_root(m_builder.program(items(base)));
+        }
+        else
+        {
+            auto [line, column] = line_column(std::max(m_furthest, m_position));
+            Logger::err() << line << ":" << column << ": syntax error" << "\n";
+            Logger::err() << "Parsing failed!" << std::endl;
+            m_ast.set_root(m_ast.add(NodeType::INTEGER, FlatAST::Value::integer(0)));
+        }
+        m_items.clear();
+        return std::move(m_ast);
+    }
+
+private:
+    // Lexer: the tokens are matched where the grammar expects them, then the whitespace after them
+
+    char current() const
+    {
+        return m_position < m_input.size() ? m_input[m_position] : '\0';
+    }
+
+    bool starts_with(std::string_view text) const
+    {
+        return m_input.substr(m_position).starts_with(text);
+    }
+
+    void skip_whitespace()
+    {
+        while (m_position < m_input.size())
+        {
+            char c = m_input[m_position];
+            if (c != ' ' && c != '\n' && c != '\r' && c != '\t')
+            {
+                break;
+            }
+            ++m_position;
+        }
+    }
+
+    bool fail()
+    {
+        m_furthest = std::max(m_furthest, m_position);
+        return false;
+    }
+
+    bool literal(std::string_view text)
+    {
+        if (!starts_with(text))
+        {
+            return fail();
+        }
+        m_position += text.size();
+        skip_whitespace();
+        return true;
+    }
+
+    static bool is_identifier_start(char c)
+    {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+    }
+
+    static bool is_digit(char c)
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    // [a-zA-Z_][a-zA-Z0-9_]*
+    bool identifier_token(std::string_view& token)
+    {
+        if (!is_identifier_start(current()))
+        {
+            return fail();
+        }
+        auto start = m_position++;
+        while (m_position < m_input.size() && (is_identifier_start(m_input[m_position]) || is_digit(m_input[m_position])))
+        {
+            ++m_position;
+        }
+        token = m_input.substr(start, m_position - start);
+        skip_whitespace();
+        return true;
+    }
+
+    bool identifier(Index& value)
+    {
+        std::string_view token;
+        if (!identifier_token(token))
+        {
+            return false;
+        }
+        value = m_builder.identifier(token);
+        return true;
+    }
+
+    // [+-]?[0-9]+, converted as SemanticValues::token_to_number does
+    bool integer(Index& value)
+    {
+        auto start = m_position;
+        auto digits = start + ((current() == '+' || current() == '-') ? 1 : 0);
+        auto end = digits;
+        while (end < m_input.size() && is_digit(m_input[end]))
+        {
+            ++end;
+        }
+        if (end == digits)
+        {
+            return fail();
+        }
+        std::int64_t number = 0;
+        std::from_chars(m_input.data() + start, m_input.data() + end, number);
+        m_position = end;
+        skip_whitespace();
+        value = m_builder.integer(number);
+        return true;
+    }
+
+    // Parser: every rule restores the position when it fails
+
+    std::span<const Index> items(std::size_t base) const
+    {
+        return std::span<const Index>(m_items.data() + base, m_items.size() - base);
+    }
+
+    bool rewind(std::size_t position, std::size_t base)
+    {
+        m_position = position;
+        m_items.resize(base);
+        return false;
+    }
+
+    // Statements <- FunctionDef / DeclareVar / Assignment / Increment / IfElse / WhileLoop / Block / PreCon / PostCon / Comment
+    bool statement(Index& value)
+    {
+        auto start = m_position;
+        char c = current();
+        if (is_identifier_start(c))
+        {
+            if (starts_with("int"))
+            {
+                if (function_def(value) || decl_var(value))
+                {
+                    return true;
+                }
+                m_position = start;
+            }
+            if (assignment_or_increment(value))
+            {
+                return true;
+            }
+            if (starts_with("if"))
+            {
+                return ifelse(value);
+            }
+            if (starts_with("while"))
+            {
+                return whileloop(value);
+            }
+            if (starts_with("void main"))
+            {
+                return block(value);
+            }
+            if (starts_with("assert"))
+            {
+                return post_con(value);
+            }
+            return fail();
+        }
+        if (c == '{')
+        {
+            return block(value);
+        }
+        if (starts_with("/*!npk"))
+        {
+            return pre_con(value);
+        }
+        if (starts_with("//"))
+        {
+            // Comment <- '//' [^\n\r]* [ \n\r\t]*
+            m_position += 2;
+            while (m_position < m_input.size() && m_input[m_position] != '\n' && m_input[m_position] != '\r')
+            {
+                ++m_position;
+            }
+            skip_whitespace();
+            value = FlatASTBuilder::COMMENT;
+            return true;
+        }
+        return fail();
+    }
+
+    // Block / Statements, where a comment is not a statement
+    bool body(Index& value)
+    {
+        auto start = m_position;
+        if (!statement(value))
+        {
+            return false;
+        }
+        if (value == FlatASTBuilder::COMMENT)
+        {
+            m_position = start;
+            return fail();
+        }
+        return true;
+    }
+
+    // Statements*, appended to m_items
+    void statements()
+    {
+        Index statement;
+        while (this->statement(statement))
+        {
+            m_items.push_back(statement);
+        }
+    }
+
+    // FunctionDef <- 'int' Identifier '(' ('int' Identifier (',' 'int' Identifier)*)? ')' '{' Statements* 'return' (Call / Expression) ';' '}'
+    bool function_def(Index& value)
+    {
+        auto start = m_position;
+        auto base = m_items.size();
+        std::string_view name_token;
+        if (!literal("int") || !identifier_token(name_token) || !literal("("))
+        {
+            return rewind(start, base);
+        }
+        Index name = m_builder.identifier(name_token);
+        auto parameters_start = m_position;
+        Index parameter;
+        if (literal("int") && identifier(parameter))
+        {
+            m_items.push_back(parameter);
+            while (true)
+            {
+                auto next = m_position;
+                if (!literal(",") || !literal("int") || !identifier(parameter))
+                {
+                    m_position = next;
+                    break;
+                }
+                m_items.push_back(parameter);
+            }
+        }
+        else
+        {
+            m_position = parameters_start;
+        }
+        auto body_base = m_items.size();
+        if (!literal(")") || !literal("{"))
+        {
+            return rewind(start, base);
+        }
+        statements();
+        Index result;
+        if (!literal("return") || !call_or_expression(result) || !literal(";") || !literal("}"))
+        {
+            return rewind(start, base);
+        }
+        value = m_builder.function(name, items(base).first(body_base - base), items(body_base), result);
+        m_items.resize(base);
+        return true;
+    }
+
+    // DeclareVar <- 'int' Identifier ('=' Integer / ',' Identifier)* ';'
+    bool decl_var(Index& value)
+    {
+        auto start = m_position;
+        auto base = m_items.size();
+        Index item;
+        if (!literal("int") || !identifier(item))
+        {
+            return rewind(start, base);
+        }
+        m_items.push_back(item);
+        while (true)
+        {
+            auto next = m_position;
+            if (literal("=") && integer(item))
+            {
+                m_items.push_back(item);
+                continue;
+            }
+            m_position = next;
+            if (literal(",") && identifier(item))
+            {
+                m_items.push_back(item);
+                continue;
+            }
+            m_position = next;
+            break;
+        }
+        if (!literal(";"))
+        {
+            return rewind(start, base);
+        }
+        value = m_builder.decl_var(items(base));
+        m_items.resize(base);
+        return true;
+    }
+
+    // Assignment <- Identifier '=' (Call / Expression) ';'
+    // Increment  <- Identifier '++' ';'
+    bool assignment_or_increment(Index& value)
+    {
+        auto start = m_position;
+        std::string_view name;
+        if (!identifier_token(name))
+        {
+            return false;
+        }
+        if (current() == '=')
+        {
+            Index var = m_builder.identifier(name);
+            Index expression;
+            if (literal("=") && call_or_expression(expression) && literal(";"))
+            {
+                value = m_builder.assign(var, expression);
+                m_builder.at_line(value, line_at(start));
+                return true;
+            }
+        }
+        else if (starts_with("++"))
+        {
+            Index var = m_builder.identifier(name);
+            if (literal("++") && literal(";"))
+            {
+                value = m_builder.increment(var);
+                m_builder.at_line(value, line_at(start));
+                return true;
+            }
+        }
+        m_position = start;
+        return fail();
+    }
+
+    // IfElse <- 'if' '(' Expression ')' (Block / Statements) ('else' (Block / Statements))?
+    bool ifelse(Index& value)
+    {
+        auto start = m_position;
+        // before the body, whose statements come after it
+        auto line = line_at(start);
+        Index parts[3];
+        if (!literal("if") || !literal("(") || !expression(parts[0]) || !literal(")") || !body(parts[1]))
+        {
+            m_position = start;
+            return false;
+        }
+        std::size_t count = 2;
+        auto else_start = m_position;
+        if (literal("else") && body(parts[2]))
+        {
+            count = 3;
+        }
+        else
+        {
+            m_position = else_start;
+        }
+        value = m_builder.ifelse(std::span<const Index>(parts, count));
+        m_builder.at_line(value, line);
+        return true;
+    }
+
+    // WhileLoop <- 'while' '(' Expression ')' (Block / Statements)
+    bool whileloop(Index& value)
+    {
+        auto start = m_position;
+        auto line = line_at(start);
+        Index condition, body;
+        if (!literal("while") || !literal("(") || !expression(condition) || !literal(")") || !this->body(body))
+        {
+            m_position = start;
+            return false;
+        }
+        value = m_builder.whileloop(condition, body);
+        m_builder.at_line(value, line);
+        return true;
+    }
+
+    // Block <- ('void main' '(' ')')? '{' Statements* '}'
+    bool block(Index& value)
+    {
+        auto start = m_position;
+        auto base = m_items.size();
+        bool main = literal("void main") && literal("(") && literal(")");
+        if (!main)
+        {
+            m_position = start;
+        }
+        if (!literal("{"))
+        {
+            return rewind(start, base);
+        }
+        statements();
+        if (!literal("}"))
+        {
+            return rewind(start, base);
+        }
+        value = m_builder.block(items(base), main);
+        m_items.resize(base);
+        return true;
+    }
+
+    // PreCon <- '/*!npk' Identifier 'between' Integer 'and' Integer '*/'
+    bool pre_con(Index& value)
+    {
+        auto start = m_position;
+        Index var, lb, ub;
+        if (!literal("/*!npk") || !identifier(var) || !literal("between") || !integer(lb) || !literal("and") || !integer(ub)
+            || !literal("*/"))
+        {
+            m_position = start;
+            return false;
+        }
+        value = m_builder.pre_con(var, lb, ub);
+        return true;
+    }
+
+    // PostCon <- 'assert' '(' Expression ')' ';'
+    bool post_con(Index& value)
+    {
+        auto start = m_position;
+        Index expression;
+        if (!literal("assert") || !literal("(") || !this->expression(expression) || !literal(")") || !literal(";"))
+        {
+            m_position = start;
+            return false;
+        }
+        value = m_builder.post_con(expression);
+        m_builder.at_line(value, line_at(start));
+        return true;
+    }
+
+    // Call / Expression
+    bool call_or_expression(Index& value)
+    {
+        return call(value) || expression(value);
+    }
+
+    // Call <- Identifier '(' (Expression (',' Expression)*)? ')'
+    bool call(Index& value)
+    {
+        auto start = m_position;
+        auto base = m_items.size();
+        std::string_view name_token;
+        if (!identifier_token(name_token) || current() != '(')
+        {
+            return rewind(start, base);
+        }
+        Index name = m_builder.identifier(name_token);
+        literal("(");
+        Index argument;
+        auto arguments_start = m_position;
+        if (expression(argument))
+        {
+            m_items.push_back(argument);
+            while (true)
+            {
+                auto next = m_position;
+                if (!literal(",") || !expression(argument))
+                {
+                    m_position = next;
+                    break;
+                }
+                m_items.push_back(argument);
+            }
+        }
+        else
+        {
+            m_position = arguments_start;
+        }
+        if (!literal(")"))
+        {
+            return rewind(start, base);
+        }
+        value = m_builder.call(name, items(base));
+        m_items.resize(base);
+        return true;
+    }
+
+    // Expression <- Term ((SeqOp / LogicOp) Term)*
+    bool expression(Index& value)
+    {
+        auto base = m_items.size();
+        Index operand;
+        if (!term(operand))
+        {
+            return false;
+        }
+        m_items.push_back(operand);
+        while (true)
+        {
+            auto next = m_position;
+            Index op;
+            if (!seq_op(op) && !logic_op(op))
+            {
+                break;
+            }
+            if (!term(operand))
+            {
+                m_position = next;
+                break;
+            }
+            m_items.push_back(op);
+            m_items.push_back(operand);
+        }
+        value = m_builder.expr(items(base));
+        m_items.resize(base);
+        return true;
+    }
+
+    // Term <- Factor (PreOp Factor)*
+    bool term(Index& value)
+    {
+        auto base = m_items.size();
+        Index operand;
+        if (!factor(operand))
+        {
+            return false;
+        }
+        m_items.push_back(operand);
+        while (true)
+        {
+            auto next = m_position;
+            Index op;
+            if (!pre_op(op))
+            {
+                break;
+            }
+            if (!factor(operand))
+            {
+                m_position = next;
+                break;
+            }
+            m_items.push_back(op);
+            m_items.push_back(operand);
+        }
+        value = m_builder.term(items(base));
+        m_items.resize(base);
+        return true;
+    }
+
+    // Factor <- '-' Factor / Integer / Identifier / '(' Expression ')'
+    bool factor(Index& value)
+    {
+        auto start = m_position;
+        char c = current();
+        if (c == '-')
+        {
+            literal("-");
+            Index operand;
+            if (factor(operand))
+            {
+                value = m_builder.negation(operand);
+                return true;
+            }
+            m_position = start;
+        }
+        if (c == '+' || c == '-' || is_digit(c))
+        {
+            if (integer(value))
+            {
+                return true;
+            }
+        }
+        if (is_identifier_start(c))
+        {
+            return identifier(value);
+        }
+        if (c == '(')
+        {
+            literal("(");
+            if (expression(value) && literal(")"))
+            {
+                return true;
+            }
+            m_position = start;
+        }
+        return fail();
+    }
+
+    // SeqOp <- '+' / '-'
+    bool seq_op(Index& value)
+    {
+        char c = current();
+        if (c != '+' && c != '-')
+        {
+            return fail();
+        }
+        ++m_position;
+        skip_whitespace();
+        value = m_builder.seq_op(c == '-');
+        return true;
+    }
+
+    // PreOp <- '*' / '/'
+    bool pre_op(Index& value)
+    {
+        char c = current();
+        if (c != '*' && c != '/')
+        {
+            return fail();
+        }
+        ++m_position;
+        skip_whitespace();
+        value = m_builder.pre_op(c == '/');
+        return true;
+    }
+
+    // LogicOp <- '<=' / '>=' / '==' / '!=' / '<' / '>'
+    bool logic_op(Index& value)
+    {
+        static constexpr std::string_view ops[] = {"<=", ">=", "==", "!=", "<", ">"};
+        for (std::size_t choice = 0; choice < std::size(ops); ++choice)
+        {
+            if (literal(ops[choice]))
+            {
+                value = m_builder.logic_op(choice);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Line of a position, counting the lines from the previous position asked for. The positions
+     * asked for only go back when a statement is parsed again from its start.
+     *
+     */
+    std::size_t line_at(std::size_t position)
+    {
+        if (position < m_line_start)
+        {
+            m_line_start = 0;
+            m_line = 1;
+        }
+        m_line += std::count(m_input.begin() + m_line_start, m_input.begin() + position, '\n');
+        m_line_start = position;
+        return m_line;
+    }
+
+    std::pair<std::size_t, std::size_t> line_column(std::size_t position) const
+    {
+        std::size_t line = 1, column = 1;
+        for (std::size_t i = 0; i < position && i < m_input.size(); ++i)
+        {
+            if (m_input[i] == '\n')
+            {
+                line++;
+                column = 1;
+            }
+            else
+            {
+                column++;
+            }
+        }
+        return {line, column};
+    }
+};
+
+#endif // DESCENT_PARSER_HPP
@@ -0,0 +1,165 @@
+#ifndef DIAGNOSTICS_HPP
+#define DIAGNOSTICS_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Events raised by the evaluation of an expression
+ *
+ */
+enum class DiagnosticKind : std::uint8_t {
+    ADDITION_OVERFLOW,
+    SUBTRACTION_OVERFLOW,
+    MULTIPLICATION_OVERFLOW,
+    DIVISION_BY_ZERO,
+    DIVISION_OVERFLOW       // the smallest value of a signed type divided by -1
+};
+
+constexpr std::size_t DIAGNOSTIC_KINDS = 5;
+
+inline const char* diagnostic_message(DiagnosticKind kind)
+{
+    switch (kind)
+    {
+        case DiagnosticKind::ADDITION_OVERFLOW: return "Overflow in evaluating addition";
+        case DiagnosticKind::SUBTRACTION_OVERFLOW: return "Overflow in evaluating subtraction";
+        case DiagnosticKind::MULTIPLICATION_OVERFLOW: return "Overflow in evaluating multiplication";
+        case DiagnosticKind::DIVISION_BY_ZERO: return "Division by 0";
+        case DiagnosticKind::DIVISION_OVERFLOW: return "Overflow in evaluating division";
+    }
+    return "unknown";
+}
+
+inline const char* diagnostic_name(DiagnosticKind kind)
+{
+    switch (kind)
+    {
+        case DiagnosticKind::ADDITION_OVERFLOW: return "addition_overflow";
+        case DiagnosticKind::SUBTRACTION_OVERFLOW: return "subtraction_overflow";
+        case DiagnosticKind::MULTIPLICATION_OVERFLOW: return "multiplication_overflow";
+        case DiagnosticKind::DIVISION_BY_ZERO: return "division_by_zero";
+        case DiagnosticKind::DIVISION_OVERFLOW: return "division_overflow";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief An event of a location, with the number of evaluations of the location that raised it
+ *
+ */
+struct Diagnostic {
+    std::size_t location;
+    DiagnosticKind kind;
+    std::size_t count;
+};
+
+/**
+ * @brief Collects the diagnostics raised during the fixpoint iteration, so that each of them is reported
+ * once afterwards instead of on every evaluation of its location.
+ *
+ * Every thread records into a buffer of its own, found through a thread-local cache, and deduplicated as
+ * it grows: recording takes no lock, except the first time a thread records into a collector. The buffers
+ * are merged by diagnostics(), which must not run concurrently with record.
+ *
+ */
+class DiagnosticCollector
+{
+private:
+    using Counts = std::unordered_map<std::uint64_t, std::size_t>;     // by location and kind, on KIND_BITS bits
+
+    static constexpr std::uint64_t KIND_BITS = 3;
+
+    std::uint64_t m_id = next_id();
+    std::mutex m_mutex;         // guards m_buffers only
+    std::deque<Counts> m_buffers;
+
+public:
+    DiagnosticCollector() = default;
+    DiagnosticCollector(const DiagnosticCollector&) = delete;
+    DiagnosticCollector& operator=(const DiagnosticCollector&) = delete;
+
+    void record(std::size_t location, DiagnosticKind kind)
+    {
+        struct Cache {
+            std::uint64_t collector = 0;
+            Counts* buffer = nullptr;
+        };
+        static thread_local Cache cache;
+        if (cache.collector != m_id)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            cache.buffer = &m_buffers.emplace_back();
+            cache.collector = m_id;
+        }
+        (*cache.buffer)[(static_cast<std::uint64_t>(location) << KIND_BITS) | static_cast<std::uint64_t>(kind)]++;
+    }
+
+    /**
+     * @brief The distinct diagnostics recorded by all the threads, by location and kind
+     *
+     * @return std::vector<Diagnostic>
+     */
+    std::vector<Diagnostic> diagnostics() const
+    {
+        Counts merged;
+        for (const auto& buffer : m_buffers)
+        {
+            for (const auto& [key, count] : buffer)
+            {
+                merged[key] += count;
+            }
+        }
+        std::vector<Diagnostic> diagnostics;
+        diagnostics.reserve(merged.size());
+        for (const auto& [key, count] : merged)
+        {
+            diagnostics.push_back({static_cast<std::size_t>(key >> KIND_BITS), static_cast<DiagnosticKind>(key & ((1 << KIND_BITS) - 1)), count});
+        }
+        std::sort(diagnostics.begin(), diagnostics.end(), [](const Diagnostic& a, const Diagnostic& b) {
+            return a.location != b.location ? a.location < b.location : a.kind < b.kind;
+        });
+        return diagnostics;
+    }
+
+    void clear()
+    {
+        for (auto& buffer : m_buffers)
+        {
+            buffer.clear();
+        }
+    }
+
+private:
+    // Identifiers are never reused, unlike addresses, so a cache cannot outlive its collector
+    static std::uint64_t next_id()
+    {
+        static std::atomic<std::uint64_t> counter{0};
+        return ++counter;
+    }
+};
+
+/**
+ * @brief Where an expression reports its diagnostics: a collector and the location being evaluated.
+ * Without a collector, nothing is recorded.
+ *
+ */
+struct DiagnosticSite {
+    DiagnosticCollector* collector = nullptr;
+    std::size_t location = 0;
+
+    void record(DiagnosticKind kind) const
+    {
+        if (collector != nullptr)
+        {
+            collector->record(location, kind);
+        }
+    }
+};
+
+#endif // DIAGNOSTICS_HPP
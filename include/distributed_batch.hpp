@@ -0,0 +1,661 @@
+#ifndef DISTRIBUTED_BATCH_HPP
+#define DISTRIBUTED_BATCH_HPP
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <condition_variable>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "analysis_server.hpp"
+#include "batch_analysis.hpp"
+#include "mapped_file.hpp"
+#include "result_cache.hpp"
+#include "thread_pool.hpp"
+
+/**
+ * @brief Host and port of a batch worker, written `HOST:PORT`
+ *
+ */
+struct BatchEndpoint {
+    std::string host;
+    std::string port;
+
+    std::string name() const
+    {
+        return host + ":" + port;
+    }
+};
+
+/**
+ * @brief Reads a list of endpoints written `HOST:PORT,HOST:PORT...`. A worker listens on `[HOST:]PORT`,
+ * so the host can be omitted when default_host is given.
+ *
+ * @param text
+ * @param endpoints
+ * @param default_host if not empty, host of the endpoints written as a port alone
+ * @return true if the text is valid
+ */
+inline bool parse_batch_endpoints(const std::string& text, std::vector<BatchEndpoint>& endpoints, const std::string& default_host = "")
+{
+    std::istringstream fields(text);
+    std::string field;
+    while (std::getline(fields, field, ','))
+    {
+        auto colon = field.rfind(':');
+        BatchEndpoint endpoint{colon == std::string::npos ? default_host : field.substr(0, colon),
+                               colon == std::string::npos ? field : field.substr(colon + 1)};
+        if (endpoint.host.empty() || endpoint.port.empty() || endpoint.port.find_first_not_of("0123456789") != std::string::npos)
+        {
+            return false;
+        }
+        endpoints.push_back(std::move(endpoint));
+    }
+    return !endpoints.empty();
+}
+
+/**
+ * @brief Estimates the cost of the analysis of a source by parsing it (see AnalysisCostEstimator), at least 1
+ * so that a file that cannot be parsed still counts
+ *
+ * @param text
+ * @return std::uint64_t
+ */
+inline std::uint64_t estimate_batch_cost(std::string_view text)
+{
+    auto ast = AbstractInterpreterParser::parse_program(text);
+    return std::max<std::uint64_t>(1, AnalysisCostEstimator::estimate(ast).cost);
+}
+
+/**
+ * @brief Splits the files of a batch into shards of about the same total cost, by assigning the files
+ * from the most expensive one to the shard with the lowest total so far
+ *
+ * @param costs of every file
+ * @param shards number of shards, at most one per file
+ * @return std::vector<std::vector<std::size_t>> the files of every shard, from the most expensive
+ */
+inline std::vector<std::vector<std::size_t>> shard_batch(const std::vector<std::uint64_t>& costs, std::size_t shards)
+{
+    shards = std::max<std::size_t>(1, std::min(shards, costs.size()));
+    std::vector<std::size_t> order(costs.size());
+    for (std::size_t i = 0; i < order.size(); ++i)
+    {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&costs](std::size_t a, std::size_t b) { return costs[a] > costs[b]; });
+
+    using Load = std::pair<std::uint64_t, std::size_t>;     // total cost and shard
+    std::priority_queue<Load, std::vector<Load>, std::greater<Load>> loads;
+    for (std::size_t shard = 0; shard < shards; ++shard)
+    {
+        loads.push({0, shard});
+    }
+    std::vector<std::vector<std::size_t>> files(shards);
+    for (auto file : order)
+    {
+        auto [total, shard] = loads.top();
+        loads.pop();
+        files[shard].push_back(file);
+        loads.push({total + costs[file], shard});
+    }
+    return files;
+}
+
+/**
+ * @brief Encodes the verdict of a file, without its path, for the answer of a worker. The integers and the
+ * AnalysisStatistics are copied in the byte order and layout of the machine, so the coordinator and its
+ * workers must run the same build.
+ *
+ * @param verdict
+ * @return std::string
+ */
+inline std::string encode_file_verdict(const FileVerdict& verdict)
+{
+    static_assert(std::is_trivially_copyable_v<AnalysisStatistics>);
+    std::string record;
+    auto put = [&record](const void* data, std::size_t size) { record.append(static_cast<const char*>(data), size); };
+    auto put_string = [&put](const std::string& text) {
+        std::uint64_t size = text.size();
+        put(&size, sizeof(size));
+        put(text.data(), text.size());
+    };
+    std::uint64_t counts[3] = {verdict.postconditions, verdict.satisfied, verdict.verdicts.size()};
+    put_string(verdict.error);
+    put(counts, sizeof(counts));
+    put(&verdict.statistics, sizeof(verdict.statistics));
+    for (const auto& postcondition : verdict.verdicts)
+    {
+        std::uint64_t location = postcondition.location;
+        std::uint8_t satisfied = postcondition.satisfied ? 1 : 0;
+        put(&location, sizeof(location));
+        put(&satisfied, sizeof(satisfied));
+    }
+    put_string(verdict.results);
+    return record;
+}
+
+/**
+ * @brief Decodes a verdict encoded by encode_file_verdict, keeping the path of the verdict
+ *
+ * @param record
+ * @param verdict
+ * @return false if the record is truncated or malformed
+ */
+inline bool decode_file_verdict(std::string_view record, FileVerdict& verdict)
+{
+    auto get = [&record](void* data, std::uint64_t size) {
+        if (record.size() < size)
+        {
+            return false;
+        }
+        std::memcpy(data, record.data(), size);
+        record.remove_prefix(size);
+        return true;
+    };
+    auto get_string = [&](std::string& text) {
+        std::uint64_t size = 0;
+        if (!get(&size, sizeof(size)) || record.size() < size)
+        {
+            return false;
+        }
+        text.assign(record.data(), size);
+        record.remove_prefix(size);
+        return true;
+    };
+    std::uint64_t counts[3];
+    if (!get_string(verdict.error) || !get(counts, sizeof(counts)) || !get(&verdict.statistics, sizeof(verdict.statistics))
+        || counts[2] > record.size() / (sizeof(std::uint64_t) + 1))
+    {
+        return false;
+    }
+    verdict.postconditions = counts[0];
+    verdict.satisfied = counts[1];
+    verdict.verdicts.resize(counts[2]);
+    for (auto& postcondition : verdict.verdicts)
+    {
+        std::uint64_t location = 0;
+        std::uint8_t satisfied = 0;
+        if (!get(&location, sizeof(location)) || !get(&satisfied, sizeof(satisfied)))
+        {
+            return false;
+        }
+        postcondition = {location, satisfied != 0};
+    }
+    return get_string(verdict.results) && record.empty();
+}
+
+/**
+ * @brief Settings of the analyses of a shard, sent by the coordinator with the shard so that every worker
+ * analyzes its files as the coordinator would
+ *
+ */
+struct ShardSettings {
+    // Version of the protocol, with the size of the statistics, checked by the workers
+    static constexpr std::uint32_t PROTOCOL = 1;
+
+    SolverMode solver_mode = SolverMode::WORKLIST;
+    AnalysisBudget budget;
+    std::optional<ResultFormat> results;
+};
+
+/**
+ * @brief Opens a TCP connection to an endpoint
+ *
+ * @param endpoint
+ * @return int the socket, negative if the connection failed
+ */
+inline int connect_batch_endpoint(const BatchEndpoint& endpoint)
+{
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    if (::getaddrinfo(endpoint.host.c_str(), endpoint.port.c_str(), &hints, &addresses) != 0)
+    {
+        return -1;
+    }
+    int fd = -1;
+    for (auto* address = addresses; address != nullptr && fd < 0; address = address->ai_next)
+    {
+        fd = ::socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (fd >= 0 && ::connect(fd, address->ai_addr, address->ai_addrlen) != 0)
+        {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+    ::freeaddrinfo(addresses);
+    if (fd >= 0)
+    {
+        // A worker whose machine goes down is then noticed instead of being waited for forever
+        int on = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &on, sizeof(on));
+    }
+    return fd;
+}
+
+/**
+ * @brief Worker of a distributed batch: analyzes the shards that coordinators send over TCP with a pool of
+ * workers, and streams back the verdict of every file as soon as it is completed.
+ *
+ * A connection carries any number of shards, one at a time. A shard is a line
+ * `shard PROTOCOL STATISTICS_SIZE SOLVER TIME_MS ITERATIONS MEMORY_MB RESULTS COUNT`, RESULTS being `none`,
+ * `ndjson` or `binary`, followed by the COUNT paths of its files, one per line, which the worker opens in its
+ * own file system. Every file is answered by a line `file POSITION SIZE`, POSITION being its position in the
+ * shard, followed by SIZE bytes of its verdict (see encode_file_verdict), and the shard by a line `done`. A
+ * file that cannot be read, parsed or analyzed is answered by its verdict too, whose error tells why, and a
+ * shard the worker cannot analyze at all by a line `error MESSAGE`. `quit` ends the connection, and
+ * `shutdown` also stops the worker.
+ *
+ */
+class BatchWorker
+{
+private:
+    WorkStealingPool m_pool;
+    std::optional<ResultCache<int64_t>> m_cache;
+
+public:
+    /**
+     * @brief Creates a worker
+     *
+     * @param jobs number of workers of its pool
+     * @param cache_path if not empty, directory of the ResultCache of the worker
+     */
+    BatchWorker(std::size_t jobs, const std::string& cache_path)
+    : m_pool(jobs)
+    {
+        if (!cache_path.empty())
+        {
+            m_cache.emplace(cache_path);
+        }
+    }
+
+    /**
+     * @brief Serves the shards of a connection until it ends
+     *
+     * @param connection
+     * @return true if the worker was asked to shut down
+     */
+    bool serve(FramedConnection& connection)
+    {
+        std::string line;
+        while (connection.read_line(line))
+        {
+            if (line == "quit")
+            {
+                return false;
+            }
+            if (line == "shutdown")
+            {
+                return true;
+            }
+
+            std::istringstream request(line);
+            std::string command, results;
+            std::uint32_t protocol = 0;
+            std::size_t statistics_size = 0, count = 0;
+            int solver = 0;
+            ShardSettings settings;
+            request >> command >> protocol >> statistics_size >> solver >> settings.budget.time_ms >> settings.budget.iterations
+                    >> settings.budget.memory_mb >> results >> count;
+            ResultFormat format{};
+            if (command != "shard" || request.fail() || solver < 0 || solver > static_cast<int>(SolverMode::PARALLEL)
+                || (results != "none" && !parse_result_format(results, format)))
+            {
+                // The number of paths is unknown: the rest of the connection cannot be read
+                connection.write("error malformed request\n");
+                return false;
+            }
+            std::vector<std::string> paths(count);
+            for (auto& path : paths)
+            {
+                if (!connection.read_line(path))
+                {
+                    return false;
+                }
+            }
+            if (protocol != ShardSettings::PROTOCOL || statistics_size != sizeof(AnalysisStatistics))
+            {
+                if (!connection.write("error the coordinator runs another version\n"))
+                {
+                    return false;
+                }
+                continue;
+            }
+            settings.solver_mode = static_cast<SolverMode>(solver);
+            if (results != "none")
+            {
+                settings.results = format;
+            }
+            if (!analyze(connection, paths, settings) || !connection.write("done\n"))
+            {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Serves the connections to a TCP port until one of them asks to shut down
+     *
+     * @param endpoint address and port to listen on, the host `*` for all the addresses
+     * @return int the exit code of the process
+     */
+    int serve_port(const BatchEndpoint& endpoint)
+    {
+        Logger::set_level(LogLevel::QUIET);
+        // A coordinator that disconnects before its answer must not stop the worker
+        std::signal(SIGPIPE, SIG_IGN);
+
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_PASSIVE;
+        addrinfo* addresses = nullptr;
+        int status = ::getaddrinfo(endpoint.host == "*" ? nullptr : endpoint.host.c_str(), endpoint.port.c_str(), &hints, &addresses);
+        if (status != 0)
+        {
+            std::cerr << "[ERROR] cannot resolve `" << endpoint.name() << "`: " << ::gai_strerror(status) << "." << std::endl;
+            return 1;
+        }
+        int listener = ::socket(addresses->ai_family, addresses->ai_socktype, addresses->ai_protocol);
+        int on = 1;
+        if (listener >= 0)
+        {
+            ::setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        }
+        bool listening = listener >= 0 && ::bind(listener, addresses->ai_addr, addresses->ai_addrlen) == 0 && ::listen(listener, 16) == 0;
+        ::freeaddrinfo(addresses);
+        if (!listening)
+        {
+            std::cerr << "[ERROR] cannot listen on `" << endpoint.name() << "`: " << std::strerror(errno) << "." << std::endl;
+            if (listener >= 0)
+            {
+                ::close(listener);
+            }
+            return 1;
+        }
+
+        bool shutdown = false;
+        while (!shutdown)
+        {
+            int client = ::accept(listener, nullptr, nullptr);
+            if (client < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                std::cerr << "[ERROR] cannot accept a connection: " << std::strerror(errno) << "." << std::endl;
+                break;
+            }
+            FramedConnection connection(client, client);
+            shutdown = serve(connection);
+            ::close(client);
+        }
+        ::close(listener);
+        return shutdown ? 0 : 1;
+    }
+
+private:
+    /**
+     * @brief Analyzes the files of a shard, longest job first (see run_batch_longest_first), writing every
+     * verdict once completed. The batch stages catch the AnalysisError of a file, which is then sent as a
+     * verdict with its error.
+     *
+     * @return false if the connection was lost, the remaining files are then skipped
+     */
+    bool analyze(FramedConnection& connection, const std::vector<std::string>& paths, const ShardSettings& settings)
+    {
+        std::mutex mutex;
+        bool connected = true;
+        run_batch_longest_first(m_pool, paths, settings.solver_mode, m_cache ? &*m_cache : nullptr, settings.budget, settings.results,
+                                [&](BatchJob& job) {
+            auto record = encode_file_verdict(job.verdict);
+            std::lock_guard<std::mutex> lock(mutex);
+            connected = connected && connection.write("file " + std::to_string(job.index) + " " + std::to_string(record.size()) + "\n" + record);
+            return connected;
+        });
+        return connected;
+    }
+};
+
+/**
+ * @brief Analyzes a list of files on workers running on other machines (see BatchWorker). The files are
+ * split into shards of about the same estimated cost (see estimate_batch_cost and shard_batch), which are
+ * handed to the workers as they become free, one connection per endpoint. A worker that cannot be reached,
+ * or that fails or disconnects before answering a shard, is not used anymore, and the shard is given to the
+ * next free worker, at most retries more times, after which its files are reported as errors. The report is
+ * that of run_batch, in the order of the list whatever the shards, followed by a line on the shards.
+ *
+ * @param paths
+ * @param endpoints
+ * @param shards number of shards, 0 for 4 per endpoint
+ * @param retries
+ * @param settings
+ * @param jobs threads that read the files to estimate their cost
+ * @param metrics_path
+ * @param results_path
+ * @param results_format
+ * @return int 0 if every postcondition of every file is satisfied, 1 otherwise
+ */
+inline int run_distributed_batch(const std::vector<std::string>& paths, const std::vector<BatchEndpoint>& endpoints, std::size_t shards,
+                                 std::size_t retries, ShardSettings settings, std::size_t jobs, const std::string& metrics_path = "",
+                                 const std::string& results_path = "", ResultFormat results_format = ResultFormat::NDJSON)
+{
+    Logger::set_level(LogLevel::QUIET);
+    std::signal(SIGPIPE, SIG_IGN);
+    BatchReport report(paths, results_path, results_format);
+    settings.results = report.encoding();
+
+    std::vector<std::uint64_t> costs(paths.size(), 1);
+    {
+        WorkStealingPool pool(jobs);
+        pool.run(paths.size(), [&](std::size_t index) {
+            SourceFile source(paths[index]);
+            if (source.is_open())
+            {
+                costs[index] = estimate_batch_cost(source.text());
+            }
+        });
+    }
+    auto files = shard_batch(costs, shards == 0 ? 4 * endpoints.size() : shards);
+
+    std::string header = "shard " + std::to_string(ShardSettings::PROTOCOL) + " " + std::to_string(sizeof(AnalysisStatistics)) + " "
+                       + std::to_string(static_cast<int>(settings.solver_mode)) + " " + std::to_string(settings.budget.time_ms) + " "
+                       + std::to_string(settings.budget.iterations) + " " + std::to_string(settings.budget.memory_mb) + " "
+                       + (!settings.results ? "none" : *settings.results == ResultFormat::BINARY ? "binary" : "ndjson") + " ";
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    // The shards are handed out from the most expensive, as the files of every shard
+    std::vector<std::uint64_t> totals(files.size(), 0);
+    std::deque<std::size_t> pending;
+    for (std::size_t shard = 0; shard < files.size(); ++shard)
+    {
+        for (auto index : files[shard])
+        {
+            totals[shard] += costs[index];
+        }
+        pending.push_back(shard);
+    }
+    std::stable_sort(pending.begin(), pending.end(), [&totals](std::size_t a, std::size_t b) { return totals[a] > totals[b]; });
+    std::vector<std::size_t> attempts(files.size(), 0);
+    std::size_t remaining = files.size();
+    std::size_t live = endpoints.size();
+    std::size_t retried = 0, failed = 0;
+
+    // Called with the mutex held
+    auto fail_shard = [&](std::size_t shard, const std::string& error) {
+        for (auto index : files[shard])
+        {
+            FileVerdict verdict;
+            verdict.path = paths[index];
+            fail_batch_file(verdict, error.c_str(), settings.results);
+            report.complete(index, std::move(verdict));
+        }
+        failed++;
+        remaining--;
+    };
+    auto retire = [&](const BatchEndpoint& endpoint, const std::string& reason) {
+        std::cerr << "[ERROR] worker `" << endpoint.name() << "` " << reason << "." << std::endl;
+        if (--live == 0)
+        {
+            while (!pending.empty())
+            {
+                fail_shard(pending.front(), "no worker left");
+                pending.pop_front();
+            }
+        }
+        changed.notify_all();
+    };
+
+    auto run_endpoint = [&](const BatchEndpoint& endpoint) {
+        int fd = -1;
+        std::optional<FramedConnection> connection;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+            changed.wait(lock, [&]() { return !pending.empty() || remaining == 0; });
+            if (remaining == 0)
+            {
+                break;
+            }
+            auto shard = pending.front();
+            pending.pop_front();
+            lock.unlock();
+
+            if (fd < 0)
+            {
+                fd = connect_batch_endpoint(endpoint);
+                if (fd < 0)
+                {
+                    lock.lock();
+                    pending.push_front(shard);
+                    retire(endpoint, "cannot be reached");
+                    return;
+                }
+                connection.emplace(fd, fd);
+            }
+            std::string request = header + std::to_string(files[shard].size()) + "\n";
+            for (auto index : files[shard])
+            {
+                request += paths[index] + "\n";
+            }
+
+            // The verdicts are only reported once the whole shard is answered, so that a retry reports none twice
+            std::vector<FileVerdict> verdicts(files[shard].size());
+            std::size_t answered = 0;
+            std::string error = "disconnected";
+            bool done = false;
+            std::string line, record;
+            if (connection->write(request))
+            {
+                while (connection->read_line(line))
+                {
+                    std::istringstream answer(line);
+                    std::string command;
+                    std::size_t position = 0, size = 0;
+                    answer >> command;
+                    if (command == "done")
+                    {
+                        done = answered == verdicts.size();
+                        error = "answered a shard partly";
+                        break;
+                    }
+                    if (command == "error")
+                    {
+                        error = "answered `" + line.substr(std::min<std::size_t>(line.size(), 6)) + "`";
+                        break;
+                    }
+                    answer >> position >> size;
+                    if (command != "file" || answer.fail() || position >= verdicts.size())
+                    {
+                        error = "sent a malformed answer";
+                        break;
+                    }
+                    if (!connection->read_block(size, record))
+                    {
+                        break;
+                    }
+                    if (!decode_file_verdict(record, verdicts[position]))
+                    {
+                        error = "sent a malformed answer";
+                        break;
+                    }
+                    answered++;
+                }
+            }
+
+            lock.lock();
+            if (done)
+            {
+                for (std::size_t position = 0; position < verdicts.size(); ++position)
+                {
+                    auto index = files[shard][position];
+                    verdicts[position].path = paths[index];
+                    report.complete(index, std::move(verdicts[position]));
+                }
+                if (--remaining == 0)
+                {
+                    changed.notify_all();
+                }
+                continue;
+            }
+            ::close(fd);
+            if (++attempts[shard] > retries)
+            {
+                fail_shard(shard, "shard failed on " + std::to_string(attempts[shard]) + " workers");
+            }
+            else
+            {
+                retried++;
+                pending.push_back(shard);
+            }
+            // The shard may be what crashes the worker, but a worker that fails once is likely to fail again
+            retire(endpoint, error + " on shard " + std::to_string(shard) + ", it is not used anymore");
+            return;
+        }
+        lock.unlock();
+        if (fd >= 0)
+        {
+            connection->write("quit\n");
+            ::close(fd);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (const auto& endpoint : endpoints)
+    {
+        threads.emplace_back(run_endpoint, std::cref(endpoint));
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    report.text() << "Distributed " << files.size() << " shards over " << endpoints.size() << " workers: " << retried << " retried, "
+                  << failed << " failed" << std::endl;
+    return report.finish(metrics_path, endpoints.size());
+}
+
+#endif // DISTRIBUTED_BATCH_HPP
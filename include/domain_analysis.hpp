@@ -0,0 +1,323 @@
+#ifndef DOMAIN_ANALYSIS_HPP
+#define DOMAIN_ANALYSIS_HPP
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "abstract_domain.hpp"
+#include "flat_ast.hpp"
+
+/**
+ * @brief Structured analysis of a program in an AbstractDomain, used to discharge postconditions before
+ * the interval analysis. It goes through the statements once, in program order, with the abstract value of
+ * every variable: the branches of an if-else statement are joined, and a loop head is iterated until it is
+ * stable, widening it after WIDENING_DELAY iterations.
+ *
+ * A postcondition is discharged when its comparison holds for every pair of values of its operands, every
+ * time it is reached, including at the fixpoint of its loops. Postconditions that are never reached, with
+ * a bottom operand, are not discharged.
+ *
+ * @tparam D
+ */
+template <AbstractDomain D>
+class DomainAnalysis
+{
+private:
+    using Value = typename D::Value;
+    using Bound = typename D::Bound;
+    using State = std::vector<Value>;       // by symbol of the AST
+
+    static constexpr std::size_t WIDENING_DELAY = 3;
+
+    const FlatAST& m_ast;
+    std::vector<std::uint8_t> m_checks;     // by node: 0 not reached, 1 held every time, 2 failed once
+    std::size_t m_discharged = 0;
+
+public:
+    explicit DomainAnalysis(const FlatAST& ast)
+    : m_ast(ast)
+    , m_checks(ast.size(), 0)
+    {}
+
+    /**
+     * @brief Analyzes the program
+     *
+     * @return std::vector<bool> the discharged postconditions, by node of the AST
+     */
+    std::vector<bool> run()
+    {
+        std::vector<bool> discharged(m_ast.size(), false);
+        if (m_ast.size() == 0)
+        {
+            return discharged;
+        }
+        for (auto block : m_ast.root().children())
+        {
+            if (block.type() == NodeType::SEQUENCE)
+            {
+                auto sequence = block.children();
+                auto [state, first] = preconditions(sequence);
+                for (std::size_t statement = first; statement < sequence.size(); ++statement)
+                {
+                    state = this->statement(sequence[statement], std::move(state));
+                }
+                break;
+            }
+        }
+        for (std::size_t node = 0; node < m_checks.size(); ++node)
+        {
+            if (m_checks[node] == 1)
+            {
+                discharged[node] = true;
+                m_discharged++;
+            }
+        }
+        return discharged;
+    }
+
+    std::size_t discharged() const
+    {
+        return m_discharged;
+    }
+
+private:
+    // The statements of the body of an if-else or while statement, given its If-Body, Else-Body or While-Body node
+    static FlatAST::Children body_statements(FlatAST::Node part)
+    {
+        auto block = part.child(0);
+        return block.type() == NodeType::SEQUENCE ? block.children() : part.children();
+    }
+
+    State statements(FlatAST::Children statements, State state)
+    {
+        for (auto statement : statements)
+        {
+            state = this->statement(statement, std::move(state));
+        }
+        return state;
+    }
+
+    State statement(FlatAST::Node statement, State state)
+    {
+        switch (statement.type())
+        {
+            case NodeType::ASSIGNMENT:
+            {
+                auto value = evaluate(statement.child(1), state);
+                state[statement.child(0).symbol()] = value;
+                return state;
+            }
+            case NodeType::POST_CON:
+            {
+                check(statement, state);
+                return state;
+            }
+            case NodeType::IFELSE:
+            {
+                auto condition = statement.child(0).child(0);
+                auto if_state = statements(body_statements(statement.child(1)), guard(condition, state, false));
+                auto else_state = guard(condition, std::move(state), true);
+                if (statement.size() == 3)
+                {
+                    else_state = statements(body_statements(statement.child(2)), std::move(else_state));
+                }
+                return join(if_state, else_state);
+            }
+            case NodeType::WHILELOOP:
+            {
+                auto condition = statement.child(0).child(0);
+                auto head = state;
+                for (std::size_t iteration = 0;; ++iteration)
+                {
+                    auto body = statements(body_statements(statement.child(1)), guard(condition, head, false));
+                    auto next = join(state, body);
+                    if (leq(next, head))
+                    {
+                        break;
+                    }
+                    head = iteration < WIDENING_DELAY ? std::move(next) : widen(head, next);
+                }
+                return guard(condition, std::move(head), true);
+            }
+            default:
+            {
+                return state;
+            }
+        }
+    }
+
+    Value evaluate(FlatAST::Node expression, const State& state) const
+    {
+        switch (expression.type())
+        {
+            case NodeType::INTEGER:
+            {
+                auto value = static_cast<Bound>(expression.integer());
+                return D::abstract(value, value);
+            }
+            case NodeType::VARIABLE:
+            {
+                return state[expression.symbol()];
+            }
+            case NodeType::ARITHM_OP:
+            {
+                auto op = arithmetic_op(expression);
+                if (!op.has_value() || expression.size() != 2)
+                {
+                    return D::top();
+                }
+                return D::arithmetic(*op, evaluate(expression.child(0), state), evaluate(expression.child(1), state));
+            }
+            default:
+            {
+                return D::top();
+            }
+        }
+    }
+
+    // Restricts the variable of a condition `variable op expression`, or of its negation
+    State guard(FlatAST::Node condition, State state, bool negated) const
+    {
+        if (condition.kind() != FlatAST::ValueKind::LOGIC_OP || condition.child(0).type() != NodeType::VARIABLE)
+        {
+            return state;
+        }
+        auto op = negated ? complement(condition.logic_op()) : condition.logic_op();
+        auto variable = condition.child(0).symbol();
+        state[variable] = D::filter(op, state[variable], evaluate(condition.child(1), state));
+        return state;
+    }
+
+    /**
+     * @brief Entry state of the program, from the preconditions that lead its sequence of statements. As in
+     * the interval analysis, a precondition `x <= c` or `c >= x` sets the upper bound of x, and `x >= c` or
+     * `c <= x` its lower bound.
+     *
+     * @param sequence
+     * @return the state and the index of the first statement after the preconditions
+     */
+    std::pair<State, std::size_t> preconditions(FlatAST::Children sequence) const
+    {
+        constexpr auto min = std::numeric_limits<Bound>::min();
+        constexpr auto max = std::numeric_limits<Bound>::max();
+        std::vector<std::pair<Bound, Bound>> bounds(m_ast.symbols().size(), {min, max});
+        std::vector<bool> bounded(bounds.size(), false);
+        std::size_t statement = 0;
+        for (; statement < sequence.size() && sequence[statement].type() == NodeType::PRE_CON; ++statement)
+        {
+            for (auto precondition : sequence[statement].children())
+            {
+                auto left = precondition.child(0);
+                auto right = precondition.child(1);
+                bool variable_on_left = left.type() == NodeType::VARIABLE;
+                auto variable = variable_on_left ? left : right;
+                auto constant = variable_on_left ? right : left;
+                const auto& op = precondition.text();
+                if (variable.type() != NodeType::VARIABLE || constant.type() != NodeType::INTEGER
+                    || (op != "<=" && op != ">="))
+                {
+                    continue;
+                }
+                auto value = static_cast<Bound>(constant.integer());
+                auto& [lb, ub] = bounds[variable.symbol()];
+                ((op == "<=") == variable_on_left ? ub : lb) = value;
+                bounded[variable.symbol()] = true;
+            }
+        }
+        State state(bounds.size(), D::top());
+        for (std::size_t symbol = 0; symbol < bounds.size(); ++symbol)
+        {
+            if (bounded[symbol])
+            {
+                state[symbol] = D::abstract(bounds[symbol].first, bounds[symbol].second);
+            }
+        }
+        return {std::move(state), statement};
+    }
+
+    void check(FlatAST::Node postcondition, const State& state)
+    {
+        auto comparison = postcondition.child(0);
+        auto& check = m_checks[postcondition.index()];
+        if (comparison.kind() != FlatAST::ValueKind::LOGIC_OP)
+        {
+            check = 2;
+            return;
+        }
+        auto left = evaluate(comparison.child(0), state);
+        auto right = evaluate(comparison.child(1), state);
+        check = D::holds(comparison.logic_op(), left, right) && check != 2 ? 1 : 2;
+    }
+
+    static State join(const State& a, const State& b)
+    {
+        State joined(a.size());
+        for (std::size_t symbol = 0; symbol < a.size(); ++symbol)
+        {
+            joined[symbol] = D::join(a[symbol], b[symbol]);
+        }
+        return joined;
+    }
+
+    static State widen(const State& a, const State& b)
+    {
+        State widened(a.size());
+        for (std::size_t symbol = 0; symbol < a.size(); ++symbol)
+        {
+            widened[symbol] = D::widen(a[symbol], b[symbol]);
+        }
+        return widened;
+    }
+
+    static bool leq(const State& a, const State& b)
+    {
+        for (std::size_t symbol = 0; symbol < a.size(); ++symbol)
+        {
+            if (!D::leq(a[symbol], b[symbol]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static LogicOp complement(LogicOp op)
+    {
+        switch (op)
+        {
+            case LogicOp::LE: return LogicOp::GEQ;
+            case LogicOp::LEQ: return LogicOp::GE;
+            case LogicOp::GE: return LogicOp::LEQ;
+            case LogicOp::GEQ: return LogicOp::LE;
+            case LogicOp::EQ: return LogicOp::NEQ;
+            case LogicOp::NEQ: return LogicOp::EQ;
+        }
+        return op;
+    }
+
+    /**
+     * @brief Operator of an arithmetic node, whether the parser wrote it as a BinOp or as text
+     *
+     */
+    static std::optional<BinOp> arithmetic_op(FlatAST::Node node)
+    {
+        if (node.kind() == FlatAST::ValueKind::BIN_OP)
+        {
+            return node.bin_op();
+        }
+        if (node.kind() == FlatAST::ValueKind::TEXT)
+        {
+            const auto& op = node.text();
+            if (op == "+") return BinOp::ADD;
+            if (op == "-") return BinOp::SUB;
+            if (op == "*") return BinOp::MUL;
+            if (op == "/") return BinOp::DIV;
+        }
+        return std::nullopt;
+    }
+};
+
+#endif // DOMAIN_ANALYSIS_HPP
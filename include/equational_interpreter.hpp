@@ -3,20 +3,155 @@
 
 #include <limits>
 #include <concepts>
+#include <algorithm>
 #include <map>
 #include <list>
 #include <memory>
 #include <queue>
-
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <stop_token>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "analysis_error.hpp"
+#include "ast_simplifier.hpp"
+#include "control_flow_graph.hpp"
+#include "cost_estimator.hpp"
+#include "diagnostics.hpp"
+#include "fixpoint_checkpoint.hpp"
+#include "fixpoint_trace.hpp"
+#include "function_summaries.hpp"
+#include "domain_analysis.hpp"
+#include "octagon_domain.hpp"
+#include "packed_domain_analysis.hpp"
+#include "program_slicer.hpp"
 #include "location_base.hpp"
+#include "logger.hpp"
+#include "location_profiler.hpp"
+#include "perf_counters.hpp"
+#include "precondition_sweep.hpp"
+#include "store_pool.hpp"
+#include "thread_pool.hpp"
+
+/**
+ * @brief Strategy used to iterate the equational system until the fixpoint is reached
+ * 
+ */
+enum class SolverMode {
+    JACOBI,     // every location is evaluated on every sweep (reference implementation)
+    WORKLIST,   // a location is evaluated only when one of the stores it reads has changed
+    WTO,        // recursive iteration over a weak topological order: inner loops are stabilized first
+    PARALLEL    // Jacobi sweeps whose independent regions are evaluated by a pool of threads
+};
+
+/**
+ * @brief Phase of the fixpoint computation: loop heads are widened while ascending, and narrowed afterwards
+ * 
+ */
+enum class IterationPhase {
+    ASCENDING,
+    NARROWING
+};
+
+/**
+ * @brief Limits of an analysis, zero meaning no limit. Once a limit is exceeded, every loop head widens the
+ * bounds that still move to the ends of the range of the type at its next evaluation, without waiting for
+ * the widening delay, so the ascending iteration ends within a few evaluations of every loop, with
+ * invariants that are still sound but coarser. Out of time or memory, the loop heads are not narrowed.
+ * 
+ */
+struct AnalysisBudget {
+    double time_ms = 0;             // wall time since the start of the analysis
+    std::size_t iterations = 0;     // ascending evaluations of a single loop head
+    std::size_t memory_mb = 0;      // store pages allocated or copied on write by the analysis
+};
 
-enum LocationType {
-    ASSIGNMENT,
-    POSTCONDITION,
-    IFELSE,
-    ENDIF,
-    WHILE,
-    ENDWHILE
+enum class BudgetExceeded : std::uint8_t {
+    NONE,
+    TIME,
+    ITERATIONS,
+    MEMORY
+};
+
+inline const char* budget_name(BudgetExceeded budget)
+{
+    switch (budget)
+    {
+        case BudgetExceeded::NONE: return "none";
+        case BudgetExceeded::TIME: return "time";
+        case BudgetExceeded::ITERATIONS: return "iterations";
+        case BudgetExceeded::MEMORY: return "memory";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief Measurements of the last analysis performed by an EquationalInterpreter
+ * 
+ */
+struct AnalysisStatistics {
+    std::size_t locations = 0;
+    std::size_t iterations = 0;
+    std::size_t ascending_iterations = 0;
+    std::size_t narrowing_iterations = 0;
+    std::size_t location_evaluations = 0;
+    std::size_t reused_locations = 0;   // taken from a previous analysis without being evaluated
+    std::size_t simplifications = 0;    // rewrites of the expressions of the AST
+    std::size_t sliced_statements = 0;  // statements removed by the slice of the postconditions
+    std::size_t accelerated_loops = 0;  // loops whose head is computed in closed form
+    std::size_t discharged_postconditions = 0;  // proved by the prefilter, before the interval analysis
+    std::size_t function_summaries = 0; // analyses of a function body, one per distinct tuple of arguments
+    std::size_t summary_reuses = 0;     // calls whose summary was already computed
+    std::size_t shared_subterms = 0;    // subterms occurring more than once in the expressions
+    std::size_t subterm_reuses = 0;     // evaluations of a shared subterm that reused its last value
+    std::size_t diagnostics = 0;        // distinct overflows and divisions by zero, by location
+    std::uint64_t estimated_evaluations = 0;    // predicted from the AST, see AnalysisCostEstimator
+    bool cached = false;                // the result was read from a ResultCache instead of being computed
+    BudgetExceeded budget_exceeded = BudgetExceeded::NONE;  // first budget exceeded, if any
+    std::array<std::size_t, LOCATION_TYPES> evaluations_by_type{};
+
+    std::size_t widenings = 0;
+    std::size_t narrowings = 0;
+
+    std::size_t stores_allocated = 0;   // canonical stores created by the pool
+    std::size_t page_allocations = 0;
+    std::size_t page_copies = 0;        // copy-on-write duplications of a page
+    std::size_t bytes_copied = 0;
+
+    double parse_ms = 0;                // zero when the interpreter is built from an AST
+    double build_ms = 0;
+    double solve_ms = 0;
+    double stability_ms = 0;            // time spent in the stability checks of the Jacobi sweeps
+    double postconditions_ms = 0;
+
+    AnalysisCounters counters;          // by phase, with PerfCounters enabled
+};
+
+/**
+ * @brief Progress of a solve, reported at the end of every iteration of the solver (see
+ * EquationalInterpreter::set_progress): a sweep of the Jacobi and parallel solvers, a pass of the worklist
+ * in program order, or an iteration of an outermost loop of the WTO solver
+ *
+ */
+struct AnalysisProgress {
+    IterationPhase phase;
+    std::size_t iteration;      // in the phase, from 1
+    std::size_t unstable;       // locations that changed in the iteration, or that wait to be evaluated
+    std::size_t evaluations;    // location evaluations since the start of the solve
+};
+
+/**
+ * @brief Outcome of the evaluation of a postcondition once the fixpoint is reached
+ * 
+ */
+struct PostconditionVerdict {
+    std::size_t location;
+    bool satisfied;
+    bool decided = true;    // false if an anytime analysis stopped before its stores were stable
 };
 
 /**
@@ -42,149 +177,2509 @@ private:
     const T min_T = std::numeric_limits<T>::min();
     const T max_T = std::numeric_limits<T>::max();
 
-    ASTNode m_ast;
+    FlatAST m_ast;
 
-    IntervalStore<T> m_precondition_store;
+    // Interning table shared by all the stores of the analysis
+    std::shared_ptr<VariableTable> m_variable_table = std::make_shared<VariableTable>();
+    IntervalStore<T> m_precondition_store{m_variable_table};
+
+    // Hash-consing table of the stores produced by the locations
+    StorePool<T> m_store_pool;
 
     std::vector<std::unique_ptr<Location<T>>> m_locations;
-    std::vector<std::unique_ptr<Location<T>>> m_old_locations;
     std::list<std::string> m_variables;
     size_t m_location_counter = 0;
-    std::shared_ptr<IntervalStore<T>> last_interval_store;
-    std::shared_ptr<IntervalStore<T>> last_added_store;
-    std::queue<std::shared_ptr<IntervalStore<T>>> m_if_body_stores_queue;
-    std::queue<std::shared_ptr<IntervalStore<T>>> m_else_body_stores_queue;
 
-    std::queue<std::shared_ptr<IntervalStore<T>>> m_final_if_body_stores_queue;
-    std::queue<std::shared_ptr<IntervalStore<T>>> m_final_else_body_stores_queue;
+    bool should_evaluate_postcondition = false;
 
-    std::queue<std::shared_ptr<IntervalStore<T>>> m_while_body_stores_queue;
-    std::queue<std::shared_ptr<IntervalStore<T>>> m_while_exit_stores_queue;
-    std::queue<std::shared_ptr<IntervalStore<T>>> m_final_while_body_stores_queue;
+    SolverMode m_solver_mode = SolverMode::WORKLIST;
+
+    // Widening starts after m_widening_delay evaluations of a loop head, and jumps to the next threshold;
+    // then every loop head is narrowed at most m_narrowing_passes times
+    IterationPhase m_phase = IterationPhase::ASCENDING;
+    std::size_t m_widening_delay = DEFAULT_WIDENING_DELAY;
+    std::size_t m_narrowing_passes = DEFAULT_NARROWING_PASSES;
+    std::vector<T> m_thresholds;
+
+    // In sparse mode, loop bodies and the ends of if-else statements only see the changes of the variables
+    // of their statement (see set_sparse)
+    bool m_sparse = false;
+
+    // The fixpoint is computed on the slice of the program that the postconditions depend on (see set_slice)
+    bool m_slice = false;
+
+    // The postconditions are first checked in the constant, sign and octagon domains (see set_prefilter)
+    bool m_prefilter = false;
+    std::vector<bool> m_discharged;     // by node of m_ast
+
+    // Functions of the program, shared with the interpreters that compute their summaries (see summarize).
+    // Such an interpreter starts from the arguments of the call and prints nothing.
+    std::shared_ptr<FunctionTable<T>> m_functions;
+    std::vector<std::pair<std::string, Interval<T>>> m_arguments;
+    bool m_summary = false;
+
+    // Configurations of a sweep, analyzed together as lanes of the stores (see set_sweep). Lane k holds the
+    // variables of the program from the id k * m_lane_width on.
+    std::vector<PreconditionSet<T>> m_sweep;
+    std::size_t m_lanes = 1;
+    std::size_t m_lane_width = 0;
+    std::vector<std::vector<T>> m_lane_thresholds;
+    std::vector<std::vector<PostconditionVerdict>> m_lane_verdicts;
+
+    // Threads of the parallel solver, and its schedule during a solve (see solve_parallel)
+    struct ParallelSweeps;
+    std::size_t m_solver_threads = 1;
+    std::unique_ptr<ParallelSweeps> m_parallel;
+
+    // Limits of the analysis, checked against the time elapsed since the start of run (see set_budget)
+    AnalysisBudget m_budget;
+    std::chrono::steady_clock::time_point m_run_start;
+
+    // Stops the solve between two evaluations once requested (see set_stop_token), and the progress of
+    // the solve (see set_progress)
+    std::stop_token m_stop_token;
+    bool m_cancelled = false;
+    std::function<void(const AnalysisProgress&)> m_progress;
+
+    // A bound went to the end of the range of T without being read from a store (see saturated)
+    bool m_saturated = false;
+
+    // Assignments whose output is only read by the next assignment, which drops it once read, and the
+    // ones whose output was dropped and is replayed when asked for (see set_low_memory)
+    bool m_low_memory = false;
+    std::vector<bool> m_transient;
+    std::vector<bool> m_dropped;
+
+    // Postconditions decided as soon as the stores they read are stable (see set_anytime)
+    struct PostconditionCones;
+    bool m_anytime = false;
+    std::unique_ptr<PostconditionCones> m_cones;
+
+    // Checkpoints of the fixpoint iteration (see set_checkpoint), and the one to resume from (see resume)
+    std::string m_checkpoint_path;
+    double m_checkpoint_interval_ms = 0;
+    std::chrono::steady_clock::time_point m_last_checkpoint;
+    std::size_t m_checkpoints = 0;
+    std::optional<FixpointCheckpoint<T>> m_resumed;
+    std::size_t m_resumed_evaluations = 0;
+
+    // State of the build phase that the solve phase reports on (see build)
+    std::size_t m_pool_lookups = 0;
+    std::size_t m_pool_hits = 0;
+    typename IntervalStore<T>::Counters m_build_counters;
+
+    // Overflows and divisions by zero of the evaluations, collected when printed or requested (see set_diagnostics)
+    bool m_collect_diagnostics = false;
+    std::unique_ptr<DiagnosticCollector> m_diagnostics;
+
+    // Subterms shared by the expressions of the locations, except in parallel sweeps (see share_subterms)
+    std::unique_ptr<SharedSubterms<T>> m_shared_subterms;
+
+    // Binary trace of the evaluations, written during a solve when a path is set (see set_trace_path)
+    std::string m_trace_path;
+    std::unique_ptr<FixpointTraceWriter<T>> m_trace;
+
+    // Time and evaluations of every location during the solve, when profiling (see set_profile)
+    bool m_profile = false;
+    std::unique_ptr<LocationProfiler> m_profiler;
+
+    // Edges between the locations, built together with the locations themselves
+    ControlFlowGraph m_cfg;
+
+    // If-else or while location of the statement that encloses every location, and the ones being built
+    std::vector<std::size_t> m_location_parents;
+    std::vector<std::size_t> m_enclosing;
+
+    // Store that flows into the next location constructed by manage_block
+    std::size_t m_current_source = StoreDependency::ENTRY_LOCATION;
+    StorePort m_current_port = StorePort::LAST;
+
+    std::size_t m_location_evaluations = 0;
+    AnalysisStatistics m_statistics;
+    std::vector<PostconditionVerdict> m_verdicts;
+
+    // Top-level statements of the program, recorded by the build so that a later analysis of a new version
+    // of the program can reuse the fixpoint of the statements that did not change
+    struct StatementExtent {
+        std::uint64_t hash;
+        std::size_t locations;  // locations built up to this statement included
+        std::size_t variables;  // variables interned up to this statement included
+    };
+    std::uint64_t m_header_hash = 0;    // declarations and preconditions
+    std::vector<StatementExtent> m_statements;
 
-    bool should_evaluate_postcondition = false;
-    bool should_perform_widening = false;
+    // Analysis whose fixpoint is reused by the next run, and number of leading locations taken from it
+    std::unique_ptr<EquationalInterpreter<T>> m_previous;
+    std::size_t m_reused_locations = 0;
 public:
+    static constexpr std::size_t DEFAULT_WIDENING_DELAY = 4;
+    static constexpr std::size_t DEFAULT_NARROWING_PASSES = 2;
+    static constexpr std::size_t BUDGET_CHECK_PERIOD = 64;
+
     EquationalInterpreter() = default;
     ~EquationalInterpreter() = default;
 
-    EquationalInterpreter(const std::string& input)
+    EquationalInterpreter(std::string_view input)
     : m_locations()
     {
-        AbstractInterpreterParser AIParser;
-        m_ast = AIParser.parse(input);
-        last_interval_store = std::make_shared<IntervalStore<T>>(m_precondition_store); 
-
+        PerfCounters::Measurement measurement(m_statistics.counters, AnalysisPhase::PARSE);
+        auto parse_start = std::chrono::steady_clock::now();
+        m_ast = AbstractInterpreterParser::parse_program(input);
+        auto parse_end = std::chrono::steady_clock::now();
+        measurement.stop();
+        m_statistics.parse_ms = std::chrono::duration<double, std::milli>(parse_end - parse_start).count();
     }
 
-    EquationalInterpreter(const ASTNode ast)
-    : m_ast(ast)
+    EquationalInterpreter(FlatAST ast)
+    : m_ast(std::move(ast))
+    , m_locations()
+    {}
+
+    EquationalInterpreter(const ASTNode& ast)
+    : m_ast(FlatAST::from(ast))
     , m_locations()
     {}
 
     void print()
     {
-        m_ast.print();
+        m_ast.root().print();
+    }
+
+    /**
+     * @brief Selects the strategy used to compute the fixpoint
+     * 
+     * @param mode 
+     */
+    void set_solver_mode(SolverMode mode)
+    {
+        m_solver_mode = mode;
+    }
+
+    SolverMode solver_mode() const
+    {
+        return m_solver_mode;
+    }
+
+    /**
+     * @brief Sets the number of threads of the parallel solver (one by default). The result does not
+     * depend on it.
+     * 
+     * @param threads 
+     */
+    void set_solver_threads(std::size_t threads)
+    {
+        m_solver_threads = threads == 0 ? 1 : threads;
+    }
+
+    std::size_t solver_threads() const
+    {
+        return m_solver_threads;
+    }
+
+    /**
+     * @brief Sets the number of evaluations of a loop head after which its store is widened
+     * 
+     * @param delay 
+     */
+    void set_widening_delay(std::size_t delay)
+    {
+        m_widening_delay = delay;
+    }
+
+    std::size_t widening_delay() const
+    {
+        return m_widening_delay;
+    }
+
+    /**
+     * @brief Sets how many times every loop head is narrowed once the ascending phase is stable
+     * 
+     * @param passes 
+     */
+    void set_narrowing_passes(std::size_t passes)
+    {
+        m_narrowing_passes = passes;
+    }
+
+    std::size_t narrowing_passes() const
+    {
+        return m_narrowing_passes;
+    }
+
+    /**
+     * @brief Enables the sparse mode, in which the changes of a variable are only propagated to the
+     * statements that mention it: a loop head leaves the stores of its body as they are when its entry
+     * changed only on variables that the loop never reads nor writes, and the end of an if-else statement
+     * joins only the variables that its branches or its condition may change. The verdicts and the
+     * invariant at the end of the program stay sound, but the stores inside a loop body are only up to
+     * date for the variables of the loop.
+     * 
+     * @param sparse 
+     */
+    void set_sparse(bool sparse)
+    {
+        m_sparse = sparse;
+    }
+
+    bool sparse() const
+    {
+        return m_sparse;
+    }
+
+    /**
+     * @brief Restricts the analysis to the statements and variables that the postconditions depend on
+     * (see ProgramSlicer). The verdicts stay sound, but the stores only hold for the variables that the
+     * slice reads at each location, so the final invariant is not printed when statements were removed.
+     * Programs without postconditions are analyzed whole.
+     * 
+     * @param slice 
+     */
+    void set_slice(bool slice)
+    {
+        m_slice = slice;
+    }
+
+    bool slice() const
+    {
+        return m_slice;
+    }
+
+    /**
+     * @brief Checks the postconditions in the constant and sign domains (see DomainAnalysis), and in the
+     * octagons of the packs of the program for a signed T (see PackedDomainAnalysis), before the interval
+     * analysis. The postconditions proved there are satisfied, and the interval analysis only computes
+     * what the others depend on, as in set_slice.
+     * 
+     * @param prefilter 
+     */
+    void set_prefilter(bool prefilter)
+    {
+        m_prefilter = prefilter;
+    }
+
+    bool prefilter() const
+    {
+        return m_prefilter;
+    }
+
+    /**
+     * @brief Collects the overflows and divisions by zero of the analysis even when the summary is not
+     * printed, for diagnostics(). The summary prints each of them once, after the fixpoint.
+     * 
+     * @param collect 
+     */
+    void set_diagnostics(bool collect)
+    {
+        m_collect_diagnostics = collect;
+    }
+
+    /**
+     * @brief Distinct diagnostics of the last run, by location, if they were collected
+     * 
+     * @return std::vector<Diagnostic> 
+     */
+    std::vector<Diagnostic> diagnostics() const
+    {
+        return m_diagnostics != nullptr ? m_diagnostics->diagnostics() : std::vector<Diagnostic>{};
+    }
+
+    /**
+     * @brief Sets the limits of the analysis (see AnalysisBudget)
+     * 
+     * @param budget 
+     */
+    void set_budget(const AnalysisBudget& budget)
+    {
+        m_budget = budget;
+    }
+
+    /**
+     * @brief Stops the solve as soon as a stop is requested on the token, which is checked before every
+     * location evaluation. A cancelled solve evaluates neither the postconditions nor the invariant: the
+     * stores are not a fixpoint, and the verdicts are left empty. The function summaries computed on the
+     * way are cancelled with it.
+     * 
+     * @param token 
+     */
+    void set_stop_token(std::stop_token token)
+    {
+        m_stop_token = std::move(token);
+    }
+
+    /**
+     * @brief Tells if the last solve was stopped by its token (see set_stop_token)
+     * 
+     */
+    bool cancelled() const
+    {
+        return m_cancelled;
+    }
+
+    /**
+     * @brief Calls the function at the end of every iteration of the solver, on the thread that drives the
+     * solve (see AnalysisProgress). The function summaries do not report their own iterations.
+     * 
+     * @param progress 
+     */
+    void set_progress(std::function<void(const AnalysisProgress&)> progress)
+    {
+        m_progress = std::move(progress);
+    }
+
+    /**
+     * @brief Decides every postcondition as soon as the locations it transitively reads, its cone, are
+     * stable, and stops the worklist solver once they are all decided. A cone without loop heads is final
+     * once stable in the ascending phase, and any other one once stable in the narrowing phase, so the
+     * verdicts are those of the whole analysis. The locations outside the cones of the undecided
+     * postconditions are not evaluated, so their stores are not invariants. Once a budget is exceeded, the
+     * solver stops instead of widening the loops to the range of the type, and the postconditions that are
+     * not decided yet are reported as such, not satisfied. Only the worklist solver is affected.
+     * 
+     * @param anytime 
+     */
+    void set_anytime(bool anytime)
+    {
+        m_anytime = anytime;
+    }
+
+    bool anytime() const
+    {
+        return m_anytime;
+    }
+
+    /**
+     * @brief Keeps the stores of the analysis only at its cut points: the output of an assignment that is only
+     * read by the next assignment is dropped as soon as that one is evaluated, so that a straight-line block
+     * holds the store at its end instead of one per statement. A store dropped this way is replayed from the
+     * last one kept before it when invariant asks for it, without its diagnostics. An assignment evaluated
+     * again then always counts as changed, which may evaluate the rest of its block again, but never the
+     * loop heads, so the invariants and the verdicts are the same. Only the worklist and WTO solvers, and
+     * the single pass over a program without loops, are affected.
+     * 
+     * @param low_memory 
+     */
+    void set_low_memory(bool low_memory)
+    {
+        m_low_memory = low_memory;
+    }
+
+    bool low_memory() const
+    {
+        return m_low_memory;
+    }
+
+    /**
+     * @brief Makes the solver write the state of the iteration to a file every interval, so that the analysis
+     * can be resumed from it (see resume). The file is written at the points where the solver can stop: by the
+     * worklist between two evaluations, by the Jacobi sweeps after a sweep that was not stable. Nothing is
+     * written once a budget is exceeded, since the loop heads are then widened to the range of the type.
+     * Only the worklist and the sequential Jacobi solvers are supported.
+     * 
+     * @param path 
+     * @param interval_ms 
+     */
+    void set_checkpoint(const std::string& path, double interval_ms)
+    {
+        m_checkpoint_path = path;
+        m_checkpoint_interval_ms = interval_ms;
+    }
+
+    /**
+     * @brief Restores the state of an iteration of the same program, analyzed with the same settings, from
+     * a checkpoint. Called between build and solve, which then continues the iteration: the invariants and
+     * the verdicts are those of an analysis that was not interrupted, and so are the counters of the
+     * statistics, except for the pages, the stores and the diagnostics, which only count the resumed part.
+     * 
+     * @param path 
+     * @return false if the file is not a checkpoint of this analysis
+     */
+    bool resume(const std::string& path)
+    {
+        auto checkpoint = FixpointCheckpoint<T>::read(path);
+        if (!checkpoint || !resumable(*checkpoint))
+        {
+            return false;
+        }
+        std::vector<std::shared_ptr<typename IntervalStore<T>::Page>> pages;
+        pages.reserve(checkpoint->pages.size());
+        for (const auto& page : checkpoint->pages)
+        {
+            pages.push_back(IntervalStore<T>::make_page(page));
+        }
+        std::vector<std::shared_ptr<IntervalStore<T>>> stores;
+        stores.reserve(checkpoint->stores.size());
+        for (const auto& saved : checkpoint->stores)
+        {
+            typename IntervalStore<T>::PageTable store_pages;
+            for (auto page : saved.pages)
+            {
+                store_pages.push_back(pages[page]);
+            }
+            stores.push_back(m_store_pool.intern(IntervalStore<T>(m_variable_table, std::move(store_pages), saved.size)));
+        }
+        auto store = [&stores](std::uint32_t index) {
+            return index == FixpointCheckpointHeader::NO_STORE ? nullptr : stores[index];
+        };
+        for (std::size_t index = 0; index < m_locations.size(); ++index)
+        {
+            auto& location = *m_locations[index];
+            const auto& saved = checkpoint->locations[index];
+            for (std::size_t port = 0; port < STORE_PORTS; ++port)
+            {
+                location.set_output_store(static_cast<StorePort>(port), store(saved.stores[port]));
+            }
+            if (location.type() == LocationType::WHILE)
+            {
+                auto& loop = static_cast<WhileLocation<T>&>(location);
+                loop.m_store_head = store(saved.stores[STORE_PORTS]);
+                loop.m_ascending_steps = saved.ascending_steps;
+                loop.m_narrowing_steps = saved.narrowing_steps;
+            }
+        }
+
+        auto build_ms = m_statistics.build_ms;
+        std::memcpy(&m_statistics, checkpoint->statistics.data(), sizeof(m_statistics));
+        m_statistics.build_ms = build_ms;
+        m_location_evaluations = checkpoint->header.location_evaluations;
+        m_resumed_evaluations = m_location_evaluations;
+        checkpoint->pages.clear();
+        checkpoint->stores.clear();
+        m_resumed = std::move(checkpoint);
+        return true;
+    }
+
+    /**
+     * @brief Records every evaluation of the solve, with the changes of its output stores, in a binary
+     * trace file (see FixpointTraceHeader) that `--print-trace` renders as text. Much cheaper than the
+     * trace log level on large programs. The parallel solver sweeps sequentially while tracing.
+     * 
+     * @param path the file to write, or empty to disable the trace
+     */
+    void set_trace_path(const std::string& path)
+    {
+        m_trace_path = path;
+    }
+
+    /**
+     * @brief Analyzes the program for several configurations of preconditions in a single pass. Every store
+     * holds one lane of the variables per configuration, named `x@k` after the first one, whose preconditions
+     * replace those of the program for the variables they mention. The lattice operations of the stores then
+     * process all the lanes at once, the expressions and conditions are evaluated lane by lane, and the
+     * fixpoint ends when every lane is stable. The locations are evaluated in Jacobi sweeps (or parallel ones),
+     * so that every lane goes through the iterates of its own run. Not compatible with the sparse mode, the
+     * prefilter and the reuse of a previous analysis. A configuration that sets a variable the program does not
+     * have makes the build throw an AnalysisError (see check_precondition_sweep).
+     * 
+     * @param configurations 
+     */
+    void set_sweep(std::vector<PreconditionSet<T>> configurations)
+    {
+        m_sweep = std::move(configurations);
+    }
+
+    /**
+     * @brief Number of configurations analyzed by the last run, 1 outside of a sweep
+     * 
+     */
+    std::size_t lanes() const
+    {
+        return m_lanes;
+    }
+
+    /**
+     * @brief Verdicts of the postconditions in every configuration of a sweep, after run(). verdicts() holds
+     * a postcondition as satisfied when it is satisfied in all of them.
+     * 
+     */
+    const std::vector<std::vector<PostconditionVerdict>>& lane_verdicts() const
+    {
+        return m_lane_verdicts;
+    }
+
+    /**
+     * @brief Prints the variables of the program in a lane of a store
+     * 
+     * @param store 
+     * @param lane 
+     */
+    void print_lane(const IntervalStore<T>& store, std::size_t lane) const
+    {
+        for (std::size_t id = 0; id < m_lane_width; ++id)
+        {
+            auto interval = store.get(id + lane * m_lane_width);
+            if (interval.is_empty())
+            {
+                Logger::out() << m_variable_table->name(id) << ": Empty" << std::endl;
+            }
+            else
+            {
+                Logger::out() << m_variable_table->name(id) << ": [" << interval.lb() << ", " << interval.ub() << "]" << std::endl;
+            }
+        }
+    }
+
+    /**
+     * @brief Measures, for every location, its evaluations, the time spent in its transfer function, the
+     * evaluations until its output stores stopped changing and its widenings (see profile)
+     * 
+     * @param profile 
+     */
+    void set_profile(bool profile)
+    {
+        m_profile = profile;
+    }
+
+    /**
+     * @brief Locations of the last run with their measures, in the order of the locations, empty unless
+     * profiling
+     * 
+     * @return std::vector<ProfiledLocation> 
+     */
+    std::vector<ProfiledLocation> profile() const
+    {
+        std::vector<ProfiledLocation> locations;
+        if (m_profiler == nullptr)
+        {
+            return locations;
+        }
+        locations.reserve(m_locations.size());
+        for (std::size_t index = 0; index < m_locations.size(); ++index)
+        {
+            const auto& location = *m_locations[index];
+            locations.push_back({location.type(), location_line(index), m_location_parents[index],
+                                 m_profiler->profiles()[index]});
+        }
+        return locations;
+    }
+
+    /**
+     * @brief Makes the next run reuse the fixpoint of a previous analysis, run with the same settings on an
+     * earlier version of the program. The locations of the leading top-level statements that did not change
+     * keep their invariants, since they do not depend on the rest of the program, and only the locations
+     * after them are solved. The previous interpreter is consumed by run().
+     * 
+     * @param previous 
+     */
+    void reuse(std::unique_ptr<EquationalInterpreter<T>> previous)
+    {
+        m_previous = std::move(previous);
+    }
+
+    /**
+     * @brief Tells if the input was parsed into a program
+     * 
+     */
+    bool parsed() const
+    {
+        return m_ast.size() > 0 && m_ast.root().size() > 0;
+    }
+
+    const AnalysisStatistics& statistics() const
+    {
+        return m_statistics;
+    }
+
+    /**
+     * @brief Verdicts of the postconditions, in program order, after run()
+     * 
+     * @return const std::vector<PostconditionVerdict>& 
+     */
+    const std::vector<PostconditionVerdict>& verdicts() const
+    {
+        return m_verdicts;
+    }
+
+    /**
+     * @brief Returns the store that holds at the end of the program, once the fixpoint is reached
+     * 
+     * @return std::shared_ptr<IntervalStore<T>> 
+     */
+    std::shared_ptr<IntervalStore<T>> final_store()
+    {
+        if (m_current_source == StoreDependency::ENTRY_LOCATION)
+        {
+            return m_store_pool.intern(m_precondition_store);
+        }
+        auto store = m_locations[m_current_source]->get_output_store(m_current_port);
+        return store != nullptr ? store : std::make_shared<IntervalStore<T>>();
+    }
+
+    /**
+     * @brief Tells if the final store is the invariant of the whole program. A slice removes the statements
+     * the postconditions do not read, and an anytime analysis does not evaluate the locations outside their
+     * cones, so their final store is only partial.
+     *
+     */
+    bool final_store_complete() const
+    {
+        return m_statistics.sliced_statements == 0 && !m_anytime;
+    }
+
+    /**
+     * @brief Number of locations of the equational system, after run()
+     * 
+     */
+    std::size_t location_count() const
+    {
+        return m_locations.size();
+    }
+
+    LocationType location_type(std::size_t location) const
+    {
+        return m_locations[location]->type();
+    }
+
+    /**
+     * @brief Source line of the statement of a location, 0 if the program was not parsed from a source. The
+     * AST keeps one line per statement, its first one, so the end of an if-else or of a while loop (ENDIF,
+     * ENDWHILE) has the line of its `if` or `while`, and not the one closing its body.
+     * 
+     */
+    std::size_t location_line(std::size_t location) const
+    {
+        return m_ast.line(m_locations[location]->m_code_block);
+    }
+
+    /**
+     * @brief Variables of the program, which the stores of the invariants address by id
+     * 
+     */
+    const VariableTable& variables() const
+    {
+        return *m_variable_table;
+    }
+
+    /**
+     * @brief Returns the invariant computed for an output of a location, or nullptr if the location has no
+     * such output or it was never reached
+     * 
+     * @param location 
+     * @param port 
+     * @return std::shared_ptr<IntervalStore<T>> 
+     */
+    std::shared_ptr<IntervalStore<T>> invariant(std::size_t location, StorePort port) const
+    {
+        auto store = m_locations[location]->get_output_store(port);
+        if (store == nullptr && port == StorePort::LAST && location < m_dropped.size() && m_dropped[location])
+        {
+            return replay(location);
+        }
+        return store;
+    }
+
+    /**
+     * @brief Tells if a bound of the completed analysis reached the range of T: an output store holds an end
+     * of the range, a widening or an accelerated loop went to it, an evaluation overflowed or divided by
+     * zero, or a budget was exceeded. Otherwise every bound of the analysis was computed exactly, so the
+     * invariants, verdicts and diagnostics are those of any wider type, which is how a program runs on the
+     * narrowest integer type (see infer_value_width). The variables that are not initialized enter the
+     * program unbounded, but only count once an output still holds them.
+     * 
+     */
+    bool saturated() const
+    {
+        if (m_saturated || m_statistics.diagnostics > 0 || m_statistics.budget_exceeded != BudgetExceeded::NONE)
+        {
+            return true;
+        }
+        std::unordered_set<const IntervalStore<T>*> checked;
+        auto reaches = [&](const std::shared_ptr<IntervalStore<T>>& store) {
+            return store != nullptr && checked.insert(store.get()).second && store->reaches(min_T, max_T);
+        };
+        for (const auto& location : m_locations)
+        {
+            for (std::size_t port = 0; port < STORE_PORTS; ++port)
+            {
+                if (reaches(location->get_output_store(static_cast<StorePort>(port))))
+                {
+                    return true;
+                }
+            }
+            if (location->type() == LocationType::WHILE && reaches(static_cast<const WhileLocation<T>&>(*location).m_store_head))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Executes the analysis of the program passed as input
+     * 
+     */
+    void run()
+    {
+        build();
+        solve();
+    }
+
+    /**
+     * @brief First phase of run: simplifies the program and builds its equational system. The solve can then
+     * happen later and on another thread, which is how the pipelined batch driver overlaps the two.
+     *
+     */
+    void build()
+    {
+        assert((m_sweep.empty() || (!m_sparse && !m_prefilter && m_previous == nullptr)) && "unsupported in a sweep");
+        if (!m_sweep.empty() && (m_solver_mode == SolverMode::WORKLIST || m_solver_mode == SolverMode::WTO))
+        {
+            m_solver_mode = SolverMode::JACOBI;
+        }
+        IntervalStore<T>::counters() = {};
+        m_run_start = std::chrono::steady_clock::now();
+        m_diagnostics.reset();
+        if (m_collect_diagnostics || Logger::enabled(LogLevel::SUMMARY))
+        {
+            m_diagnostics = std::make_unique<DiagnosticCollector>();
+        }
+
+        // First, build the equational system
+        PerfCounters::Measurement build_measurement(m_statistics.counters, AnalysisPhase::BUILD);
+        auto build_start = std::chrono::steady_clock::now();
+        m_statistics.estimated_evaluations = AnalysisCostEstimator::estimate(m_ast).cost;
+        simplify_ast();
+        m_discharged.clear();
+        if (m_prefilter)
+        {
+            prefilter_ast();
+        }
+        if (m_slice || m_prefilter)
+        {
+            slice_ast();
+        }
+        auto unchanged_statements = m_previous != nullptr ? share_variables_with_previous() : 0;
+        build_equational_system();
+        if (m_previous != nullptr)
+        {
+            adopt_previous_fixpoint(unchanged_statements);
+        }
+        if (!m_sweep.empty())
+        {
+            expand_lanes();
+        }
+        share_subterms();
+        m_profiler = m_profile ? std::make_unique<LocationProfiler>(m_locations.size()) : nullptr;
+        auto build_end = std::chrono::steady_clock::now();
+        build_measurement.stop();
+        m_statistics.build_ms = std::chrono::duration<double, std::milli>(build_end - build_start).count();
+        m_pool_lookups = m_store_pool.lookups();
+        m_pool_hits = m_store_pool.hits();
+        m_build_counters = IntervalStore<T>::counters();
+    }
+
+    /**
+     * @brief Second phase of run: solves the equational system made by build and evaluates the postconditions
+     *
+     */
+    void solve()
+    {
+        assert(((m_checkpoint_path.empty() && !m_resumed) || (m_sweep.empty() && m_previous == nullptr
+                && (m_solver_mode == SolverMode::WORKLIST || m_solver_mode == SolverMode::JACOBI))) && "unsupported with checkpoints");
+        assert((!m_anytime || (m_sweep.empty() && m_previous == nullptr && m_checkpoint_path.empty() && !m_resumed)) && "unsupported in the anytime mode");
+        m_cones.reset();
+        m_saturated = false;
+        m_cancelled = m_stop_token.stop_requested();
+        find_transient_assignments();
+        // The counters are per thread, and the time waited between the phases is not part of the budget
+        IntervalStore<T>::counters() = m_build_counters;
+        m_run_start = std::chrono::steady_clock::now() - std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                          std::chrono::duration<double, std::milli>(m_statistics.build_ms));
+        auto pool_lookups = m_pool_lookups;
+        auto pool_hits = m_pool_hits;
+        m_last_checkpoint = std::chrono::steady_clock::now();
+
+        print_equational_system();
+        if (Logger::enabled(LogLevel::VERBOSE) && !m_summary)
+        {
+            m_ast.root().print();
+            print_dependencies();
+        }
+
+        if (!m_trace_path.empty())
+        {
+            m_trace = std::make_unique<FixpointTraceWriter<T>>(m_trace_path, m_solver_mode == SolverMode::JACOBI || m_solver_mode == SolverMode::PARALLEL);
+            if (m_trace->good())
+            {
+                m_trace->begin(m_variable_table, m_locations);
+            }
+            else
+            {
+                std::cerr << "[ERROR] cannot write the trace `" << m_trace_path << "`." << std::endl;
+                m_trace.reset();
+            }
+        }
+
+        // Then, perform the fixpoint iteration (here it's pretty verbose)
+        PerfCounters::Measurement solve_measurement(m_statistics.counters, AnalysisPhase::SOLVE);
+        auto solve_start = std::chrono::steady_clock::now();
+        if (is_acyclic())
+        {
+            solve_acyclic();
+        }
+        else
+        {
+            switch (m_solver_mode)
+            {
+                case SolverMode::WORKLIST:
+                {
+                    solve_worklist();
+                    break;
+                }
+                case SolverMode::WTO:
+                {
+                    solve_wto();
+                    break;
+                }
+                case SolverMode::JACOBI:
+                {
+                    solve_jacobi();
+                    break;
+                }
+                case SolverMode::PARALLEL:
+                {
+                    solve_parallel();
+                    break;
+                }
+            }
+        }
+        auto solve_end = std::chrono::steady_clock::now();
+        solve_measurement.stop();
+        if (m_trace != nullptr)
+        {
+            m_trace->flush();
+            if (!m_trace->good())
+            {
+                std::cerr << "[ERROR] cannot write the trace `" << m_trace_path << "`." << std::endl;
+            }
+            m_trace.reset();
+        }
+
+        auto it_count = m_statistics.ascending_iterations + m_statistics.narrowing_iterations;
+        m_statistics.locations = m_locations.size();
+        m_statistics.iterations = it_count;
+        m_statistics.location_evaluations = m_location_evaluations;
+        m_statistics.reused_locations = m_reused_locations;
+        m_statistics.solve_ms = std::chrono::duration<double, std::milli>(solve_end - solve_start).count();
+        if (m_cancelled)
+        {
+            LOG_SUMMARY << "Analysis cancelled after " << m_location_evaluations << " location evaluations" << std::endl;
+            return;
+        }
+
+        // Finally, evaluate all the postconditions
+        should_evaluate_postcondition = true;
+        LOG_TRACE << "|EVALUATING POSTCONDITIONS|===================" << std::endl;
+        PerfCounters::Measurement postconditions_measurement(m_statistics.counters, AnalysisPhase::POSTCONDITIONS);
+        auto postconditions_start = std::chrono::steady_clock::now();
+        evaluate_postconditions();
+        auto postconditions_end = std::chrono::steady_clock::now();
+        postconditions_measurement.stop();
+        m_statistics.postconditions_ms = std::chrono::duration<double, std::milli>(postconditions_end - postconditions_start).count();
+        LOG_TRACE << "===================COMPLETED===================" << std::endl;
+
+        const auto& counters = IntervalStore<T>::counters();
+        m_statistics.stores_allocated = (m_store_pool.lookups() - pool_lookups) - (m_store_pool.hits() - pool_hits);
+        m_statistics.page_allocations = counters.page_allocations;
+        m_statistics.page_copies = counters.page_copies;
+        m_statistics.bytes_copied = counters.page_copies * sizeof(typename IntervalStore<T>::Page);
+        auto diagnostics = this->diagnostics();
+        m_statistics.diagnostics = diagnostics.size();
+        m_statistics.function_summaries = m_functions->summaries();
+        m_statistics.summary_reuses = m_functions->reuses();
+        m_statistics.shared_subterms = m_shared_subterms != nullptr ? m_shared_subterms->size() : 0;
+        m_statistics.subterm_reuses = m_shared_subterms != nullptr ? m_shared_subterms->reuses() : 0;
+        for (const auto& diagnostic : diagnostics)
+        {
+            WARN_SUMMARY << "[WARNING] " << diagnostic_message(diagnostic.kind) << " at location " << diagnostic.location
+                         << " (" << location_type_name(m_locations[diagnostic.location]->type()) << ", "
+                         << diagnostic.count << (diagnostic.count == 1 ? " evaluation)" : " evaluations)") << std::endl;
+        }
+        // The statements removed by a slice may change the variables after they are asserted, and an anytime
+        // analysis leaves the locations outside the cones of the postconditions unevaluated
+        if (Logger::enabled(LogLevel::SUMMARY) && final_store_complete() && !m_summary && m_sweep.empty())
+        {
+            Logger::out() << "Final invariant:" << std::endl;
+            final_store()->print(Logger::out());
+        }
+        else if (Logger::enabled(LogLevel::SUMMARY) && final_store_complete() && !m_summary)
+        {
+            auto final = final_store();
+            for (std::size_t lane = 0; lane < m_lanes; ++lane)
+            {
+                auto satisfied = std::count_if(m_lane_verdicts[lane].begin(), m_lane_verdicts[lane].end(), [](const auto& verdict) { return verdict.satisfied; });
+                Logger::out() << "Final invariant of configuration " << lane << " (" << satisfied << " of " << m_lane_verdicts[lane].size()
+                          << " postconditions satisfied):" << std::endl;
+                print_lane(*final, lane);
+            }
+        }
+        if (m_statistics.budget_exceeded != BudgetExceeded::NONE && m_cones != nullptr)
+        {
+            WARN_SUMMARY << "[WARNING] Budget exceeded (" << budget_name(m_statistics.budget_exceeded) << "): the analysis stopped with "
+                         << m_cones->undecided << " postconditions undecided" << std::endl;
+        }
+        else if (m_statistics.budget_exceeded != BudgetExceeded::NONE)
+        {
+            WARN_SUMMARY << "[WARNING] Budget exceeded (" << budget_name(m_statistics.budget_exceeded)
+                         << "): the loops that were not stable were widened to the range of the type" << std::endl;
+        }
+        LOG_SUMMARY << "Fixpoint iterations: " << it_count << " (" << m_statistics.ascending_iterations << " ascending, "
+                    << m_statistics.narrowing_iterations << " narrowing)" << std::endl;
+        LOG_SUMMARY << "Location evaluations: " << m_location_evaluations << std::endl;
+        if (m_cones != nullptr)
+        {
+            LOG_SUMMARY << "Decided postconditions: " << m_verdicts.size() - m_cones->undecided << " of " << m_verdicts.size() << std::endl;
+        }
+        if (!m_sweep.empty())
+        {
+            LOG_SUMMARY << "Configurations: " << m_lanes << " (" << m_lane_width << " variables each)" << std::endl;
+        }
+        if (m_statistics.sliced_statements > 0)
+        {
+            LOG_SUMMARY << "Sliced statements: " << m_statistics.sliced_statements << std::endl;
+        }
+        if (m_functions->size() > 0)
+        {
+            LOG_SUMMARY << "Function summaries: " << m_statistics.function_summaries << " (" << m_statistics.summary_reuses
+                        << " calls reused one)" << std::endl;
+        }
+        if (m_statistics.shared_subterms > 0)
+        {
+            LOG_SUMMARY << "Shared subterms: " << m_statistics.shared_subterms << " (" << m_statistics.subterm_reuses
+                        << " evaluations reused one)" << std::endl;
+        }
+        if (m_prefilter)
+        {
+            LOG_SUMMARY << "Discharged postconditions: " << m_statistics.discharged_postconditions << std::endl;
+        }
+        if (m_reused_locations > 0)
+        {
+            LOG_SUMMARY << "Reused locations: " << m_reused_locations << " of " << m_locations.size() << std::endl;
+        }
+        if (m_resumed_evaluations > 0)
+        {
+            LOG_SUMMARY << "Resumed from a checkpoint after " << m_resumed_evaluations << " location evaluations" << std::endl;
+        }
+        if (m_checkpoints > 0)
+        {
+            LOG_SUMMARY << "Checkpoints written: " << m_checkpoints << std::endl;
+        }
+        LOG_SUMMARY << "Distinct stores: " << m_store_pool.size() << " (" << m_store_pool.hits() - pool_hits << " of "
+                    << m_store_pool.lookups() - pool_lookups << " stores shared)" << std::endl;
+        LOG_SUMMARY << "Solve time: " << m_statistics.solve_ms << " ms" << std::endl;
+    }
+
+private:
+
+    /**
+     * @brief Prints the inputs of every location
+     * 
+     */
+    void print_dependencies() const
+    {
+        Logger::out() << "|DEPENDENCIES|=========================" << std::endl;
+        for (std::size_t i = 0; i < m_cfg.size(); ++i)
+        {
+            Logger::out() << "Location " << i << " reads";
+            for (const auto& dependency : m_cfg.predecessors(i))
+            {
+                if (dependency.source == StoreDependency::ENTRY_LOCATION)
+                {
+                    Logger::out() << " entry";
+                }
+                else
+                {
+                    Logger::out() << " " << dependency.source << ":" << static_cast<int>(dependency.port);
+                }
+            }
+            Logger::out() << std::endl;
+        }
+    }
+
+    /**
+     * @brief Solves a system without loops, whatever the solver mode: every location only reads the
+     * locations before it, so a single pass in program order reaches the fixpoint, with neither a
+     * worklist nor a sweep to check that it is stable
+     * 
+     */
+    void solve_acyclic()
+    {
+        auto entry_store = m_store_pool.intern(m_precondition_store);
+        auto evaluations = initial_evaluations();
+
+        m_phase = IterationPhase::ASCENDING;
+        solve_system(entry_store, evaluations, 1);
+        m_statistics.ascending_iterations = m_reused_locations < m_locations.size() ? 1 : 0;
+        m_statistics.narrowing_iterations = 0;
+        if (m_progress && !m_cancelled)
+        {
+            report_progress(1, 0);
+        }
+
+        print_locations("FINAL LOCATIONS");
+    }
+
+    /**
+     * @brief Iterates the whole system until no location changes between two sweeps, first widening and
+     * then narrowing the loop heads
+     * 
+     */
+    void solve_jacobi()
+    {
+        auto entry_store = m_store_pool.intern(m_precondition_store);
+        auto evaluations = initial_evaluations();
+
+        // A resumed iteration continues the sweeps of the phase of its checkpoint
+        auto resumed = take_resumed(evaluations);
+        if (!resumed || resumed->phase == IterationPhase::ASCENDING)
+        {
+            m_phase = IterationPhase::ASCENDING;
+            m_statistics.ascending_iterations = sweep_until_stable(entry_store, evaluations, resumed ? resumed->sweeps : 0);
+            resumed.reset();
+        }
+
+        m_phase = IterationPhase::NARROWING;
+        m_statistics.narrowing_iterations = has_loops() && !m_cancelled ? sweep_until_stable(entry_store, evaluations, resumed ? resumed->sweeps : 0) : 0;
+    }
+
+    /**
+     * @brief Performs Jacobi sweeps in the current phase until the system is stable
+     * 
+     * @param entry_store 
+     * @param evaluations 
+     * @param sweeps already performed in this phase, if resumed
+     * @return std::size_t the number of sweeps
+     */
+    std::size_t sweep_until_stable(std::shared_ptr<IntervalStore<T>>& entry_store, std::vector<std::size_t>& evaluations, std::size_t sweeps = 0)
+    {
+        if (m_parallel != nullptr)
+        {
+            return sweep_in_parallel_until_stable(entry_store, evaluations);
+        }
+        std::size_t it_count = sweeps;
+        while (true)
+        {
+            LOG_TRACE << "===================Iteration " << it_count << "===================" << std::endl;
+            LOG_TRACE << "===================JACOBI ITERATION===================" << std::endl;
+            it_count++;
+            solve_system(entry_store, evaluations, it_count);
+            if (m_cancelled)
+            {
+                break;
+            }
+            print_locations("NEW LOCATIONS");
+
+            LOG_TRACE << "|CHECKING STABILITY|====================" << std::endl;
+            PerfCounters::Measurement stability_measurement(m_statistics.counters, AnalysisPhase::STABILITY);
+            auto stability_start = std::chrono::steady_clock::now();
+            auto stable = is_stable();
+            auto stability_end = std::chrono::steady_clock::now();
+            stability_measurement.stop();
+            m_statistics.stability_ms += std::chrono::duration<double, std::milli>(stability_end - stability_start).count();
+            if (m_progress)
+            {
+                report_progress(it_count, stable ? 0 : changed_locations());
+            }
+            if (stable)
+            {
+                break;
+            }
+            if (checkpoint_due())
+            {
+                write_checkpoint(evaluations, {}, {}, it_count);
+            }
+        }
+
+        return it_count;
+    }
+
+    /**
+     * @brief Regions of the parallel solver and the tasks of a run of its pool, which performs up to
+     * `window` consecutive sweeps
+     * 
+     */
+    struct ParallelSweeps {
+        WorkStealingPool pool;
+        std::size_t window;
+        std::vector<std::size_t> region_begin;      // first location of every region, then the end of the last one
+        WorkStealingPool::TaskGraph graph;          // task s * regions() + r evaluates region r in the s-th sweep of a run
+
+        // State of the current run
+        std::unique_ptr<std::atomic<std::size_t>[]> unfinished;     // regions not evaluated yet, for every sweep
+        std::unique_ptr<std::atomic<bool>[]> changed;               // a location of the sweep changed
+        std::unique_ptr<std::atomic<std::size_t>[]> unstable;       // locations that changed in the sweep
+        std::unique_ptr<std::atomic<bool>[]> decided;               // whether the sweep is performed is known
+        std::vector<std::string> out;                               // messages of every task
+        std::vector<std::string> err;
+        typename IntervalStore<T>::Counters counters;
+
+        explicit ParallelSweeps(std::size_t threads)
+        : pool(threads)
+        , window(std::clamp<std::size_t>(threads, 4, 32))
+        , unfinished(std::make_unique<std::atomic<std::size_t>[]>(window))
+        , changed(std::make_unique<std::atomic<bool>[]>(window))
+        , unstable(std::make_unique<std::atomic<std::size_t>[]>(window))
+        , decided(std::make_unique<std::atomic<bool>[]>(window))
+        {}
+
+        std::size_t regions() const
+        {
+            return region_begin.size() - 1;
+        }
+    };
+
+    /**
+     * @brief Iterates the system with Jacobi sweeps evaluated by a pool of threads, with the result of
+     * `jacobi` whatever the number of threads.
+     *
+     * The locations are split in regions of consecutive locations that only read the one before them: the
+     * bodies of the branches of an if-else and of a loop start new regions, as do the ends of the if-else
+     * statements and the locations after a loop, which only read the exit of its head and so do not wait
+     * for its body. A region is evaluated once the regions it reads from are evaluated in the same sweep,
+     * and the next sweep of a region starts as soon as the regions reading it have read it and the previous
+     * sweep is known to be needed, that is, as soon as a location changed in it: consecutive sweeps then
+     * overlap along the program, which is a single chain of stores at the top level. Every location reads
+     * the same stores as in a sequential sweep, and no sweep is started after a stable one. The messages
+     * of the locations are printed in the order of the sequential sweeps. With one thread, or with
+     * tracing enabled (log level or binary trace), the sweeps are sequential.
+     * 
+     */
+    void solve_parallel()
+    {
+        if (m_solver_threads > 1 && m_reused_locations < m_locations.size() && !Logger::enabled(LogLevel::TRACE) && m_trace == nullptr)
+        {
+            m_parallel = std::make_unique<ParallelSweeps>(m_solver_threads);
+            schedule_sweeps(*m_parallel);
+        }
+        solve_jacobi();
+        m_parallel.reset();
+    }
+
+    /**
+     * @brief Splits the locations that are not reused in regions, and builds the tasks of a run of the
+     * pool. The task of region r in sweep s waits for:
+     * - the regions that r reads in sweep s;
+     * - region r, the regions that read r and the regions that r reads through a loop back edge, in sweep
+     *   s - 1, so that its stores are not replaced while they are read;
+     * - from the second sweep of the run, the first change of a location in sweep s - 1 (see
+     *   sweep_in_parallel_until_stable).
+     * 
+     * @param sweeps 
+     */
+    void schedule_sweeps(ParallelSweeps& sweeps) const
+    {
+        auto begin = m_reused_locations;
+        auto end = m_locations.size();
+        auto is_forward = [begin](std::size_t index, const StoreDependency& dependency) {
+            return dependency.source != StoreDependency::ENTRY_LOCATION && dependency.source >= begin && dependency.source < index;
+        };
+
+        std::vector<std::size_t> forward_successors(end, 0);
+        for (auto index = begin; index < end; ++index)
+        {
+            for (const auto& dependency : m_cfg.predecessors(index))
+            {
+                if (is_forward(index, dependency))
+                {
+                    forward_successors[dependency.source]++;
+                }
+            }
+        }
+
+        std::vector<std::size_t> region_of(end, 0);
+        for (auto index = begin; index < end; ++index)
+        {
+            std::size_t forward_predecessors = 0;
+            bool reads_previous = false;
+            for (const auto& dependency : m_cfg.predecessors(index))
+            {
+                if (is_forward(index, dependency))
+                {
+                    forward_predecessors++;
+                    reads_previous = reads_previous || dependency.source == index - 1;
+                }
+            }
+            if (index == begin || forward_predecessors != 1 || !reads_previous || forward_successors[index - 1] != 1)
+            {
+                sweeps.region_begin.push_back(index);
+            }
+            region_of[index] = sweeps.region_begin.size() - 1;
+        }
+        auto regions = sweeps.region_begin.size();
+        sweeps.region_begin.push_back(end);
+
+        // Regions read by every region in the same sweep, and in the previous sweep through back edges
+        std::vector<std::vector<std::size_t>> reads(regions);
+        std::vector<std::vector<std::size_t>> reads_back(regions);
+        for (auto index = begin; index < end; ++index)
+        {
+            for (const auto& dependency : m_cfg.predecessors(index))
+            {
+                if (dependency.source == StoreDependency::ENTRY_LOCATION || dependency.source < begin)
+                {
+                    continue;
+                }
+                auto source = region_of[dependency.source];
+                auto target = region_of[index];
+                auto& list = is_forward(index, dependency) ? reads[target] : reads_back[target];
+                if (source != target && std::find(list.begin(), list.end(), source) == list.end())
+                {
+                    list.push_back(source);
+                }
+            }
+        }
+
+        auto tasks = regions * sweeps.window;
+        sweeps.graph.successors.assign(tasks, {});
+        sweeps.graph.predecessors.assign(tasks, 0);
+        auto add_edge = [&sweeps](std::size_t from, std::size_t to) {
+            auto& successors = sweeps.graph.successors[from];
+            if (std::find(successors.begin(), successors.end(), to) == successors.end())
+            {
+                successors.push_back(to);
+                sweeps.graph.predecessors[to]++;
+            }
+        };
+        for (std::size_t sweep = 0; sweep < sweeps.window; ++sweep)
+        {
+            for (std::size_t region = 0; region < regions; ++region)
+            {
+                auto task = sweep * regions + region;
+                for (auto source : reads[region])
+                {
+                    add_edge(sweep * regions + source, task);
+                }
+                if (sweep == 0)
+                {
+                    continue;
+                }
+                auto previous = (sweep - 1) * regions;
+                add_edge(previous + region, task);
+                for (auto source : reads[region])
+                {
+                    // The source is evaluated again once it has been read
+                    add_edge(previous + region, sweep * regions + source);
+                }
+                for (auto source : reads_back[region])
+                {
+                    add_edge(previous + source, task);
+                }
+                // Released by the first change in the previous sweep
+                sweeps.graph.predecessors[task]++;
+            }
+        }
+        sweeps.out.resize(tasks);
+        sweeps.err.resize(tasks);
+    }
+
+    /**
+     * @brief Performs Jacobi sweeps in the current phase on the pool until the system is stable. A run of
+     * the pool performs up to `window` sweeps: a sweep is started by the first location that changes in the
+     * previous one, and the run stops when a sweep ends without changes. The evaluations, the messages and
+     * the page counters of the tasks are collected at the end of every run.
+     * 
+     * @param entry_store 
+     * @param evaluations 
+     * @return std::size_t the number of sweeps
+     */
+    std::size_t sweep_in_parallel_until_stable(std::shared_ptr<IntervalStore<T>>& entry_store, std::vector<std::size_t>& evaluations)
+    {
+        auto& sweeps = *m_parallel;
+        auto regions = sweeps.regions();
+        auto decide = [&sweeps, regions](std::size_t sweep, bool needed) {
+            if (sweep == sweeps.window || sweeps.decided[sweep].exchange(true))
+            {
+                return;
+            }
+            if (!needed)
+            {
+                sweeps.pool.stop();
+                return;
+            }
+            for (std::size_t region = 0; region < regions; ++region)
+            {
+                sweeps.pool.release(sweep * regions + region);
+            }
+        };
+
+        std::size_t it_count = 0;
+        while (true)
+        {
+            for (std::size_t sweep = 0; sweep < sweeps.window; ++sweep)
+            {
+                sweeps.unfinished[sweep].store(regions, std::memory_order_relaxed);
+                sweeps.changed[sweep].store(false, std::memory_order_relaxed);
+                sweeps.unstable[sweep].store(0, std::memory_order_relaxed);
+                sweeps.decided[sweep].store(sweep == 0, std::memory_order_relaxed);
+            }
+            sweeps.counters = {};
+
+            sweeps.pool.run(sweeps.graph, [&](std::size_t task) {
+                // The regions already started end their sweep, the others are dropped
+                if (m_stop_token.stop_requested())
+                {
+                    sweeps.pool.stop();
+                    return;
+                }
+                auto sweep = task / regions;
+                auto region = task % regions;
+                auto& counters = IntervalStore<T>::counters();
+                auto before = counters;
+                static thread_local std::ostringstream out;
+                static thread_local std::ostringstream err;
+                std::size_t changed_locations = 0;
+                {
+                    Logger::Capture capture(out, err);
+                    for (auto index = sweeps.region_begin[region]; index < sweeps.region_begin[region + 1]; ++index)
+                    {
+                        link_inputs(index, entry_store, evaluations);
+                        evaluate(index);
+                        evaluations[index]++;
+                        changed_locations += m_locations[index]->has_changed() ? 1 : 0;
+                    }
+                }
+                bool changed = changed_locations > 0;
+                if (out.tellp() > 0)
+                {
+                    sweeps.out[task] = out.str();
+                    out.str("");
+                }
+                if (err.tellp() > 0)
+                {
+                    sweeps.err[task] = err.str();
+                    err.str("");
+                }
+                std::atomic_ref<std::size_t>(sweeps.counters.page_allocations).fetch_add(counters.page_allocations - before.page_allocations, std::memory_order_relaxed);
+                std::atomic_ref<std::size_t>(sweeps.counters.page_copies).fetch_add(counters.page_copies - before.page_copies, std::memory_order_relaxed);
+                counters = before;
+
+                if (changed)
+                {
+                    sweeps.unstable[sweep].fetch_add(changed_locations, std::memory_order_relaxed);
+                    sweeps.changed[sweep].store(true);
+                    decide(sweep + 1, true);
+                }
+                if (sweeps.unfinished[sweep].fetch_sub(1) == 1)
+                {
+                    decide(sweep + 1, sweeps.changed[sweep].load());
+                }
+            });
+
+            auto& counters = IntervalStore<T>::counters();
+            counters.page_allocations += sweeps.counters.page_allocations;
+            counters.page_copies += sweeps.counters.page_copies;
+            if (m_stop_token.stop_requested())
+            {
+                m_cancelled = true;
+                return it_count;
+            }
+            bool stable = false;
+            for (std::size_t sweep = 0; sweep < sweeps.window && !stable; ++sweep)
+            {
+                it_count++;
+                for (auto task = sweep * regions; task < (sweep + 1) * regions; ++task)
+                {
+                    Logger::out() << sweeps.out[task];
+                    Logger::err() << sweeps.err[task];
+                    sweeps.out[task].clear();
+                    sweeps.err[task].clear();
+                }
+                for (auto index = m_reused_locations; index < m_locations.size(); ++index)
+                {
+                    count_evaluation(index);
+                }
+                stable = !sweeps.changed[sweep].load();
+                if (m_progress)
+                {
+                    report_progress(it_count, sweeps.unstable[sweep].load(std::memory_order_relaxed));
+                }
+            }
+            if (stable)
+            {
+                return it_count;
+            }
+        }
+    }
+
+    /**
+     * @brief Increments a counter of the statistics that locations evaluated at the same time by the
+     * parallel solver may share
+     * 
+     * @param counter 
+     */
+    static void count(std::size_t& counter)
+    {
+        std::atomic_ref<std::size_t>(counter).fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Iterates the system with a worklist. Locations are extracted in program order and a location
+     * is evaluated again only when one of the stores it reads from has changed, so that parts of the program
+     * that are already stable are not evaluated again. The narrowing phase starts from the loop heads.
+     * 
+     */
+    void solve_worklist()
+    {
+        auto entry_store = m_store_pool.intern(m_precondition_store);
+        auto evaluations = initial_evaluations();
+
+        std::vector<std::size_t> all_locations;
+        std::vector<std::size_t> loop_heads;
+        for (std::size_t i = m_reused_locations; i < m_locations.size(); ++i)
+        {
+            all_locations.push_back(i);
+            if (m_locations[i]->type() == LocationType::WHILE)
+            {
+                loop_heads.push_back(i);
+            }
+        }
+
+        if (m_anytime)
+        {
+            build_postcondition_cones();
+        }
+
+        // A resumed iteration continues the worklist of the phase of its checkpoint
+        auto resumed = take_resumed(evaluations);
+        if (!resumed || resumed->phase == IterationPhase::ASCENDING)
+        {
+            m_phase = IterationPhase::ASCENDING;
+            m_statistics.ascending_iterations = resumed ? run_worklist(resumed->queued, entry_store, evaluations, std::move(resumed->phase_evaluations))
+                                                        : run_worklist(all_locations, entry_store, evaluations);
+            resumed.reset();
+        }
+
+        m_phase = IterationPhase::NARROWING;
+        if (!anytime_done() && !m_cancelled)
+        {
+            m_statistics.narrowing_iterations = resumed ? run_worklist(resumed->queued, entry_store, evaluations, std::move(resumed->phase_evaluations))
+                                                        : run_worklist(loop_heads, entry_store, evaluations);
+        }
+
+        print_locations("FINAL LOCATIONS");
+    }
+
+    /**
+     * @brief Runs the worklist in the current phase, starting from the given locations
+     * 
+     * @param initial 
+     * @param entry_store 
+     * @param evaluations the evaluations of every location, over all the phases
+     * @param phase_evaluations the evaluations of every location already made in this phase, if resumed
+     * @return std::size_t the largest number of evaluations of a single location in this phase
+     */
+    std::size_t run_worklist(const std::vector<std::size_t>& initial, std::shared_ptr<IntervalStore<T>>& entry_store, std::vector<std::size_t>& evaluations,
+                             std::vector<std::size_t> phase_evaluations = {})
+    {
+        phase_evaluations.resize(m_locations.size(), 0);
+        std::vector<bool> in_worklist(m_locations.size(), false);
+        std::priority_queue<std::size_t, std::vector<std::size_t>, std::greater<std::size_t>> worklist;
+        // In the anytime mode, only the cones of the undecided postconditions are iterated
+        auto push = [&](std::size_t index) {
+            if (m_cones != nullptr && m_cones->relevant[index] == 0)
+            {
+                return;
+            }
+            worklist.push(index);
+            in_worklist[index] = true;
+            queue_in_cones(index, true);
+        };
+        for (auto index : initial)
+        {
+            push(index);
+        }
+        if (m_cones != nullptr)
+        {
+            decide_postconditions(m_cones->slots);
+        }
+
+        // A pass ends when the worklist goes back to an earlier location, which is where the progress is reported
+        std::size_t passes = 0;
+        std::size_t last = 0;
+        while (!worklist.empty() && !anytime_done() && !m_cancelled)
+        {
+            auto index = worklist.top();
+            if (passes == 0 || index <= last)
+            {
+                if (m_progress && passes > 0)
+                {
+                    report_progress(passes, worklist.size());
+                    if (m_cancelled)
+                    {
+                        break;
+                    }
+                }
+                passes++;
+            }
+            last = index;
+            worklist.pop();
+            in_worklist[index] = false;
+            queue_in_cones(index, false);
+            if (m_cones != nullptr && m_cones->relevant[index] == 0)
+            {
+                continue;
+            }
+
+            evaluate_location(index, entry_store, evaluations, phase_evaluations);
+            for_each_affected_dependent(index, evaluations, [&](std::size_t dependent) {
+                if (!in_worklist[dependent])
+                {
+                    LOG_TRACE << "  Location " << dependent << " added to the worklist" << std::endl;
+                    push(dependent);
+                }
+            });
+            // The last evaluation may have widened a loop to the range of the type: nothing is decided on it
+            if (m_cones != nullptr && !budget_exceeded())
+            {
+                decide_postconditions(m_cones->watchers[index]);
+            }
+            if (m_location_evaluations % BUDGET_CHECK_PERIOD == 0 && checkpoint_due())
+            {
+                write_checkpoint(evaluations, phase_evaluations, in_worklist, 0);
+            }
+        }
+        if (m_progress && passes > 0 && !m_cancelled)
+        {
+            report_progress(passes, worklist.size());
+        }
+
+        return max_evaluations(phase_evaluations);
+    }
+
+    /**
+     * @brief Calls the action on every location that reads an output store of the given location that
+     * changed during its last evaluation (all of them after its first evaluation)
+     * 
+     * @param index 
+     * @param evaluations 
+     * @param action 
+     */
+    template <typename F>
+    void for_each_affected_dependent(std::size_t index, const std::vector<std::size_t>& evaluations, F&& action)
+    {
+        auto& loc = m_locations[index];
+        for (auto dependent : m_cfg.successors(index))
+        {
+            for (const auto& dependency : m_cfg.predecessors(dependent))
+            {
+                if (dependency.source == index && (evaluations[index] == 1 || loc->has_changed(dependency.port)))
+                {
+                    action(dependent);
+                    break;
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Iterates the system along a weak topological order of the control-flow graph, with the
+     * recursive strategy: a loop is iterated until its head is stable, and every inner loop is stabilized
+     * on each iteration of the outer one, so that the outer loop only sees stable inner invariants. Loop
+     * heads are exactly the heads of the components, so widening and narrowing happen only there. As in
+     * the worklist, a location is evaluated only when one of the stores it reads has changed.
+     * 
+     */
+    void solve_wto()
+    {
+        auto entry_store = m_store_pool.intern(m_precondition_store);
+        auto evaluations = initial_evaluations();
+        auto wto = WeakTopologicalOrder::compute(m_cfg, 0);
+        WtoState state{wto, entry_store, evaluations, std::vector<std::size_t>(m_locations.size(), 0), std::vector<bool>(m_locations.size(), false)};
+        for (std::size_t i = m_reused_locations; i < m_locations.size(); ++i)
+        {
+            state.dirty[i] = true;
+        }
+
+        m_phase = IterationPhase::ASCENDING;
+        stabilize(state, 0, wto.size());
+        m_statistics.ascending_iterations = max_evaluations(state.phase_evaluations);
+
+        m_statistics.narrowing_iterations = 0;
+        if (has_loops() && !m_cancelled)
+        {
+            state.phase_evaluations.assign(m_locations.size(), 0);
+            for (std::size_t i = 0; i < m_locations.size(); ++i)
+            {
+                state.dirty[i] = i >= m_reused_locations && m_locations[i]->type() == LocationType::WHILE;
+            }
+            m_phase = IterationPhase::NARROWING;
+            stabilize(state, 0, wto.size());
+            m_statistics.narrowing_iterations = max_evaluations(state.phase_evaluations);
+        }
+
+        print_locations("FINAL LOCATIONS");
+    }
+
+    struct WtoState {
+        const WeakTopologicalOrder& wto;
+        std::shared_ptr<IntervalStore<T>>& entry_store;
+        std::vector<std::size_t>& evaluations;
+        std::vector<std::size_t> phase_evaluations;
+        std::vector<bool> dirty;    // locations that read a store that changed since their last evaluation
+    };
+
+    /**
+     * @brief Evaluates the elements of a weak topological order between two positions, stabilizing every
+     * component in turn
+     * 
+     * @param state 
+     * @param begin 
+     * @param end 
+     * @param outermost whether the components are not nested in another one, which reports the progress
+     */
+    void stabilize(WtoState& state, std::size_t begin, std::size_t end, bool outermost = true)
+    {
+        auto position = begin;
+        while (position < end && !m_cancelled)
+        {
+            auto index = state.wto.node(position);
+            if (!state.wto.is_head(position))
+            {
+                evaluate_if_dirty(state, index);
+                position++;
+                continue;
+            }
+
+            // The head becomes dirty again as long as the body feeds it a different store
+            LOG_TRACE << "===================Stabilizing Component " << index << "===================" << std::endl;
+            do {
+                evaluate_if_dirty(state, index);
+                stabilize(state, position + 1, state.wto.component_end(position), false);
+                if (m_progress && outermost && !m_cancelled)
+                {
+                    report_progress(state.phase_evaluations[index], std::count(state.dirty.begin(), state.dirty.end(), true));
+                }
+            } while (state.dirty[index] && !m_cancelled);
+            position = state.wto.component_end(position);
+        }
+    }
+
+    void evaluate_if_dirty(WtoState& state, std::size_t index)
+    {
+        if (!state.dirty[index])
+        {
+            return;
+        }
+        state.dirty[index] = false;
+        evaluate_location(index, state.entry_store, state.evaluations, state.phase_evaluations);
+        for_each_affected_dependent(index, state.evaluations, [&state](std::size_t dependent) {
+            state.dirty[dependent] = true;
+        });
+    }
+
+    /**
+     * @brief Feeds the inputs of a location and evaluates it
+     * 
+     * @param index 
+     * @param entry_store 
+     * @param evaluations the evaluations of every location, over all the phases
+     * @param phase_evaluations the evaluations of every location in the current phase
+     */
+    void evaluate_location(std::size_t index, std::shared_ptr<IntervalStore<T>>& entry_store, std::vector<std::size_t>& evaluations,
+                           std::vector<std::size_t>& phase_evaluations)
+    {
+        LOG_TRACE << "===================Evaluating Location " << index << "===================" << std::endl;
+        link_inputs(index, entry_store, evaluations);
+        evaluate(index);
+        evaluations[index]++;
+        phase_evaluations[index]++;
+        count_evaluation(index);
+        if (m_trace != nullptr)
+        {
+            m_trace->evaluation(m_phase == IterationPhase::NARROWING, phase_evaluations[index], index, *m_locations[index]);
+        }
+        drop_transient_input(index);
+    }
+
+    void count_evaluation(std::size_t index)
+    {
+        m_location_evaluations++;
+        m_statistics.evaluations_by_type[static_cast<std::size_t>(m_locations[index]->type())]++;
+        if (m_location_evaluations % BUDGET_CHECK_PERIOD == 0)
+        {
+            check_budget();
+        }
+        // A single load of the state of the token, which the solvers check before the next evaluation
+        m_cancelled = m_cancelled || m_stop_token.stop_requested();
+    }
+
+    // The function may request the stop itself, which then happens before the next evaluation
+    void report_progress(std::size_t iteration, std::size_t unstable)
+    {
+        m_progress({m_phase, iteration, unstable, m_location_evaluations});
+        m_cancelled = m_cancelled || m_stop_token.stop_requested();
+    }
+
+    // Locations that changed in their last evaluation
+    std::size_t changed_locations() const
+    {
+        return std::count_if(m_locations.begin(), m_locations.end(), [](const auto& location) { return location->has_changed(); });
+    }
+
+    /**
+     * @brief Checks the time and memory budgets. Called between evaluations by the thread that drives
+     * the solve, every BUDGET_CHECK_PERIOD evaluations.
+     * 
+     */
+    void check_budget()
+    {
+        if (budget_exceeded())
+        {
+            return;
+        }
+        if (m_budget.time_ms > 0)
+        {
+            auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_run_start).count();
+            if (elapsed > m_budget.time_ms)
+            {
+                exceed_budget(BudgetExceeded::TIME);
+                return;
+            }
+        }
+        if (m_budget.memory_mb > 0)
+        {
+            const auto& counters = IntervalStore<T>::counters();
+            auto bytes = (counters.page_allocations + counters.page_copies) * sizeof(typename IntervalStore<T>::Page);
+            if (bytes > (m_budget.memory_mb << 20))
+            {
+                exceed_budget(BudgetExceeded::MEMORY);
+            }
+        }
+    }
+
+    /**
+     * @brief Records the first budget exceeded. The loop heads call it from the threads of the parallel
+     * solver.
+     * 
+     */
+    void exceed_budget(BudgetExceeded budget)
+    {
+        auto expected = BudgetExceeded::NONE;
+        std::atomic_ref<BudgetExceeded>(m_statistics.budget_exceeded).compare_exchange_strong(expected, budget);
+    }
+
+    bool budget_exceeded()
+    {
+        return std::atomic_ref<BudgetExceeded>(m_statistics.budget_exceeded).load(std::memory_order_relaxed) != BudgetExceeded::NONE;
+    }
+
+    // Narrowing is bounded by the number of passes, and only skipped when out of time or memory
+    bool stop_narrowing()
+    {
+        auto budget = std::atomic_ref<BudgetExceeded>(m_statistics.budget_exceeded).load(std::memory_order_relaxed);
+        return budget == BudgetExceeded::TIME || budget == BudgetExceeded::MEMORY;
+    }
+
+    bool checkpoint_due()
+    {
+        return !m_checkpoint_path.empty() && !budget_exceeded()
+            && std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_last_checkpoint).count() >= m_checkpoint_interval_ms;
+    }
+
+    // Hash of the program the equational system was built from, which a checkpoint is only valid for
+    std::uint64_t program_hash() const
+    {
+        auto hash = m_header_hash;
+        for (const auto& statement : m_statements)
+        {
+            hash = (hash ^ statement.hash) * 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    std::uint8_t checkpoint_flags() const
+    {
+        return (m_sparse ? 1 : 0) | (m_slice ? 2 : 0) | (m_prefilter ? 4 : 0);
+    }
+
+    /**
+     * @brief Writes the current state of the iteration to the checkpoint file
+     * 
+     * @param evaluations of every location, over all the phases
+     * @param phase_evaluations of every location in the current phase, empty for the Jacobi sweeps
+     * @param queued the locations in the worklist, empty for the Jacobi sweeps
+     * @param sweeps the Jacobi sweeps completed in the current phase
+     */
+    void write_checkpoint(const std::vector<std::size_t>& evaluations, const std::vector<std::size_t>& phase_evaluations,
+                          const std::vector<bool>& queued, std::size_t sweeps)
+    {
+        static_assert(std::is_trivially_copyable_v<AnalysisStatistics>);
+        FixpointCheckpoint<T> checkpoint;
+        std::unordered_map<const IntervalStore<T>*, std::uint32_t> stores;
+        std::unordered_map<const typename IntervalStore<T>::Page*, std::uint32_t> pages;
+        auto index_of = [&](const std::shared_ptr<IntervalStore<T>>& store) -> std::uint32_t {
+            if (store == nullptr)
+            {
+                return FixpointCheckpointHeader::NO_STORE;
+            }
+            auto [it, inserted] = stores.try_emplace(store.get(), static_cast<std::uint32_t>(checkpoint.stores.size()));
+            if (inserted)
+            {
+                typename FixpointCheckpoint<T>::Store saved;
+                saved.size = static_cast<std::uint32_t>(store->size());
+                for (const auto& page : store->pages())
+                {
+                    auto [page_it, new_page] = pages.try_emplace(page.get(), static_cast<std::uint32_t>(checkpoint.pages.size()));
+                    if (new_page)
+                    {
+                        checkpoint.pages.push_back(*page);
+                    }
+                    saved.pages.push_back(page_it->second);
+                }
+                checkpoint.stores.push_back(std::move(saved));
+            }
+            return it->second;
+        };
+
+        checkpoint.locations.resize(m_locations.size());
+        for (std::size_t index = 0; index < m_locations.size(); ++index)
+        {
+            const auto& location = *m_locations[index];
+            auto& saved = checkpoint.locations[index];
+            saved.evaluations = evaluations[index];
+            saved.phase_evaluations = phase_evaluations.empty() ? 0 : phase_evaluations[index];
+            for (std::size_t port = 0; port < STORE_PORTS; ++port)
+            {
+                saved.stores[port] = index_of(location.get_output_store(static_cast<StorePort>(port)));
+            }
+            saved.stores[STORE_PORTS] = FixpointCheckpointHeader::NO_STORE;
+            if (location.type() == LocationType::WHILE)
+            {
+                const auto& loop = static_cast<const WhileLocation<T>&>(location);
+                saved.stores[STORE_PORTS] = index_of(loop.m_store_head);
+                saved.ascending_steps = loop.m_ascending_steps;
+                saved.narrowing_steps = loop.m_narrowing_steps;
+            }
+            if (!queued.empty() && queued[index])
+            {
+                checkpoint.queued.push_back(static_cast<std::uint32_t>(index));
+            }
+        }
+        checkpoint.statistics.assign(reinterpret_cast<const char*>(&m_statistics), sizeof(m_statistics));
+
+        auto& header = checkpoint.header;
+        std::memcpy(header.magic, FixpointCheckpointHeader::MAGIC, sizeof(header.magic));
+        header.format = FixpointCheckpointHeader::FORMAT;
+        header.value_size = sizeof(T);
+        header.value_signed = std::is_signed_v<T> ? 1 : 0;
+        header.solver = static_cast<std::uint8_t>(m_solver_mode);
+        header.narrowing = m_phase == IterationPhase::NARROWING ? 1 : 0;
+        header.flags = checkpoint_flags();
+        header.program_hash = program_hash();
+        header.widening_delay = m_widening_delay;
+        header.narrowing_passes = m_narrowing_passes;
+        header.locations = m_locations.size();
+        header.sweeps = sweeps;
+        header.location_evaluations = m_location_evaluations;
+        header.queued = checkpoint.queued.size();
+        header.pages = checkpoint.pages.size();
+        header.stores = checkpoint.stores.size();
+        header.statistics_size = checkpoint.statistics.size();
+        if (checkpoint.write(m_checkpoint_path))
+        {
+            m_checkpoints++;
+        }
+        else
+        {
+            Logger::err() << "[ERROR] cannot write the checkpoint `" << m_checkpoint_path << "`." << std::endl;
+        }
+        m_last_checkpoint = std::chrono::steady_clock::now();
+    }
+
+    // Tells if a checkpoint was written by an analysis of this program with the same settings
+    bool resumable(const FixpointCheckpoint<T>& checkpoint) const
+    {
+        const auto& header = checkpoint.header;
+        if (header.solver != static_cast<std::uint8_t>(m_solver_mode) || header.flags != checkpoint_flags()
+            || header.program_hash != program_hash() || header.widening_delay != m_widening_delay
+            || header.narrowing_passes != m_narrowing_passes || header.locations != m_locations.size()
+            || header.statistics_size != sizeof(AnalysisStatistics) || !m_sweep.empty() || m_previous != nullptr)
+        {
+            return false;
+        }
+        for (const auto& store : checkpoint.stores)
+        {
+            if (store.size > m_variable_table->size() || store.pages.size() * IntervalStore<T>::PAGE_SIZE < store.size)
+            {
+                return false;
+            }
+        }
+        for (const auto& location : checkpoint.locations)
+        {
+            for (auto store : location.stores)
+            {
+                if (store != FixpointCheckpointHeader::NO_STORE && store >= checkpoint.stores.size())
+                {
+                    return false;
+                }
+            }
+        }
+        return std::all_of(checkpoint.queued.begin(), checkpoint.queued.end(), [this](auto index) { return index < m_locations.size(); });
+    }
+
+    // State of the solver at the checkpoint given to resume
+    struct ResumedIteration {
+        IterationPhase phase;
+        std::size_t sweeps;
+        std::vector<std::size_t> phase_evaluations;
+        std::vector<std::size_t> queued;
+    };
+
+    /**
+     * @brief Takes the state of the solver from the checkpoint given to resume, if any
+     * 
+     * @param evaluations set to the evaluations of every location at the checkpoint
+     * @return std::optional<ResumedIteration> 
+     */
+    std::optional<ResumedIteration> take_resumed(std::vector<std::size_t>& evaluations)
+    {
+        if (!m_resumed)
+        {
+            return std::nullopt;
+        }
+        ResumedIteration resumed{m_resumed->header.narrowing != 0 ? IterationPhase::NARROWING : IterationPhase::ASCENDING,
+                                 m_resumed->header.sweeps, {}, {}};
+        for (std::size_t index = 0; index < m_locations.size(); ++index)
+        {
+            evaluations[index] = m_resumed->locations[index].evaluations;
+            resumed.phase_evaluations.push_back(m_resumed->locations[index].phase_evaluations);
+        }
+        resumed.queued.assign(m_resumed->queued.begin(), m_resumed->queued.end());
+        m_resumed.reset();
+        return resumed;
+    }
+
+    struct PostconditionCones {
+        std::vector<std::size_t> locations;                 // of the postconditions that are not discharged, by slot
+        std::vector<std::uint32_t> slots;                   // all of them
+        std::vector<std::vector<std::uint32_t>> cones;      // locations of the cone of every slot
+        std::vector<std::vector<std::uint32_t>> watchers;   // slots whose cone holds every location
+        std::vector<bool> loops;                            // the cone holds a loop head, which narrowing changes
+        std::vector<std::size_t> queued;                    // locations of the cone of every slot in the worklist
+        std::vector<std::size_t> relevant;                  // undecided slots whose cone holds every location
+        std::vector<bool> decided;
+        std::size_t undecided = 0;
+    };
+
+    /**
+     * @brief Computes the cone of every postcondition by walking the dependencies of the locations backwards
+     * 
+     */
+    void build_postcondition_cones()
+    {
+        m_cones = std::make_unique<PostconditionCones>();
+        auto& cones = *m_cones;
+        cones.watchers.resize(m_locations.size());
+        cones.relevant.assign(m_locations.size(), 0);
+        std::vector<std::size_t> visited(m_locations.size(), 0);
+        std::vector<std::uint32_t> stack;
+        for (std::size_t index = 0; index < m_locations.size(); ++index)
+        {
+            if (m_locations[index]->type() != LocationType::POSTCONDITION
+                || static_cast<const PostConditionLocation<T>&>(*m_locations[index]).m_discharged)
+            {
+                continue;
+            }
+            auto slot = static_cast<std::uint32_t>(cones.locations.size());
+            cones.locations.push_back(index);
+            cones.slots.push_back(slot);
+            std::vector<std::uint32_t> cone;
+            bool loops = false;
+            stack.assign(1, static_cast<std::uint32_t>(index));
+            visited[index] = slot + 1;
+            while (!stack.empty())
+            {
+                auto location = stack.back();
+                stack.pop_back();
+                cone.push_back(location);
+                cones.watchers[location].push_back(slot);
+                cones.relevant[location]++;
+                loops = loops || m_locations[location]->type() == LocationType::WHILE;
+                for (const auto& dependency : m_cfg.predecessors(location))
+                {
+                    if (dependency.source != StoreDependency::ENTRY_LOCATION && visited[dependency.source] != slot + 1)
+                    {
+                        visited[dependency.source] = slot + 1;
+                        stack.push_back(static_cast<std::uint32_t>(dependency.source));
+                    }
+                }
+            }
+            cones.cones.push_back(std::move(cone));
+            cones.loops.push_back(loops);
+        }
+        cones.queued.assign(cones.locations.size(), 0);
+        cones.decided.assign(cones.locations.size(), false);
+        cones.undecided = cones.locations.size();
+    }
+
+    void queue_in_cones(std::size_t index, bool queued)
+    {
+        if (m_cones == nullptr)
+        {
+            return;
+        }
+        for (auto slot : m_cones->watchers[index])
+        {
+            m_cones->queued[slot] += queued ? 1 : std::size_t(-1);
+        }
+    }
+
+    /**
+     * @brief Decides the given postconditions whose cone is stable and final, and drops their cone from
+     * the locations to iterate
+     * 
+     * @param slots 
+     */
+    void decide_postconditions(const std::vector<std::uint32_t>& slots)
+    {
+        auto& cones = *m_cones;
+        for (auto slot : slots)
+        {
+            if (cones.decided[slot] || cones.queued[slot] > 0 || (m_phase == IterationPhase::ASCENDING && cones.loops[slot]))
+            {
+                continue;
+            }
+            LOG_TRACE << "  Postcondition at location " << cones.locations[slot] << " decided" << std::endl;
+            cones.decided[slot] = true;
+            cones.undecided--;
+            for (auto location : cones.cones[slot])
+            {
+                cones.relevant[location]--;
+            }
+        }
+    }
+
+    // Tells if the anytime mode stops the solver: every postcondition is decided or a budget is exceeded
+    bool anytime_done()
+    {
+        return m_cones != nullptr && (m_cones->undecided == 0 || budget_exceeded());
+    }
+
+    bool decided(std::size_t location) const
+    {
+        if (m_cones == nullptr)
+        {
+            return true;
+        }
+        auto it = std::lower_bound(m_cones->locations.begin(), m_cones->locations.end(), location);
+        return it == m_cones->locations.end() || *it != location || m_cones->decided[it - m_cones->locations.begin()];
+    }
+
+    // The loop heads of the parallel solver widen on several threads
+    void saturate()
+    {
+        std::atomic_ref<bool>(m_saturated).store(true, std::memory_order_relaxed);
+    }
+
+    static std::size_t max_evaluations(const std::vector<std::size_t>& evaluations)
+    {
+        return evaluations.empty() ? 0 : *std::max_element(evaluations.begin(), evaluations.end());
+    }
+
+    /**
+     * @brief Tells if a location that is not reused from a previous analysis is a loop head
+     * 
+     */
+    bool has_loops() const
+    {
+        return std::any_of(m_locations.begin() + m_reused_locations, m_locations.end(), [](const auto& loc) { return loc->type() == LocationType::WHILE; });
+    }
+
+    /**
+     * @brief Tells if every location that is not reused from a previous analysis only reads the locations
+     * before it, that is, if the part of the control-flow graph to solve has no back edge
+     * 
+     */
+    bool is_acyclic() const
+    {
+        for (auto index = m_reused_locations; index < m_locations.size(); ++index)
+        {
+            for (const auto& dependency : m_cfg.predecessors(index))
+            {
+                if (dependency.source != StoreDependency::ENTRY_LOCATION && dependency.source >= index)
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Returns the evaluation counters at the start of a solve. The locations reused from a previous
+     * analysis count as evaluated, so that their dependents read their stores.
+     * 
+     */
+    std::vector<std::size_t> initial_evaluations() const
+    {
+        std::vector<std::size_t> evaluations(m_locations.size(), 0);
+        std::fill(evaluations.begin(), evaluations.begin() + m_reused_locations, 1);
+        return evaluations;
+    }
+
+    /**
+     * @brief Feeds the inputs of a location with the current output stores of its sources
+     * 
+     * @param index 
+     * @param entry_store 
+     * @param evaluations 
+     */
+    void link_inputs(std::size_t index, std::shared_ptr<IntervalStore<T>>& entry_store, std::vector<std::size_t>& evaluations)
+    {
+        auto& loc = m_locations[index];
+        for (const auto& dependency : m_cfg.predecessors(index))
+        {
+            std::shared_ptr<IntervalStore<T>> store = nullptr;
+            if (dependency.source == StoreDependency::ENTRY_LOCATION)
+            {
+                store = entry_store;
+            }
+            else if (evaluations[dependency.source] > 0)
+            {
+                store = invariant(dependency.source, dependency.port);
+            }
+
+            loc->set_input(dependency.slot, std::move(store));
+        }
+    }
+
+    /**
+     * @brief Connects the location at the given index to the store that currently flows through the program,
+     * which then becomes the store produced by the location
+     * 
+     * @param index 
+     */
+    void connect_to_current_source(std::size_t index)
+    {
+        m_cfg.add_edge(index, {m_current_source, m_current_port, InputSlot::PREVIOUS});
+        m_current_source = index;
+        m_current_port = StorePort::LAST;
+    }
+
+    /**
+     * @brief Prints the stores of all the locations at the trace level
+     * 
+     * @param header 
+     */
+    void print_locations(const char* header) const
+    {
+        if (!Logger::enabled(LogLevel::TRACE))
+        {
+            return;
+        }
+        Logger::out() << "===================" << header << "===================" << std::endl;
+        for (std::size_t i = 0; i < m_locations.size(); ++i)
+        {
+            Logger::out() << "Location " << i << std::endl;
+            m_locations[i]->print();
+        }
+    }
+
+    /**
+     * @brief Checks if the system is stable, that is, if no location changed its stores during the last sweep
+     * 
+     * @return true 
+     * @return false 
+     */
+    bool is_stable()
+    {
+        for (std::size_t i = 0; i < m_locations.size(); ++i)
+        {
+            LOG_TRACE << " Location " << i;
+            if (m_locations[i]->has_changed())
+            {
+                LOG_TRACE << " not stable" << std::endl;
+                return false;
+            }
+            else 
+            {
+                LOG_TRACE << " stable" << std::endl;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Hashes the declarations and the preconditions of the program together, and every top-level
+     * statement after them on its own
+     * 
+     * @param header 
+     * @param statements 
+     */
+    void hash_program(std::uint64_t& header, std::vector<std::uint64_t>& statements) const
+    {
+        auto combine = [](std::uint64_t seed, std::uint64_t hash) { return (seed ^ hash) * 0x100000001b3ull; };
+        header = 0;
+        statements.clear();
+        auto blocks = m_ast.root().children();
+        std::size_t block = 0;
+        while (block < blocks.size() && (blocks[block].type() == NodeType::DECLARATION || blocks[block].type() == NodeType::FUNCTION))
+        {
+            header = combine(header, blocks[block++].hash());
+        }
+        if (block == blocks.size())
+        {
+            return;
+        }
+        auto sequence = blocks[block].children();
+        std::size_t statement = 0;
+        while (statement < sequence.size() && sequence[statement].type() == NodeType::PRE_CON)
+        {
+            header = combine(header, sequence[statement++].hash());
+        }
+        for (; statement < sequence.size(); ++statement)
+        {
+            statements.push_back(sequence[statement].hash());
+        }
+    }
+
+    /**
+     * @brief Counts the leading top-level statements that did not change since the previous analysis. If
+     * there are any, the build then interns the variables in the table of the previous analysis, truncated
+     * to the variables of those statements: it is the table the build would create anyway, since the same
+     * statements intern the same variables in the same order, and the reused stores can be compared with
+     * the new ones without translating identifiers.
+     * 
+     * @return std::size_t 
+     */
+    std::size_t share_variables_with_previous()
+    {
+        const auto& previous = *m_previous;
+        if (previous.m_solver_mode != m_solver_mode || previous.m_widening_delay != m_widening_delay
+            || previous.m_narrowing_passes != m_narrowing_passes || previous.m_sparse != m_sparse || previous.m_slice != m_slice
+            || previous.m_prefilter != m_prefilter
+            || previous.m_statistics.budget_exceeded != BudgetExceeded::NONE)
+        {
+            return 0;
+        }
+
+        std::uint64_t header;
+        std::vector<std::uint64_t> statements;
+        hash_program(header, statements);
+        if (header != previous.m_header_hash)
+        {
+            return 0;
+        }
+        std::size_t unchanged = 0;
+        while (unchanged < statements.size() && unchanged < previous.m_statements.size()
+               && statements[unchanged] == previous.m_statements[unchanged].hash)
+        {
+            unchanged++;
+        }
+        if (unchanged == 0)
+        {
+            return 0;
+        }
+
+        m_variable_table = previous.m_variable_table;
+        m_variable_table->truncate(previous.m_statements[unchanged - 1].variables);
+        m_precondition_store = IntervalStore<T>(m_variable_table);
+        return unchanged;
+    }
+
+    /**
+     * @brief Gives the locations of the unchanged statements the stores of the previous analysis, and
+     * releases the previous analysis
+     * 
+     * @param unchanged the number of unchanged top-level statements
+     */
+    void adopt_previous_fixpoint(std::size_t unchanged)
+    {
+        auto previous = std::move(m_previous);
+        if (unchanged > 0 && previous->m_thresholds != m_thresholds)
+        {
+            // The loops of the previous analysis were widened with other thresholds
+            for (std::size_t statement = 0; statement < unchanged; ++statement)
+            {
+                auto begin = statement == 0 ? 0 : m_statements[statement - 1].locations;
+                auto end = m_statements[statement].locations;
+                if (std::any_of(m_locations.begin() + begin, m_locations.begin() + end, [](const auto& loc) { return loc->type() == LocationType::WHILE; }))
+                {
+                    unchanged = statement;
+                    break;
+                }
+            }
+        }
+
+        m_reused_locations = unchanged > 0 ? m_statements[unchanged - 1].locations : 0;
+        assert(m_reused_locations <= previous->m_locations.size() && "unchanged statements build the same locations");
+        for (std::size_t i = 0; i < m_reused_locations; ++i)
+        {
+            m_locations[i]->adopt_stores(*previous->m_locations[i]);
+        }
+        if (m_variable_table == previous->m_variable_table)
+        {
+            // The reused stores are canonical instances of the previous pool
+            m_store_pool = std::move(previous->m_store_pool);
+        }
+        LOG_TRACE << "[INFO] Reused " << m_reused_locations << " locations of the previous analysis" << std::endl;
     }
 
     /**
-     * @brief Executes the analysis of the program passed as input
+     * @brief Adds the lanes of the configurations of the sweep to the variables, and sets their preconditions
+     * and widening thresholds. The first configuration takes the variables of the program themselves.
      * 
      */
-    void run()
+    void expand_lanes()
     {
-        std::size_t it_count = 0;
-        // First, build the equational system
-        build_equational_system();
-
-        print_equational_system();
-
-        // Then, perform the fixpoint iteration (here it's pretty verbose)
-        do {
-            std::cout << "===================Iteration " << it_count++ << "===================" << std::endl;
-            copy_locations();
-            std::cout << "===================OLD LOCATIONS===================" << std::endl;
-            for (std::size_t i = 0; i < m_old_locations.size(); ++i)
-            {
-                std::cout << "Location " << i << std::endl;
-                m_old_locations[i]->print();
-            }   
-            std::cout << "===================JACOBI ITERATION===================" << std::endl;
-            solve_system();
-            std::cout << "===================NEW LOCATIONS===================" << std::endl;
-            for (std::size_t i = 0; i < m_locations.size(); ++i)
+        m_lanes = m_sweep.size();
+        m_lane_width = m_variable_table->size();
+        for (std::size_t lane = 1; lane < m_lanes; ++lane)
+        {
+            for (std::size_t id = 0; id < m_lane_width; ++id)
             {
-                std::cout << "Location " << i << std::endl;
-                m_locations[i]->print();
+                m_variable_table->intern(m_variable_table->name(id) + "@" + std::to_string(lane));
             }
+        }
 
-            std::cout << "|CHECKING STABILITY|====================" << std::endl;
-        } while (!is_stable());
-
-        // Finally, evaluate all the postconditions
-        should_evaluate_postcondition = true;
-        std::cout << "|EVALUATING POSTCONDITIONS|===================" << std::endl;
-        evaluate_postconditions();
-        std::cout << "===================COMPLETED===================" << std::endl;
-        std::cout << "Fixpoint iterations: " << it_count << std::endl;
-
+        auto program = m_precondition_store;
+        m_precondition_store = IntervalStore<T>(m_variable_table);
+        m_lane_thresholds.assign(m_lanes, m_thresholds);
+        m_lane_verdicts.assign(m_lanes, {});
+        for (std::size_t lane = 0; lane < m_lanes; ++lane)
+        {
+            auto offset = lane * m_lane_width;
+            for (std::size_t id = 0; id < m_lane_width; ++id)
+            {
+                m_precondition_store.set(id + offset, program.get(id));
+            }
+            for (const auto& [name, interval] : m_sweep[lane])
+            {
+                auto id = m_variable_table->find(name);
+                if (id == VariableTable::npos || id >= m_lane_width)
+                {
+                    throw AnalysisError("configuration " + std::to_string(lane) + " of the sweep sets `" + name + "`, which is not a variable of the program");
+                }
+                m_precondition_store.set(id + offset, interval);
+                add_threshold(m_lane_thresholds[lane], interval.lb());
+                add_threshold(m_lane_thresholds[lane], interval.ub());
+            }
+            auto& thresholds = m_lane_thresholds[lane];
+            std::sort(thresholds.begin(), thresholds.end());
+            thresholds.erase(std::unique(thresholds.begin(), thresholds.end()), thresholds.end());
+        }
+        LOG_TRACE << "[INFO] Sweeping " << m_lanes << " configurations" << std::endl;
     }
 
-private:
-
     /**
-     * @brief Performs a deep copy of the locations
+     * @brief Hash-conses the subterms of the expressions of all the locations into m_shared_subterms. The
+     * threads of the parallel sweeps would evaluate the same subterms concurrently, so they are not shared.
      * 
      */
-    void copy_locations()
+    void share_subterms()
     {
-        m_old_locations.clear();
-        for (std::size_t i = 0; i < m_locations.size(); ++i)
+        m_shared_subterms.reset();
+        if (m_solver_mode == SolverMode::PARALLEL)
         {
-            std::cout << "  Copying location " << i << std::endl;
-            auto& loc = m_locations[i];
-            m_old_locations.push_back(copy_location(loc));
+            return;
         }
+        std::vector<CompiledExpression<T>*> expressions;
+        for (auto& location : m_locations)
+        {
+            switch (location->type())
+            {
+                case LocationType::ASSIGNMENT:
+                {
+                    auto& assignment = static_cast<AssignmentLocation<T>&>(*location);
+                    expressions.push_back(&assignment.m_expression);
+                    for (auto& argument : assignment.m_arguments)
+                    {
+                        expressions.push_back(&argument);
+                    }
+                    break;
+                }
+                case LocationType::POSTCONDITION:
+                {
+                    auto& postcondition = static_cast<PostConditionLocation<T>&>(*location);
+                    expressions.push_back(&postcondition.m_lhs);
+                    expressions.push_back(&postcondition.m_rhs);
+                    break;
+                }
+                case LocationType::IFELSE:
+                {
+                    expressions.push_back(&static_cast<IfElseLocation<T>&>(*location).m_condition.rhs);
+                    break;
+                }
+                case LocationType::WHILE:
+                {
+                    expressions.push_back(&static_cast<WhileLocation<T>&>(*location).m_condition.rhs);
+                    break;
+                }
+                default:
+                {
+                    break;
+                }
+            }
+        }
+        m_shared_subterms = std::make_unique<SharedSubterms<T>>();
+        m_shared_subterms->share(expressions);
+        LOG_TRACE << "[INFO] Shared " << m_shared_subterms->size() << " subterms" << std::endl;
     }
 
     /**
-     * @brief Performs a deep copy of a single location
+     * @brief Folds the constants and cancels the identities and negations of the expressions of the AST
+     * (see ASTSimplifier), before the equational system is built from it
      * 
-     * @param src 
-     * @return std::unique_ptr<Location<T>> 
      */
-    std::unique_ptr<Location<T>> copy_location(std::unique_ptr<Location<T>>& src)
+    void simplify_ast()
     {
-        // copy the internal
-        std::unique_ptr<Location<T>> copy;
-        copy = std::move(src->copy());
-
-        return copy;
+        ASTSimplifier<T> simplifier(m_ast);
+        m_ast = simplifier.simplify();
+        m_statistics.simplifications = simplifier.rewrites();
+        LOG_TRACE << "[INFO] Rewrote " << m_statistics.simplifications << " expressions" << std::endl;
     }
 
     /**
-     * @brief Checks if a location is stable, that is, if the store of the current and previous iteration are the same
+     * @brief Marks the postconditions that hold in the constant or in the sign domain, or in the octagons
+     * of the packs of the program for a signed T
      * 
-     * @return true 
-     * @return false 
      */
-    bool is_stable()
+    void prefilter_ast()
     {
-        for (std::size_t i = 0; i < m_locations.size(); ++i)
+        m_discharged.assign(m_ast.size(), false);
+        if constexpr (std::is_integral_v<T>)
         {
-            std::cout << " Location " << i;
-            std::flush(std::cout);
-            if (!m_locations[i]->is_stable(m_old_locations[i]))
+            auto constants = DomainAnalysis<ConstantDomain<T>>(m_ast).run();
+            auto signs = DomainAnalysis<SignDomain<T>>(m_ast).run();
+            std::vector<bool> octagons(m_ast.size(), false);
+            if constexpr (std::is_signed_v<T>)
             {
-                std::cout << " not stable" << std::endl;
-                return false;
+                octagons = PackedDomainAnalysis<OctagonDomain<T>>(m_ast).run();
             }
-            else 
+            for (std::size_t node = 0; node < m_discharged.size(); ++node)
             {
-                std::cout << " stable" << std::endl;
+                m_discharged[node] = constants[node] || signs[node] || octagons[node];
             }
         }
-        return true;
+        m_statistics.discharged_postconditions = std::count(m_discharged.begin(), m_discharged.end(), true);
+        LOG_TRACE << "[INFO] Discharged " << m_statistics.discharged_postconditions << " postconditions" << std::endl;
+    }
+
+    /**
+     * @brief Replaces the AST with its slice with respect to the postconditions
+     * 
+     */
+    void slice_ast()
+    {
+        ProgramSlicer slicer(m_ast, m_prefilter ? &m_discharged : nullptr);
+        if (auto slice = slicer.slice())
+        {
+            if (m_prefilter)
+            {
+                std::vector<bool> discharged(slice->size(), false);
+                for (std::size_t node = 0; node < m_discharged.size(); ++node)
+                {
+                    auto copy = slicer.copy_of(static_cast<FlatAST::Index>(node));
+                    if (m_discharged[node] && copy.has_value())
+                    {
+                        discharged[*copy] = true;
+                    }
+                }
+                m_discharged = std::move(discharged);
+            }
+            m_ast = std::move(*slice);
+            m_statistics.sliced_statements = slicer.statements() - slicer.kept_statements();
+            LOG_TRACE << "[INFO] Kept " << slicer.kept_statements() << " of " << slicer.statements() << " statements in the slice" << std::endl;
+        }
     }
 
     /**
@@ -194,50 +2689,74 @@ private:
     void build_equational_system()
     {
 
-        std::cout << "|VARIABLES AND PRECONDITIONS|========" << std::endl;
+        LOG_TRACE << "|VARIABLES AND PRECONDITIONS|========" << std::endl;
 
-        // First, we get all the variables
-        assert(m_ast.children[0].type == NodeType::DECLARATION);
-        auto code_blocks = m_ast.children;
+        // First, we get all the variables, and the functions defined among them
+        auto code_blocks = m_ast.root().children();
+        if (m_functions == nullptr)
+        {
+            m_functions = std::make_shared<FunctionTable<T>>();
+        }
 
         auto decl_count = 0;
-        auto decl_block_count = 0;
-        while(code_blocks[decl_block_count].type == NodeType::DECLARATION)
+        std::size_t decl_block_count = 0;
+        while(decl_block_count < code_blocks.size()
+              && (code_blocks[decl_block_count].type() == NodeType::DECLARATION || code_blocks[decl_block_count].type() == NodeType::FUNCTION))
         {
-            for (const auto& new_variable_block : code_blocks[decl_block_count].children)
+            if (code_blocks[decl_block_count].type() == NodeType::FUNCTION)
+            {
+                LOG_TRACE << "[INFO] Adding function " << code_blocks[decl_block_count].text() << std::endl;
+                m_functions->add(m_ast, code_blocks[decl_block_count]);
+                decl_block_count++;
+                continue;
+            }
+            for (auto new_variable_block : code_blocks[decl_block_count].children())
             {
                 add_variable(new_variable_block);
                 decl_count++;
             }
             decl_block_count++;
         }
-        std::cout << "[INFO] Declared " << decl_count << " variables" << std::endl;
+        for (const auto& [name, interval] : m_arguments)
+        {
+            m_precondition_store.set(m_variable_table->intern(name), interval);
+        }
+        LOG_TRACE << "[INFO] Declared " << decl_count << " variables" << std::endl;
 
-        // Advance to the next block, which should be a sequence block
-        auto code_block = m_ast.children[decl_block_count];
-        assert(code_block.type == NodeType::SEQUENCE && "Expected a sequence block");
-        code_blocks = code_block.children;
+        // Advance to the next block, which should be the main block
+        if (decl_block_count + 1 != code_blocks.size() || code_blocks[decl_block_count].type() != NodeType::SEQUENCE)
+        {
+            throw AnalysisError("unsupported program: a program is made of declarations and functions followed by the main block");
+        }
+        code_blocks = code_blocks[decl_block_count].children();
 
         // Then, we register all the preconditions
-        std::cout << "[INFO] Introducting preconditions" << std::endl;
-        auto prec_count = 0;
-        while(code_blocks[prec_count].type == NodeType::PRE_CON)
+        LOG_TRACE << "[INFO] Introducting preconditions" << std::endl;
+        std::size_t prec_count = 0;
+        while(prec_count < code_blocks.size() && code_blocks[prec_count].type() == NodeType::PRE_CON)
         {
-            for (const auto& prec : code_blocks[prec_count].children)
+            for (auto prec : code_blocks[prec_count].children())
             {
                 add_precondition(prec);
             }
             prec_count++;
         }
-        std::cout << "[INFO] Added " << prec_count << " preconditions" << std::endl;
+        LOG_TRACE << "[INFO] Added " << prec_count << " preconditions" << std::endl;
 
         // Finally, we construct the locations by traversing the AST
-        std::cout << "|CONSTRUCTING LOCATIONS|==============" << std::endl;  
-        for (int i = prec_count; i < code_blocks.size(); i++)
+        LOG_TRACE << "|CONSTRUCTING LOCATIONS|==============" << std::endl;  
+        std::vector<std::uint64_t> statement_hashes;
+        hash_program(m_header_hash, statement_hashes);
+        for (std::size_t i = prec_count; i < code_blocks.size(); i++)
         {
-            auto block = code_blocks[i];
-            manage_block(block);
+            manage_block(code_blocks[i]);
+            m_statements.push_back({statement_hashes[i - prec_count], m_locations.size(), m_variable_table->size()});
         }
+
+        std::sort(m_thresholds.begin(), m_thresholds.end());
+        m_thresholds.erase(std::unique(m_thresholds.begin(), m_thresholds.end()), m_thresholds.end());
+
+        m_cfg.finalize(m_locations.size());
     }
 
     /**
@@ -246,9 +2765,9 @@ private:
      * @param block 
      * @param fallback_location 
      */
-    void manage_block(ASTNode& block, std::shared_ptr<Location<T>> fallback_location = nullptr)
+    void manage_block(FlatAST::Node block, std::shared_ptr<Location<T>> fallback_location = nullptr)
     {
-        switch(block.type)
+        switch(block.type())
         {
 
             case NodeType::ASSIGNMENT:
@@ -259,40 +2778,30 @@ private:
                 * 
                 */
                 
-                std::cout << "[INFO] Assignment block" << std::endl;
+                LOG_TRACE << "[INFO] Assignment block" << std::endl;
                 auto assignment_loc = std::make_unique<AssignmentLocation<T>>();
 
                 assignment_loc->m_store_before = std::make_shared<IntervalStore<T>>();
                 assignment_loc->m_store_after = std::make_shared<IntervalStore<T>>();
                 assignment_loc->m_fallback_location = fallback_location;
 
-                assignment_loc->m_code_block = block;
-                
-                assignment_loc->m_operation = [ptr=assignment_loc.get(), this](void) -> void {
-                    // ptr->m_code_block.print();
-                    std::cout << "-------EVALUATING ASSIGNMENT-------" << std::endl;
-                    auto store = *(ptr->m_store_before);
-                    store.print();
-
-                    auto lhs = ptr->m_code_block.children[0];
-                    auto rhs = ptr->m_code_block.children[1];
-
-                    std::string var = std::get<std::string>(lhs.value);
-                    auto interval = evaluate_expression(rhs, store);
-
-                    // print the interval 
-                    std::cout << "Interval of " << var << ": [" << interval.lb() << ", " << interval.ub() << "]" << std::endl;
-                    // Modify the interval in the store
-                    ptr->m_store_after = std::make_shared<IntervalStore<T>>(store);
-                    ptr->m_store_after->set(var, interval);
-                    
-
-                };
+                assignment_loc->m_code_block = block.index();
+                assignment_loc->m_variable = m_variable_table->intern(block.child(0).text());
+                if (block.child(1).type() == NodeType::CALL)
+                {
+                    compile_call(*assignment_loc, block.child(1));
+                }
+                else
+                {
+                    assignment_loc->m_expression = CompiledExpression<T>::compile(block.child(1), *m_variable_table);
+                }
             
                 std::unique_ptr<Location<T>> loc = std::move(assignment_loc);
                 m_locations.push_back(std::move(loc));
+                m_location_parents.push_back(m_enclosing.empty() ? ProfiledLocation::TOP_LEVEL : m_enclosing.back());
                 m_location_counter++;
-                std::cout << "[INFO] Added Assignment Location. Counter: " << m_location_counter << std::endl;
+                connect_to_current_source(m_location_counter - 1);
+                LOG_TRACE << "[INFO] Added Assignment Location. Counter: " << m_location_counter << std::endl;
 
                 break;
             }
@@ -301,57 +2810,27 @@ private:
                 /**
                  * A postcondition location is not directly considered by the equational semantics, but is extremely well suited
                  * in this situation. We introduce a location with a single store as we don't perform any modification of the variables.
-                 * The evaluation of the postconsition, embedded in the operation, is executed only after the fixpoint iteration
+                 * The evaluation of the postcondition, in its transfer function, is executed only after the fixpoint iteration
                  * terminates.
                  */
 
-                std::cout << "[INFO] Postcondition block" << std::endl;
+                LOG_TRACE << "[INFO] Postcondition block" << std::endl;
                 auto postcondition_loc = std::make_unique<PostConditionLocation<T>>();
 
                 postcondition_loc->m_store = std::make_shared<IntervalStore<T>>();
                 
-                postcondition_loc->m_code_block = block;
+                postcondition_loc->m_code_block = block.index();
+                compile_postcondition(*postcondition_loc, block.child(0));
+                postcondition_loc->m_discharged = !m_discharged.empty() && m_discharged[block.index()];
 
                 postcondition_loc->m_fallback_location = fallback_location;
 
-                postcondition_loc->m_operation = [ptr = postcondition_loc.get(), this](void) -> void {
-
-                    std::cout << "-------EVALUATING POSTCONDITION-------" << std::endl;
-
-                    auto store = *(ptr->m_store);
-                    auto postcondition = ptr->m_code_block.children[0];
-
-                    auto lhs = postcondition.children[0];
-                    auto rhs = postcondition.children[1];
-
-                    auto op = std::get<LogicOp>(postcondition.value);
-
-                    auto left = evaluate_expression(lhs, store);
-                    auto right = evaluate_expression(rhs, store);
-
-                    if (should_evaluate_postcondition)
-                    {
-                        auto eval = evaluate_logic_operation(left, right, op);
-
-                        if (eval)
-                        {
-                            std::cout << "Postcondition satisfied" << std::endl;
-                        }
-                        else
-                        {
-                            std::cerr << "Postcondition not satisfied" << std::endl;
-                        }
-                    }
-                    else
-                    {
-                        std::cout << "Postcondition not evaluated" << std::endl;
-                    }
-                };
-                
                 std::unique_ptr<Location<T>> loc = std::move(postcondition_loc);
                 m_locations.push_back(std::move(loc));
+                m_location_parents.push_back(m_enclosing.empty() ? ProfiledLocation::TOP_LEVEL : m_enclosing.back());
                 m_location_counter++;
-                std::cout << "[INFO] Added Postcondition Location. Counter: " << m_location_counter << std::endl;
+                connect_to_current_source(m_location_counter - 1);
+                LOG_TRACE << "[INFO] Added Postcondition Location. Counter: " << m_location_counter << std::endl;
                 break;
             }
             case NodeType::IFELSE:
@@ -365,177 +2844,88 @@ private:
                  * two bodies of the if case.
                  * 
                  */
-                std::cout << "[INFO] If-else block" << std::endl;
+                LOG_TRACE << "[INFO] If-else block" << std::endl;
                 auto ifelse_loc = std::make_unique<IfElseLocation<T>>();
 
                 ifelse_loc->m_store_before_condition = std::make_shared<IntervalStore<T>>();
                 ifelse_loc->m_store_if_body = std::make_shared<IntervalStore<T>>();
                 ifelse_loc->m_store_else_body = std::make_shared<IntervalStore<T>>();
                 ifelse_loc->m_fallback_location = fallback_location;
-                ifelse_loc->m_code_block = block;
-
-                auto m_store_else_body_copy = ifelse_loc->m_store_else_body; 
-
-                auto exists_else_block = block.children.size() == 3;
-
-                ifelse_loc->m_operation = [ptr = ifelse_loc.get(), this](void) -> void {
-                    std::cout << "-------EVALUATING IF-ELSE-------" << std::endl;
-                    
-                    auto empty_if_body = false;
-                    auto empty_else_body = false;
-
-                    auto store = *(ptr->m_store_before_condition);
-                    
-                    auto exists_else = ptr->m_code_block.children.size() == 3;
-                    auto condition_block = ptr->m_code_block.children[0].children;
-                    auto condition = condition_block[0];
-                    auto if_body = ptr->m_code_block.children[1];
-
-                    // Start by evaluating the condition and restricting the store
-                    auto lhs = condition.children[0];
-                    auto rhs = condition.children[1];
-                    auto var = std::get<std::string>(lhs.value);
-                    auto op = std::get<LogicOp>(condition.value);
-
-                    assert(lhs.type == NodeType::VARIABLE && "UNEXPECTED EXPRESSION ON LHS");
-                    auto rhs_interval = evaluate_expression(rhs, store);
-
-                    std::cout << "If condition: " << var << " " << op << " [" << rhs_interval.lb() << ", " << rhs_interval.ub() << "]" << std::endl; 
-
-                    auto if_body_store = apply_command_to_store(store, var, rhs_interval, op);
-                    if (if_body_store.get(var).is_empty())
-                    {
-                        empty_if_body = true;
-                    }
-                    else
-                    {
-                         if_body_store.print();
-                    }
-
-                    ptr->m_store_if_body = std::make_shared<IntervalStore<T>>(if_body_store);
-                    m_if_body_stores_queue.push(ptr->m_store_if_body);
-
-                    ptr->m_store_if_body->print();
-
-                    auto complementary_op = extract_complementary_op(op);
-                    auto rhs_interval_else = evaluate_expression(rhs, store);
-                    auto else_body_store = apply_command_to_store(store, var, rhs_interval_else, complementary_op);
-                    
-
-                    std::cout << "Else condition: " << var << " " << complementary_op << " [" << rhs_interval_else.lb() << ", " << rhs_interval_else.ub() << "]" << std::endl;
-                    else_body_store.print();
-                    ptr->m_store_else_body = std::make_shared<IntervalStore<T>>(else_body_store);
-                    m_else_body_stores_queue.push(ptr->m_store_else_body);
-
-                    if (!exists_else)
-                    {
-                        m_final_else_body_stores_queue.push(ptr->m_store_else_body);
-                    } 
-
-                    if (else_body_store.get(var).is_empty())
-                    {
-                        empty_else_body = true;
-                    }
-                    else
-                    {
-                        else_body_store.print();
-                    }
-                    
-                    if (empty_if_body && empty_else_body)
-                    {
-                        std::cerr << "[WARNING] Both branches are empty for variable " << var << std::endl; 
-                    }
-                    else if (empty_if_body)
-                    {
-                        std::cerr << "[WARNING] If body branch is empty for variable " << var << std::endl;
-                    }
-                    else if (empty_else_body)
-                    {
-                        std::cerr << "[WARNING] Else body branch is empty for variable " << var << std::endl;
-                    }
+                ifelse_loc->m_code_block = block.index();
+                ifelse_loc->m_condition = CompiledCondition<T>::compile(block.child(0).child(0), *m_variable_table);
 
-                    std::cout << "If header completed" << std::endl;
-                };
+                auto exists_else_block = block.size() == 3;
 
                 std::unique_ptr<Location<T>> loc = std::move(ifelse_loc);
                 m_locations.push_back(std::move(loc));
+                m_location_parents.push_back(m_enclosing.empty() ? ProfiledLocation::TOP_LEVEL : m_enclosing.back());
                 m_location_counter++;
-                std::cout << "[INFO] Added If Else Location. Counter: " << m_location_counter << std::endl; 
+                LOG_TRACE << "[INFO] Added If Else Location. Counter: " << m_location_counter << std::endl; 
+
+                auto ifelse_index = m_location_counter - 1;
+                connect_to_current_source(ifelse_index);
+                m_enclosing.push_back(ifelse_index);
+                m_current_port = StorePort::IF_BODY;
 
 
                 // Check, recusively, the if branch
-                std::cout << "[INFO] Entering the if body" << std::endl;
-                auto if_body_blocks = block.children[1].children;
+                LOG_TRACE << "[INFO] Entering the if body" << std::endl;
+                auto if_body_blocks = block.child(1).children();
                 auto if_body_block = if_body_blocks[0];
 
                 // In the case of a sequence, get to the children
-                if (if_body_block.type == NodeType::SEQUENCE)
-                    if_body_blocks = if_body_block.children;
+                if (if_body_block.type() == NodeType::SEQUENCE)
+                    if_body_blocks = if_body_block.children();
 
                 for (std::size_t i = 0; i < if_body_blocks.size(); ++i)
                 {
                     manage_block(if_body_blocks[i]);
                 }
 
-                auto last_location_offset = m_location_counter;
-                std::cout << last_location_offset << std::endl;
-
-                auto last_if_body_location_store = m_locations[last_location_offset - 1]->get_last_store();
-                m_locations[last_location_offset - 1]->ends_if_body = true;
+                StoreDependency final_if_body = {m_current_source, m_current_port, InputSlot::FINAL_IF_BODY};
+                m_current_source = ifelse_index;
+                m_current_port = StorePort::ELSE_BODY;
 
-                // If it exists, check the if branch                
-                std::shared_ptr<IntervalStore<T>> last_else_body_location_store = nullptr;
+                // If it exists, check the else branch
                 if (exists_else_block)
                 {
-                    std::cout << "[INFO] Checking else block" << std::endl;
-                    auto else_body_blocks = block.children[2].children;
+                    LOG_TRACE << "[INFO] Checking else block" << std::endl;
+                    auto else_body_blocks = block.child(2).children();
                     auto else_body_block = else_body_blocks[0];
 
                     // else_body_block.print();
-                    if (else_body_block.type == NodeType::SEQUENCE)
-                        else_body_blocks = else_body_block.children;
+                    if (else_body_block.type() == NodeType::SEQUENCE)
+                        else_body_blocks = else_body_block.children();
                     
                     for (std::size_t i = 0; i < else_body_blocks.size(); ++i)
                     {
                         // else_body_blocks[i].print();
                         manage_block(else_body_blocks[i]);
                     }
-
-                    last_location_offset = m_location_counter;
-                    std::cout << last_location_offset << std::endl;
-                    last_else_body_location_store = m_locations[last_location_offset - 1]->get_last_store();
-                    m_locations[last_location_offset - 1]->ends_else_body = true;
-                }
-
-                if (last_else_body_location_store == nullptr)
-                {
-                    last_else_body_location_store = m_store_else_body_copy;
                 }
 
-                std::cout << "[INFO] If closure location" << std::endl;
+                LOG_TRACE << "[INFO] If closure location" << std::endl;
+                m_enclosing.pop_back();
                 auto endif_loc = std::make_unique<EndIfLocation<T>>();
+                endif_loc->m_code_block = block.index();
                 endif_loc->m_store_before = nullptr;
-                endif_loc->m_store_after_body = last_if_body_location_store;
-                endif_loc->m_store_after_else = last_else_body_location_store;
+                endif_loc->m_store_after_body = nullptr;
+                endif_loc->m_store_after_else = nullptr;
                 endif_loc->m_store_after = nullptr;
 
-                endif_loc->m_operation = [ptr = endif_loc.get(), this](void) -> void {
-                    std::cout << "Finalizing if statement" << std::endl;
-                    auto if_body_store = *(ptr->m_store_after_body);
-                    auto else_body_store = *(ptr->m_store_after_else);
-
-                    // Copy the if body store to the after store
-                    ptr->m_store_after = std::make_shared<IntervalStore<T>>(if_body_store);
-                    // And join that with the else store
-                    ptr->m_store_after->joinAll(else_body_store);
-                    std::cout << "Store after if-else" << std::endl;
-                    ptr->m_store_after->print();
-                };
+                StoreDependency final_else_body = {m_current_source, m_current_port, InputSlot::FINAL_ELSE_BODY};
+                collect_modified_variables(block, endif_loc->m_modified);
 
                 std::unique_ptr<Location<T>> end_loc = std::move(endif_loc);
                 m_locations.push_back(std::move(end_loc));
+                m_location_parents.push_back(m_enclosing.empty() ? ProfiledLocation::TOP_LEVEL : m_enclosing.back());
                 m_location_counter++;
-                std::cout << "[INFO] Added If Closure Location. Counter: " << m_location_counter << std::endl; 
+
+                m_cfg.add_edge(m_location_counter - 1, final_if_body);
+                m_cfg.add_edge(m_location_counter - 1, final_else_body);
+                m_current_source = m_location_counter - 1;
+                m_current_port = StorePort::LAST;
+                LOG_TRACE << "[INFO] Added If Closure Location. Counter: " << m_location_counter << std::endl; 
                 break;
             }
             case NodeType::WHILELOOP:
@@ -555,126 +2945,128 @@ private:
                 while_loc->m_store_body = std::make_shared<IntervalStore<T>>();
                 while_loc->m_store_exit = std::make_shared<IntervalStore<T>>();
 
-                while_loc->m_code_block = block;
-
-                while_loc->m_operation = [ptr = while_loc.get(), this](void) -> void {
-                    std::cout << "-------EVALUATING WHILE-------" << std::endl;
-                    
-                    // ptr->m_code_block.print();
-
-                    auto store = *(ptr->m_store_before_condition);
-                    store.print();
-                    auto condition_blocks = ptr->m_code_block.children[0];
-
-                    auto condition = condition_blocks.children[0];
-
-                    auto var = std::get<std::string>(condition.children[0].value);
-                    auto op = std::get<LogicOp>(condition.value);
-                    auto rhs = condition.children[1];
-
-                    auto rhs_interval = evaluate_expression(rhs, store);
-                    std::cout << "While Condition " << var << " " << op << " [" << rhs_interval.lb() << ", " << rhs_interval.ub() << "]" << std::endl;
-
-                    auto while_body_store = IntervalStore<T>(store);
-                    if (m_final_while_body_stores_queue.empty())
-                    {
-                        std::cerr << "No feedback store yet" << std::endl;
-                    } 
-                    else
-                    {
-                        auto feedback_store_ptr = m_final_while_body_stores_queue.front();
-                        auto feedback_store = *feedback_store_ptr;
-                        while_body_store.joinAll(feedback_store);
-                        m_final_while_body_stores_queue.pop();
-                    }
-
-                    auto while_body_store_restricted = apply_command_to_store(while_body_store, var, rhs_interval, op);
-                    if (should_perform_widening)
-                    {   
-                        auto widened_store = widen(store, while_body_store, var);
-                        while_body_store_restricted = widened_store;
-                        std::cout << "Performing widening" << std::endl;
-                        while_body_store_restricted = apply_command_to_store(widened_store, var, rhs_interval, op);
-                        std::cout << "Widened store" << std::endl;
-                        widened_store.print();
-                    } 
-
-
-                    ptr->m_store_body = std::make_shared<IntervalStore<T>>(while_body_store_restricted);
-                    std::cout << "Applying condition to store" << std::endl;
-                    ptr->m_store_body->print();
-                    m_while_body_stores_queue.push(ptr->m_store_body);
-            
-                    auto complementary_op = extract_complementary_op(op);
-
-                    std::cout << "Complementary while condition " << var << " " << complementary_op << " [" << rhs_interval.lb() << ", " << rhs_interval.ub() << "]" << std::endl;
-
-                    auto while_exit_store = apply_command_to_store(while_body_store, var, rhs_interval, complementary_op);
-                    ptr->m_store_exit = std::make_shared<IntervalStore<T>>(while_exit_store);
-
-                    m_while_exit_stores_queue.push(ptr->m_store_exit);
-
-                    std::cout << "Finished while header" << std::endl;
-                };
+                while_loc->m_code_block = block.index();
+                while_loc->m_condition = CompiledCondition<T>::compile(block.child(0).child(0), *m_variable_table);
+                for (auto constant : while_loc->m_condition.rhs.constants())
+                {
+                    add_threshold(constant);
+                }
 
                 std::unique_ptr<Location<T>> loc = std::move(while_loc);
                 m_locations.push_back(std::move(loc));
+                m_location_parents.push_back(m_enclosing.empty() ? ProfiledLocation::TOP_LEVEL : m_enclosing.back());
                 m_location_counter++;
-                std::cout << "[INFO] Added While Location. Counter: " << m_location_counter << std::endl;
+                LOG_TRACE << "[INFO] Added While Location. Counter: " << m_location_counter << std::endl;
+
+                auto while_index = m_location_counter - 1;
+                connect_to_current_source(while_index);
+                m_enclosing.push_back(while_index);
+                m_current_port = StorePort::WHILE_BODY;
 
                 // Check, recursively, the while body.
-                std::cout << "[INFO] Entering While Body" << std::endl;
+                LOG_TRACE << "[INFO] Entering While Body" << std::endl;
 
-                auto while_body_blocks = block.children[1].children;
+                auto while_body_blocks = block.child(1).children();
                 auto while_body_first_block = while_body_blocks[0];
 
-                if (while_body_first_block.type == NodeType::SEQUENCE)
-                    while_body_blocks = while_body_first_block.children;
+                if (while_body_first_block.type() == NodeType::SEQUENCE)
+                    while_body_blocks = while_body_first_block.children();
 
                 for (std::size_t i = 0; i < while_body_blocks.size(); ++i)
                 {
                     manage_block(while_body_blocks[i]);
                 }
 
-                auto last_location_offset = m_location_counter;
-                std::cout << last_location_offset << std::endl;
-
-                m_locations[last_location_offset - 1]->ends_while_body = true;
+                m_cfg.add_edge(while_index, {m_current_source, m_current_port, InputSlot::WHILE_FEEDBACK});
+                auto& while_location = static_cast<WhileLocation<T>&>(*m_locations[while_index]);
+                collect_mentioned_variables(block, while_location.m_relevant);
+                while_location.m_acceleration = loop_acceleration(while_index);
+                if (while_location.m_acceleration.has_value())
+                {
+                    LOG_TRACE << "[INFO] The loop is accelerated" << std::endl;
+                    m_statistics.accelerated_loops++;
+                }
 
+                m_enclosing.pop_back();
                 auto end_while_loc = std::make_unique<EndWhileLocation<T>>();
+                end_while_loc->m_code_block = block.index();
 
                 end_while_loc->m_store_from_while = nullptr;
                 end_while_loc->m_store_after = nullptr;
 
-                end_while_loc->m_operation = [ptr = end_while_loc.get(), this](void) -> void {
-                    std::cout << "Finalizing while statement" << std::endl;
-                    auto while_body_store = *(ptr->m_store_from_while);
-
-                    while_body_store.print();
-
-                    // Copy the while body store to the after store
-                    ptr->m_store_after = std::make_shared<IntervalStore<T>>(while_body_store);
-                    // And join that with the else store
-                    std::cout << "Store after while" << std::endl;
-                    ptr->m_store_after->print();
-                };
-                
-
                 std::unique_ptr<Location<T>> end_loc = std::move(end_while_loc); 
                 m_locations.push_back(std::move(end_loc));
+                m_location_parents.push_back(m_enclosing.empty() ? ProfiledLocation::TOP_LEVEL : m_enclosing.back());
                 m_location_counter++;
-                std::cout << "[INFO] Added End While Location. Counter: " << m_location_counter << std::endl;
+
+                m_cfg.add_edge(m_location_counter - 1, {while_index, StorePort::WHILE_EXIT, InputSlot::FINAL_WHILE_BODY});
+                m_current_source = m_location_counter - 1;
+                m_current_port = StorePort::LAST;
+                LOG_TRACE << "[INFO] Added End While Location. Counter: " << m_location_counter << std::endl;
+                break;
+            }
+            default:
+            {
+                throw AnalysisError("unknown block type");
+            }
+        }
+    }
+
+    /**
+     * @brief Adds to the set the variables that a statement may change: the assigned variables and the
+     * variables restricted by the conditions, including those of the nested statements. Called once the
+     * statement is built, so that all its variables are interned.
+     * 
+     * @param block 
+     * @param modified 
+     */
+    void collect_modified_variables(FlatAST::Node block, VariableSet& modified) const
+    {
+        switch (block.type())
+        {
+            case NodeType::ASSIGNMENT:
+            {
+                modified.insert(m_variable_table->find(block.child(0).text()));
+                break;
+            }
+            case NodeType::LOGIC_OP:
+            {
+                modified.insert(m_variable_table->find(block.child(0).text()));
+                break;
+            }
+            case NodeType::PRE_CON:
+            case NodeType::POST_CON:
+            {
                 break;
             }
             default:
             {
-                std::cerr << "Unknown block type" << std::endl;
-                block.print();
-                exit(1);
+                for (auto child : block.children())
+                {
+                    collect_modified_variables(child, modified);
+                }
             }
         }
     }
 
+    /**
+     * @brief Adds to the set every variable that appears in a statement
+     * 
+     * @param block 
+     * @param mentioned 
+     */
+    void collect_mentioned_variables(FlatAST::Node block, VariableSet& mentioned) const
+    {
+        if (block.type() == NodeType::VARIABLE)
+        {
+            mentioned.insert(m_variable_table->find(block.text()));
+        }
+        for (auto child : block.children())
+        {
+            collect_mentioned_variables(child, mentioned);
+        }
+    }
+
     /**
      * @brief Extracts the complementary logic operation of a given operation
      * 
@@ -683,7 +3075,7 @@ private:
      */
     LogicOp extract_complementary_op(LogicOp op)
     {
-        std::cout << "Extracting complementary op of " << op << std::endl;
+        LOG_TRACE << "Extracting complementary op of " << op << std::endl;
         switch(op)
         {
             case LogicOp::LEQ:
@@ -712,200 +3104,360 @@ private:
             }
             default:
             {
-                std::cerr << "Unknown logic operation" << op << std::endl;
-                exit(1);
+                throw AnalysisError("unknown logic operation");
+            }
+        }
+    }
+
+    /**
+     * @brief Resolves the function of a call and compiles its arguments
+     * 
+     * @param loc 
+     * @param call 
+     */
+    void compile_call(AssignmentLocation<T>& loc, FlatAST::Node call)
+    {
+        loc.m_function = m_functions->find(call.text());
+        if (!loc.m_function.has_value())
+        {
+            throw AnalysisError("call of the undefined function `" + call.text() + "`");
+        }
+        if (m_functions->function(*loc.m_function).parameters.size() != call.size())
+        {
+            throw AnalysisError("`" + call.text() + "` is called with " + std::to_string(call.size()) + " arguments");
+        }
+        for (auto argument : call.children())
+        {
+            loc.m_arguments.push_back(CompiledExpression<T>::compile(argument, *m_variable_table));
+        }
+    }
+
+    /**
+     * @brief Compiles the comparison asserted by a postcondition
+     * 
+     * @param loc 
+     * @param postcondition 
+     */
+    void compile_postcondition(PostConditionLocation<T>& loc, FlatAST::Node postcondition)
+    {
+        if (postcondition.type() != NodeType::LOGIC_OP || postcondition.kind() != FlatAST::ValueKind::LOGIC_OP)
+        {
+            throw AnalysisError("unsupported postcondition: a postcondition is a comparison");
+        }
+        loc.m_lhs = CompiledExpression<T>::compile(postcondition.child(0), *m_variable_table);
+        loc.m_rhs = CompiledExpression<T>::compile(postcondition.child(1), *m_variable_table);
+        loc.m_op = postcondition.logic_op();
+    }
+
+    /**
+     * @brief Recognizes a counting loop, whose body only holds assignments and postconditions: the variable
+     * of the condition `x < e` or `x <= e` (respectively `x > e`, `x >= e`) is increased (decreased) once
+     * by a constant, and every other assignment either assigns a constant or a variable to itself. The
+     * variables of `e` are not assigned by the body.
+     * 
+     * @param while_index the location of the loop, followed by the locations of its body
+     * @return std::optional<LoopAcceleration<T>> 
+     */
+    std::optional<LoopAcceleration<T>> loop_acceleration(std::size_t while_index) const
+    {
+        const auto& loop = static_cast<const WhileLocation<T>&>(*m_locations[while_index]);
+        auto variable = loop.m_condition.variable;
+        LoopAcceleration<T> acceleration;
+        VariableSet assigned;
+        bool counted = false;
+        for (std::size_t index = while_index + 1; index < m_locations.size(); ++index)
+        {
+            if (m_locations[index]->type() == LocationType::POSTCONDITION)
+            {
+                continue;
+            }
+            if (m_locations[index]->type() != LocationType::ASSIGNMENT)
+            {
+                return std::nullopt;
+            }
+            const auto& assignment = static_cast<const AssignmentLocation<T>&>(*m_locations[index]);
+            const auto& code = assignment.m_expression.code();
+            const auto& constants = assignment.m_expression.constants();
+            assigned.insert(assignment.m_variable);
+            if (assignment.m_variable == variable)
+            {
+                // x = x + c, c + x or x - c
+                bool counts = !counted && code.size() == 3 && (code[2].op == OpCode::ADD || code[2].op == OpCode::SUB)
+                    && ((code[0].op == OpCode::PUSH_VAR && code[0].operand == variable && code[1].op == OpCode::PUSH_CONST)
+                        || (code[2].op == OpCode::ADD && code[0].op == OpCode::PUSH_CONST && code[1].op == OpCode::PUSH_VAR && code[1].operand == variable));
+                if (!counts)
+                {
+                    return std::nullopt;
+                }
+                auto step = constants[0];
+                if (code[2].op == OpCode::SUB)
+                {
+                    if (!std::is_signed_v<T> || step == min_T)
+                    {
+                        return std::nullopt;
+                    }
+                    step = -step;
+                }
+                acceleration.step = step;
+                counted = true;
+            }
+            else if (assignment.m_expression.is_constant())
+            {
+                std::erase_if(acceleration.constants, [&](const auto& constant) { return constant.first == assignment.m_variable; });
+                acceleration.constants.push_back({assignment.m_variable, constants[0]});
+            }
+            else if (!(code.size() == 1 && code[0].op == OpCode::PUSH_VAR && code[0].operand == assignment.m_variable))
+            {
+                return std::nullopt;
+            }
+        }
+
+        auto op = loop.m_condition.op;
+        bool towards_bound = ((op == LogicOp::LE || op == LogicOp::LEQ) && acceleration.step > 0)
+            || ((op == LogicOp::GE || op == LogicOp::GEQ) && acceleration.step < 0);
+        if (!counted || !towards_bound)
+        {
+            return std::nullopt;
+        }
+        for (const auto& instruction : loop.m_condition.rhs.code())
+        {
+            if (instruction.op == OpCode::PUSH_VAR && assigned.contains(instruction.operand))
+            {
+                return std::nullopt;
             }
         }
+        return acceleration;
     }
 
     /**
-     * @brief Evaluates the expression by recursively traversing the AST
+     * @brief Least fixpoint of the interval equations of the head of an accelerated loop. Once the head
+     * reaches the bound `b` of the condition, the body is entered with an interval up to `b` and feeds back
+     * up to `b + step`, so the head adds `b + step` to the entry, and the constants of the body when the loop
+     * is entered. It is not the least invariant of the program: the intervals do not keep the stride, and in
+     * tests/loop1.c, where `a` goes from 1 by 2 while `a <= 10`, the head is [1, 12] and the exit [11, 12]
+     * although `a` never exceeds 11; a closed form giving [1, 11] would be undone by the next evaluation of
+     * the body.
      * 
-     * @param block 
-     * @param store 
-     * @return Interval<T> 
+     * @param head the head of the lanes before this one, the entry store for the first lane
+     * @param entry the store before the loop
+     * @param rhs the bound of the condition in the entry store
+     * @param loop 
+     * @param offset the first variable of the lane
+     * @return IntervalStore<T> 
      */
-    Interval<T> evaluate_expression(ASTNode& block, IntervalStore<T>& store)
+    IntervalStore<T> accelerated_head(IntervalStore<T> head, const IntervalStore<T>& entry, Interval<T>& rhs, WhileLocation<T>& loop, std::size_t offset)
     {
-        if (block.type == NodeType::INTEGER)
+        auto variable = loop.m_condition.variable + offset;
+        auto op = loop.m_condition.op;
+        auto entered = entry;
+        apply_command_to_store(entered, variable, rhs, op);
+        if (std::as_const(entered).get(variable).is_empty())
         {
-            return Interval<T>(std::get<T>(block.value), std::get<T>(block.value));
+            // The loop is never entered
+            return head;
         }
-        else if (block.type == NodeType::VARIABLE)
+
+        const auto& acceleration = *loop.m_acceleration;
+        bool overflow = false;
+        auto interval = entry.get(variable);
+        if (acceleration.step > 0)
         {
-            return store.get(std::get<std::string>(block.value));
+            auto bound = op == LogicOp::LE ? BoundArithmetic<T>::sub(rhs.ub(), 1, overflow) : rhs.ub();
+            interval.ub() = std::max(interval.ub(), BoundArithmetic<T>::add(bound, acceleration.step, overflow));
         }
-        else if (block.type == NodeType::ARITHM_OP)
+        else
         {
-            auto left = evaluate_expression(block.children[0], store);
-            auto right = evaluate_expression(block.children[1], store);
-
-            auto op = std::get<BinOp>(block.value);
-            switch(op)
-            {
-                case BinOp::ADD:
-                {
-                    return left + right;
-                }
-                case BinOp::SUB:
-                {
-                    return left - right;
-                }
-                case BinOp::MUL:
-                {
-                    return left * right;
-                }
-                case BinOp::DIV:
-                {
-                    if (right.contains(null_T))
-                    {
-                        std::cerr << "[WARNING] Division by 0" << std::endl;
-                    }
-                    return left / right;
-                }
-                default:
-                {
-                    // block.print();
-                    std::cerr << "Unknown binary operation" << std::endl;
-                    exit(1);
-                }
-            }
+            auto bound = op == LogicOp::GE ? BoundArithmetic<T>::add(rhs.lb(), 1, overflow) : rhs.lb();
+            interval.lb() = std::min(interval.lb(), BoundArithmetic<T>::add(bound, acceleration.step, overflow));
         }
-        else
+        if (overflow)
         {
-            std::cerr << "Unexpected expression" << std::endl;
-            exit(1);
-        }    
+            saturate();
+        }
+        head.set(variable, interval);
+        for (auto [assigned, value] : acceleration.constants)
+        {
+            auto joined = std::as_const(head).get(assigned + offset);
+            Interval<T> constant(value, value);
+            joined.join(constant);
+            head.set(assigned + offset, joined);
+        }
+        return head;
     }
 
     /**
-     * @brief Performs the widening operation on the store
+     * @brief Adds a constant of the program, and its neighbours, to the widening thresholds
      * 
-     * @param store 
-     * @param new_store 
-     * @param var 
-     * @return IntervalStore<T> 
+     * @param value 
      */
-    IntervalStore<T> widen(IntervalStore<T>& store, IntervalStore<T>& new_store, std::string& var)
+    void add_threshold(T value)
     {
-        IntervalStore<T> widened_store;
-        widened_store = new_store;
-
-        auto old_interval = store.get(var);
-        auto reference_interval = new_store.get(var);
-
+        add_threshold(m_thresholds, value);
+    }
 
-        auto new_lb = reference_interval.lb();
-        auto new_ub = reference_interval.ub();
+    void add_threshold(std::vector<T>& thresholds, T value)
+    {
+        thresholds.push_back(value);
+        if (value > min_T) thresholds.push_back(value - 1);
+        if (value < max_T) thresholds.push_back(value + 1);
+    }
 
-        auto old_lb = old_interval.lb();
-        auto old_ub = old_interval.ub();
+public:
+    // The store kernels of the transfer functions are public for the microbenchmarks of bench/
 
-        if (old_lb > new_lb)
+    /**
+     * @brief Widens the store of a loop head with thresholds: every bound that moved since the previous
+     * evaluation is pushed to the closest threshold beyond it, or to the end of the range of T
+     * 
+     * @param store the head store of the previous evaluation
+     * @param widened_store the head store of this evaluation, widened in place
+     */
+    void widen(const IntervalStore<T>& store, IntervalStore<T>& widened_store)
+    {
+        // Largest threshold below the new lower bound, and smallest one above the new upper bound
+        auto below = [this](const std::vector<T>& thresholds, T lb) {
+            auto it = std::upper_bound(thresholds.begin(), thresholds.end(), lb);
+            if (it == thresholds.begin())
+            {
+                saturate();
+                return min_T;
+            }
+            return *std::prev(it);
+        };
+        auto above = [this](const std::vector<T>& thresholds, T ub) {
+            auto it = std::lower_bound(thresholds.begin(), thresholds.end(), ub);
+            if (it == thresholds.end())
+            {
+                saturate();
+                return max_T;
+            }
+            return *it;
+        };
+        if (m_lane_thresholds.empty())
         {
-            new_lb = min_T;
+            widened_store.widenAll(store,
+                [&](T lb) { return below(m_thresholds, lb); },
+                [&](T ub) { return above(m_thresholds, ub); });
         }
         else
         {
-            new_lb = old_lb;
+            // Every lane of a sweep has the thresholds of its own preconditions
+            auto lane = [this](std::size_t id) -> const std::vector<T>& {
+                return m_lane_thresholds[m_lane_width == 0 ? 0 : std::min(id / m_lane_width, m_lanes - 1)];
+            };
+            widened_store.widenAll(store,
+                [&](std::size_t id, T lb) { return below(lane(id), lb); },
+                [&](std::size_t id, T ub) { return above(lane(id), ub); });
         }
+    }
 
-        if (old_ub < new_ub)
-        {
-            new_ub = max_T;
-        }
-        else
-        {
-            new_ub = old_ub;
-        }
+    /**
+     * @brief Widens the store of a loop head without thresholds, once a budget is exceeded: every bound
+     * that moved goes to the end of the range of T, so a head changes at most twice per variable
+     * 
+     * @param store the head store of the previous evaluation
+     * @param widened_store the head store of this evaluation, widened in place
+     */
+    void widen_to_range(const IntervalStore<T>& store, IntervalStore<T>& widened_store)
+    {
+        widened_store.widenAll(store, [this](T) { return min_T; }, [this](T) { return max_T; });
+    }
 
-        widened_store.set(var, {new_lb, new_ub});
-        return widened_store;
+    /**
+     * @brief Narrows the store of a loop head, intersecting it with the store recomputed from it. Since
+     * the previous head is a post-fixpoint, the result is still a sound invariant.
+     * 
+     * @param store the head store of the previous evaluation
+     * @param narrowed_store the head store of this evaluation, narrowed in place
+     */
+    void narrow(const IntervalStore<T>& store, IntervalStore<T>& narrowed_store)
+    {
+        narrowed_store.meetAll(store);
     }
 
     /**
-     * @brief Applies a specific command to the store (command which is not an assignment)
+     * @brief Applies a specific command to the store (command which is not an assignment), in place
      * 
      */
-    IntervalStore<T> apply_command_to_store(IntervalStore<T> store, std::string& var, Interval<T>& interval, LogicOp& op)
+    void apply_command_to_store(IntervalStore<T>& store, std::size_t id, Interval<T>& interval, LogicOp op)
     {
         switch(op)
         {
             case LogicOp::LEQ:
             {
-                auto lb = store.get(var).lb();
-                auto ub = store.get(var).ub();
+                auto lb = store.get(id).lb();
+                auto ub = store.get(id).ub();
 
                 Interval<T> new_interval = {lb, ub};
                 Interval<T> original_unbounded = {min_T, interval.ub()};
                 new_interval.meet(original_unbounded);
 
-                store.set(var, new_interval);
-                return store;
+                store.set(id, new_interval);
+                return;
             }
             case LogicOp::LE:
             {
-                auto lb = store.get(var).lb();
-                auto ub = store.get(var).ub();
+                auto lb = store.get(id).lb();
+                auto ub = store.get(id).ub();
 
                 Interval<T> new_interval = {lb, ub};
-                Interval<T> original_unbounded = {min_T, interval.ub() - 1};
+                Interval<T> original_unbounded = {min_T, static_cast<T>(interval.ub() - 1)};
                 new_interval.meet(original_unbounded);
 
-                store.set(var, new_interval);
-                return store;
+                store.set(id, new_interval);
+                return;
             }
             case LogicOp::GEQ:
             {
-                auto lb = store.get(var).lb();
-                auto ub = store.get(var).ub();
+                auto lb = store.get(id).lb();
+                auto ub = store.get(id).ub();
 
                 Interval<T> new_interval = {lb, ub};
                 Interval<T> original_unbounded = {interval.lb(), max_T};
                 new_interval.meet(original_unbounded);
                 
-                store.set(var, new_interval);
-                return store;
+                store.set(id, new_interval);
+                return;
             }
             case LogicOp::GE:
             {
-                auto lb = store.get(var).lb();
-                auto ub = store.get(var).ub();
+                auto lb = store.get(id).lb();
+                auto ub = store.get(id).ub();
 
                 Interval<T> new_interval = {lb, ub};
-                Interval<T> original_unbounded = {interval.lb() + 1, max_T};
+                Interval<T> original_unbounded = {static_cast<T>(interval.lb() + 1), max_T};
                 new_interval.meet(original_unbounded);
                 
-                store.set(var, new_interval);
-                return store;
+                store.set(id, new_interval);
+                return;
             }
             case LogicOp::EQ:
             {
-                auto lb = store.get(var).lb();
-                auto ub = store.get(var).ub();
+                auto lb = store.get(id).lb();
+                auto ub = store.get(id).ub();
 
                 Interval<T> new_interval = {lb, ub};
                 new_interval.meet(interval);
 
-                store.set(var, new_interval);
-                return store;
+                store.set(id, new_interval);
+                return;
             }
             case LogicOp::NEQ:
             {
-                auto lb = store.get(var).lb();
-                auto ub = store.get(var).ub();
+                auto lb = store.get(id).lb();
+                auto ub = store.get(id).ub();
                 // if the interval to be removed is on the lower side
                 if (interval.lb() <= lb)
                 {
                     if (lb + 1 <= ub)
                     {
-                        store.set(var, {lb + 1, ub});
+                        store.set(id, {static_cast<T>(lb + 1), ub});
                     }
                     else
                     {
-                        store.get(var).is_empty() = true;
+                        store.set(id, Interval<T>::empty());
                     }
-                    return store;
+                    return;
                 }
 
                 // If the interval to be removed is on the upper side
@@ -913,40 +3465,39 @@ private:
                 {
                     if (ub - 1 >= lb)
                     {
-                        store.set(var, {lb, ub - 1});
+                        store.set(id, {lb, static_cast<T>(ub - 1)});
                     }
                     else
                     {
-                        store.get(var).is_empty() = true;
+                        store.set(id, Interval<T>::empty());
                     }
-                    return store;
+                    return;
                 }
 
                 // If the interval to be removed is in the middle
                 if (interval.ub() < ub && interval.lb() > lb)
                 {
-                    return store;
+                    return;
                 }
 
                 // If the interval to be removed is exactly equal to the interval
                 if (interval.ub() == ub && interval.lb() == lb)
                 {
-                    store.get(var).is_empty() = true;
-                    return store;
+                    store.set(id, Interval<T>::empty());
+                    return;
                 }
 
-                exit(1);
-                
+                // Not restricting the variable is always sound
+                return;
             }
             default:
             {
-                std::cerr << "Unknown logic operation" << op << std::endl;
-                exit(1);
+                throw AnalysisError("unknown logic operation");
             }
         }
-        return store;
     }
 
+private:
     /**
      * @brief Evaluates the logic opeation between two intervals
      * 
@@ -993,12 +3544,13 @@ private:
      */
     void print_equational_system()
     {
-        std::cout << "|PRECONDITIONS|========================" << std::endl;   
-        for (auto &prec_element : m_precondition_store.store())
+        LOG_TRACE << "|PRECONDITIONS|========================" << std::endl;   
+        for (std::size_t id = 0; id < m_precondition_store.size(); ++id)
         {
-            std::cout << "[INFO] " << prec_element.first << ": [" << prec_element.second.lb() << ", " << prec_element.second.ub() << "]" << std::endl;
+            auto interval = m_precondition_store.get(id);
+            LOG_TRACE << "[INFO] " << m_precondition_store.name(id) << ": [" << interval.lb() << ", " << interval.ub() << "]" << std::endl;
         }
-        std::cout << "=======================================" << std::endl;
+        LOG_TRACE << "=======================================" << std::endl;
     }
 
     /**
@@ -1006,11 +3558,12 @@ private:
      * 
      * @param node 
      */
-    void add_variable(const ASTNode& node)
+    void add_variable(FlatAST::Node node)
     {
-        auto var_name = std::get<std::string>(node.value);
-        std::cout << "[INFO] Adding variable " << var_name << std::endl;
-        m_precondition_store.set(var_name, {min_T, max_T});
+        const auto& var_name = node.text();
+        LOG_TRACE << "[INFO] Adding variable " << var_name << std::endl;
+        auto id = m_variable_table->intern(var_name);
+        m_precondition_store.set(id, {min_T, max_T});
         m_variables.push_back(var_name);
     }
     
@@ -1019,43 +3572,45 @@ private:
      * 
      * @param node 
      */
-    void add_precondition(const ASTNode& node)
+    void add_precondition(FlatAST::Node node)
     {
-        auto op = std::get<std::string>(node.value);
+        const auto& op = node.text();
         
-        auto left = node.children[0];
-        auto right = node.children[1];
+        auto left = node.child(0);
+        auto right = node.child(1);
         bool variable_on_left = false;
 
         T val;
         std::string var;
-        if (left.type==NodeType::INTEGER && right.type==NodeType::VARIABLE)
+        if (left.type()==NodeType::INTEGER && right.type()==NodeType::VARIABLE)
         {
-            val = std::get<T>(left.value);
-            var = std::get<std::string>(right.value);
+            val = static_cast<T>(left.integer());
+            var = right.text();
         }
-        else if (left.type==NodeType::VARIABLE && right.type==NodeType::INTEGER)
+        else if (left.type()==NodeType::VARIABLE && right.type()==NodeType::INTEGER)
         {
             variable_on_left = true;
-            val = std::get<T>(right.value);
-            var = std::get<std::string>(left.value);
+            val = static_cast<T>(right.integer());
+            var = left.text();
         }
         else {
-            std::cout << "UNEXPECTED" << std::endl;
-            exit(1);
+            throw AnalysisError("unsupported precondition: a precondition compares a variable with an integer");
         }
+        add_threshold(val);
 
+        auto id = m_variable_table->intern(var);
+        auto interval = m_precondition_store.get(id);
         switch (m_logic_op_map.at(op))
         {
             case LogicOp::LEQ:
             {
                 if (variable_on_left)
                 {
-                    m_precondition_store.get(var).ub() = val;
+                    interval.ub() = val;
                 }
                 else
                 {
-                    m_precondition_store.get(var).lb() = val;
+                    interval.lb() = val;
                 }
 
                 break;
@@ -1064,151 +3619,567 @@ private:
             {
                 if (variable_on_left)
                 {
-                    m_precondition_store.get(var).lb() = val;
+                    interval.lb() = val;
                 }
                 else
                 {
-                    m_precondition_store.get(var).ub() = val;
+                    interval.ub() = val;
                 }
                 break;
             }
             default:
             {
-                std::cerr << "Unknown logic operation" << op << std::endl;
-                exit(1);
+                throw AnalysisError("unknown logic operation");
             }
         }
+        m_precondition_store.set(id, interval);
     }
 
     /**
-     * @brief Solves a single iteration of the fixpoint by evaluating all the locations.
-     * Here, stores are linked to each other and passed to the locations. Operations are then performed
+     * @brief Solves a single iteration of the fixpoint by evaluating all the locations in program order.
+     * Every location reads the current output stores of its predecessors in the control-flow graph, so that
+     * forward edges carry the stores of this sweep and loop back edges the stores of the previous one.
      * 
+     * @param entry_store 
+     * @param evaluations 
+     * @param sweep number of the sweep in the current phase
      */
-    void solve_system()
+    void solve_system(std::shared_ptr<IntervalStore<T>>& entry_store, std::vector<std::size_t>& evaluations, std::size_t sweep)
     {
-        last_interval_store = std::make_shared<IntervalStore<T>>(m_precondition_store);
-        auto last_location_type = LocationType::ASSIGNMENT;
-        std::unique_ptr<Location<T>> last_location = nullptr;
-        std::size_t counter = 0;
-        for (auto& loc : m_locations)
+        for (std::size_t index = m_reused_locations; index < m_locations.size() && !m_cancelled; ++index)
         {
-            auto current_location_type = identify_type(loc);
-
-            if (last_location_type == LocationType::IFELSE)
+            link_inputs(index, entry_store, evaluations);
+            evaluate(index);
+            evaluations[index]++;
+            count_evaluation(index);
+            if (m_trace != nullptr)
             {
-                auto last_if_body_store = m_if_body_stores_queue.front();
-                m_if_body_stores_queue.pop();
+                m_trace->evaluation(m_phase == IterationPhase::NARROWING, sweep, index, *m_locations[index]);
+            }
+            drop_transient_input(index);
+        }
+    }
+
+    /**
+     * @brief Marks the assignments whose output only the next assignment reads, in the low-memory mode of
+     * the solvers that evaluate a location only when one of its inputs changed (see set_low_memory)
+     * 
+     */
+    void find_transient_assignments()
+    {
+        m_transient.assign(m_locations.size(), false);
+        m_dropped.assign(m_locations.size(), false);
+        if (!m_low_memory || (!is_acyclic() && m_solver_mode != SolverMode::WORKLIST && m_solver_mode != SolverMode::WTO))
+        {
+            return;
+        }
+        assert(m_reused_locations == 0 && m_sweep.empty() && m_checkpoint_path.empty() && !m_resumed && "unsupported in the low-memory mode");
+        for (std::size_t index = 0; index < m_locations.size(); ++index)
+        {
+            const auto& successors = m_cfg.successors(index);
+            m_transient[index] = m_locations[index]->type() == LocationType::ASSIGNMENT && successors.size() == 1
+                && m_locations[successors.front()]->type() == LocationType::ASSIGNMENT;
+        }
+    }
 
-                std::cout << "Setting previous store to if body store" << std::endl;
+    /**
+     * @brief Once an assignment is evaluated, drops its input and, if no other location reads it, the output
+     * of the assignment before it
+     * 
+     * @param index 
+     */
+    void drop_transient_input(std::size_t index)
+    {
+        if (m_transient.empty() || m_locations[index]->type() != LocationType::ASSIGNMENT)
+        {
+            return;
+        }
+        auto source = m_cfg.predecessors(index).front().source;
+        if (source == StoreDependency::ENTRY_LOCATION || !m_transient[source])
+        {
+            return;
+        }
+        static_cast<AssignmentLocation<T>&>(*m_locations[index]).m_store_before = nullptr;
+        static_cast<AssignmentLocation<T>&>(*m_locations[source]).m_store_after = nullptr;
+        m_dropped[source] = true;
+    }
 
-                loc->set_previous_store(last_if_body_store);
+    /**
+     * @brief Recomputes the output of an assignment dropped in the low-memory mode from the last store kept
+     * before it, through the assignments in between. Their calls read the summaries computed by the solve,
+     * and their diagnostics are not recorded again.
+     * 
+     * @param index 
+     * @return std::shared_ptr<IntervalStore<T>> 
+     */
+    std::shared_ptr<IntervalStore<T>> replay(std::size_t index) const
+    {
+        std::vector<std::size_t> block{index};
+        IntervalStore<T> store(m_variable_table);
+        while (true)
+        {
+            const auto& dependency = m_cfg.predecessors(block.back()).front();
+            if (dependency.source == StoreDependency::ENTRY_LOCATION)
+            {
+                store = m_precondition_store;
+                break;
             }
-            else 
+            if (auto kept = m_locations[dependency.source]->get_output_store(dependency.port))
             {
-                if (current_location_type == LocationType::ENDIF)
-                {
-                    auto last_if_body_store = m_final_if_body_stores_queue.front();
-                    m_final_if_body_stores_queue.pop();
-
-                    auto last_else_body_store = m_final_else_body_stores_queue.front();
-                    m_final_else_body_stores_queue.pop();
+                store = *kept;
+                break;
+            }
+            assert(m_dropped[dependency.source] && "the assignments of a replayed block were evaluated");
+            block.push_back(dependency.source);
+        }
 
-                    loc->set_final_if_body_store(last_if_body_store);
-                    loc->set_final_else_body_store(last_else_body_store);
+        for (auto it = block.rbegin(); it != block.rend(); ++it)
+        {
+            const auto& location = static_cast<const AssignmentLocation<T>&>(*m_locations[*it]);
+            for (std::size_t lane = 0; lane < m_lanes; ++lane)
+            {
+                auto offset = lane * m_lane_width;
+                Interval<T> interval;
+                if (location.m_function.has_value())
+                {
+                    std::vector<Interval<T>> arguments;
+                    for (const auto& argument : location.m_arguments)
+                    {
+                        arguments.push_back(argument.evaluate(store, {}, offset));
+                    }
+                    auto empty = std::any_of(arguments.begin(), arguments.end(), [](const auto& argument) { return argument.is_empty(); });
+                    auto summary = empty ? std::optional<Interval<T>>(Interval<T>::empty()) : m_functions->lookup(*location.m_function, arguments);
+                    assert(summary.has_value() && "the summaries of a replayed block were computed by the solve");
+                    interval = summary.value_or(Interval<T>(min_T, max_T));
                 }
-                else if (counter != 0 && last_location->ends_if_body)
+                else if (location.m_expression.is_constant())
                 {
-                // This means that the next node is the else body
-                    auto last_else_body_store = m_else_body_stores_queue.front();
-                    m_else_body_stores_queue.pop();
+                    interval = Interval<T>(location.m_expression.constants()[0], location.m_expression.constants()[0]);
+                }
+                else
+                {
+                    interval = location.m_expression.evaluate(store, {}, offset);
+                }
+                store.set(location.m_variable + offset, interval);
+            }
+        }
+        return std::make_shared<IntervalStore<T>>(std::move(store));
+    }
 
-                    std::cout << "Setting previous store to else body store" << std::endl;
-                    // print the if body store
-                    last_else_body_store->print();
+    // Nothing is recorded when the diagnostics are not collected
+    DiagnosticSite diagnostic_site(std::size_t location) const
+    {
+        return {m_diagnostics.get(), location};
+    }
 
-                    loc->set_previous_store(last_else_body_store);
-                } 
-                else if (counter != 0 && current_location_type == LocationType::ENDWHILE)
-                {
-                    auto last_while_body_store = m_while_exit_stores_queue.front();
-                    m_while_exit_stores_queue.pop();
+    /**
+     * @brief Computes the output stores of a location from its inputs. The tag of the location selects its
+     * transfer function statically, so that the solvers can inline them into their loops.
+     * 
+     * @param location 
+     * @param index of the location, to which its diagnostics and verdicts are attributed
+     */
+    void transfer(Location<T>& location, std::size_t index)
+    {
+        switch (location.type())
+        {
+            case LocationType::ASSIGNMENT: transfer_assignment(static_cast<AssignmentLocation<T>&>(location), index); break;
+            case LocationType::POSTCONDITION: transfer_postcondition(static_cast<PostConditionLocation<T>&>(location), index); break;
+            case LocationType::IFELSE: transfer_ifelse(static_cast<IfElseLocation<T>&>(location), index); break;
+            case LocationType::ENDIF: transfer_endif(static_cast<EndIfLocation<T>&>(location)); break;
+            case LocationType::WHILE: transfer_while(static_cast<WhileLocation<T>&>(location), index); break;
+            case LocationType::ENDWHILE: transfer_endwhile(static_cast<EndWhileLocation<T>&>(location)); break;
+        }
+    }
 
-                    loc->set_final_while_body_store(last_while_body_store);
-                }
-                else if (counter != 0 && last_location_type == LocationType::WHILE)
-                {
-                    auto last_while_body_store = m_while_body_stores_queue.front();
-                    m_while_body_stores_queue.pop();
+    // Evaluates a location with its transfer function, recording which of its outputs changed
+    void evaluate(std::size_t index)
+    {
+        auto& location = *m_locations[index];
+        if (m_profiler == nullptr)
+        {
+            location.evaluate([this, index](Location<T>& location) { transfer(location, index); });
+            return;
+        }
+        m_profiler->measure(index, [&] {
+            location.evaluate([this, index](Location<T>& location) { transfer(location, index); });
+            return location.has_changed();
+        });
+    }
 
-                    loc->set_previous_store(last_while_body_store);
-                }
-                else
+    void transfer_assignment(AssignmentLocation<T>& location, std::size_t index)
+    {
+        LOG_TRACE << "-------EVALUATING ASSIGNMENT-------" << std::endl;
+        auto store = *(location.m_store_before);
+        if (Logger::enabled(LogLevel::TRACE)) store.print(Logger::out());
+
+        for (std::size_t lane = 0; lane < m_lanes; ++lane)
+        {
+            // The lanes read and write disjoint variables, so they can update the same store
+            auto offset = lane * m_lane_width;
+            // A right-hand side folded into a constant has nothing to evaluate
+            auto interval = location.m_function.has_value() ? call(location, store, index, offset)
+                : location.m_expression.is_constant()
+                ? Interval<T>(location.m_expression.constants()[0], location.m_expression.constants()[0])
+                : location.m_expression.evaluate(store, diagnostic_site(index), offset);
+
+            // print the interval 
+            LOG_TRACE << "Interval of " << m_variable_table->name(location.m_variable + offset) << ": [" << interval.lb() << ", " << interval.ub() << "]" << std::endl;
+            // Modify the interval in the store
+            store.set(location.m_variable + offset, interval);
+        }
+        location.m_store_after = m_store_pool.intern(std::move(store));
+    }
+
+    /**
+     * @brief Result of the call of an assignment `x = f(...)` in a store: the summary of f for the intervals of
+     * the arguments, computed on the first call with these intervals
+     * 
+     */
+    Interval<T> call(const AssignmentLocation<T>& location, const IntervalStore<T>& store, std::size_t index, std::size_t offset)
+    {
+        std::vector<Interval<T>> arguments;
+        arguments.reserve(location.m_arguments.size());
+        for (const auto& argument : location.m_arguments)
+        {
+            arguments.push_back(argument.evaluate(store, diagnostic_site(index), offset));
+            if (arguments.back().is_empty())
+            {
+                return Interval<T>::empty();
+            }
+        }
+        auto function = *location.m_function;
+        if (auto summary = m_functions->lookup(function, arguments))
+        {
+            return *summary;
+        }
+        auto result = summarize(function, arguments, index);
+        m_functions->insert(function, arguments, result);
+        return result;
+    }
+
+    /**
+     * @brief Analyzes the program of a function (see FunctionTable) from the given arguments, with the settings of
+     * this analysis but the parallel solver, and returns the interval of its result. Its overflows and divisions
+     * by zero are attributed to the location of the call.
+     * 
+     */
+    Interval<T> summarize(std::size_t function, const std::vector<Interval<T>>& arguments, std::size_t index)
+    {
+        const auto& definition = m_functions->function(function);
+        EquationalInterpreter<T> callee(definition.program);
+        callee.m_functions = m_functions;
+        callee.m_summary = true;
+        callee.m_solver_mode = m_solver_mode == SolverMode::PARALLEL ? SolverMode::JACOBI : m_solver_mode;
+        callee.m_widening_delay = m_widening_delay;
+        callee.m_narrowing_passes = m_narrowing_passes;
+        callee.m_sparse = m_sparse;
+        callee.m_collect_diagnostics = m_diagnostics != nullptr;
+        callee.m_stop_token = m_stop_token;
+        for (std::size_t i = 0; i < arguments.size(); ++i)
+        {
+            callee.m_arguments.push_back({definition.parameters[i], arguments[i]});
+        }
+
+        // The page counters of the thread are those of this analysis
+        auto counters = IntervalStore<T>::counters();
+        {
+            std::ostringstream discarded;
+            Logger::Capture capture(discarded, discarded);
+            callee.run();
+        }
+        IntervalStore<T>::counters() = counters;
+        if (callee.saturated())
+        {
+            saturate();
+        }
+        for (const auto& diagnostic : callee.diagnostics())
+        {
+            diagnostic_site(index).record(diagnostic.kind);
+        }
+        return callee.final_store()->get(callee.m_variable_table->intern(FunctionTable<T>::RESULT));
+    }
+
+    void transfer_postcondition(PostConditionLocation<T>& location, std::size_t index)
+    {
+        LOG_TRACE << "-------EVALUATING POSTCONDITION-------" << std::endl;
+
+        location.m_store = location.m_store_before;
+        if (location.m_discharged)
+        {
+            if (should_evaluate_postcondition)
+            {
+                m_verdicts.push_back({index, true});
+                LOG_SUMMARY << "Postcondition satisfied" << std::endl;
+            }
+            return;
+        }
+
+        const auto& store = *(location.m_store);
+        std::size_t satisfied = 0;
+        for (std::size_t lane = 0; lane < m_lanes; ++lane)
+        {
+            auto offset = lane * m_lane_width;
+            auto left = location.m_lhs.evaluate(store, diagnostic_site(index), offset);
+            auto right = location.m_rhs.evaluate(store, diagnostic_site(index), offset);
+            if (should_evaluate_postcondition)
+            {
+                auto eval = evaluate_logic_operation(left, right, location.m_op);
+                satisfied += eval ? 1 : 0;
+                if (!m_lane_verdicts.empty())
                 {
-                    loc->set_previous_store(last_interval_store);
+                    m_lane_verdicts[lane].push_back({index, eval});
                 }
             }
+        }
 
-            
-            loc->m_operation();
-            last_interval_store = loc->get_last_store();
+        if (should_evaluate_postcondition && !decided(index))
+        {
+            m_verdicts.push_back({index, false, false});
+            WARN_SUMMARY << "Postcondition undecided" << std::endl;
+        }
+        else if (should_evaluate_postcondition)
+        {
+            auto eval = satisfied == m_lanes;
+            m_verdicts.push_back({index, eval});
 
-            if (loc->ends_if_body)
+            if (m_sweep.empty() && eval)
+            {
+                LOG_SUMMARY << "Postcondition satisfied" << std::endl;
+            }
+            else if (m_sweep.empty())
+            {
+                WARN_SUMMARY << "Postcondition not satisfied" << std::endl;
+            }
+            else if (eval)
             {
-                m_final_if_body_stores_queue.push(last_interval_store);
+                LOG_SUMMARY << "Postcondition satisfied in all " << m_lanes << " configurations" << std::endl;
             }
-            if (loc->ends_else_body)
+            else
+            {
+                WARN_SUMMARY << "Postcondition satisfied in " << satisfied << " of " << m_lanes << " configurations" << std::endl;
+            }
+        }
+        else
+        {
+            LOG_TRACE << "Postcondition not evaluated" << std::endl;
+        }
+    }
+
+    void transfer_ifelse(IfElseLocation<T>& location, std::size_t index)
+    {
+        LOG_TRACE << "-------EVALUATING IF-ELSE-------" << std::endl;
+
+        const auto& store = *(location.m_store_before_condition);
+
+        // Start by evaluating the condition and restricting the store, in every lane of a sweep
+        auto var = location.m_condition.variable;
+        auto op = location.m_condition.op;
+        std::vector<Interval<T>> lane_rhs;
+        auto if_body_store = store;
+        for (std::size_t lane = 0; lane < m_lanes; ++lane)
+        {
+            auto offset = lane * m_lane_width;
+            auto rhs_interval = location.m_condition.rhs.evaluate(store, diagnostic_site(index), offset);
+
+            LOG_TRACE << "If condition: " << m_variable_table->name(var + offset) << " " << op << " [" << rhs_interval.lb() << ", " << rhs_interval.ub() << "]" << std::endl; 
+
+            apply_command_to_store(if_body_store, var + offset, rhs_interval, op);
+            if (!std::as_const(if_body_store).get(var + offset).is_empty() && Logger::enabled(LogLevel::TRACE))
             {
-                m_final_else_body_stores_queue.push(last_interval_store);
+                if_body_store.print(Logger::out());
             }
-            if (loc->ends_while_body)
+            lane_rhs.push_back(rhs_interval);
+        }
+
+        location.m_store_if_body = m_store_pool.intern(std::move(if_body_store));
+
+        if (Logger::enabled(LogLevel::TRACE)) location.m_store_if_body->print(Logger::out());
+
+        auto complementary_op = extract_complementary_op(op);
+        auto else_body_store = store;
+        for (std::size_t lane = 0; lane < m_lanes; ++lane)
+        {
+            auto offset = lane * m_lane_width;
+            auto& var_name = m_variable_table->name(var + offset);
+            apply_command_to_store(else_body_store, var + offset, lane_rhs[lane], complementary_op);
+
+            LOG_TRACE << "Else condition: " << var_name << " " << complementary_op << " [" << lane_rhs[lane].lb() << ", " << lane_rhs[lane].ub() << "]" << std::endl;
+            if (Logger::enabled(LogLevel::TRACE)) else_body_store.print(Logger::out());
+
+            auto empty_if_body = std::as_const(*location.m_store_if_body).get(var + offset).is_empty();
+            auto empty_else_body = std::as_const(else_body_store).get(var + offset).is_empty();
+            if (!empty_else_body && Logger::enabled(LogLevel::TRACE))
             {
-                m_final_while_body_stores_queue.push(last_interval_store);
+                else_body_store.print(Logger::out());
             }
 
-            last_location = std::make_unique<Location<T>>(*loc);
-            last_location_type = identify_type(loc);
-            counter++;
+            if (empty_if_body && empty_else_body)
+            {
+                WARN_SUMMARY << "[WARNING] Both branches are empty for variable " << var_name << std::endl; 
+            }
+            else if (empty_if_body)
+            {
+                WARN_SUMMARY << "[WARNING] If body branch is empty for variable " << var_name << std::endl;
+            }
+            else if (empty_else_body)
+            {
+                WARN_SUMMARY << "[WARNING] Else body branch is empty for variable " << var_name << std::endl;
+            }
         }
+        location.m_store_else_body = m_store_pool.intern(std::move(else_body_store));
+
+        LOG_TRACE << "If header completed" << std::endl;
     }
 
-    /**
-     * @brief Identifies the dynamic type of location
-     * 
-     * @param loc 
-     * @return LocationType 
-     */
-    LocationType identify_type(std::unique_ptr<Location<T>>& loc)
+    void transfer_endif(EndIfLocation<T>& location)
     {
-        if (dynamic_cast<AssignmentLocation<T>*>(loc.get()))
+        LOG_TRACE << "Finalizing if statement" << std::endl;
+        if (location.m_store_after_body == location.m_store_after_else)
         {
-            return LocationType::ASSIGNMENT;
+            // Both branches produced the same canonical store, the join is the store itself
+            location.m_store_after = location.m_store_after_body;
         }
-        else if (dynamic_cast<PostConditionLocation<T>*>(loc.get()))
+        else
+        {
+            // Copy the if body store to the after store
+            auto joined_store = *(location.m_store_after_body);
+            // And join that with the else store
+            joined_store.joinAll(*(location.m_store_after_else), m_sparse ? &location.m_modified : nullptr);
+            location.m_store_after = m_store_pool.intern(std::move(joined_store));
+        }
+        LOG_TRACE << "Store after if-else" << std::endl;
+        if (Logger::enabled(LogLevel::TRACE)) location.m_store_after->print(Logger::out());
+    }
+
+    void transfer_while(WhileLocation<T>& location, std::size_t index)
+    {
+        LOG_TRACE << "-------EVALUATING WHILE-------" << std::endl;
+
+        // location.m_code_block.print();
+
+        const auto& store = *(location.m_store_before_condition);
+        if (Logger::enabled(LogLevel::TRACE)) store.print(Logger::out());
+        auto var = location.m_condition.variable;
+        auto op = location.m_condition.op;
+        auto& var_name = m_variable_table->name(var);
+
+        auto rhs_interval = location.m_condition.rhs.evaluate(store, diagnostic_site(index));
+        LOG_TRACE << "While Condition " << var_name << " " << op << " [" << rhs_interval.lb() << ", " << rhs_interval.ub() << "]" << std::endl;
+        // The bounds of the condition in the other lanes of a sweep
+        std::vector<Interval<T>> lane_rhs;
+        for (std::size_t lane = 1; lane < m_lanes; ++lane)
         {
-            return LocationType::POSTCONDITION;
+            lane_rhs.push_back(location.m_condition.rhs.evaluate(store, diagnostic_site(index), lane * m_lane_width));
         }
-        else if (dynamic_cast<IfElseLocation<T>*>(loc.get()))
+        auto rhs = [&](std::size_t lane) -> Interval<T>& { return lane == 0 ? rhs_interval : lane_rhs[lane - 1]; };
+        // The store restricted by the condition, or by its complement, in every lane
+        auto restrict = [&](IntervalStore<T>& restricted, LogicOp condition_op) {
+            for (std::size_t lane = 0; lane < m_lanes; ++lane)
+            {
+                apply_command_to_store(restricted, var + lane * m_lane_width, rhs(lane), condition_op);
+            }
+        };
+
+        auto while_body_store = store;
+        if (location.m_store_feedback == nullptr)
         {
-            return LocationType::IFELSE;
+            WARN_TRACE << "No feedback store yet" << std::endl;
+        } 
+        else
+        {
+            while_body_store.joinAll(*(location.m_store_feedback));
         }
-        else if (dynamic_cast<EndIfLocation<T>*>(loc.get()))
+        if (location.m_acceleration.has_value())
         {
-            return LocationType::ENDIF;
+            // Already the invariant of the head once the loop is stable, which widening then leaves as is
+            auto head = store;
+            for (std::size_t lane = 0; lane < m_lanes; ++lane)
+            {
+                head = accelerated_head(std::move(head), store, rhs(lane), location, lane * m_lane_width);
+            }
+            while_body_store.joinAll(head);
         }
-        else if(dynamic_cast<WhileLocation<T>*>(loc.get()))
+
+        if (location.m_store_head != nullptr)
         {
-            return LocationType::WHILE;
+            if (m_phase == IterationPhase::ASCENDING)
+            {
+                auto steps = ++location.m_ascending_steps;
+                if (m_budget.iterations > 0 && steps > m_budget.iterations)
+                {
+                    exceed_budget(BudgetExceeded::ITERATIONS);
+                }
+                if (budget_exceeded())
+                {
+                    LOG_TRACE << "Performing widening to the range of the type" << std::endl;
+                    widen_to_range(*(location.m_store_head), while_body_store);
+                    count(m_statistics.widenings);
+                    if (m_profiler != nullptr) m_profiler->widening(index);
+                }
+                else if (steps > m_widening_delay)
+                {
+                    LOG_TRACE << "Performing widening" << std::endl;
+                    widen(*(location.m_store_head), while_body_store);
+                    count(m_statistics.widenings);
+                    if (m_profiler != nullptr) m_profiler->widening(index);
+                }
+            }
+            else if (location.m_narrowing_steps < m_narrowing_passes && !stop_narrowing())
+            {
+                LOG_TRACE << "Performing narrowing" << std::endl;
+                location.m_narrowing_steps++;
+                count(m_statistics.narrowings);
+                narrow(*(location.m_store_head), while_body_store);
+            }
+            else
+            {
+                // Out of narrowing passes: the previous head is still a sound invariant
+                while_body_store = *(location.m_store_head);
+            }
         }
-        else if(dynamic_cast<EndWhileLocation<T>*>(loc.get()))
+        location.m_store_head = m_store_pool.intern(while_body_store);
+        LOG_TRACE << "Loop head store" << std::endl;
+        if (Logger::enabled(LogLevel::TRACE)) location.m_store_head->print(Logger::out());
+
+        // The body and the exit restrict the head store, which the exit then takes over
+        auto while_body_store_restricted = while_body_store;
+        restrict(while_body_store_restricted, op);
+
+        if (m_sparse && location.m_store_body->is_interned() && location.m_store_body->equals(while_body_store_restricted, location.m_relevant))
         {
-            return LocationType::ENDWHILE;
+            // Only variables that the loop ignores changed: the body keeps its stores
+            LOG_TRACE << "Body store unchanged on the variables of the loop" << std::endl;
         }
         else
         {
-            std::cerr << "Unknown location type" << std::endl;
-            exit(1);
+            location.m_store_body = m_store_pool.intern(std::move(while_body_store_restricted));
         }
+        LOG_TRACE << "Applying condition to store" << std::endl;
+        if (Logger::enabled(LogLevel::TRACE)) location.m_store_body->print(Logger::out());
+
+        auto complementary_op = extract_complementary_op(op);
+
+        LOG_TRACE << "Complementary while condition " << var_name << " " << complementary_op << " [" << rhs_interval.lb() << ", " << rhs_interval.ub() << "]" << std::endl;
+
+        restrict(while_body_store, complementary_op);
+        location.m_store_exit = m_store_pool.intern(std::move(while_body_store));
+
+        LOG_TRACE << "Finished while header" << std::endl;
+    }
+
+    void transfer_endwhile(EndWhileLocation<T>& location)
+    {
+        LOG_TRACE << "Finalizing while statement" << std::endl;
+        const auto& while_body_store = *(location.m_store_from_while);
+
+        if (Logger::enabled(LogLevel::TRACE)) while_body_store.print(Logger::out());
+
+        // The exit store of the loop is the after store, copied only if it is not canonical yet
+        location.m_store_after = m_store_pool.intern(while_body_store);
+        // And join that with the else store
+        LOG_TRACE << "Store after while" << std::endl;
+        if (Logger::enabled(LogLevel::TRACE)) location.m_store_after->print(Logger::out());
     }
 
     /**
@@ -1217,11 +4188,11 @@ private:
      */
     void evaluate_postconditions()
     {
-        for (auto& loc : m_locations)
+        for (std::size_t index = 0; index < m_locations.size(); ++index)
         {
-            if (dynamic_cast<PostConditionLocation<T>*>(loc.get()))
+            if (m_locations[index]->type() == LocationType::POSTCONDITION)
             {
-                loc->m_operation();
+                transfer_postcondition(static_cast<PostConditionLocation<T>&>(*m_locations[index]), index);
             }
         }
     }
@@ -1229,4 +4200,4 @@ private:
 
 
 
-#endif
\ No newline at end of file
+#endif
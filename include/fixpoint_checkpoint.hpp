@@ -0,0 +1,223 @@
+#ifndef FIXPOINT_CHECKPOINT_HPP
+#define FIXPOINT_CHECKPOINT_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <unistd.h>
+
+#include "interval_store.hpp"
+#include "location_base.hpp"
+#include "mapped_file.hpp"
+
+/**
+ * @brief Header of a checkpoint of a fixpoint iteration, from which an analysis of the same program with
+ * the same settings resumes (see EquationalInterpreter::resume). It is followed by these sections, whose
+ * integers are stored in the byte order of the machine:
+ * - statistics: the AnalysisStatistics of the interrupted run, as `statistics_size` bytes;
+ * - locations: for every location, its evaluations over all the phases and in the current phase, its
+ *   ascending and narrowing steps (four u64), then the indices of its output stores in the StorePort order
+ *   followed by the one of its loop head store (STORE_PORTS + 1 u32, NO_STORE if it has none);
+ * - queued: the locations in the worklist (u32), none for the Jacobi sweeps;
+ * - pages: the store pages (IntervalStore::Page), each one written once however many stores share it;
+ * - stores: for every store, its size and its number of pages (two u32), then the indices of its pages (u32).
+ *
+ */
+struct FixpointCheckpointHeader {
+    static constexpr char MAGIC[8] = {'A', 'B', 'S', 'I', 'N', 'T', 'C', 'K'};
+    static constexpr std::uint32_t FORMAT = 1;
+    static constexpr std::uint32_t NO_STORE = 0xffffffffu;
+
+    char magic[8];
+    std::uint32_t format;
+    std::uint32_t value_size;
+    std::uint32_t value_signed;
+    std::uint8_t solver;            // SolverMode
+    std::uint8_t narrowing;         // 1 in the narrowing phase
+    std::uint8_t flags;             // sparse, slice and prefilter, from the lowest bit
+    std::uint8_t reserved;
+    std::uint64_t program_hash;     // of the declarations, the preconditions and the statements
+    std::uint64_t widening_delay;
+    std::uint64_t narrowing_passes;
+    std::uint64_t locations;
+    std::uint64_t sweeps;           // Jacobi sweeps completed in the current phase
+    std::uint64_t location_evaluations;
+    std::uint64_t queued;
+    std::uint64_t pages;
+    std::uint64_t stores;
+    std::uint64_t statistics_size;
+};
+
+/**
+ * @brief State of an interrupted fixpoint iteration, as written in a checkpoint file. The stores are
+ * given as lists of pages, so that the stores that share pages in the interpreter share them in the file.
+ *
+ * @tparam T
+ */
+template <typename T>
+struct FixpointCheckpoint {
+    using Page = typename IntervalStore<T>::Page;
+    static_assert(std::is_trivially_copyable_v<Page>);
+
+    struct LocationState {
+        std::uint64_t evaluations = 0;
+        std::uint64_t phase_evaluations = 0;
+        std::uint64_t ascending_steps = 0;
+        std::uint64_t narrowing_steps = 0;
+        std::uint32_t stores[STORE_PORTS + 1];
+    };
+
+    struct Store {
+        std::uint32_t size = 0;
+        std::vector<std::uint32_t> pages;
+    };
+
+    FixpointCheckpointHeader header{};
+    std::string statistics;
+    std::vector<LocationState> locations;
+    std::vector<std::uint32_t> queued;
+    std::vector<Page> pages;
+    std::vector<Store> stores;
+
+    /**
+     * @brief Writes the checkpoint next to the path and renames it over the path, so that an interruption
+     * leaves the previous checkpoint in place
+     *
+     * @param path
+     * @return false if the file could not be written
+     */
+    bool write(const std::string& path) const
+    {
+        auto temporary = path + ".tmp." + std::to_string(::getpid());
+        std::error_code error;
+        {
+            std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+            auto put = [&out](const void* data, std::size_t size) { out.write(static_cast<const char*>(data), size); };
+            put(&header, sizeof(header));
+            put(statistics.data(), statistics.size());
+            for (const auto& location : locations)
+            {
+                put(&location.evaluations, 4 * sizeof(std::uint64_t));
+                put(location.stores, sizeof(location.stores));
+            }
+            put(queued.data(), queued.size() * sizeof(std::uint32_t));
+            put(pages.data(), pages.size() * sizeof(Page));
+            for (const auto& store : stores)
+            {
+                std::uint32_t counts[2] = {store.size, static_cast<std::uint32_t>(store.pages.size())};
+                put(counts, sizeof(counts));
+                put(store.pages.data(), store.pages.size() * sizeof(std::uint32_t));
+            }
+            out.flush();
+            if (!out.good())
+            {
+                out.close();
+                std::filesystem::remove(temporary, error);
+                return false;
+            }
+        }
+        std::filesystem::rename(temporary, path, error);
+        if (error)
+        {
+            std::filesystem::remove(temporary, error);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Reads a checkpoint written with T
+     *
+     * @param path
+     * @return std::optional<FixpointCheckpoint<T>> nothing if the file is missing, truncated or not a
+     * checkpoint written with T
+     */
+    static std::optional<FixpointCheckpoint<T>> read(const std::string& path)
+    {
+        MappedFile file(path);
+        const char* position = file.data();
+        const char* end = file.data() + file.size();
+        auto get = [&](void* data, std::uint64_t size) {
+            if (static_cast<std::uint64_t>(end - position) < size)
+            {
+                return false;
+            }
+            std::memcpy(data, position, size);
+            position += size;
+            return true;
+        };
+        // Bounds a count read from the file by the bytes left, before allocating for it
+        auto fits = [&](std::uint64_t count, std::uint64_t size) { return count <= static_cast<std::uint64_t>(end - position) / size; };
+
+        FixpointCheckpoint<T> checkpoint;
+        auto& header = checkpoint.header;
+        if (!file.is_open() || !get(&header, sizeof(header))
+            || std::memcmp(header.magic, FixpointCheckpointHeader::MAGIC, sizeof(header.magic)) != 0
+            || header.format != FixpointCheckpointHeader::FORMAT || header.value_size != sizeof(T)
+            || header.value_signed != (std::is_signed_v<T> ? 1u : 0u) || !fits(header.statistics_size, 1))
+        {
+            return std::nullopt;
+        }
+        checkpoint.statistics.resize(header.statistics_size);
+        get(checkpoint.statistics.data(), header.statistics_size);
+
+        if (!fits(header.locations, sizeof(LocationState)))
+        {
+            return std::nullopt;
+        }
+        checkpoint.locations.resize(header.locations);
+        for (auto& location : checkpoint.locations)
+        {
+            get(&location.evaluations, 4 * sizeof(std::uint64_t));
+            get(location.stores, sizeof(location.stores));
+        }
+        if (!fits(header.queued, sizeof(std::uint32_t)))
+        {
+            return std::nullopt;
+        }
+        checkpoint.queued.resize(header.queued);
+        get(checkpoint.queued.data(), header.queued * sizeof(std::uint32_t));
+        if (!fits(header.pages, sizeof(Page)))
+        {
+            return std::nullopt;
+        }
+        checkpoint.pages.resize(header.pages);
+        get(checkpoint.pages.data(), header.pages * sizeof(Page));
+        if (!fits(header.stores, 2 * sizeof(std::uint32_t)))
+        {
+            return std::nullopt;
+        }
+        checkpoint.stores.resize(header.stores);
+        for (auto& store : checkpoint.stores)
+        {
+            std::uint32_t counts[2];
+            if (!get(counts, sizeof(counts)) || !fits(counts[1], sizeof(std::uint32_t)))
+            {
+                return std::nullopt;
+            }
+            store.size = counts[0];
+            store.pages.resize(counts[1]);
+            get(store.pages.data(), counts[1] * sizeof(std::uint32_t));
+            for (auto page : store.pages)
+            {
+                if (page >= checkpoint.pages.size())
+                {
+                    return std::nullopt;
+                }
+            }
+        }
+        if (position != end)
+        {
+            return std::nullopt;
+        }
+        return checkpoint;
+    }
+};
+
+#endif // FIXPOINT_CHECKPOINT_HPP
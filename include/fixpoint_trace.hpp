@@ -0,0 +1,515 @@
+#ifndef FIXPOINT_TRACE_HPP
+#define FIXPOINT_TRACE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "interval_store.hpp"
+#include "location_base.hpp"
+#include "mapped_file.hpp"
+
+/**
+ * @brief Header of a binary trace of the fixpoint iteration. It is followed by records that start with a
+ * FixpointTraceRecord tag, whose integers are stored in the byte order of the machine:
+ * - VARIABLES: first id (u32), count (u32), then for every variable the size (u32) and the bytes of its name;
+ * - LOCATIONS: count (u32), then the LocationType of every location (u8);
+ * - EVALUATION: phase (u8, 1 when narrowing), changed ports (u8, a bitmask of StorePort), location (u32),
+ *   iteration (u32), then for every changed port in increasing order the port (u8), the location and the
+ *   port of the base store (u32, u8), the number of entries (u32) and the entries, each one a variable id
+ *   (u32), an empty flag (u8) and the bounds (two T).
+ *
+ * A changed output store is recorded as the variables whose interval differs from its base: the last
+ * recorded store of the same port, or the last store recorded by the trace if the store shares more of its
+ * pages (NO_BASE before the first one). In program order, that is usually the store the location read,
+ * which only differs on the variables it assigns. The stores are rebuilt by replaying the trace.
+ *
+ */
+struct FixpointTraceHeader {
+    static constexpr char MAGIC[8] = {'A', 'B', 'S', 'I', 'N', 'T', 'T', 'R'};
+    static constexpr std::uint32_t FORMAT = 1;
+    static constexpr std::uint32_t NO_BASE = 0xffffffff;
+
+    char magic[8];
+    std::uint32_t format;
+    std::uint32_t value_size;
+    std::uint32_t value_signed;
+    std::uint32_t sweeps;       // the iterations are sweeps over all the locations
+};
+
+enum class FixpointTraceRecord : std::uint8_t {
+    VARIABLES = 1,
+    LOCATIONS = 2,
+    EVALUATION = 3
+};
+
+/**
+ * @brief Buffered writer of a binary trace of the fixpoint iteration (see FixpointTraceHeader). It keeps the
+ * last recorded output stores of every location to record only what changed.
+ *
+ * @tparam T
+ */
+template <typename T>
+class FixpointTraceWriter
+{
+private:
+    static constexpr std::size_t BUFFER_SIZE = 1 << 20;
+
+    std::ofstream m_file;
+    std::vector<char> m_buffer;
+    std::size_t m_used = 0;
+    std::shared_ptr<VariableTable> m_variables;
+    std::size_t m_named = 0;        // variables whose names were recorded
+    std::vector<std::array<std::shared_ptr<IntervalStore<T>>, STORE_PORTS>> m_last;
+    std::uint32_t m_latest = FixpointTraceHeader::NO_BASE;      // location and port of the last recorded store
+    std::uint8_t m_latest_port = 0;
+    bool m_failed = false;
+
+public:
+    /**
+     * @brief Creates the trace file, see good
+     *
+     * @param path
+     * @param sweeps whether the iterations are sweeps over all the locations, or evaluations of a location
+     */
+    FixpointTraceWriter(const std::string& path, bool sweeps)
+    : m_file(path, std::ios::binary | std::ios::trunc)
+    {
+        m_buffer.resize(BUFFER_SIZE);
+        FixpointTraceHeader header;
+        std::memcpy(header.magic, FixpointTraceHeader::MAGIC, sizeof(header.magic));
+        header.format = FixpointTraceHeader::FORMAT;
+        header.value_size = sizeof(T);
+        header.value_signed = std::is_signed_v<T> ? 1 : 0;
+        header.sweeps = sweeps ? 1 : 0;
+        put(header);
+    }
+
+    FixpointTraceWriter(const FixpointTraceWriter&) = delete;
+    FixpointTraceWriter& operator=(const FixpointTraceWriter&) = delete;
+
+    ~FixpointTraceWriter()
+    {
+        flush();
+    }
+
+    /**
+     * @brief Tells if the trace could be written so far
+     *
+     */
+    bool good() const
+    {
+        return m_file.is_open() && !m_failed;
+    }
+
+    /**
+     * @brief Records the locations of the system and the variables interned so far
+     *
+     * @param variables
+     * @param locations
+     */
+    void begin(std::shared_ptr<VariableTable> variables, const std::vector<std::unique_ptr<Location<T>>>& locations)
+    {
+        m_variables = std::move(variables);
+        m_last.assign(locations.size(), {});
+        record_names();
+        reserve(sizeof(std::uint32_t) + 1 + locations.size());
+        put(FixpointTraceRecord::LOCATIONS);
+        put(static_cast<std::uint32_t>(locations.size()));
+        for (const auto& loc : locations)
+        {
+            put(static_cast<std::uint8_t>(loc->type()));
+        }
+    }
+
+    /**
+     * @brief Records the evaluation of a location, with the changes of its output stores
+     *
+     * @param narrowing
+     * @param iteration
+     * @param index
+     * @param loc
+     */
+    void evaluation(bool narrowing, std::size_t iteration, std::size_t index, const Location<T>& loc)
+    {
+        if (m_variables->size() > m_named)
+        {
+            record_names();
+        }
+        std::uint8_t changed = 0;
+        for (std::size_t port = 0; port < STORE_PORTS; ++port)
+        {
+            if (loc.has_changed(static_cast<StorePort>(port)) && loc.get_output_store(static_cast<StorePort>(port)) != nullptr)
+            {
+                changed |= 1u << port;
+            }
+        }
+        reserve(RECORD_SIZE);
+        put(FixpointTraceRecord::EVALUATION);
+        put(static_cast<std::uint8_t>(narrowing ? 1 : 0));
+        put(changed);
+        put(static_cast<std::uint32_t>(index));
+        put(static_cast<std::uint32_t>(iteration));
+        for (std::size_t port = 0; port < STORE_PORTS; ++port)
+        {
+            if ((changed >> port) & 1u)
+            {
+                auto store = loc.get_output_store(static_cast<StorePort>(port));
+                auto& last = m_last[index][port];
+                auto base_location = static_cast<std::uint32_t>(index);
+                auto base_port = static_cast<std::uint8_t>(port);
+                const IntervalStore<T>* base = last.get();
+                if (m_latest != FixpointTraceHeader::NO_BASE && (m_latest != index || m_latest_port != port))
+                {
+                    const auto* latest = m_last[m_latest][m_latest_port].get();
+                    if (base == nullptr || store->unshared_pages(latest) < store->unshared_pages(base))
+                    {
+                        base_location = m_latest;
+                        base_port = m_latest_port;
+                        base = latest;
+                    }
+                }
+                else if (base == nullptr)
+                {
+                    base_location = FixpointTraceHeader::NO_BASE;
+                }
+                put(static_cast<std::uint8_t>(port));
+                put(base_location);
+                put(base_port);
+                auto count_offset = m_used;
+                put(std::uint32_t(0));
+                std::uint32_t count = 0;
+                store->for_each_difference(base, [this, &count](std::size_t id, const Interval<T>& interval) {
+                    reserve(ENTRY_SIZE);
+                    put(static_cast<std::uint32_t>(id));
+                    put(static_cast<std::uint8_t>(interval.is_empty() ? 1 : 0));
+                    put(interval.lb());
+                    put(interval.ub());
+                    count++;
+                });
+                std::memcpy(m_buffer.data() + count_offset, &count, sizeof(count));
+                last = std::move(store);
+                m_latest = static_cast<std::uint32_t>(index);
+                m_latest_port = static_cast<std::uint8_t>(port);
+            }
+        }
+        if (m_used >= BUFFER_SIZE / 2)
+        {
+            flush();
+        }
+    }
+
+    void flush()
+    {
+        if (m_used > 0 && m_file.is_open())
+        {
+            m_failed = m_failed || !m_file.write(m_buffer.data(), m_used);
+            m_file.flush();
+        }
+        m_used = 0;
+    }
+
+private:
+    static constexpr std::size_t ENTRY_SIZE = sizeof(std::uint32_t) + sizeof(std::uint8_t) + 2 * sizeof(T);
+    // Room for the fixed part of the records, checked once per record
+    static constexpr std::size_t RECORD_SIZE = 2 * sizeof(std::uint32_t) + 3 + STORE_PORTS * (2 * sizeof(std::uint32_t) + 2);
+
+    /**
+     * @brief Grows the buffer to hold the given number of bytes more. The buffer is only written to the file
+     * between records.
+     *
+     */
+    void reserve(std::size_t bytes)
+    {
+        if (m_used + bytes > m_buffer.size())
+        {
+            m_buffer.resize(std::max(2 * m_buffer.size(), m_used + bytes));
+        }
+    }
+
+    template <typename V>
+    void put(const V& value)
+    {
+        static_assert(std::is_trivially_copyable_v<V>);
+        std::memcpy(m_buffer.data() + m_used, &value, sizeof(value));
+        m_used += sizeof(value);
+    }
+
+    void put_bytes(const std::string& bytes)
+    {
+        reserve(bytes.size());
+        std::memcpy(m_buffer.data() + m_used, bytes.data(), bytes.size());
+        m_used += bytes.size();
+    }
+
+    void record_names()
+    {
+        auto size = m_variables->size();
+        reserve(3 * sizeof(std::uint32_t) + 1);
+        put(FixpointTraceRecord::VARIABLES);
+        put(static_cast<std::uint32_t>(m_named));
+        put(static_cast<std::uint32_t>(size - m_named));
+        for (auto id = m_named; id < size; ++id)
+        {
+            const auto& name = m_variables->name(id);
+            reserve(sizeof(std::uint32_t));
+            put(static_cast<std::uint32_t>(name.size()));
+            put_bytes(name);
+        }
+        m_named = size;
+    }
+};
+
+/**
+ * @brief Prints a binary trace as text: every evaluation with the iteration and the phase in which it took
+ * place, whether the location was stable, and the rebuilt content of the output stores that changed.
+ * Evaluations of sweeps are grouped by sweep.
+ *
+ * @tparam T the type of the bounds the trace was written with
+ */
+template <typename T>
+class FixpointTracePrinter
+{
+private:
+    struct Bound {
+        bool present = false;
+        bool empty = false;
+        T lb{};
+        T ub{};
+    };
+
+    MappedFile m_file;
+    const char* m_position = nullptr;
+    const char* m_end = nullptr;
+    std::vector<std::string> m_names;
+    std::vector<std::uint8_t> m_types;
+    std::vector<std::array<std::vector<Bound>, STORE_PORTS>> m_stores;
+
+public:
+    explicit FixpointTracePrinter(const std::string& path)
+    : m_file(path)
+    {}
+
+    /**
+     * @brief Prints the whole trace. The lines are not flushed one by one, since a trace prints many more
+     * of them than the log.
+     *
+     * @param out
+     * @return false if the file is not a trace written with T, or is truncated
+     */
+    bool print(std::ostream& out)
+    {
+        FixpointTraceHeader header;
+        m_position = m_file.data();
+        m_end = m_file.data() + m_file.size();
+        if (!m_file.is_open() || !get(header) || std::memcmp(header.magic, FixpointTraceHeader::MAGIC, sizeof(header.magic)) != 0
+            || header.format != FixpointTraceHeader::FORMAT || header.value_size != sizeof(T)
+            || header.value_signed != (std::is_signed_v<T> ? 1u : 0u))
+        {
+            return false;
+        }
+        bool sweeps = header.sweeps != 0;
+
+        std::uint8_t phase = 0xff;
+        std::uint32_t sweep = 0;
+        while (m_position < m_end)
+        {
+            FixpointTraceRecord tag;
+            if (!get(tag))
+            {
+                return false;
+            }
+            switch (tag)
+            {
+                case FixpointTraceRecord::VARIABLES:
+                {
+                    if (!read_names())
+                    {
+                        return false;
+                    }
+                    break;
+                }
+                case FixpointTraceRecord::LOCATIONS:
+                {
+                    std::uint32_t count;
+                    if (!get(count) || static_cast<std::size_t>(m_end - m_position) < count)
+                    {
+                        return false;
+                    }
+                    m_types.assign(m_position, m_position + count);
+                    m_position += count;
+                    m_stores.assign(count, {});
+                    break;
+                }
+                case FixpointTraceRecord::EVALUATION:
+                {
+                    std::uint8_t record_phase;
+                    std::uint8_t changed;
+                    std::uint32_t index;
+                    std::uint32_t iteration;
+                    if (!get(record_phase) || !get(changed) || !get(index) || !get(iteration) || index >= m_stores.size())
+                    {
+                        return false;
+                    }
+                    if (record_phase != phase)
+                    {
+                        phase = record_phase;
+                        out << "===================" << (phase == 0 ? "ASCENDING" : "NARROWING")
+                            << " PHASE===================" << '\n';
+                        sweep = 0;
+                    }
+                    if (sweeps && iteration != sweep)
+                    {
+                        sweep = iteration;
+                        out << "===================Iteration " << sweep << "===================" << '\n';
+                    }
+                    if (!print_evaluation(out, changed, index, sweeps ? 0 : iteration))
+                    {
+                        return false;
+                    }
+                    break;
+                }
+                default:
+                    return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    template <typename V>
+    bool get(V& value)
+    {
+        if (static_cast<std::size_t>(m_end - m_position) < sizeof(value))
+        {
+            return false;
+        }
+        std::memcpy(&value, m_position, sizeof(value));
+        m_position += sizeof(value);
+        return true;
+    }
+
+    bool read_names()
+    {
+        std::uint32_t first;
+        std::uint32_t count;
+        if (!get(first) || !get(count) || first != m_names.size())
+        {
+            return false;
+        }
+        for (std::uint32_t i = 0; i < count; ++i)
+        {
+            std::uint32_t size;
+            if (!get(size) || static_cast<std::size_t>(m_end - m_position) < size)
+            {
+                return false;
+            }
+            m_names.emplace_back(m_position, size);
+            m_position += size;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Applies and prints the changes of an evaluation
+     *
+     * @param out
+     * @param changed
+     * @param index
+     * @param iteration the evaluation of the location in its phase, or 0 in a sweep
+     */
+    bool print_evaluation(std::ostream& out, std::uint8_t changed, std::uint32_t index, std::uint32_t iteration)
+    {
+        out << "Location " << index << " (" << location_type_name(static_cast<LocationType>(m_types[index])) << ")";
+        if (iteration > 0)
+        {
+            out << ", evaluation " << iteration;
+        }
+        out << (changed == 0 ? " stable" : " not stable") << '\n';
+        for (std::size_t port = 0; port < STORE_PORTS; ++port)
+        {
+            if (((changed >> port) & 1u) == 0)
+            {
+                continue;
+            }
+            std::uint8_t recorded_port;
+            std::uint32_t base_location;
+            std::uint8_t base_port;
+            std::uint32_t count;
+            if (!get(recorded_port) || !get(base_location) || !get(base_port) || !get(count) || recorded_port != port
+                || (base_location != FixpointTraceHeader::NO_BASE && (base_location >= m_stores.size() || base_port >= STORE_PORTS)))
+            {
+                return false;
+            }
+            auto& store = m_stores[index][port];
+            if (base_location != index || base_port != port)
+            {
+                if (base_location == FixpointTraceHeader::NO_BASE)
+                {
+                    store.clear();
+                }
+                else
+                {
+                    store = m_stores[base_location][base_port];
+                }
+            }
+            for (std::uint32_t i = 0; i < count; ++i)
+            {
+                std::uint32_t id;
+                std::uint8_t empty;
+                Bound bound;
+                if (!get(id) || !get(empty) || !get(bound.lb) || !get(bound.ub) || id >= m_names.size())
+                {
+                    return false;
+                }
+                bound.present = true;
+                bound.empty = empty != 0;
+                if (id >= store.size())
+                {
+                    store.resize(id + 1);
+                }
+                store[id] = bound;
+            }
+
+            out << "Store " << port_name(static_cast<StorePort>(port)) << '\n';
+            for (std::size_t id = 0; id < store.size(); ++id)
+            {
+                if (!store[id].present)
+                {
+                    continue;
+                }
+                if (store[id].empty)
+                {
+                    out << m_names[id] << ": Empty" << '\n';
+                }
+                else
+                {
+                    out << m_names[id] << ": [" << store[id].lb << ", " << store[id].ub << "]" << '\n';
+                }
+            }
+        }
+        return true;
+    }
+
+    static const char* port_name(StorePort port)
+    {
+        switch (port)
+        {
+            case StorePort::LAST: return "after";
+            case StorePort::IF_BODY: return "if body";
+            case StorePort::ELSE_BODY: return "else body";
+            case StorePort::WHILE_BODY: return "body";
+            case StorePort::WHILE_EXIT: return "exit";
+        }
+        return "unknown";
+    }
+};
+
+#endif // FIXPOINT_TRACE_HPP
@@ -0,0 +1,449 @@
+#ifndef FLAT_AST_HPP
+#define FLAT_AST_HPP
+
+#include <cstdint>
+#include <initializer_list>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ast.hpp"
+#include "variable_table.hpp"
+
+/**
+ * @brief Abstract syntax tree stored in an arena: the nodes live in a single array and are addressed by
+ * their index, the children of a node are a range of a second array of indices, and the identifiers (as
+ * every other text of the tree) are interned in a table of symbols. The tree is built bottom-up, each
+ * node being added once all its children are, so a subtree can be the child of several nodes. It is
+ * read through Node handles, which are two words and can be copied freely instead of subtrees.
+ *
+ * The nodes hold the same types and values as ASTNode, into which a subtree can be converted (see
+ * Node::to_tree), and hash and print in the same way.
+ *
+ */
+class FlatAST
+{
+public:
+    using Index = std::uint32_t;
+
+    // Alternatives of the value of a node, in the order of ASTNode::VType
+    enum class ValueKind : std::uint8_t {
+        TEXT,
+        INTEGER,
+        BIN_OP,
+        LOGIC_OP
+    };
+
+    struct Value {
+        ValueKind kind = ValueKind::TEXT;
+        std::int64_t payload = 0;   // symbol, integer or operator
+
+        static Value integer(std::int64_t value)
+        {
+            return {ValueKind::INTEGER, value};
+        }
+
+        static Value op(BinOp op)
+        {
+            return {ValueKind::BIN_OP, static_cast<std::int64_t>(op)};
+        }
+
+        static Value op(LogicOp op)
+        {
+            return {ValueKind::LOGIC_OP, static_cast<std::int64_t>(op)};
+        }
+    };
+
+private:
+    struct Entry {
+        NodeType type;
+        Value value;
+        Index first_child;      // in m_children
+        Index child_count;
+    };
+
+    std::vector<Entry> m_nodes;
+    std::vector<Index> m_children;
+    std::vector<std::uint32_t> m_lines;     // source line of the statements, 0 for the other nodes
+    VariableTable m_symbols;
+    Index m_root = 0;
+
+public:
+    class Node;
+
+    /**
+     * @brief Children of a node, as a random-access range of handles
+     *
+     */
+    class Children
+    {
+    private:
+        const FlatAST* m_ast = nullptr;
+        const Index* m_begin = nullptr;
+        const Index* m_end = nullptr;
+
+    public:
+        class iterator
+        {
+        private:
+            const FlatAST* m_ast;
+            const Index* m_position;
+
+        public:
+            iterator(const FlatAST* ast, const Index* position)
+            : m_ast(ast)
+            , m_position(position)
+            {}
+
+            Node operator*() const
+            {
+                return Node(m_ast, *m_position);
+            }
+
+            iterator& operator++()
+            {
+                ++m_position;
+                return *this;
+            }
+
+            bool operator==(const iterator& other) const = default;
+        };
+
+        Children() = default;
+
+        Children(const FlatAST* ast, const Index* begin, const Index* end)
+        : m_ast(ast)
+        , m_begin(begin)
+        , m_end(end)
+        {}
+
+        std::size_t size() const
+        {
+            return m_end - m_begin;
+        }
+
+        bool empty() const
+        {
+            return m_begin == m_end;
+        }
+
+        Node operator[](std::size_t i) const
+        {
+            return Node(m_ast, m_begin[i]);
+        }
+
+        iterator begin() const
+        {
+            return iterator(m_ast, m_begin);
+        }
+
+        iterator end() const
+        {
+            return iterator(m_ast, m_end);
+        }
+    };
+
+    /**
+     * @brief Handle of a node, valid as long as its tree is neither destroyed nor extended
+     *
+     */
+    class Node
+    {
+    private:
+        const FlatAST* m_ast = nullptr;
+        Index m_index = 0;
+
+    public:
+        Node() = default;
+
+        Node(const FlatAST* ast, Index index)
+        : m_ast(ast)
+        , m_index(index)
+        {}
+
+        Index index() const
+        {
+            return m_index;
+        }
+
+        NodeType type() const
+        {
+            return entry().type;
+        }
+
+        ValueKind kind() const
+        {
+            return entry().value.kind;
+        }
+
+        Children children() const
+        {
+            const auto* first = m_ast->m_children.data() + entry().first_child;
+            return Children(m_ast, first, first + entry().child_count);
+        }
+
+        std::size_t size() const
+        {
+            return entry().child_count;
+        }
+
+        Node child(std::size_t i) const
+        {
+            return Node(m_ast, m_ast->m_children[entry().first_child + i]);
+        }
+
+        /**
+         * @brief Symbol of the text of the node, such as the name of a variable
+         *
+         */
+        std::size_t symbol() const
+        {
+            return static_cast<std::size_t>(entry().value.payload);
+        }
+
+        const std::string& text() const
+        {
+            return m_ast->m_symbols.name(symbol());
+        }
+
+        std::int64_t integer() const
+        {
+            return entry().value.payload;
+        }
+
+        BinOp bin_op() const
+        {
+            return static_cast<BinOp>(entry().value.payload);
+        }
+
+        LogicOp logic_op() const
+        {
+            return static_cast<LogicOp>(entry().value.payload);
+        }
+
+        /**
+         * @brief Structural hash of the subtree, equal to ASTNode::hash of the same subtree
+         *
+         */
+        std::uint64_t hash() const
+        {
+            std::uint64_t h = 0xcbf29ce484222325ull;
+            auto mix = [&h](std::uint64_t word) {
+                for (int byte = 0; byte < 8; ++byte)
+                {
+                    h = (h ^ ((word >> (8 * byte)) & 0xff)) * 0x100000001b3ull;
+                }
+            };
+            mix(static_cast<std::uint64_t>(type()));
+            mix(static_cast<std::uint64_t>(kind()));
+            if (kind() == ValueKind::TEXT)
+            {
+                const auto& name = text();
+                mix(name.size());
+                for (unsigned char c : name)
+                {
+                    h = (h ^ c) * 0x100000001b3ull;
+                }
+            }
+            else
+            {
+                mix(static_cast<std::uint64_t>(entry().value.payload));
+            }
+            mix(size());
+            for (auto child : children())
+            {
+                mix(child.hash());
+            }
+            return h;
+        }
+
+        /**
+         * @brief Copies the subtree into an ASTNode
+         *
+         */
+        ASTNode to_tree() const
+        {
+            ASTNode node(type(), value());
+            node.children.reserve(size());
+            for (auto child : children())
+            {
+                node.children.push_back(child.to_tree());
+            }
+            return node;
+        }
+
+        void print(int depth = 0) const
+        {
+            std::string indent(depth * 2, ' ');
+            std::cout << indent << "NodeType: " << type() << ", Value: ";
+            ASTNode::printVariant(value());
+            for (auto child : children())
+            {
+                child.print(depth + 1);
+            }
+        }
+
+    private:
+        const Entry& entry() const
+        {
+            return m_ast->m_nodes[m_index];
+        }
+
+        ASTNode::VType value() const
+        {
+            switch (kind())
+            {
+                case ValueKind::TEXT: return text();
+                case ValueKind::INTEGER: return integer();
+                case ValueKind::BIN_OP: return bin_op();
+                case ValueKind::LOGIC_OP: return logic_op();
+            }
+            return text();
+        }
+    };
+
+    FlatAST() = default;
+
+    /**
+     * @brief Copies a tree into an arena
+     *
+     * @param tree
+     * @return FlatAST
+     */
+    static FlatAST from(const ASTNode& tree)
+    {
+        FlatAST ast;
+        ast.set_root(ast.add_tree(tree));
+        return ast;
+    }
+
+    /**
+     * @brief Interns a text, as the value of a node
+     *
+     * @param text
+     * @return Value
+     */
+    Value text(std::string_view text)
+    {
+        return {ValueKind::TEXT, static_cast<std::int64_t>(m_symbols.intern(text))};
+    }
+
+    /**
+     * @brief Adds a node whose children were already added
+     *
+     * @param type
+     * @param value
+     * @param children
+     * @return Index
+     */
+    Index add(NodeType type, Value value, std::initializer_list<Index> children = {})
+    {
+        return add(type, value, children.begin(), children.size());
+    }
+
+    Index add(NodeType type, Value value, const std::vector<Index>& children)
+    {
+        return add(type, value, children.data(), children.size());
+    }
+
+    /**
+     * @brief Reserves room for the given number of nodes, with one child each on average
+     *
+     * @param nodes
+     */
+    void reserve(std::size_t nodes)
+    {
+        m_nodes.reserve(nodes);
+        m_children.reserve(nodes);
+    }
+
+    NodeType type(Index index) const
+    {
+        return m_nodes[index].type;
+    }
+
+    Value value(Index index) const
+    {
+        return m_nodes[index].value;
+    }
+
+    void set_root(Index root)
+    {
+        m_root = root;
+    }
+
+    /**
+     * @brief Line of the source at which a statement starts, 0 if the node is not a statement or the tree
+     * was not parsed from a source
+     *
+     * @param index
+     */
+    std::uint32_t line(Index index) const
+    {
+        return index < m_lines.size() ? m_lines[index] : 0;
+    }
+
+    void set_line(Index index, std::uint32_t line)
+    {
+        if (line == 0)
+        {
+            return;
+        }
+        if (m_lines.size() <= index)
+        {
+            m_lines.resize(m_nodes.size(), 0);
+        }
+        m_lines[index] = line;
+    }
+
+    Node root() const
+    {
+        return Node(this, m_root);
+    }
+
+    Node node(Index index) const
+    {
+        return Node(this, index);
+    }
+
+    std::size_t size() const
+    {
+        return m_nodes.size();
+    }
+
+    const VariableTable& symbols() const
+    {
+        return m_symbols;
+    }
+
+private:
+    Index add(NodeType type, Value value, const Index* children, std::size_t count)
+    {
+        auto first = static_cast<Index>(m_children.size());
+        m_children.insert(m_children.end(), children, children + count);
+        m_nodes.push_back({type, value, first, static_cast<Index>(count)});
+        return static_cast<Index>(m_nodes.size() - 1);
+    }
+
+    Index add_tree(const ASTNode& tree)
+    {
+        std::vector<Index> children;
+        children.reserve(tree.children.size());
+        for (const auto& child : tree.children)
+        {
+            children.push_back(add_tree(child));
+        }
+        Value value;
+        switch (tree.value.index())
+        {
+            case 0: value = text(std::get<std::string>(tree.value)); break;
+            case 1: value = Value::integer(std::get<std::int64_t>(tree.value)); break;
+            case 2: value = Value::op(std::get<BinOp>(tree.value)); break;
+            case 3: value = Value::op(std::get<LogicOp>(tree.value)); break;
+        }
+        return add(tree.type, value, children);
+    }
+};
+
+#endif // FLAT_AST_HPP
@@ -0,0 +1,290 @@
+#ifndef FUNCTION_SUMMARIES_HPP
+#define FUNCTION_SUMMARIES_HPP
+
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "analysis_error.hpp"
+#include "flat_ast.hpp"
+#include "interval.hpp"
+
+/**
+ * @brief Functions of a program and their summaries.
+ *
+ * Every definition `int f(int a, int b) { ... return e; }` becomes a program of its own: its declarations are
+ * the parameters, the local variables declared at the top level of the body and RESULT, and its statements are
+ * those of the body followed by `RESULT = e`. A summary maps the intervals of the arguments of a call to the
+ * interval of RESULT at the end of that program, so that the body is analyzed once per distinct tuple of
+ * arguments instead of once per call.
+ *
+ * A function only reads its parameters and local variables, has no preconditions or postconditions, and only
+ * calls the functions defined before it, so that it cannot be recursive. The table is shared by the
+ * interpreter of the program and by those of its functions, from any thread.
+ *
+ * @tparam T
+ */
+template <typename T>
+class FunctionTable
+{
+public:
+    // The variable that holds the returned value, which no identifier can name
+    static constexpr const char* RESULT = "@return";
+
+    struct Function {
+        std::string name;
+        std::vector<std::string> parameters;
+        FlatAST program;
+    };
+
+private:
+    using Index = FlatAST::Index;
+    using Arguments = std::vector<T>;   // the bounds of every argument, in order
+
+    std::vector<Function> m_functions;
+    std::unordered_map<std::string, std::size_t> m_indices;
+
+    mutable std::mutex m_mutex;
+    std::map<std::pair<std::size_t, Arguments>, Interval<T>> m_summaries;
+    std::size_t m_reuses = 0;
+
+public:
+    /**
+     * @brief Adds the definition of a function, exiting on the programs described above that are not accepted
+     *
+     * @param source the program of the definition
+     * @param definition a FUNCTION node: the declaration of the parameters, the body and the returned expression
+     */
+    void add(const FlatAST& source, FlatAST::Node definition)
+    {
+        Function function;
+        function.name = definition.text();
+        if (m_indices.contains(function.name))
+        {
+            error(function.name, "is defined twice");
+        }
+
+        std::unordered_set<std::string> variables;
+        for (auto parameter : definition.child(0).children())
+        {
+            function.parameters.push_back(parameter.text());
+            variables.insert(parameter.text());
+        }
+        auto body = definition.child(1);
+        for (auto statement : body.children())
+        {
+            if (statement.type() == NodeType::DECLARATION)
+            {
+                for (auto local : statement.children())
+                {
+                    if (local.type() == NodeType::VARIABLE)
+                    {
+                        variables.insert(local.text());
+                    }
+                }
+            }
+        }
+        check(function.name, body, variables);
+        check(function.name, definition.child(2), variables);
+
+        function.program = program(source, definition);
+        m_indices[function.name] = m_functions.size();
+        m_functions.push_back(std::move(function));
+    }
+
+    std::optional<std::size_t> find(const std::string& name) const
+    {
+        auto it = m_indices.find(name);
+        if (it == m_indices.end())
+        {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+    const Function& function(std::size_t index) const
+    {
+        return m_functions[index];
+    }
+
+    std::size_t size() const
+    {
+        return m_functions.size();
+    }
+
+    /**
+     * @brief Summary of a function for the given arguments, if it was already computed
+     *
+     */
+    std::optional<Interval<T>> lookup(std::size_t function, const std::vector<Interval<T>>& arguments)
+    {
+        std::lock_guard lock(m_mutex);
+        auto it = m_summaries.find({function, key(arguments)});
+        if (it == m_summaries.end())
+        {
+            return std::nullopt;
+        }
+        m_reuses++;
+        return it->second;
+    }
+
+    /**
+     * @brief Records the summary of a function for the given arguments. Two threads may compute the same
+     * summary concurrently: the analysis is deterministic, and the first one is kept.
+     *
+     */
+    void insert(std::size_t function, const std::vector<Interval<T>>& arguments, const Interval<T>& result)
+    {
+        std::lock_guard lock(m_mutex);
+        m_summaries.emplace(std::make_pair(function, key(arguments)), result);
+    }
+
+    /**
+     * @brief Number of summaries computed, and of calls that reused one of them
+     *
+     */
+    std::size_t summaries() const
+    {
+        std::lock_guard lock(m_mutex);
+        return m_summaries.size();
+    }
+
+    std::size_t reuses() const
+    {
+        std::lock_guard lock(m_mutex);
+        return m_reuses;
+    }
+
+private:
+    [[noreturn]] static void error(const std::string& function, const std::string& message)
+    {
+        throw AnalysisError("function `" + function + "` " + message);
+    }
+
+    static Arguments key(const std::vector<Interval<T>>& arguments)
+    {
+        Arguments bounds;
+        bounds.reserve(2 * arguments.size());
+        for (const auto& argument : arguments)
+        {
+            bounds.push_back(argument.lb());
+            bounds.push_back(argument.ub());
+        }
+        return bounds;
+    }
+
+    // Checks the variables, calls and statements of a subtree of the function
+    void check(const std::string& function, FlatAST::Node node, const std::unordered_set<std::string>& variables) const
+    {
+        switch (node.type())
+        {
+            case NodeType::VARIABLE:
+            {
+                if (!variables.contains(node.text()))
+                {
+                    error(function, "reads `" + node.text() + "`, which is neither a parameter nor a local variable");
+                }
+                break;
+            }
+            case NodeType::CALL:
+            {
+                auto callee = find(node.text());
+                if (!callee.has_value())
+                {
+                    error(function, "calls `" + node.text() + "`, which is not defined before it");
+                }
+                if (m_functions[*callee].parameters.size() != node.size())
+                {
+                    error(function, "calls `" + node.text() + "` with " + std::to_string(node.size()) + " arguments");
+                }
+                break;
+            }
+            case NodeType::PRE_CON:
+            case NodeType::POST_CON:
+            {
+                error(function, "holds a precondition or a postcondition");
+            }
+            case NodeType::FUNCTION:
+            {
+                error(function, "holds the definition of `" + node.text() + "`");
+            }
+            default:
+            {
+                break;
+            }
+        }
+        for (auto child : node.children())
+        {
+            check(function, child, variables);
+        }
+    }
+
+    /**
+     * @brief Builds the program that computes the result of a function
+     *
+     */
+    static FlatAST program(const FlatAST& source, FlatAST::Node definition)
+    {
+        FlatAST target;
+        std::vector<Index> copies(source.size(), std::numeric_limits<Index>::max());
+        auto copy = [&](auto& self, FlatAST::Node node) -> Index {
+            if (copies[node.index()] != std::numeric_limits<Index>::max())
+            {
+                return copies[node.index()];
+            }
+            std::vector<Index> children;
+            children.reserve(node.size());
+            for (auto child : node.children())
+            {
+                children.push_back(self(self, child));
+            }
+            auto value = source.value(node.index());
+            if (value.kind == FlatAST::ValueKind::TEXT)
+            {
+                value = target.text(node.text());
+            }
+            auto index = target.add(node.type(), value, children);
+            copies[node.index()] = index;
+            return index;
+        };
+
+        std::vector<Index> variables;
+        for (auto parameter : definition.child(0).children())
+        {
+            variables.push_back(copy(copy, parameter));
+        }
+        std::vector<Index> statements;
+        for (auto statement : definition.child(1).children())
+        {
+            if (statement.type() != NodeType::DECLARATION)
+            {
+                statements.push_back(copy(copy, statement));
+                continue;
+            }
+            for (auto local : statement.children())
+            {
+                if (local.type() == NodeType::VARIABLE)
+                {
+                    variables.push_back(copy(copy, local));
+                }
+            }
+        }
+        auto result = target.add(NodeType::VARIABLE, target.text(RESULT));
+        variables.push_back(result);
+        statements.push_back(target.add(NodeType::ASSIGNMENT, target.text("="), {result, copy(copy, definition.child(2))}));
+
+        auto declaration = target.add(NodeType::DECLARATION, target.text("int"), variables);
+        auto body = target.add(NodeType::SEQUENCE, target.text(";"), statements);
+        target.set_root(target.add(NodeType::INTEGER, FlatAST::Value::integer(0), {declaration, body}));
+        return target;
+    }
+};
+
+#endif // FUNCTION_SUMMARIES_HPP
@@ -0,0 +1,65 @@
+#ifndef INCREMENTAL_ANALYSIS_HPP
+#define INCREMENTAL_ANALYSIS_HPP
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "equational_interpreter.hpp"
+
+/**
+ * @brief Analyzes successive versions of a program. Every analysis reuses the fixpoint of the previous
+ * one for the leading top-level statements that did not change, so that editing the end of a file
+ * only solves the locations after the edit (see EquationalInterpreter::reuse).
+ *
+ * @tparam T
+ */
+template <typename T>
+class IncrementalAnalysis
+{
+private:
+    std::function<void(EquationalInterpreter<T>&)> m_configure;
+    std::unique_ptr<EquationalInterpreter<T>> m_last;
+
+public:
+    /**
+     * @brief Creates a session whose analyses are all set up by the given function
+     *
+     * @param configure called on every interpreter before it runs, to select its settings
+     */
+    explicit IncrementalAnalysis(std::function<void(EquationalInterpreter<T>&)> configure = nullptr)
+    : m_configure(std::move(configure))
+    {}
+
+    ~IncrementalAnalysis() = default;
+
+    /**
+     * @brief Analyzes a new version of the program
+     *
+     * @param input
+     * @return EquationalInterpreter<T>* the completed analysis, or nullptr if the input could not be
+     * parsed, in which case the next version is compared with the last one that was analyzed. A version
+     * that cannot be analyzed throws an AnalysisError, and the next version is then analyzed from scratch.
+     */
+    EquationalInterpreter<T>* analyze(std::string_view input)
+    {
+        auto interpreter = std::make_unique<EquationalInterpreter<T>>(input);
+        if (!interpreter->parsed())
+        {
+            return nullptr;
+        }
+        if (m_configure)
+        {
+            m_configure(*interpreter);
+        }
+        if (m_last != nullptr)
+        {
+            interpreter->reuse(std::move(m_last));
+        }
+        interpreter->run();
+        m_last = std::move(interpreter);
+        return m_last.get();
+    }
+};
+
+#endif // INCREMENTAL_ANALYSIS_HPP
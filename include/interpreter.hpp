@@ -38,10 +38,9 @@ public:
     AbstractInterpreter() = default;
     ~AbstractInterpreter() = default;
 
-    AbstractInterpreter(const std::string& input)
+    AbstractInterpreter(std::string_view input)
     {
-        AbstractInterpreterParser AIParser;
-        m_ast = AIParser.parse(input);
+        m_ast = AbstractInterpreterParser::parse_program(input).root().to_tree();
     }
 
     AbstractInterpreter(const ASTNode ast)
@@ -199,16 +198,16 @@ private:
             {
                 if (variable_on_left)
                 {
-                    m_interval_store.get(var).ub() = val;
-                    m_precondition_store.get(var).ub() = val;
+                    m_interval_store.set(var, {m_interval_store.get(var).lb(), val});
+                    m_precondition_store.set(var, {m_precondition_store.get(var).lb(), val});
                     #ifdef DEBUG
                     std::cout << "Reduced upper bound of " << var << " to " << val << std::endl;
                     #endif
                 }
                 else
                 {
-                    m_interval_store.get(var).lb() = val;
-                    m_precondition_store.get(var).lb() = val;
+                    m_interval_store.set(var, {val, m_interval_store.get(var).ub()});
+                    m_precondition_store.set(var, {val, m_precondition_store.get(var).ub()});
                     #ifdef DEBUG
                     std::cout << "Reduced lower bound of " << var << " to " << val << std::endl;
                     #endif
@@ -220,16 +219,16 @@ private:
             {
                 if (variable_on_left)
                 {
-                    m_interval_store.get(var).lb() = val;
-                    m_precondition_store.get(var).lb() = val;
+                    m_interval_store.set(var, {val, m_interval_store.get(var).ub()});
+                    m_precondition_store.set(var, {val, m_precondition_store.get(var).ub()});
                     #ifdef DEBUG
                     std::cout << "Reduced lower bound of " << var << " to " << val << std::endl;
                     #endif
                 }
                 else
                 {
-                    m_interval_store.get(var).ub() = val;
-                    m_precondition_store.get(var).ub() = val;
+                    m_interval_store.set(var, {m_interval_store.get(var).lb(), val});
+                    m_precondition_store.set(var, {m_precondition_store.get(var).lb(), val});
                     #ifdef DEBUG
                     std::cout << "Reduced upper bound of " << var << " to " << val << std::endl;
                     #endif
@@ -281,7 +280,7 @@ private:
         //     // std::cerr << "Assignment does not respect precondition for " << var << std::endl;
 
         // }
-        m_interval_store.get(var) = result;
+        m_interval_store.set(var, result);
 
         #ifdef DEBUG
         std::cout << "Interval of variable " << var <<" : [" << m_interval_store.get(var).lb() << ", " << m_interval_store.get(var).ub() << "]" << std::endl;
@@ -460,7 +459,7 @@ private:
             std::cout << "Condition is respected for " << changed_var << " [" << if_body_interval.lb() << "," << if_body_interval.ub() << "]" << std::endl;
             #endif
 
-            m_interval_store.get(changed_var) = if_body_interval;
+            m_interval_store.set(changed_var, if_body_interval);
 
             for (const auto& child : if_body.children)
             {
@@ -509,7 +508,7 @@ private:
             // Evaluate the case for the left interval if it's in the original
             if (original_interval.contains(left_interval))
             {
-                m_interval_store.get(changed_var) = left_interval;
+                m_interval_store.set(changed_var, left_interval);
                 for (const auto& child : else_body.children)
                 {
                     eval(child);
@@ -526,7 +525,7 @@ private:
 
             if (original_interval.contains(right_interval))
             {
-                m_interval_store.get(changed_var) = right_interval;
+                m_interval_store.set(changed_var, right_interval);
                 for (const auto& child : else_body.children)
                 {
                     eval(child);
@@ -608,6 +607,15 @@ private:
         return {res, var};
     }
 
+    Interval<T> warn_on_overflow(const Interval<T>& interval)
+    {
+        if (interval.overflowed())
+        {
+            std::cerr << "!WARNING!: OVERFLOW" << std::endl;
+        }
+        return interval;
+    }
+
     /**
      * @brief Evaluates an expression in the AST by performing a depth traversal of the syntactic tree representing the expression, computing
      * the resulting interval
@@ -635,15 +643,15 @@ private:
             {
                 case BinOp::ADD:
                 {
-                    return left + right;
+                    return warn_on_overflow(left + right);
                 }
                 case BinOp::SUB:
                 {
-                    return left - right;
+                    return warn_on_overflow(left - right);
                 }
                 case BinOp::MUL:
                 {
-                    return left * right;
+                    return warn_on_overflow(left * right);
                 }
                 case BinOp::DIV:
                 {
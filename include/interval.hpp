@@ -1,7 +1,152 @@
 #ifndef INTERVAL_HPP
 #define INTERVAL_HPP
 
+#include <algorithm>
+#include <cstdint>
 #include <limits>
+#include <type_traits>
+
+/**
+ * @brief Saturating arithmetic on the bounds of intervals: a result that does not fit in T is clamped to
+ * the range of T, which then stands for an infinite bound, and the overflow flag is raised. The generic
+ * version compares against the limits before operating; the widths used by the analysis are specialized
+ * below with the overflow builtins of the compiler.
+ *
+ * @tparam T
+ */
+template <typename T>
+struct BoundArithmetic {
+    static constexpr T min_T = std::numeric_limits<T>::min();
+    static constexpr T max_T = std::numeric_limits<T>::max();
+
+    static T add(T a, T b, bool& overflow)
+    {
+        if (b > 0 && a > max_T - b) { overflow = true; return max_T; }
+        if (b < 0 && a < min_T - b) { overflow = true; return min_T; }
+        return a + b;
+    }
+
+    static T sub(T a, T b, bool& overflow)
+    {
+        if (b < 0 && a > max_T + b) { overflow = true; return max_T; }
+        if (b > 0 && a < min_T + b) { overflow = true; return min_T; }
+        return a - b;
+    }
+
+    static T mul(T a, T b, bool& overflow)
+    {
+        if (a == 0 || b == 0)
+        {
+            return 0;
+        }
+        bool overflows = a > 0 ? (b > 0 ? a > max_T / b : b < min_T / a)
+                               : (b > 0 ? a < min_T / b : a < max_T / b);
+        if (overflows)
+        {
+            overflow = true;
+            return (a < 0) != (b < 0) ? min_T : max_T;
+        }
+        return a * b;
+    }
+
+    // The divisor is not 0; the smallest value of a signed type divided by -1 is the only quotient out of range
+    static T div(T a, T b, bool& overflow)
+    {
+        if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+        {
+            if (a == min_T && b == T(-1))
+            {
+                overflow = true;
+                return max_T;
+            }
+        }
+        return a / b;
+    }
+};
+
+template <>
+struct BoundArithmetic<std::int64_t> {
+    using T = std::int64_t;
+    static constexpr T min_T = std::numeric_limits<T>::min();
+    static constexpr T max_T = std::numeric_limits<T>::max();
+
+    static T add(T a, T b, bool& overflow)
+    {
+        T result;
+        if (__builtin_add_overflow(a, b, &result))
+        {
+            overflow = true;
+            return b > 0 ? max_T : min_T;
+        }
+        return result;
+    }
+
+    static T sub(T a, T b, bool& overflow)
+    {
+        T result;
+        if (__builtin_sub_overflow(a, b, &result))
+        {
+            overflow = true;
+            return b < 0 ? max_T : min_T;
+        }
+        return result;
+    }
+
+    static T mul(T a, T b, bool& overflow)
+    {
+        T result;
+        if (__builtin_mul_overflow(a, b, &result))
+        {
+            overflow = true;
+            return (a < 0) != (b < 0) ? min_T : max_T;
+        }
+        return result;
+    }
+
+    static T div(T a, T b, bool& overflow)
+    {
+        if (a == min_T && b == -1)
+        {
+            overflow = true;
+            return max_T;
+        }
+        return a / b;
+    }
+};
+
+// 32-bit bounds are computed exactly on 64 bits and clamped back
+template <>
+struct BoundArithmetic<std::int32_t> {
+    using T = std::int32_t;
+    static constexpr std::int64_t min_T = std::numeric_limits<T>::min();
+    static constexpr std::int64_t max_T = std::numeric_limits<T>::max();
+
+    static T clamp(std::int64_t value, bool& overflow)
+    {
+        overflow |= value < min_T || value > max_T;
+        return static_cast<T>(std::clamp(value, min_T, max_T));
+    }
+
+    static T add(T a, T b, bool& overflow)
+    {
+        return clamp(std::int64_t(a) + b, overflow);
+    }
+
+    static T sub(T a, T b, bool& overflow)
+    {
+        return clamp(std::int64_t(a) - b, overflow);
+    }
+
+    static T mul(T a, T b, bool& overflow)
+    {
+        return clamp(std::int64_t(a) * b, overflow);
+    }
+
+    static T div(T a, T b, bool& overflow)
+    {
+        return clamp(std::int64_t(a) / b, overflow);
+    }
+};
 
 template <typename T>
 class Interval{
@@ -12,6 +157,8 @@ private:
 public: 
 
     bool m_is_empty = false;
+    // Set by an arithmetic operation whose bounds were clamped to the range of T. Not part of the value.
+    bool m_overflow = false;
     T m_lb;
     T m_ub;
     // Default constructor
@@ -28,16 +175,22 @@ public:
 
     // Copy constructor
     Interval(const Interval<T>& other)
-    : m_lb(other.m_lb)
+    : m_is_empty(other.m_is_empty)
+    , m_overflow(other.m_overflow)
+    , m_lb(other.m_lb)
     , m_ub(other.m_ub)
     {}
 
+    Interval<T>& operator=(const Interval<T>& other) = default;
+
     // Default destructor
     ~Interval() = default;
 
     // Getters and Setters
     T& lb() { return m_lb; }
     T& ub() { return m_ub; }
+    const T& lb() const { return m_lb; }
+    const T& ub() const { return m_ub; }
 
 
     // ===============================================================================
@@ -141,51 +294,85 @@ public:
         return Interval<T>(value, value);
     }
 
+    // Expressions over an empty interval (an unreachable store) are empty as well
+    static Interval<T> empty()
+    {
+        Interval<T> interval;
+        interval.m_is_empty = true;
+        return interval;
+    }
+
+    using Arithmetic = BoundArithmetic<T>;
+
+    /**
+     * @brief Tells if the bounds of the interval were clamped to the range of T by the operation that
+     * computed it
+     *
+     */
+    bool overflowed() const
+    {
+        return m_overflow;
+    }
+
     Interval<T> operator+(Interval<T>& other) const
     {
-        if (m_lb > max_T - other.ub() || m_ub > max_T - other.lb())
+        if (m_is_empty || other.m_is_empty)
         {
-            std::cerr << "Overflow Encountered in evaluating addition" << std::endl;
+            return empty();
         }
-        return Interval<T>(m_lb + other.lb(), m_ub +  other.ub());
+        bool overflow = false;
+        Interval<T> result(Arithmetic::add(m_lb, other.lb(), overflow), Arithmetic::add(m_ub, other.ub(), overflow));
+        result.m_overflow = overflow;
+        return result;
     }
 
     Interval<T> operator-(Interval<T>& other) const
     {
-        if (m_lb < min_T + other.ub() || m_ub < min_T + other.lb())
+        if (m_is_empty || other.m_is_empty)
         {
-            std::cerr << "Overflow Encountered in evaluating subtraction" << std::endl;
+            return empty();
         }
-        return Interval<T>(m_lb - other.ub(), m_ub - other.lb());
+        bool overflow = false;
+        Interval<T> result(Arithmetic::sub(m_lb, other.ub(), overflow), Arithmetic::sub(m_ub, other.lb(), overflow));
+        result.m_overflow = overflow;
+        return result;
     }
 
     Interval<T> operator-() const 
     {
-        if (m_lb == min_T)
+        if (m_is_empty)
         {
-            std::cerr << "Overflow Encountered in evaluating negation" << std::endl;
+            return empty();
         }
-        return Interval<T>(-m_ub, -m_lb);
+        bool overflow = false;
+        Interval<T> result(Arithmetic::sub(0, m_ub, overflow), Arithmetic::sub(0, m_lb, overflow));
+        result.m_overflow = overflow;
+        return result;
     }
 
     Interval<T> operator*(Interval<T>& other) const
     {
-        
-        if (m_lb > max_T / other.ub() || m_ub > max_T / other.lb())
+        if (m_is_empty || other.m_is_empty)
         {
-            std::cerr << "Overflow Encountered in evaluating multiplication" << std::endl;
+            return empty();
         }
 
-        T other_lb = other.lb();
-        T other_ub = other.ub();
-        T new_lb = std::min({m_lb * other_lb, m_lb * other_ub, m_ub * other_lb, m_ub * other_ub});
-        T new_ub = std::max({m_lb * other_lb, m_lb * other_ub, m_ub * other_lb, m_ub * other_ub});
-        
-        return Interval<T>(new_lb, new_ub);
+        bool overflow = false;
+        T ll = Arithmetic::mul(m_lb, other.lb(), overflow);
+        T lu = Arithmetic::mul(m_lb, other.ub(), overflow);
+        T ul = Arithmetic::mul(m_ub, other.lb(), overflow);
+        T uu = Arithmetic::mul(m_ub, other.ub(), overflow);
+        Interval<T> result(std::min(std::min(ll, lu), std::min(ul, uu)), std::max(std::max(ll, lu), std::max(ul, uu)));
+        result.m_overflow = overflow;
+        return result;
     }
 
     Interval<T> operator/(Interval<T>& other) const
     {
+        if (m_is_empty || other.m_is_empty)
+        {
+            return empty();
+        }
 
         T other_lb = other.lb();
         T other_ub = other.ub();
@@ -195,9 +382,14 @@ public:
         }
         else
         {
-            T new_lb = std::min({m_lb / other_lb, m_lb / other_ub, m_ub / other_lb, m_ub / other_ub});
-            T new_ub = std::max({m_lb / other_lb, m_lb / other_ub, m_ub / other_lb, m_ub / other_ub});
-            return Interval<T>(new_lb, new_ub);
+            bool overflow = false;
+            T ll = Arithmetic::div(m_lb, other_lb, overflow);
+            T lu = Arithmetic::div(m_lb, other_ub, overflow);
+            T ul = Arithmetic::div(m_ub, other_lb, overflow);
+            T uu = Arithmetic::div(m_ub, other_ub, overflow);
+            Interval<T> result(std::min({ll, lu, ul, uu}), std::max({ll, lu, ul, uu}));
+            result.m_overflow = overflow;
+            return result;
         }
     }
 
@@ -232,6 +424,11 @@ public:
     {
         return m_is_empty;
     }
+
+    bool is_empty() const
+    {
+        return m_is_empty;
+    }
 };
 
 #endif // INTERVAL_HPP
\ No newline at end of file
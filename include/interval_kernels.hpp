@@ -0,0 +1,221 @@
+#ifndef INTERVAL_KERNELS_HPP
+#define INTERVAL_KERNELS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__) || defined(__SSE4_2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+/**
+ * @brief Comparison and selection kernels over blocks of LANES bounds, on which the store-wide lattice
+ * operations of IntervalStore are built. A comparison yields a mask with bit i set when it holds for
+ * lane i, so that it can be combined with the emptiness masks of the stores by plain bit operations.
+ *
+ * The generic version is scalar. The version for 64-bit bounds uses AVX2, SSE4.2 or NEON when the
+ * compiler targets them, and falls back to the scalar loops otherwise.
+ *
+ * @tparam T
+ */
+template <typename T>
+struct IntervalKernels {
+    using Mask = std::uint64_t;
+    static constexpr std::size_t LANES = 64;
+
+    /**
+     * @brief Returns the lanes where a[i] < b[i]
+     *
+     * @param a
+     * @param b
+     * @return Mask
+     */
+    static Mask less(const T* a, const T* b)
+    {
+        Mask mask = 0;
+        for (std::size_t i = 0; i < LANES; ++i)
+        {
+            mask |= static_cast<Mask>(a[i] < b[i]) << i;
+        }
+        return mask;
+    }
+
+    /**
+     * @brief Returns the lanes where a[i] != b[i]
+     *
+     * @param a
+     * @param b
+     * @return Mask
+     */
+    static Mask not_equal(const T* a, const T* b)
+    {
+        Mask mask = 0;
+        for (std::size_t i = 0; i < LANES; ++i)
+        {
+            mask |= static_cast<Mask>(a[i] != b[i]) << i;
+        }
+        return mask;
+    }
+
+    /**
+     * @brief Copies src[i] into dst[i] for the lanes of the mask
+     *
+     * @param dst
+     * @param src
+     * @param mask
+     */
+    static void copy_lanes(T* dst, const T* src, Mask mask)
+    {
+        for (std::size_t i = 0; i < LANES; ++i)
+        {
+            dst[i] = (mask >> i) & 1 ? src[i] : dst[i];
+        }
+    }
+};
+
+#if defined(__AVX2__)
+
+template <>
+struct IntervalKernels<std::int64_t> {
+    using Mask = std::uint64_t;
+    static constexpr std::size_t LANES = 64;
+
+    static Mask less(const std::int64_t* a, const std::int64_t* b)
+    {
+        Mask mask = 0;
+        for (std::size_t i = 0; i < LANES; i += 4)
+        {
+            auto lt = _mm256_cmpgt_epi64(load(b + i), load(a + i));
+            mask |= static_cast<Mask>(_mm256_movemask_pd(_mm256_castsi256_pd(lt))) << i;
+        }
+        return mask;
+    }
+
+    static Mask not_equal(const std::int64_t* a, const std::int64_t* b)
+    {
+        Mask mask = 0;
+        for (std::size_t i = 0; i < LANES; i += 4)
+        {
+            auto eq = _mm256_cmpeq_epi64(load(a + i), load(b + i));
+            mask |= static_cast<Mask>(_mm256_movemask_pd(_mm256_castsi256_pd(eq))) << i;
+        }
+        return ~mask;
+    }
+
+    static void copy_lanes(std::int64_t* dst, const std::int64_t* src, Mask mask)
+    {
+        const auto bits = _mm256_setr_epi64x(1, 2, 4, 8);
+        for (std::size_t i = 0; i < LANES && (mask >> i) != 0; i += 4)
+        {
+            // Spreads the four bits of the mask over the four lanes
+            auto lanes = _mm256_and_si256(_mm256_set1_epi64x(static_cast<long long>(mask >> i)), bits);
+            auto select = _mm256_cmpeq_epi64(lanes, bits);
+            auto blended = _mm256_blendv_epi8(load(dst + i), load(src + i), select);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), blended);
+        }
+    }
+
+private:
+    static __m256i load(const std::int64_t* p)
+    {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    }
+};
+
+#elif defined(__SSE4_2__)
+
+template <>
+struct IntervalKernels<std::int64_t> {
+    using Mask = std::uint64_t;
+    static constexpr std::size_t LANES = 64;
+
+    static Mask less(const std::int64_t* a, const std::int64_t* b)
+    {
+        Mask mask = 0;
+        for (std::size_t i = 0; i < LANES; i += 2)
+        {
+            auto lt = _mm_cmpgt_epi64(load(b + i), load(a + i));
+            mask |= static_cast<Mask>(_mm_movemask_pd(_mm_castsi128_pd(lt))) << i;
+        }
+        return mask;
+    }
+
+    static Mask not_equal(const std::int64_t* a, const std::int64_t* b)
+    {
+        Mask mask = 0;
+        for (std::size_t i = 0; i < LANES; i += 2)
+        {
+            auto eq = _mm_cmpeq_epi64(load(a + i), load(b + i));
+            mask |= static_cast<Mask>(_mm_movemask_pd(_mm_castsi128_pd(eq))) << i;
+        }
+        return ~mask;
+    }
+
+    static void copy_lanes(std::int64_t* dst, const std::int64_t* src, Mask mask)
+    {
+        const auto bits = _mm_set_epi64x(2, 1);
+        for (std::size_t i = 0; i < LANES && (mask >> i) != 0; i += 2)
+        {
+            auto lanes = _mm_and_si128(_mm_set1_epi64x(static_cast<long long>(mask >> i)), bits);
+            auto select = _mm_cmpeq_epi64(lanes, bits);
+            auto blended = _mm_blendv_epi8(load(dst + i), load(src + i), select);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), blended);
+        }
+    }
+
+private:
+    static __m128i load(const std::int64_t* p)
+    {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    }
+};
+
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+
+template <>
+struct IntervalKernels<std::int64_t> {
+    using Mask = std::uint64_t;
+    static constexpr std::size_t LANES = 64;
+
+    static Mask less(const std::int64_t* a, const std::int64_t* b)
+    {
+        Mask mask = 0;
+        for (std::size_t i = 0; i < LANES; i += 2)
+        {
+            mask |= pack(vcltq_s64(vld1q_s64(a + i), vld1q_s64(b + i))) << i;
+        }
+        return mask;
+    }
+
+    static Mask not_equal(const std::int64_t* a, const std::int64_t* b)
+    {
+        Mask mask = 0;
+        for (std::size_t i = 0; i < LANES; i += 2)
+        {
+            mask |= pack(vceqq_s64(vld1q_s64(a + i), vld1q_s64(b + i))) << i;
+        }
+        return ~mask;
+    }
+
+    static void copy_lanes(std::int64_t* dst, const std::int64_t* src, Mask mask)
+    {
+        const uint64x2_t bits = {1, 2};
+        for (std::size_t i = 0; i < LANES && (mask >> i) != 0; i += 2)
+        {
+            auto select = vtstq_u64(vdupq_n_u64(mask >> i), bits);
+            vst1q_s64(dst + i, vbslq_s64(select, vld1q_s64(src + i), vld1q_s64(dst + i)));
+        }
+    }
+
+private:
+    static Mask pack(uint64x2_t lanes)
+    {
+        return (vgetq_lane_u64(lanes, 0) & 1) | (vgetq_lane_u64(lanes, 1) & 2);
+    }
+};
+
+#endif
+
+#endif // INTERVAL_KERNELS_HPP
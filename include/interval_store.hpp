@@ -1,86 +1,801 @@
 #ifndef INTERVAL_STORE_HPP
 #define INTERVAL_STORE_HPP
 
-#include <map>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
 #include <string>
-#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "interval.hpp"
+#include "interval_kernels.hpp"
+#include "recycling_allocator.hpp"
+#include "variable_table.hpp"
 
 /**
  * @brief The IntervalStore class represents a store of intervals for variables,
  * together with the some operations that can be performed on the store.
- * 
- * @tparam T 
+ *
+ * Intervals are addressed by the identifiers of a VariableTable, which is shared by all the stores
+ * of an analysis, and the name-based accessors are a thin layer over the identifier-based ones.
+ * The intervals are split in fixed-size pages that are shared between copies of a store: a page is
+ * duplicated only when it is modified while another store still refers to it, so that copying a store
+ * and changing a few variables costs in proportion to the pages that were actually touched.
+ *
+ * A page keeps the lower bounds, the upper bounds and the emptiness flags of its slots in separate arrays
+ * (a bitmask for the flags), so that joining, meeting, widening and comparing whole stores runs as
+ * vectorized comparisons and selections over the pages (see IntervalKernels).
+ *
+ * Every store maintains a hash of its content, updated incrementally on each write, which lets a StorePool
+ * hash-cons stores into canonical instances. Interned stores are immutable.
+ *
+ * @tparam T
  */
 template <typename T>
 class IntervalStore
 {
+public:
+    static constexpr std::size_t PAGE_SIZE = 64;
+    using Kernels = IntervalKernels<T>;
+    using Mask = typename Kernels::Mask;
+    static_assert(PAGE_SIZE == Kernels::LANES, "a page is one block of the kernels");
+
+    /**
+     * @brief Intervals of PAGE_SIZE consecutive variables. Slots past the size of the store hold the
+     * default interval.
+     *
+     */
+    struct Page {
+        std::array<T, PAGE_SIZE> lb{};
+        std::array<T, PAGE_SIZE> ub{};
+        Mask empty = 0;   // bit i is set when slot i is empty
+
+        Interval<T> get(std::size_t slot) const
+        {
+            Interval<T> interval(lb[slot], ub[slot]);
+            interval.is_empty() = (empty >> slot) & 1;
+            return interval;
+        }
+
+        void set(std::size_t slot, const Interval<T>& interval)
+        {
+            lb[slot] = interval.lb();
+            ub[slot] = interval.ub();
+            empty = (empty & ~(Mask(1) << slot)) | (static_cast<Mask>(interval.is_empty()) << slot);
+        }
+    };
+
+    /**
+     * @brief Page traffic of all the stores used by the calling thread
+     * 
+     */
+    struct Counters {
+        std::size_t page_allocations = 0;
+        std::size_t page_copies = 0;
+    };
+
+    static Counters& counters()
+    {
+        static thread_local Counters thread_counters;
+        return thread_counters;
+    }
+
+    // The page tables of the stores of an analysis all have the same length, and are recycled as the pages
+    using PageTable = std::vector<std::shared_ptr<Page>, RecyclingAllocator<std::shared_ptr<Page>>>;
+
 private:
-    std::map<std::string, Interval<T>> m_store;
+    std::shared_ptr<VariableTable> m_variables;
+    PageTable m_pages;
+    std::size_t m_size = 0;
+
+    // Sum of the hashes of all the slots, recomputed lazily after the store is resized
+    mutable std::uint64_t m_hash = 0;
+    mutable bool m_hash_valid = true;
+    bool m_interned = false;
 
 public:
     IntervalStore() = default;
     ~IntervalStore() = default;
+
+    // Copies share the pages of the original, but are never interned
     IntervalStore(const IntervalStore<T>& other)
+    : m_variables(other.m_variables)
+    , m_pages(other.m_pages)
+    , m_size(other.m_size)
+    , m_hash(other.m_hash)
+    , m_hash_valid(other.m_hash_valid)
+    {}
+
+    IntervalStore<T>& operator=(const IntervalStore<T>& other)
+    {
+        assert(!m_interned && "interned stores are immutable");
+        m_variables = other.m_variables;
+        m_pages = other.m_pages;
+        m_size = other.m_size;
+        m_hash = other.m_hash;
+        m_hash_valid = other.m_hash_valid;
+        return *this;
+    }
+
+    // Moves take the pages of the original without touching their reference counts, and leave it empty
+    IntervalStore(IntervalStore<T>&& other) noexcept
+    : m_variables(std::move(other.m_variables))
+    , m_pages(std::move(other.m_pages))
+    , m_size(std::exchange(other.m_size, 0))
+    , m_hash(std::exchange(other.m_hash, 0))
+    , m_hash_valid(std::exchange(other.m_hash_valid, true))
+    {
+        assert(!other.m_interned && "interned stores are immutable");
+        other.m_pages.clear();
+    }
+
+    IntervalStore<T>& operator=(IntervalStore<T>&& other) noexcept
+    {
+        assert(!m_interned && !other.m_interned && "interned stores are immutable");
+        m_variables = std::move(other.m_variables);
+        m_pages = std::move(other.m_pages);
+        other.m_pages.clear();
+        m_size = std::exchange(other.m_size, 0);
+        m_hash = std::exchange(other.m_hash, 0);
+        m_hash_valid = std::exchange(other.m_hash_valid, true);
+        return *this;
+    }
+
+    explicit IntervalStore(std::shared_ptr<VariableTable> variables)
+    : m_variables(std::move(variables))
+    {
+        resize(m_variables->size());
+    }
+
+    /**
+     * @brief Store of the first variables of the table made of the given pages, such as the pages of
+     * another store
+     *
+     * @param variables
+     * @param pages at least enough pages for size variables
+     * @param size
+     */
+    IntervalStore(std::shared_ptr<VariableTable> variables, PageTable pages, std::size_t size)
+    : m_variables(std::move(variables))
+    , m_pages(std::move(pages))
+    , m_size(size)
+    , m_hash_valid(false)
     {
-        for (const auto& [key, interval] : other.m_store)
+        assert(m_pages.size() * PAGE_SIZE >= m_size && "a store has a page for every variable");
+    }
+
+    void set(std::size_t id, const Interval<T>& interval)
+    {
+        if (id >= m_size)
+        {
+            resize(id + 1);
+        }
+        auto& page = writable_page(id / PAGE_SIZE);
+        if (m_hash_valid)
         {
-            m_store[key] = interval;
+            m_hash += slot_hash(id, interval) - slot_hash(id, page.get(id % PAGE_SIZE));
         }
+        page.set(id % PAGE_SIZE, interval);
+    }
+
+    /**
+     * @brief Returns the interval of a variable, without detaching shared pages. Intervals are changed
+     * through set only.
+     *
+     * @param id
+     * @return Interval<T>
+     */
+    Interval<T> get(std::size_t id) const
+    {
+        if (id >= m_size)
+        {
+            // Variables interned after the store was built are read as the default interval
+            return missing();
+        }
+        return m_pages[id / PAGE_SIZE]->get(id % PAGE_SIZE);
     }
 
     void set(const std::string& var, const Interval<T>& interval)
     {
-        m_store[var] = interval;
+        set(id(var), interval);
     }
 
-    Interval<T>& get(const std::string& var)
+    Interval<T> get(const std::string& var) const
     {
-        return m_store[var];
+        auto id = m_variables != nullptr ? m_variables->find(var) : VariableTable::npos;
+        if (id == VariableTable::npos)
+        {
+            return missing();
+        }
+        return get(id);
     }
 
-    void joinAll(IntervalStore<T>& other)
+    /**
+     * @brief Returns the identifier of a variable in the table of the store
+     *
+     * @param var
+     * @return std::size_t
+     */
+    std::size_t id(const std::string& var)
     {
-        for (auto& interval_mapping : other.store())
+        if (m_variables == nullptr)
         {
-            auto var = interval_mapping.first;
-            auto interval = interval_mapping.second;
-            if (auto it = m_store.find(var); it != m_store.end())
+            m_variables = std::make_shared<VariableTable>();
+        }
+        return m_variables->intern(var);
+    }
+
+    /**
+     * @brief Joins the other store into this one. When both stores are built on the same table, the join
+     * can be restricted to a set of variables, the others keeping the intervals of this store.
+     *
+     * @param other
+     * @param only if not null, the variables to join
+     */
+    void joinAll(const IntervalStore<T>& other, const VariableSet* only = nullptr)
+    {
+        if (m_variables != other.m_variables && m_variables != nullptr && other.m_variables != nullptr)
+        {
+            // Stores built on different tables are merged by name
+            for (std::size_t other_id = 0; other_id < other.size(); ++other_id)
             {
-                it->second.join(interval);
+                join_slot(id(other.name(other_id)), other.get(other_id));
             }
-            else
+            return;
+        }
+
+        if (m_variables == nullptr)
+        {
+            m_variables = other.m_variables;
+        }
+        if (m_size == 0)
+        {
+            // Nothing to join with: share all the pages of the other store
+            assert(!m_interned && "interned stores are immutable");
+            m_pages = other.m_pages;
+            m_size = other.m_size;
+            m_hash = other.m_hash;
+            m_hash_valid = other.m_hash_valid;
+            return;
+        }
+
+        // Variables missing from this store take the interval of the other one
+        for (std::size_t id = m_size; id < other.m_size; ++id)
+        {
+            set(id, other.get(id));
+        }
+        for (std::size_t page = 0; page < other.m_pages.size(); ++page)
+        {
+            auto selected = other.lanes(page) & selection(only, page);
+            if (selected == 0 || m_pages[page] == other.m_pages[page])
+            {
+                // Joining a page with itself leaves it unchanged
+                continue;
+            }
+            Page joined = *m_pages[page];
+            auto changed = join_page(joined, *other.m_pages[page], selected);
+            if (changed != 0)
+            {
+                commit_page(page, joined, changed);
+            }
+        }
+    }
+
+    /**
+     * @brief Intersects every interval of the store with the interval of the same variable in the
+     * other store. Variables missing from one of the stores are read as the default interval.
+     *
+     * @param other
+     */
+    void meetAll(const IntervalStore<T>& other)
+    {
+        if (m_variables != other.m_variables && m_variables != nullptr && other.m_variables != nullptr)
+        {
+            for (std::size_t other_id = 0; other_id < other.size(); ++other_id)
+            {
+                auto id = this->id(other.name(other_id));
+                auto interval = get(id);
+                auto other_interval = other.get(other_id);
+                interval.meet(other_interval);
+                if (!(interval == get(id)))
+                {
+                    set(id, interval);
+                }
+            }
+            return;
+        }
+
+        if (m_variables == nullptr)
+        {
+            m_variables = other.m_variables;
+        }
+        if (m_size < other.m_size)
+        {
+            resize(other.m_size);
+        }
+        for (std::size_t page = 0; page < m_pages.size(); ++page)
+        {
+            const auto& other_page = page < other.m_pages.size() ? *other.m_pages[page] : default_page();
+            if (m_pages[page].get() == &other_page)
+            {
+                continue;
+            }
+            Page met = *m_pages[page];
+            auto changed = meet_page(met, other_page, lanes(page));
+            if (changed != 0)
+            {
+                commit_page(page, met, changed);
+            }
+        }
+    }
+
+    /**
+     * @brief Widens the store, as the newer of two successive stores, with respect to the previous one.
+     * Bounds that did not grow are set back to the previous ones, and a lower (upper) bound that grew is
+     * replaced by below(bound) (above(bound)), or below(id, bound) when the thresholds depend on the variable.
+     * Both stores must be built on the same table.
+     *
+     * @param previous
+     * @param below
+     * @param above
+     */
+    template <typename Below, typename Above>
+    void widenAll(const IntervalStore<T>& previous, Below below, Above above)
+    {
+        assert((m_variables == previous.m_variables || previous.m_variables == nullptr) && "widening needs a shared table");
+        for (std::size_t page = 0; page < m_pages.size(); ++page)
+        {
+            const auto& old_page = page < previous.m_pages.size() ? *previous.m_pages[page] : default_page();
+            if (m_pages[page].get() == &old_page)
+            {
+                continue;
+            }
+            const auto& new_page = *m_pages[page];
+            Page widened = new_page;
+            auto both = ~new_page.empty & ~old_page.empty & lanes(page);
+            auto lower = Kernels::less(new_page.lb.data(), old_page.lb.data()) & both;
+            auto upper = Kernels::less(old_page.ub.data(), new_page.ub.data()) & both;
+            Kernels::copy_lanes(widened.lb.data(), old_page.lb.data(), both & ~lower);
+            Kernels::copy_lanes(widened.ub.data(), old_page.ub.data(), both & ~upper);
+            for (auto bits = lower; bits != 0; bits &= bits - 1)
+            {
+                auto slot = static_cast<std::size_t>(__builtin_ctzll(bits));
+                widened.lb[slot] = threshold(below, page * PAGE_SIZE + slot, new_page.lb[slot]);
+            }
+            for (auto bits = upper; bits != 0; bits &= bits - 1)
+            {
+                auto slot = static_cast<std::size_t>(__builtin_ctzll(bits));
+                widened.ub[slot] = threshold(above, page * PAGE_SIZE + slot, new_page.ub[slot]);
+            }
+            auto changed = (Kernels::not_equal(widened.lb.data(), new_page.lb.data())
+                            | Kernels::not_equal(widened.ub.data(), new_page.ub.data())) & both;
+            if (changed != 0)
             {
-                m_store[var] = interval;
+                commit_page(page, widened, changed);
             }
         }
     }
 
+    std::shared_ptr<VariableTable> variables() const
+    {
+        return m_variables;
+    }
 
-    std::map<std::string, Interval<T>>& store() 
+    std::size_t size() const
     {
-        return this->m_store;
+        return m_size;
     }
 
-    void print()
+    /**
+     * @brief Returns the hash of the content of the store, which is equal for stores that compare equal
+     * 
+     * @return std::uint64_t 
+     */
+    std::uint64_t hash() const
     {
-        for (auto& [key, interval] : m_store)
+        if (!m_hash_valid)
         {
+            m_hash = 0;
+            for (std::size_t i = 0; i < m_size; ++i)
+            {
+                m_hash += slot_hash(i, get(i));
+            }
+            m_hash_valid = true;
+        }
+        return m_hash;
+    }
+
+    bool is_interned() const
+    {
+        return m_interned;
+    }
+
+    /**
+     * @brief Marks the store as the canonical instance of its content. Called by the StorePool only.
+     * 
+     */
+    void mark_interned()
+    {
+        m_interned = true;
+    }
+
+    const std::string& name(std::size_t id) const
+    {
+        return m_variables->name(id);
+    }
+
+    void print(std::ostream& out = std::cout) const
+    {
+        for (std::size_t i = 0; i < m_size; ++i)
+        {
+            auto interval = get(i);
             if (interval.is_empty())
             {
-                std::cout << key << ": Empty" << std::endl;
+                out << name(i) << ": Empty" << std::endl;
             }
             else
             {
-                std::cout << key << ": [" << interval.lb() << ", " << interval.ub() << "]" << std::endl;
+                out << name(i) << ": [" << interval.lb() << ", " << interval.ub() << "]" << std::endl;
+            }
+        }
+    }
+
+    /**
+     * @brief Tells if an interval that is not empty has the given lower bound or the given upper bound
+     *
+     * @param lb
+     * @param ub
+     */
+    bool reaches(T lb, T ub) const
+    {
+        for (std::size_t page = 0; page < m_pages.size(); ++page)
+        {
+            const auto& intervals = *m_pages[page];
+            auto slots = lanes(page) & ~intervals.empty;
+            for (std::size_t slot = 0; slots != 0; ++slot, slots >>= 1)
+            {
+                if ((slots & 1) != 0 && (intervals.lb[slot] == lb || intervals.ub[slot] == ub))
+                {
+                    return true;
+                }
             }
         }
+        return false;
     }
 
-    bool equals(IntervalStore<T>& other)
+    bool equals(const IntervalStore<T>& other) const
     {
-        return m_store == other.store();
+        if (this == &other)
+        {
+            return true;
+        }
+        if (m_variables == other.m_variables || m_variables == nullptr || other.m_variables == nullptr)
+        {
+            if (m_size != other.m_size || hash() != other.hash())
+            {
+                return false;
+            }
+            for (std::size_t page = 0; page < m_pages.size(); ++page)
+            {
+                if (m_pages[page] != other.m_pages[page] && differing_slots(*m_pages[page], *other.m_pages[page], lanes(page)) != 0)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Stores built on different tables are compared by name
+        if (m_size != other.m_size)
+        {
+            return false;
+        }
+        for (std::size_t i = 0; i < m_size; ++i)
+        {
+            auto other_id = other.m_variables->find(name(i));
+            if (other_id == VariableTable::npos || other_id >= other.size() || !(get(i) == other.get(other_id)))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Tells if the two stores, built on the same table, hold the same intervals for a set of variables
+     *
+     * @param other
+     * @param only
+     */
+    bool equals(const IntervalStore<T>& other, const VariableSet& only) const
+    {
+        assert((m_variables == other.m_variables || m_variables == nullptr || other.m_variables == nullptr) && "comparing a subset needs a shared table");
+        for (std::size_t page = 0; page < only.word_count(); ++page)
+        {
+            const auto& ours = page < m_pages.size() ? *m_pages[page] : default_page();
+            const auto& theirs = page < other.m_pages.size() ? *other.m_pages[page] : default_page();
+            if (&ours != &theirs && differing_slots(ours, theirs, only.word(page)) != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Calls action(id, interval) on every variable of the store whose interval differs in the
+     * previous store, built on the same table, or on all of them if there is no previous store. Shared
+     * pages are skipped.
+     *
+     * @param previous may be nullptr
+     * @param action
+     */
+    template <typename F>
+    void for_each_difference(const IntervalStore<T>* previous, F&& action) const
+    {
+        for (std::size_t page = 0; page < m_pages.size(); ++page)
+        {
+            const auto& ours = *m_pages[page];
+            for (auto bits = differing_lanes(page, previous); bits != 0; bits &= bits - 1)
+            {
+                auto slot = static_cast<std::size_t>(__builtin_ctzll(bits));
+                action(page * PAGE_SIZE + slot, ours.get(slot));
+            }
+        }
+    }
+
+    // Pages are copied on write by every evaluation, and recycled by the thread that releases them
+    template <typename... Args>
+    static std::shared_ptr<Page> make_page(Args&&... args)
+    {
+        return std::allocate_shared<Page>(RecyclingAllocator<Page>(), std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Pages of the store, which its copies share until they modify them
+     *
+     */
+    const PageTable& pages() const
+    {
+        return m_pages;
+    }
+
+    /**
+     * @brief Returns the number of pages of the store that another store does not share, which bounds the
+     * cost of comparing them
+     *
+     * @param other may be nullptr
+     */
+    std::size_t unshared_pages(const IntervalStore<T>* other) const
+    {
+        if (other == nullptr)
+        {
+            return m_pages.size();
+        }
+        std::size_t count = 0;
+        for (std::size_t page = 0; page < m_pages.size(); ++page)
+        {
+            count += page >= other->m_pages.size() || m_pages[page] != other->m_pages[page];
+        }
+        return count;
+    }
+
+private:
+    static Interval<T> missing()
+    {
+        return Interval<T>();
+    }
+
+    // The threshold of a widened bound, given to a function of the bound or of the variable and the bound
+    template <typename Threshold>
+    static T threshold(Threshold& function, std::size_t id, T bound)
+    {
+        if constexpr (std::is_invocable_v<Threshold&, std::size_t, T>)
+        {
+            return function(id, bound);
+        }
+        else
+        {
+            return function(bound);
+        }
+    }
+
+    static const Page& default_page()
+    {
+        static const Page page;
+        return page;
+    }
+
+    /**
+     * @brief Returns the slots of a page that hold variables of the store
+     *
+     * @param page
+     * @return Mask
+     */
+    Mask lanes(std::size_t page) const
+    {
+        auto begin = page * PAGE_SIZE;
+        if (begin >= m_size)
+        {
+            return 0;
+        }
+        auto count = m_size - begin;
+        return count >= PAGE_SIZE ? ~Mask(0) : (Mask(1) << count) - 1;
+    }
+
+    /**
+     * @brief Returns the slots of a page that belong to the set, or all of them without a set
+     *
+     */
+    static Mask selection(const VariableSet* only, std::size_t page)
+    {
+        return only != nullptr ? only->word(page) : ~Mask(0);
+    }
+
+    /**
+     * @brief Joins the selected slots of other into page, and returns the slots whose interval changed
+     *
+     */
+    static Mask join_page(Page& page, const Page& other, Mask lanes)
+    {
+        auto both = ~page.empty & ~other.empty & lanes;
+        auto taken = page.empty & ~other.empty & lanes;
+        auto lower = (Kernels::less(other.lb.data(), page.lb.data()) & both) | taken;
+        auto upper = (Kernels::less(page.ub.data(), other.ub.data()) & both) | taken;
+        Kernels::copy_lanes(page.lb.data(), other.lb.data(), lower);
+        Kernels::copy_lanes(page.ub.data(), other.ub.data(), upper);
+        auto inverted = Kernels::less(page.ub.data(), page.lb.data()) & both;
+        page.empty = (page.empty & ~taken) | inverted;
+        return lower | upper | inverted;
+    }
+
+    /**
+     * @brief Meets the selected slots of page with other, and returns the slots whose interval changed
+     *
+     */
+    static Mask meet_page(Page& page, const Page& other, Mask lanes)
+    {
+        auto both = ~page.empty & ~other.empty & lanes;
+        auto emptied = ~page.empty & other.empty & lanes;
+        auto raised = Kernels::less(page.lb.data(), other.lb.data()) & both;
+        auto lowered = Kernels::less(other.ub.data(), page.ub.data()) & both;
+        Kernels::copy_lanes(page.lb.data(), other.lb.data(), raised);
+        Kernels::copy_lanes(page.ub.data(), other.ub.data(), lowered);
+        auto inverted = Kernels::less(page.ub.data(), page.lb.data()) & both;
+        page.empty |= emptied | inverted;
+        return raised | lowered | emptied | inverted;
+    }
+
+    /**
+     * @brief Returns the selected slots whose intervals differ. Empty intervals are equal whatever their bounds.
+     *
+     */
+    static Mask differing_slots(const Page& a, const Page& b, Mask lanes)
+    {
+        auto bounds = Kernels::not_equal(a.lb.data(), b.lb.data()) | Kernels::not_equal(a.ub.data(), b.ub.data());
+        return ((a.empty ^ b.empty) | (~a.empty & ~b.empty & bounds)) & lanes;
+    }
+
+    /**
+     * @brief Returns the slots of a page of the store whose interval differs in another store, built on the
+     * same table, or all of them if there is no other store
+     *
+     */
+    Mask differing_lanes(std::size_t page, const IntervalStore<T>* other) const
+    {
+        assert((other == nullptr || m_variables == other->m_variables || other->m_variables == nullptr) && "comparing needs a shared table");
+        if (other == nullptr)
+        {
+            return lanes(page);
+        }
+        const auto& ours = *m_pages[page];
+        const auto& theirs = page < other->m_pages.size() ? *other->m_pages[page] : default_page();
+        return &ours == &theirs ? 0 : differing_slots(ours, theirs, lanes(page));
+    }
+
+    /**
+     * @brief Replaces a page by its updated content, whose changed slots are given, keeping the hash
+     * up to date. A shared page is replaced rather than duplicated.
+     *
+     */
+    void commit_page(std::size_t page, const Page& updated, Mask changed)
+    {
+        assert(!m_interned && "interned stores are immutable");
+        if (m_hash_valid)
+        {
+            const auto& current = *m_pages[page];
+            for (auto bits = changed; bits != 0; bits &= bits - 1)
+            {
+                auto slot = static_cast<std::size_t>(__builtin_ctzll(bits));
+                auto id = page * PAGE_SIZE + slot;
+                m_hash += slot_hash(id, updated.get(slot)) - slot_hash(id, current.get(slot));
+            }
+        }
+        if (m_pages[page].use_count() > 1)
+        {
+            m_pages[page] = make_page(updated);
+            counters().page_copies++;
+        }
+        else
+        {
+            // The page is ours alone: synchronize with the threads that released it before writing in place
+            std::atomic_thread_fence(std::memory_order_acquire);
+            *m_pages[page] = updated;
+        }
+    }
+
+    void resize(std::size_t size)
+    {
+        assert(!m_interned && "interned stores are immutable");
+        m_hash_valid = false;
+        auto pages = (size + PAGE_SIZE - 1) / PAGE_SIZE;
+        while (m_pages.size() < pages)
+        {
+            m_pages.push_back(make_page());
+            counters().page_allocations++;
+        }
+        m_size = std::max(m_size, size);
+    }
+
+    Page& writable_page(std::size_t page)
+    {
+        assert(!m_interned && "interned stores are immutable");
+        if (m_pages[page].use_count() > 1)
+        {
+            m_pages[page] = make_page(*m_pages[page]);
+            counters().page_copies++;
+        }
+        else
+        {
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return *m_pages[page];
+    }
+
+    /**
+     * @brief Hash of a single slot. All empty intervals are equal, so their bounds are not hashed.
+     * 
+     */
+    static std::uint64_t slot_hash(std::size_t id, const Interval<T>& interval)
+    {
+        std::uint64_t h = static_cast<std::uint64_t>(id) * 0x9e3779b97f4a7c15ull;
+        if (interval.is_empty())
+        {
+            h ^= 0x5bd1e9955bd1e995ull;
+        }
+        else
+        {
+            h ^= static_cast<std::uint64_t>(interval.lb()) * 0xbf58476d1ce4e5b9ull;
+            h ^= (static_cast<std::uint64_t>(interval.ub()) + 0x632be59bd9b4e019ull) * 0x94d049bb133111ebull;
+        }
+        // Final mixing step of splitmix64
+        h ^= h >> 31;
+        h *= 0xd6e8feb86659fd93ull;
+        h ^= h >> 32;
+        return h;
+    }
+
+    void join_slot(std::size_t id, const Interval<T>& interval)
+    {
+        if (id >= m_size)
+        {
+            set(id, interval);
+            return;
+        }
+
+        // Only detach the page when the join actually changes the interval
+        const auto& current = static_cast<const IntervalStore<T>&>(*this).get(id);
+        Interval<T> joined = current;
+        Interval<T> other = interval;
+        joined.join(other);
+        if (!(joined == current))
+        {
+            set(id, joined);
+        }
     }
 };
-#endif // INTERVAL_STORE_HPP
\ No newline at end of file
+#endif // INTERVAL_STORE_HPP
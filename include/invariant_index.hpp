@@ -0,0 +1,290 @@
+#ifndef INVARIANT_INDEX_HPP
+#define INVARIANT_INDEX_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "equational_interpreter.hpp"
+#include "interval.hpp"
+#include "location_base.hpp"
+#include "mapped_file.hpp"
+
+/**
+ * @brief Header of an invariant index: the intervals of the variables at every output of every location of
+ * an analysis, for lookups by variable and source line in the mapped file. The header is followed by the
+ * entries, sorted by variable, line, location and port, then by the name of every variable as its size
+ * (u32) followed by its bytes. The integers are stored in the byte order of the machine.
+ *
+ */
+struct InvariantIndexHeader {
+    static constexpr char MAGIC[8] = {'A', 'B', 'S', 'I', 'N', 'T', 'I', 'X'};
+    static constexpr std::uint32_t FORMAT = 1;
+
+    char magic[8];
+    std::uint32_t format;
+    std::uint32_t value_size;
+    std::uint32_t value_signed;
+    std::uint32_t variables;
+    std::uint64_t entries;
+    std::uint64_t names_offset;
+};
+
+/**
+ * @brief Interval of a variable at an output of a location
+ *
+ * @tparam T
+ */
+template <typename T>
+struct InvariantIndexEntry {
+    std::uint32_t variable;
+    std::uint32_t line;         // 0 if the program was not parsed from a source; the line of the `if` or `while` for their ends
+    std::uint32_t location;
+    std::uint8_t type;          // LocationType
+    std::uint8_t port;          // StorePort
+    std::uint8_t empty;
+    std::uint8_t reserved;
+    T lb;
+    T ub;
+
+    Interval<T> interval() const
+    {
+        Interval<T> interval(lb, ub);
+        interval.m_is_empty = empty != 0;
+        return interval;
+    }
+};
+
+/**
+ * @brief Writes the invariant index of a completed analysis. The locations that were never reached have
+ * no entry.
+ *
+ * @tparam T
+ * @param path
+ * @param interpreter
+ * @return false if the file cannot be written
+ */
+template <typename T>
+bool write_invariant_index(const std::string& path, const EquationalInterpreter<T>& interpreter)
+{
+    static_assert(sizeof(InvariantIndexHeader) % alignof(InvariantIndexEntry<T>) == 0);
+    std::vector<InvariantIndexEntry<T>> entries;
+    for (std::size_t location = 0; location < interpreter.location_count(); ++location)
+    {
+        auto line = static_cast<std::uint32_t>(interpreter.location_line(location));
+        auto type = static_cast<std::uint8_t>(interpreter.location_type(location));
+        for (std::size_t port = 0; port < STORE_PORTS; ++port)
+        {
+            auto store = interpreter.invariant(location, static_cast<StorePort>(port));
+            if (store == nullptr)
+            {
+                continue;
+            }
+            for (std::size_t id = 0; id < store->size(); ++id)
+            {
+                auto interval = std::as_const(*store).get(id);
+                entries.push_back({static_cast<std::uint32_t>(id), line, static_cast<std::uint32_t>(location), type,
+                                   static_cast<std::uint8_t>(port), static_cast<std::uint8_t>(interval.is_empty() ? 1 : 0), 0,
+                                   interval.lb(), interval.ub()});
+            }
+        }
+    }
+    std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+        return std::tie(a.variable, a.line, a.location, a.port) < std::tie(b.variable, b.line, b.location, b.port);
+    });
+
+    const auto& variables = interpreter.variables();
+    InvariantIndexHeader header{};
+    std::memcpy(header.magic, InvariantIndexHeader::MAGIC, sizeof(header.magic));
+    header.format = InvariantIndexHeader::FORMAT;
+    header.value_size = sizeof(T);
+    header.value_signed = std::is_signed_v<T> ? 1 : 0;
+    header.variables = static_cast<std::uint32_t>(variables.size());
+    header.entries = entries.size();
+    header.names_offset = sizeof(header) + entries.size() * sizeof(InvariantIndexEntry<T>);
+
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(InvariantIndexEntry<T>));
+    for (std::size_t id = 0; id < variables.size(); ++id)
+    {
+        const auto& name = variables.name(id);
+        auto size = static_cast<std::uint32_t>(name.size());
+        file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+        file.write(name.data(), name.size());
+    }
+    file.flush();
+    return file.good();
+}
+
+/**
+ * @brief Invariant index mapped in memory. Opening it only reads the names of the variables, and every
+ * lookup is a binary search in the entries.
+ *
+ * @tparam T the type of the bounds the index was written with
+ */
+template <typename T>
+class InvariantIndex
+{
+public:
+    using Entry = InvariantIndexEntry<T>;
+
+private:
+    MappedFile m_file;
+    std::span<const Entry> m_entries;
+    std::vector<std::string_view> m_names;
+    std::unordered_map<std::string_view, std::uint32_t> m_ids;
+    bool m_good = false;
+
+public:
+    explicit InvariantIndex(const std::string& path)
+    : m_file(path)
+    {
+        InvariantIndexHeader header;
+        if (!m_file.is_open() || m_file.size() < sizeof(header))
+        {
+            return;
+        }
+        std::memcpy(&header, m_file.data(), sizeof(header));
+        if (std::memcmp(header.magic, InvariantIndexHeader::MAGIC, sizeof(header.magic)) != 0 || header.format != InvariantIndexHeader::FORMAT
+            || header.value_size != sizeof(T) || header.value_signed != (std::is_signed_v<T> ? 1u : 0u)
+            || header.entries > (m_file.size() - sizeof(header)) / sizeof(Entry)
+            || header.names_offset != sizeof(header) + header.entries * sizeof(Entry))
+        {
+            return;
+        }
+        m_entries = {reinterpret_cast<const Entry*>(m_file.data() + sizeof(header)), header.entries};
+
+        const char* position = m_file.data() + header.names_offset;
+        const char* end = m_file.data() + m_file.size();
+        for (std::uint32_t id = 0; id < header.variables; ++id)
+        {
+            std::uint32_t size;
+            if (end - position < static_cast<std::ptrdiff_t>(sizeof(size)))
+            {
+                return;
+            }
+            std::memcpy(&size, position, sizeof(size));
+            position += sizeof(size);
+            if (static_cast<std::size_t>(end - position) < size)
+            {
+                return;
+            }
+            m_names.emplace_back(position, size);
+            m_ids.emplace(m_names.back(), id);
+            position += size;
+        }
+
+        // The entries are read as they are mapped, so a damaged one must not index the names or the type and port names
+        auto invalid = [&](const Entry& entry) {
+            return entry.variable >= header.variables || entry.type >= LOCATION_TYPES || entry.port >= STORE_PORTS;
+        };
+        if (std::any_of(m_entries.begin(), m_entries.end(), invalid))
+        {
+            return;
+        }
+        m_good = true;
+    }
+
+    /**
+     * @brief Tells if the file is a complete index written with T
+     *
+     */
+    bool good() const
+    {
+        return m_good;
+    }
+
+    std::size_t variables() const
+    {
+        return m_names.size();
+    }
+
+    std::string_view name(std::uint32_t variable) const
+    {
+        return m_names[variable];
+    }
+
+    std::optional<std::uint32_t> variable(std::string_view name) const
+    {
+        auto it = m_ids.find(name);
+        if (it == m_ids.end())
+        {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+    /**
+     * @brief All the entries, sorted by variable, line, location and port
+     *
+     */
+    std::span<const Entry> entries() const
+    {
+        return m_entries;
+    }
+
+    /**
+     * @brief Entries of a variable at the locations of a line
+     *
+     * @param variable
+     * @param line
+     * @return std::span<const Entry>
+     */
+    std::span<const Entry> at(std::uint32_t variable, std::uint32_t line) const
+    {
+        return lines(variable, line, line);
+    }
+
+    /**
+     * @brief Entries of a variable at the locations of the lines from first to last
+     *
+     * @param variable
+     * @param first
+     * @param last
+     * @return std::span<const Entry>
+     */
+    std::span<const Entry> lines(std::uint32_t variable, std::uint32_t first, std::uint32_t last) const
+    {
+        auto begin = std::lower_bound(m_entries.begin(), m_entries.end(), std::pair(variable, first), [](const Entry& entry, const auto& key) {
+            return std::pair(entry.variable, entry.line) < key;
+        });
+        auto end = std::upper_bound(begin, m_entries.end(), std::pair(variable, last), [](const auto& key, const Entry& entry) {
+            return key < std::pair(entry.variable, entry.line);
+        });
+        return {begin, end};
+    }
+
+    /**
+     * @brief Prints an entry as `x at line 12, location 7 (while, while_body): [0, 10]`
+     *
+     * @param out
+     * @param entry
+     */
+    void print(std::ostream& out, const Entry& entry) const
+    {
+        out << name(entry.variable) << " at line " << entry.line << ", location " << entry.location << " ("
+            << location_type_name(static_cast<LocationType>(entry.type)) << ", " << store_port_name(static_cast<StorePort>(entry.port)) << "): ";
+        if (entry.empty != 0)
+        {
+            out << "Empty\n";
+        }
+        else
+        {
+            out << "[" << entry.lb << ", " << entry.ub << "]\n";
+        }
+    }
+};
+
+#endif // INVARIANT_INDEX_HPP
@@ -1,13 +1,95 @@
 #ifndef LOCATION_BASE_HPP
 #define LOCATION_BASE_HPP
 
-#include <functional>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
 #include "interval_store.hpp"
+#include "compiled_expression.hpp"
+#include "logger.hpp"
 #include "parser.hpp"
 
+/**
+ * @brief Output store of a location that can be read by another location
+ * 
+ */
+enum class StorePort {
+    LAST,
+    IF_BODY,
+    ELSE_BODY,
+    WHILE_BODY,
+    WHILE_EXIT
+};
+
+constexpr std::size_t STORE_PORTS = 5;
+
+/**
+ * @brief Input of a location that is fed by the output store of another location
+ * 
+ */
+enum class InputSlot {
+    PREVIOUS,
+    FINAL_IF_BODY,
+    FINAL_ELSE_BODY,
+    FINAL_WHILE_BODY,
+    WHILE_FEEDBACK
+};
+
+/**
+ * @brief Concrete kind of a location, used to dispatch on it with a switch
+ * 
+ */
+enum class LocationType : std::uint8_t {
+    ASSIGNMENT,
+    POSTCONDITION,
+    IFELSE,
+    ENDIF,
+    WHILE,
+    ENDWHILE
+};
+
+constexpr std::size_t LOCATION_TYPES = 6;
+
+inline const char* location_type_name(LocationType type)
+{
+    switch (type)
+    {
+        case LocationType::ASSIGNMENT: return "assignment";
+        case LocationType::POSTCONDITION: return "postcondition";
+        case LocationType::IFELSE: return "ifelse";
+        case LocationType::ENDIF: return "endif";
+        case LocationType::WHILE: return "while";
+        case LocationType::ENDWHILE: return "endwhile";
+    }
+    return "unknown";
+}
+
+inline const char* store_port_name(StorePort port)
+{
+    switch (port)
+    {
+        case StorePort::LAST: return "last";
+        case StorePort::IF_BODY: return "if_body";
+        case StorePort::ELSE_BODY: return "else_body";
+        case StorePort::WHILE_BODY: return "while_body";
+        case StorePort::WHILE_EXIT: return "while_exit";
+    }
+    return "unknown";
+}
+
+template <typename T> class AssignmentLocation;
+template <typename T> class PostConditionLocation;
+template <typename T> class IfElseLocation;
+template <typename T> class EndIfLocation;
+template <typename T> class WhileLocation;
+template <typename T> class EndWhileLocation;
 
 /**
- * @brief Represents a generic location in the abstract interpreter.
+ * @brief Represents a generic location in the abstract interpreter. The concrete kind is stored in a tag,
+ * and the accessors switch on it instead of going through virtual calls. The transfer functions of the
+ * locations belong to the interpreter, which dispatches on the same tag.
  * 
  * @tparam T 
  */
@@ -15,68 +97,114 @@ template <typename T>
 class Location
 {
 public:
-    std::function<void(void)> m_operation;
     std::shared_ptr<Location<T>> m_fallback_location;
-    ASTNode m_code_block;
+    FlatAST::Index m_code_block = 0;    // statement of the location in the AST of the interpreter
 
+    // Bitmask of the output ports whose store changed during the last evaluation
+    std::uint8_t m_changed_ports = 0;
 
-    bool ends_if_body = false;
-    bool ends_else_body = false;
-    bool ends_while_body = false;
+    explicit Location(LocationType type)
+    : m_type(type)
+    {}
 
-    Location() = default;
     virtual ~Location() = default;
 
-    virtual void print() const {
-        std::cout << "Abstract Location" << std::endl;
-    };
-
-    virtual std::shared_ptr<IntervalStore<T>> get_last_store() const {
-        return nullptr;
-    }
-
-    virtual void set_previous_store(std::shared_ptr<IntervalStore<T>> store) {
-        return;
-    }
-
-    virtual std::shared_ptr<IntervalStore<T>> get_if_body_store() const 
+    LocationType type() const
     {
-        return nullptr;
+        return m_type;
     }
 
-    virtual std::shared_ptr<IntervalStore<T>> get_else_body_store() const
+    /**
+     * @brief Runs the transfer function of the location, recording which of its output stores changed
+     * 
+     * @param transfer called with the location, computes its output stores
+     */
+    template <typename Transfer>
+    void evaluate(Transfer&& transfer)
     {
-        return nullptr;
-    }
+        std::array<std::shared_ptr<IntervalStore<T>>, STORE_PORTS> old_stores;
+        for (std::size_t port = 0; port < STORE_PORTS; ++port)
+        {
+            old_stores[port] = get_output_store(static_cast<StorePort>(port));
+        }
 
-    virtual void set_final_if_body_store(std::shared_ptr<IntervalStore<T>> store)
-    {
-        return;
-    }
+        transfer(*this);
 
-    virtual void set_final_else_body_store(std::shared_ptr<IntervalStore<T>> store)
-    {
-        return;
+        m_changed_ports = 0;
+        for (std::size_t port = 0; port < STORE_PORTS; ++port)
+        {
+            if (store_changed(old_stores[port], get_output_store(static_cast<StorePort>(port))))
+            {
+                m_changed_ports |= 1u << port;
+            }
+        }
     }
 
-    virtual void set_final_while_body_store(std::shared_ptr<IntervalStore<T>> store)
+    bool has_changed() const
     {
-        return;
+        return m_changed_ports != 0;
     }
 
-    virtual std::shared_ptr<IntervalStore<T>> get_while_body_store() const
+    bool has_changed(StorePort port) const
     {
-        return nullptr;
+        return (m_changed_ports >> static_cast<std::size_t>(port)) & 1u;
     }
 
-    virtual bool is_stable(std::unique_ptr<Location<T>>& old_location) const
-    {
-        return false;
-    }
+    /**
+     * @brief Returns the output store of the location that corresponds to the given port, or nullptr if the
+     * location has no such output
+     * 
+     * @param port 
+     * @return std::shared_ptr<IntervalStore<T>> 
+     */
+    std::shared_ptr<IntervalStore<T>> get_output_store(StorePort port) const;
+
+    /**
+     * @brief Feeds the given input of the location. Inputs that the location does not have are ignored.
+     * 
+     * @param slot 
+     * @param store 
+     */
+    void set_input(InputSlot slot, std::shared_ptr<IntervalStore<T>> store);
 
-    virtual std::unique_ptr<Location<T>> copy() const
+    /**
+     * @brief Replaces the output store of the given port, as get_output_store returns it. Ports that the
+     * location does not have are ignored.
+     * 
+     * @param port 
+     * @param store 
+     */
+    void set_output_store(StorePort port, std::shared_ptr<IntervalStore<T>> store);
+
+    /**
+     * @brief Takes over all the stores of a location of the same kind, as left by a previous analysis, so
+     * that the location holds the same invariants without being evaluated
+     * 
+     * @param other 
+     */
+    void adopt_stores(const Location<T>& other);
+
+    void print() const;
+
+private:
+    LocationType m_type;
+
+    static bool store_changed(const std::shared_ptr<IntervalStore<T>>& old_store, const std::shared_ptr<IntervalStore<T>>& new_store)
     {
-        return nullptr;
+        if (old_store == new_store)
+        {
+            return false;
+        }
+        if (old_store == nullptr || new_store == nullptr)
+        {
+            return true;
+        }
+        if (old_store->is_interned() && new_store->is_interned())
+        {
+            // Distinct canonical stores always have different contents
+            return true;
+        }
+        return !new_store->equals(*old_store);
     }
 };
 
@@ -94,76 +222,43 @@ template <typename T>
 class AssignmentLocation : public Location<T>
 {
 public:
+    AssignmentLocation()
+    : Location<T>(LocationType::ASSIGNMENT)
+    {}
+
     std::shared_ptr<IntervalStore<T>> m_store_before;
     std::shared_ptr<IntervalStore<T>> m_store_after;
 
-    virtual void print() const override
+    // Assigned variable and compiled right-hand side
+    std::size_t m_variable = 0;
+    CompiledExpression<T> m_expression;
+
+    // For `x = f(...)`, the function in the FunctionTable of the interpreter and its compiled arguments
+    std::optional<std::size_t> m_function;
+    std::vector<CompiledExpression<T>> m_arguments;
+
+    void print() const
     {
-        std::cout << "(ASSIGNMENT LOCATION)" << std::endl;
-        std::cout << "Store before assignment" << std::endl;
+        Logger::out() << "(ASSIGNMENT LOCATION)" << std::endl;
+        Logger::out() << "Store before assignment" << std::endl;
         if (m_store_before != nullptr)
         {
-            m_store_before->print();
+            m_store_before->print(Logger::out());
         }
         else
         {
-            std::cout << "Empty" << std::endl;
+            Logger::out() << "Empty" << std::endl;
         }
 
-        std::cout << "Store after assignment" << std::endl;
+        Logger::out() << "Store after assignment" << std::endl;
         if (m_store_after != nullptr)
         {
-            m_store_after->print();
+            m_store_after->print(Logger::out());
         } 
         else
         {
-            std::cout << "Empty" << std::endl;
-        }
-    }
-
-    virtual std::shared_ptr<IntervalStore<T>> get_last_store() const override
-    {
-        return m_store_after;
-    }
-
-    virtual void set_previous_store(std::shared_ptr<IntervalStore<T>> store) override
-    {
-        m_store_before = store;
-    }
-
-    virtual bool is_stable(std::unique_ptr<Location<T>>& old_location) const override
-    {
-        if (auto old = dynamic_cast<AssignmentLocation<T>*>(old_location.get()))
-        {
-            if (old != nullptr)
-            {
-                return m_store_after->equals(*old->m_store_after);
-            }
-        }
-        return false;
-    }
-
-    virtual std::unique_ptr<Location<T>> copy() const override
-    {
-        auto copy = std::make_unique<AssignmentLocation<T>>();
-        if (m_store_before != nullptr)
-        {
-            copy->m_store_before = std::make_shared<IntervalStore<T>>(*m_store_before);
-        }
-        else
-        {
-            copy->m_store_before = nullptr;
-        }
-    
-        if (m_store_after != nullptr)
-        {
-            copy->m_store_after = std::make_shared<IntervalStore<T>>(*m_store_after);
-        }
-        else 
-        {
-            copy->m_store_after = nullptr;
+            Logger::out() << "Empty" << std::endl;
         }
-        return copy;
     }
 };
 
@@ -176,41 +271,27 @@ template <typename T>
 class PostConditionLocation : public Location<T>
 {
 public:
+    PostConditionLocation()
+    : Location<T>(LocationType::POSTCONDITION)
+    {}
+
+    // The store is passed through, but the input and the output are kept apart so that linking a new input
+    // before an evaluation does not hide the change of the output from Location::evaluate
+    std::shared_ptr<IntervalStore<T>> m_store_before;
     std::shared_ptr<IntervalStore<T>> m_store;
 
-    virtual void print() const override
-    {
-        std::cout << "(POSTCONDITION LOCATION)" << std::endl;
-        m_store->print();
-    }
+    // Compiled operands of the asserted comparison
+    CompiledExpression<T> m_lhs;
+    CompiledExpression<T> m_rhs;
+    LogicOp m_op = LogicOp::EQ;
 
-    virtual std::shared_ptr<IntervalStore<T>> get_last_store() const override
-    {
-        return m_store;
-    }
-
-    virtual void set_previous_store(std::shared_ptr<IntervalStore<T>> store) override
-    {
-        m_store = store;
-    }
+    // Proved by the prefilter of the interpreter, so its operands are not evaluated
+    bool m_discharged = false;
 
-    virtual bool is_stable(std::unique_ptr<Location<T>>& old_location) const override
+    void print() const
     {
-        return true;
-    }
-
-    virtual std::unique_ptr<Location<T>> copy() const override
-    {
-        auto copy = std::make_unique<PostConditionLocation<T>>();
-        if (m_store != nullptr)
-        {
-            copy->m_store = std::make_shared<IntervalStore<T>>(*m_store);
-        }
-        else
-        {
-            copy->m_store = nullptr;
-        }
-        return copy;
+        Logger::out() << "(POSTCONDITION LOCATION)" << std::endl;
+        m_store->print(Logger::out());
     }
 };
 
@@ -223,95 +304,45 @@ template <typename T>
 class IfElseLocation : public Location<T>
 {
 public:
+    IfElseLocation()
+    : Location<T>(LocationType::IFELSE)
+    {}
+
     std::shared_ptr<IntervalStore<T>> m_store_before_condition;
     std::shared_ptr<IntervalStore<T>> m_store_if_body;
     std::shared_ptr<IntervalStore<T>> m_store_else_body;
 
-    virtual void print() const override
+    CompiledCondition<T> m_condition;
+
+    void print() const
     {
-        std::cout << "(IF-ELSE LOCATION)" << std::endl;
-        std::cout << "Store before condition" << std::endl;
+        Logger::out() << "(IF-ELSE LOCATION)" << std::endl;
+        Logger::out() << "Store before condition" << std::endl;
         if (m_store_before_condition != nullptr) {
-            m_store_before_condition->print();
+            m_store_before_condition->print(Logger::out());
         }
         else
         {
-            std::cout << "Empty" << std::endl;
+            Logger::out() << "Empty" << std::endl;
         }
 
-        std::cout << "Store if body" << std::endl;
+        Logger::out() << "Store if body" << std::endl;
         if (m_store_if_body != nullptr) {
-            m_store_if_body->print();
+            m_store_if_body->print(Logger::out());
         }
         else
         {
-            std::cout << "Empty" << std::endl;
+            Logger::out() << "Empty" << std::endl;
         }
-        std::cout << "Store else body" << std::endl;
+        Logger::out() << "Store else body" << std::endl;
         if (m_store_else_body != nullptr) {
-            m_store_else_body->print();
+            m_store_else_body->print(Logger::out());
         }
         else
         {
-            std::cout << "Empty" << std::endl;
+            Logger::out() << "Empty" << std::endl;
         }
     }
-
-    virtual std::shared_ptr<IntervalStore<T>> get_if_body_store() const override
-    {
-        return m_store_if_body;
-    }
-
-    virtual std::shared_ptr<IntervalStore<T>> get_else_body_store() const override
-    {
-        return m_store_else_body;
-    }
-
-    virtual void set_previous_store(std::shared_ptr<IntervalStore<T>> store) override
-    {
-        m_store_before_condition = store;
-    }
-
-    virtual bool is_stable(std::unique_ptr<Location<T>>& old_location) const override
-    {
-        if (auto old = dynamic_cast<IfElseLocation<T>*>(old_location.get()))
-        {
-            return m_store_if_body->equals(*old->m_store_if_body) && m_store_else_body->equals(*old->m_store_else_body);
-        }
-        return false;
-    }
-
-    virtual std::unique_ptr<Location<T>> copy() const override
-    {
-        auto copy = std::make_unique<IfElseLocation<T>>();
-        if (m_store_before_condition != nullptr)
-        {
-            copy->m_store_before_condition = std::make_shared<IntervalStore<T>>(*m_store_before_condition);
-        }
-        else
-        {
-            copy->m_store_before_condition = nullptr;
-        }
-
-        if (m_store_if_body != nullptr)
-        {
-            copy->m_store_if_body = std::make_shared<IntervalStore<T>>(*m_store_if_body);
-        }
-        else
-        {
-            copy->m_store_if_body = nullptr;
-        }
-
-        if (m_store_else_body != nullptr)
-        {
-            copy->m_store_else_body = std::make_shared<IntervalStore<T>>(*m_store_else_body);
-        }
-        else
-        {
-            copy->m_store_else_body = nullptr;
-        }
-        return copy;
-    }
 };
 
 
@@ -324,93 +355,42 @@ template<typename T>
 class EndIfLocation : public Location<T>
 {
 public:
+    EndIfLocation()
+    : Location<T>(LocationType::ENDIF)
+    {}
+
     std::shared_ptr<IntervalStore<T>> m_store_before;
     std::shared_ptr<IntervalStore<T>> m_store_after_body;
     std::shared_ptr<IntervalStore<T>> m_store_after_else;
     std::shared_ptr<IntervalStore<T>> m_store_after;
 
-    virtual void print() const override
-    {
-        std::cout << "(END-IF LOCATION)" << std::endl;
-
-        std::cout << "Store after body" << std::endl;
-        if (m_store_after_body != nullptr) {
-            m_store_after_body->print();
-        } else {
-            std::cout << "Empty" << std::endl;
-        }
-
-        std::cout << "Store after else" << std::endl;
-        if (m_store_after_else != nullptr) {
-            m_store_after_else->print();
-        } else {
-            std::cout << "Empty" << std::endl;
-        }
-
-        std::cout << "Store after join" << std::endl;
-        if (m_store_after != nullptr) {
-            m_store_after->print();
-        } else {
-            std::cout << "Empty" << std::endl;
-        }
-    }
-
-    virtual std::shared_ptr<IntervalStore<T>> get_last_store() const override
-    {
-        return m_store_after;
-    }
+    // Variables that one of the branches, or the condition, may change: the only ones to join in sparse mode
+    VariableSet m_modified;
 
-    virtual void set_previous_store(std::shared_ptr<IntervalStore<T>> store) override
+    void print() const
     {
-        m_store_before = store;
-    }
-
-    virtual void set_final_if_body_store(std::shared_ptr<IntervalStore<T>> store) override
-    {
-        m_store_after_body = store;
-    }
-
-    virtual void set_final_else_body_store(std::shared_ptr<IntervalStore<T>> store) override
-    {
-        m_store_after_else = store;
-    }
-
-    virtual bool is_stable(std::unique_ptr<Location<T>>& old_location) const override
-    {
-        if (auto old = dynamic_cast<EndIfLocation<T>*>(old_location.get()))
-        {
-            return m_store_after_body->equals(*old->m_store_after_body) && m_store_after_else->equals(*old->m_store_after_else);
-        }
-        return false;
-    }
-
-    virtual std::unique_ptr<Location<T>> copy() const override
-    {
-        auto copy = std::make_unique<EndIfLocation<T>>();
-        if (m_store_before != nullptr) {
-            copy->m_store_before = std::make_shared<IntervalStore<T>>(*m_store_before);
-        } else {
-            copy->m_store_before = nullptr;
-        }
+        Logger::out() << "(END-IF LOCATION)" << std::endl;
 
+        Logger::out() << "Store after body" << std::endl;
         if (m_store_after_body != nullptr) {
-            copy->m_store_after_body = std::make_shared<IntervalStore<T>>(*m_store_after_body);
+            m_store_after_body->print(Logger::out());
         } else {
-            copy->m_store_after_body = nullptr;
+            Logger::out() << "Empty" << std::endl;
         }
 
+        Logger::out() << "Store after else" << std::endl;
         if (m_store_after_else != nullptr) {
-            copy->m_store_after_else = std::make_shared<IntervalStore<T>>(*m_store_after_else);
+            m_store_after_else->print(Logger::out());
         } else {
-            copy->m_store_after_else = nullptr;
+            Logger::out() << "Empty" << std::endl;
         }
 
+        Logger::out() << "Store after join" << std::endl;
         if (m_store_after != nullptr) {
-            copy->m_store_after = std::make_shared<IntervalStore<T>>(*m_store_after);
+            m_store_after->print(Logger::out());
         } else {
-            copy->m_store_after = nullptr;
+            Logger::out() << "Empty" << std::endl;
         }
-        return copy;
     }
 };
 
@@ -419,87 +399,70 @@ public:
  * 
  * @tparam T 
  */
+/**
+ * @brief Closed form of a counting loop, whose body moves the variable of the condition by a constant
+ * step towards its bound, assigns constants to some other variables and leaves the rest unchanged
+ *
+ * @tparam T
+ */
+template <typename T>
+struct LoopAcceleration {
+    T step = 0;                                             // added to the variable of the condition
+    std::vector<std::pair<std::size_t, T>> constants;       // last constant assigned to a variable
+};
+
 template <typename T>
 class WhileLocation : public Location<T>
 {
 public:
+    WhileLocation()
+    : Location<T>(LocationType::WHILE)
+    {}
+
     std::shared_ptr<IntervalStore<T>> m_store_before_condition;
+    std::shared_ptr<IntervalStore<T>> m_store_feedback;
     std::shared_ptr<IntervalStore<T>> m_store_body;
     std::shared_ptr<IntervalStore<T>> m_store_exit;
 
-    virtual void print() const override
-    {
-        std::cout << "(WHILE LOCATION)" << std::endl;
-        if (m_store_before_condition != nullptr) {
-            std::cout << "Store before condition" << std::endl;
-            m_store_before_condition->print();
-        } else {
-            std::cout << "Empty" << std::endl;
-        }
+    // Loop head invariant (entry joined with feedback) of the last evaluation, used to widen and narrow
+    std::shared_ptr<IntervalStore<T>> m_store_head;
+    std::size_t m_ascending_steps = 0;
+    std::size_t m_narrowing_steps = 0;
 
-        if (m_store_body != nullptr) {
-            std::cout << "Store after condition" << std::endl;
-            m_store_body->print();
-        } else {
-            std::cout << "Empty" << std::endl;
-        }
+    // Variables mentioned anywhere in the loop: in sparse mode the body store is replaced only when one
+    // of them changes, so the locations of the body are not evaluated again for the others
+    VariableSet m_relevant;
 
-        if (m_store_exit != nullptr) {
-            std::cout << "Store exit condition" << std::endl;
-            m_store_exit->print();
-        } else {
-            std::cout << "Empty" << std::endl;
-        }
-    }
-    
-    virtual std::shared_ptr<IntervalStore<T>> get_while_body_store() const override
-    {
-        m_store_body->print();
-        return m_store_body;
-    }
-
-    virtual std::shared_ptr<IntervalStore<T>> get_exit_store() const
-    {
-        return m_store_exit;
-    }
-
-    virtual void set_previous_store(std::shared_ptr<IntervalStore<T>> store) override
-    {
-        m_store_before_condition = store;
-    }
+    CompiledCondition<T> m_condition;
 
-    virtual bool is_stable(std::unique_ptr<Location<T>>& old_location) const override
-    {
-        if (auto old = dynamic_cast<WhileLocation<T>*>(old_location.get()))
-        {
-            return m_store_body->equals(*old->m_store_body) && m_store_exit->equals(*old->m_store_exit);
-        }
-        return false;
-    }
+    // Set when the invariant of the head can be computed in one step (see LoopAcceleration)
+    std::optional<LoopAcceleration<T>> m_acceleration;
 
-    virtual std::unique_ptr<Location<T>> copy() const override
+    void print() const
     {
-        auto copy = std::make_unique<WhileLocation<T>>();
+        Logger::out() << "(WHILE LOCATION)" << std::endl;
         if (m_store_before_condition != nullptr) {
-            copy->m_store_before_condition = std::make_shared<IntervalStore<T>>(*m_store_before_condition);
+            Logger::out() << "Store before condition" << std::endl;
+            m_store_before_condition->print(Logger::out());
         } else {
-            copy->m_store_before_condition = nullptr;
+            Logger::out() << "Empty" << std::endl;
         }
 
         if (m_store_body != nullptr) {
-            copy->m_store_body = std::make_shared<IntervalStore<T>>(*m_store_body);
+            Logger::out() << "Store after condition" << std::endl;
+            m_store_body->print(Logger::out());
         } else {
-            copy->m_store_body = nullptr;
+            Logger::out() << "Empty" << std::endl;
         }
 
         if (m_store_exit != nullptr) {
-            copy->m_store_exit = std::make_shared<IntervalStore<T>>(*m_store_exit);
+            Logger::out() << "Store exit condition" << std::endl;
+            m_store_exit->print(Logger::out());
         } else {
-            copy->m_store_exit = nullptr;
+            Logger::out() << "Empty" << std::endl;
         }
-        return copy;
     }
-
+    
 };
 
 /**
@@ -511,56 +474,234 @@ template <typename T>
 class EndWhileLocation : public Location<T>
 {
 public:
+    EndWhileLocation()
+    : Location<T>(LocationType::ENDWHILE)
+    {}
+
     std::shared_ptr<IntervalStore<T>> m_store_from_while;
     std::shared_ptr<IntervalStore<T>> m_store_after;
 
-    virtual void print() const override
+    void print() const
     {
-        std::cout << "(END WHILE LOCATION)" << std::endl;
+        Logger::out() << "(END WHILE LOCATION)" << std::endl;
         if (m_store_from_while != nullptr) {
-            std::cout << "Store from while" << std::endl;
-            m_store_from_while->print();
+            Logger::out() << "Store from while" << std::endl;
+            m_store_from_while->print(Logger::out());
         } else {
-            std::cout << "Empty" << std::endl;
+            Logger::out() << "Empty" << std::endl;
         }
 
         if (m_store_after != nullptr) {
-            std::cout << "Store after" << std::endl;
-            m_store_after->print();
+            Logger::out() << "Store after" << std::endl;
+            m_store_after->print(Logger::out());
         } else {
-            std::cout << "Empty" << std::endl;
+            Logger::out() << "Empty" << std::endl;
         }
     }
+};
 
-    virtual void set_final_while_body_store(std::shared_ptr<IntervalStore<T>> store) override
+template <typename T>
+std::shared_ptr<IntervalStore<T>> Location<T>::get_output_store(StorePort port) const
+{
+    switch (m_type)
     {
-        m_store_from_while = store;
+        case LocationType::ASSIGNMENT:
+        {
+            return port == StorePort::LAST ? static_cast<const AssignmentLocation<T>*>(this)->m_store_after : nullptr;
+        }
+        case LocationType::POSTCONDITION:
+        {
+            return port == StorePort::LAST ? static_cast<const PostConditionLocation<T>*>(this)->m_store : nullptr;
+        }
+        case LocationType::IFELSE:
+        {
+            auto loc = static_cast<const IfElseLocation<T>*>(this);
+            if (port == StorePort::IF_BODY) return loc->m_store_if_body;
+            if (port == StorePort::ELSE_BODY) return loc->m_store_else_body;
+            return nullptr;
+        }
+        case LocationType::ENDIF:
+        {
+            return port == StorePort::LAST ? static_cast<const EndIfLocation<T>*>(this)->m_store_after : nullptr;
+        }
+        case LocationType::WHILE:
+        {
+            auto loc = static_cast<const WhileLocation<T>*>(this);
+            if (port == StorePort::WHILE_BODY) return loc->m_store_body;
+            if (port == StorePort::WHILE_EXIT) return loc->m_store_exit;
+            return nullptr;
+        }
+        case LocationType::ENDWHILE:
+        {
+            return port == StorePort::LAST ? static_cast<const EndWhileLocation<T>*>(this)->m_store_after : nullptr;
+        }
     }
+    return nullptr;
+}
 
-    virtual bool is_stable(std::unique_ptr<Location<T>>& old_location) const override
+template <typename T>
+void Location<T>::set_input(InputSlot slot, std::shared_ptr<IntervalStore<T>> store)
+{
+    switch (m_type)
     {
-        if (auto old = dynamic_cast<EndWhileLocation<T>*>(old_location.get()))
+        case LocationType::ASSIGNMENT:
+        {
+            if (slot == InputSlot::PREVIOUS) static_cast<AssignmentLocation<T>*>(this)->m_store_before = std::move(store);
+            break;
+        }
+        case LocationType::POSTCONDITION:
+        {
+            if (slot == InputSlot::PREVIOUS) static_cast<PostConditionLocation<T>*>(this)->m_store_before = std::move(store);
+            break;
+        }
+        case LocationType::IFELSE:
+        {
+            if (slot == InputSlot::PREVIOUS) static_cast<IfElseLocation<T>*>(this)->m_store_before_condition = std::move(store);
+            break;
+        }
+        case LocationType::ENDIF:
+        {
+            auto loc = static_cast<EndIfLocation<T>*>(this);
+            if (slot == InputSlot::PREVIOUS) loc->m_store_before = std::move(store);
+            else if (slot == InputSlot::FINAL_IF_BODY) loc->m_store_after_body = std::move(store);
+            else if (slot == InputSlot::FINAL_ELSE_BODY) loc->m_store_after_else = std::move(store);
+            break;
+        }
+        case LocationType::WHILE:
+        {
+            auto loc = static_cast<WhileLocation<T>*>(this);
+            if (slot == InputSlot::PREVIOUS) loc->m_store_before_condition = std::move(store);
+            else if (slot == InputSlot::WHILE_FEEDBACK) loc->m_store_feedback = std::move(store);
+            break;
+        }
+        case LocationType::ENDWHILE:
         {
-            return m_store_after->equals(*old->m_store_after);
+            if (slot == InputSlot::FINAL_WHILE_BODY) static_cast<EndWhileLocation<T>*>(this)->m_store_from_while = std::move(store);
+            break;
         }
-        return false;
     }
+}
 
-    virtual std::unique_ptr<Location<T>> copy() const override
+template <typename T>
+void Location<T>::set_output_store(StorePort port, std::shared_ptr<IntervalStore<T>> store)
+{
+    switch (m_type)
     {
-        auto copy = std::make_unique<EndWhileLocation<T>>();
-        if (m_store_from_while != nullptr) {
-            copy->m_store_from_while = std::make_shared<IntervalStore<T>>(*m_store_from_while);
-        } else {
-            copy->m_store_from_while = nullptr;
+        case LocationType::ASSIGNMENT:
+        {
+            if (port == StorePort::LAST) static_cast<AssignmentLocation<T>*>(this)->m_store_after = std::move(store);
+            break;
         }
-        if (m_store_after != nullptr) {
-            copy->m_store_after = std::make_shared<IntervalStore<T>>(*m_store_after);
-        } else {
-            copy->m_store_after = nullptr;
+        case LocationType::POSTCONDITION:
+        {
+            if (port == StorePort::LAST) static_cast<PostConditionLocation<T>*>(this)->m_store = std::move(store);
+            break;
+        }
+        case LocationType::IFELSE:
+        {
+            auto loc = static_cast<IfElseLocation<T>*>(this);
+            if (port == StorePort::IF_BODY) loc->m_store_if_body = std::move(store);
+            else if (port == StorePort::ELSE_BODY) loc->m_store_else_body = std::move(store);
+            break;
+        }
+        case LocationType::ENDIF:
+        {
+            if (port == StorePort::LAST) static_cast<EndIfLocation<T>*>(this)->m_store_after = std::move(store);
+            break;
+        }
+        case LocationType::WHILE:
+        {
+            auto loc = static_cast<WhileLocation<T>*>(this);
+            if (port == StorePort::WHILE_BODY) loc->m_store_body = std::move(store);
+            else if (port == StorePort::WHILE_EXIT) loc->m_store_exit = std::move(store);
+            break;
+        }
+        case LocationType::ENDWHILE:
+        {
+            if (port == StorePort::LAST) static_cast<EndWhileLocation<T>*>(this)->m_store_after = std::move(store);
+            break;
         }
-        return copy;
     }
-};
+}
+
+template <typename T>
+void Location<T>::adopt_stores(const Location<T>& other)
+{
+    assert(m_type == other.m_type && "stores can only be adopted from a location of the same kind");
+    m_changed_ports = 0;
+    switch (m_type)
+    {
+        case LocationType::ASSIGNMENT:
+        {
+            auto loc = static_cast<AssignmentLocation<T>*>(this);
+            auto from = static_cast<const AssignmentLocation<T>*>(&other);
+            loc->m_store_before = from->m_store_before;
+            loc->m_store_after = from->m_store_after;
+            break;
+        }
+        case LocationType::POSTCONDITION:
+        {
+            auto loc = static_cast<PostConditionLocation<T>*>(this);
+            auto from = static_cast<const PostConditionLocation<T>*>(&other);
+            loc->m_store_before = from->m_store_before;
+            loc->m_store = from->m_store;
+            break;
+        }
+        case LocationType::IFELSE:
+        {
+            auto loc = static_cast<IfElseLocation<T>*>(this);
+            auto from = static_cast<const IfElseLocation<T>*>(&other);
+            loc->m_store_before_condition = from->m_store_before_condition;
+            loc->m_store_if_body = from->m_store_if_body;
+            loc->m_store_else_body = from->m_store_else_body;
+            break;
+        }
+        case LocationType::ENDIF:
+        {
+            auto loc = static_cast<EndIfLocation<T>*>(this);
+            auto from = static_cast<const EndIfLocation<T>*>(&other);
+            loc->m_store_before = from->m_store_before;
+            loc->m_store_after_body = from->m_store_after_body;
+            loc->m_store_after_else = from->m_store_after_else;
+            loc->m_store_after = from->m_store_after;
+            break;
+        }
+        case LocationType::WHILE:
+        {
+            auto loc = static_cast<WhileLocation<T>*>(this);
+            auto from = static_cast<const WhileLocation<T>*>(&other);
+            loc->m_store_before_condition = from->m_store_before_condition;
+            loc->m_store_feedback = from->m_store_feedback;
+            loc->m_store_body = from->m_store_body;
+            loc->m_store_exit = from->m_store_exit;
+            loc->m_store_head = from->m_store_head;
+            loc->m_ascending_steps = from->m_ascending_steps;
+            loc->m_narrowing_steps = from->m_narrowing_steps;
+            break;
+        }
+        case LocationType::ENDWHILE:
+        {
+            auto loc = static_cast<EndWhileLocation<T>*>(this);
+            auto from = static_cast<const EndWhileLocation<T>*>(&other);
+            loc->m_store_from_while = from->m_store_from_while;
+            loc->m_store_after = from->m_store_after;
+            break;
+        }
+    }
+}
+
+template <typename T>
+void Location<T>::print() const
+{
+    switch (m_type)
+    {
+        case LocationType::ASSIGNMENT: static_cast<const AssignmentLocation<T>*>(this)->print(); break;
+        case LocationType::POSTCONDITION: static_cast<const PostConditionLocation<T>*>(this)->print(); break;
+        case LocationType::IFELSE: static_cast<const IfElseLocation<T>*>(this)->print(); break;
+        case LocationType::ENDIF: static_cast<const EndIfLocation<T>*>(this)->print(); break;
+        case LocationType::WHILE: static_cast<const WhileLocation<T>*>(this)->print(); break;
+        case LocationType::ENDWHILE: static_cast<const EndWhileLocation<T>*>(this)->print(); break;
+    }
+}
 
 #endif // LOCATION_BASE_HPP
\ No newline at end of file
@@ -0,0 +1,185 @@
+#ifndef LOCATION_PROFILER_HPP
+#define LOCATION_PROFILER_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "location_base.hpp"
+
+/**
+ * @brief What the profiler measured for a location
+ *
+ */
+struct LocationProfile {
+    std::size_t evaluations = 0;
+    std::uint64_t nanoseconds = 0;      // in the transfer function
+    std::size_t stable_after = 0;       // evaluations up to the last one that changed an output store
+    std::size_t widenings = 0;
+};
+
+/**
+ * @brief Location of a profile, with the statements that enclose it
+ *
+ */
+struct ProfiledLocation {
+    static constexpr std::size_t TOP_LEVEL = std::numeric_limits<std::size_t>::max();
+
+    LocationType type;
+    std::size_t line;       // 0 if the program was not parsed from a source
+    std::size_t parent;     // index of the if-else or while location of the enclosing statement
+    LocationProfile profile;
+
+    /**
+     * @brief Name of the location in the reports, `while:12` for the loop of line 12
+     *
+     */
+    std::string frame(std::size_t index) const
+    {
+        return std::string(location_type_name(type)) + (line > 0 ? ":" + std::to_string(line) : "#" + std::to_string(index));
+    }
+};
+
+/**
+ * @brief Times the evaluations of the locations of an equational system. The slot of a location is only
+ * written by the thread that evaluates it, so the parallel solver needs no synchronization.
+ *
+ */
+class LocationProfiler
+{
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::vector<LocationProfile> m_profiles;
+
+public:
+    explicit LocationProfiler(std::size_t locations)
+    : m_profiles(locations)
+    {}
+
+    /**
+     * @brief Runs an evaluation of a location
+     *
+     * @param index
+     * @param evaluate returns whether an output store of the location changed
+     */
+    template <typename Evaluate>
+    void measure(std::size_t index, Evaluate&& evaluate)
+    {
+        auto start = Clock::now();
+        bool changed = evaluate();
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+
+        auto& profile = m_profiles[index];
+        profile.evaluations++;
+        profile.nanoseconds += static_cast<std::uint64_t>(elapsed);
+        if (changed)
+        {
+            profile.stable_after = profile.evaluations;
+        }
+    }
+
+    void widening(std::size_t index)
+    {
+        m_profiles[index].widenings++;
+    }
+
+    const std::vector<LocationProfile>& profiles() const
+    {
+        return m_profiles;
+    }
+};
+
+/**
+ * @brief Time of every location with the locations nested in its statement
+ *
+ */
+inline std::vector<std::uint64_t> inclusive_nanoseconds(const std::vector<ProfiledLocation>& locations)
+{
+    std::vector<std::uint64_t> inclusive(locations.size(), 0);
+    // The statements enclosing a location come before it
+    for (std::size_t index = locations.size(); index-- > 0;)
+    {
+        inclusive[index] += locations[index].profile.nanoseconds;
+        if (locations[index].parent != ProfiledLocation::TOP_LEVEL)
+        {
+            inclusive[locations[index].parent] += inclusive[index];
+        }
+    }
+    return inclusive;
+}
+
+/**
+ * @brief Writes the locations that were evaluated, from the most expensive one in its own transfer
+ * function to the cheapest, with their time including the statements they enclose
+ *
+ * @param out
+ * @param locations
+ */
+inline void write_profile_report(std::ostream& out, const std::vector<ProfiledLocation>& locations)
+{
+    auto inclusive = inclusive_nanoseconds(locations);
+    std::vector<std::size_t> ranking;
+    std::uint64_t total = 0;
+    std::size_t evaluations = 0;
+    for (std::size_t index = 0; index < locations.size(); ++index)
+    {
+        total += locations[index].profile.nanoseconds;
+        evaluations += locations[index].profile.evaluations;
+        if (locations[index].profile.evaluations > 0)
+        {
+            ranking.push_back(index);
+        }
+    }
+    std::stable_sort(ranking.begin(), ranking.end(), [&](std::size_t a, std::size_t b) {
+        return locations[a].profile.nanoseconds > locations[b].profile.nanoseconds;
+    });
+
+    auto ms = [](std::uint64_t nanoseconds) { return nanoseconds / 1e6; };
+    out << "Profile: " << locations.size() << " locations, " << evaluations << " evaluations, " << std::fixed
+        << std::setprecision(3) << ms(total) << " ms in the transfer functions" << std::endl;
+    out << std::setw(6) << "rank" << std::setw(10) << "location" << std::setw(20) << "frame" << std::setw(13)
+        << "evaluations" << std::setw(11) << "self_ms" << std::setw(8) << "share" << std::setw(11) << "total_ms"
+        << std::setw(14) << "stable_after" << std::setw(11) << "widenings" << std::endl;
+    for (std::size_t rank = 0; rank < ranking.size(); ++rank)
+    {
+        auto index = ranking[rank];
+        const auto& profile = locations[index].profile;
+        out << std::setw(6) << rank + 1 << std::setw(10) << index << std::setw(20) << locations[index].frame(index)
+            << std::setw(13) << profile.evaluations << std::setw(11) << ms(profile.nanoseconds) << std::setw(7)
+            << std::setprecision(1) << (total > 0 ? 100.0 * profile.nanoseconds / total : 0.0) << "%"
+            << std::setprecision(3) << std::setw(11) << ms(inclusive[index]) << std::setw(14) << profile.stable_after
+            << std::setw(11) << profile.widenings << std::endl;
+    }
+    out << std::defaultfloat;
+}
+
+/**
+ * @brief Writes the time of the locations in the folded format of flamegraph.pl, one line per location
+ * with its enclosing statements as the stack, `program;while:3;ifelse:5;assignment:6 1200` for 1200 ns
+ *
+ * @param out
+ * @param locations
+ */
+inline void write_folded_stacks(std::ostream& out, const std::vector<ProfiledLocation>& locations)
+{
+    std::vector<std::string> stacks(locations.size());
+    for (std::size_t index = 0; index < locations.size(); ++index)
+    {
+        auto parent = locations[index].parent;
+        stacks[index] = (parent == ProfiledLocation::TOP_LEVEL ? std::string("program") : stacks[parent]) + ";"
+                      + locations[index].frame(index);
+        if (locations[index].profile.nanoseconds > 0)
+        {
+            out << stacks[index] << " " << locations[index].profile.nanoseconds << "\n";
+        }
+    }
+    out.flush();
+}
+
+#endif // LOCATION_PROFILER_HPP
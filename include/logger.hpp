@@ -0,0 +1,133 @@
+#ifndef LOGGER_HPP
+#define LOGGER_HPP
+
+#include <iostream>
+#include <string>
+
+/**
+ * @brief Highest verbosity that is compiled in. Statements above this level are removed at compile
+ * time, whatever the level selected at runtime.
+ *
+ */
+#ifndef ABSINT_MAX_LOG_LEVEL
+#ifdef DEBUG
+#define ABSINT_MAX_LOG_LEVEL 3
+#else
+#define ABSINT_MAX_LOG_LEVEL 2
+#endif
+#endif
+
+/**
+ * @brief Verbosity of the analysis output
+ *
+ */
+enum class LogLevel : int {
+    QUIET = 0,      // errors only
+    SUMMARY = 1,    // final invariants, postcondition verdicts and statistics
+    TRACE = 2,      // every step of the construction and of the fixpoint iteration
+    VERBOSE = 3     // trace, plus the AST and the dependencies between locations (`debug`)
+};
+
+/**
+ * @brief Process-wide verbosity. Checking a level compiled out is a constant expression, and the
+ * logging macros below do not evaluate their operands when the level is disabled.
+ *
+ */
+class Logger
+{
+private:
+    static inline LogLevel s_level = LogLevel::SUMMARY;
+    static inline thread_local std::ostream* t_out = nullptr;
+    static inline thread_local std::ostream* t_err = nullptr;
+
+public:
+    static constexpr LogLevel MAX_LEVEL = static_cast<LogLevel>(ABSINT_MAX_LOG_LEVEL);
+
+    static void set_level(LogLevel level)
+    {
+        s_level = level;
+    }
+
+    static LogLevel level()
+    {
+        return s_level;
+    }
+
+    static bool enabled(LogLevel level)
+    {
+        return level <= MAX_LEVEL && level <= s_level;
+    }
+
+    /**
+     * @brief Parses the name of a level (`quiet`, `summary`, `trace` or `debug`)
+     *
+     * @param name
+     * @param level
+     * @return true if the name is valid
+     */
+    static bool parse_level(const std::string& name, LogLevel& level)
+    {
+        if (name == "quiet") level = LogLevel::QUIET;
+        else if (name == "summary") level = LogLevel::SUMMARY;
+        else if (name == "trace") level = LogLevel::TRACE;
+        else if (name == "debug") level = LogLevel::VERBOSE;
+        else return false;
+        return true;
+    }
+
+    /**
+     * @brief Streams of the logging macros in the calling thread: the standard ones, unless a Capture is
+     * active in the thread
+     *
+     */
+    static std::ostream& out()
+    {
+        return t_out != nullptr ? *t_out : std::cout;
+    }
+
+    static std::ostream& err()
+    {
+        return t_err != nullptr ? *t_err : std::cerr;
+    }
+
+    /**
+     * @brief Redirects the logging macros of the calling thread to the given streams while it lives, so that
+     * the messages of tasks run in parallel can be printed afterwards in a deterministic order
+     *
+     */
+    class Capture
+    {
+    private:
+        std::ostream* m_previous_out;
+        std::ostream* m_previous_err;
+
+    public:
+        Capture(std::ostream& out, std::ostream& err)
+        : m_previous_out(t_out)
+        , m_previous_err(t_err)
+        {
+            t_out = &out;
+            t_err = &err;
+        }
+
+        Capture(const Capture&) = delete;
+        Capture& operator=(const Capture&) = delete;
+
+        ~Capture()
+        {
+            t_out = m_previous_out;
+            t_err = m_previous_err;
+        }
+    };
+};
+
+#define ABSINT_LOG(level, stream) if (!Logger::enabled(level)) {} else stream
+
+#define LOG_SUMMARY ABSINT_LOG(LogLevel::SUMMARY, Logger::out())
+#define LOG_TRACE ABSINT_LOG(LogLevel::TRACE, Logger::out())
+#define LOG_DEBUG ABSINT_LOG(LogLevel::VERBOSE, Logger::out())
+
+#define WARN_SUMMARY ABSINT_LOG(LogLevel::SUMMARY, Logger::err())
+#define WARN_TRACE ABSINT_LOG(LogLevel::TRACE, Logger::err())
+
+#endif // LOGGER_HPP
@@ -0,0 +1,177 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief Read-only memory mapping of a whole file. The mapping is released with the object.
+ *
+ */
+class MappedFile
+{
+private:
+    const char* m_data = nullptr;
+    std::size_t m_size = 0;
+
+public:
+    MappedFile() = default;
+
+    /**
+     * @brief Maps the given file, leaving the object closed (see is_open) if it cannot be read
+     *
+     * @param path
+     */
+    explicit MappedFile(const std::string& path)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return;
+        }
+        struct stat info;
+        if (::fstat(fd, &info) == 0 && info.st_size > 0)
+        {
+            void* data = ::mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED)
+            {
+                m_data = static_cast<const char*>(data);
+                m_size = info.st_size;
+            }
+        }
+        ::close(fd);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr))
+    , m_size(std::exchange(other.m_size, 0))
+    {}
+
+    MappedFile& operator=(MappedFile&& other) noexcept
+    {
+        if (this != &other)
+        {
+            unmap();
+            m_data = std::exchange(other.m_data, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+        }
+        return *this;
+    }
+
+    ~MappedFile()
+    {
+        unmap();
+    }
+
+    bool is_open() const
+    {
+        return m_data != nullptr;
+    }
+
+    const char* data() const
+    {
+        return m_data;
+    }
+
+    std::size_t size() const
+    {
+        return m_size;
+    }
+
+    /**
+     * @brief Reads the whole mapping now, so that the pages are not faulted in by the thread that parses it
+     *
+     */
+    void prefetch() const
+    {
+        if (m_data == nullptr)
+        {
+            return;
+        }
+        ::madvise(const_cast<char*>(m_data), m_size, MADV_WILLNEED);
+        const auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        volatile char sink = 0;
+        for (std::size_t offset = 0; offset < m_size; offset += page)
+        {
+            sink = sink + m_data[offset];
+        }
+    }
+
+private:
+    void unmap()
+    {
+        if (m_data != nullptr)
+        {
+            ::munmap(const_cast<char*>(m_data), m_size);
+        }
+    }
+};
+
+/**
+ * @brief Source of a program, mapped in memory so that the parser reads the file without copying it. The
+ * file must not be truncated while its text is in use.
+ *
+ */
+class SourceFile
+{
+private:
+    MappedFile m_file;
+    std::string m_copy;
+    bool m_open = false;
+
+public:
+    SourceFile() = default;
+
+    /**
+     * @brief Maps the given file, leaving the object closed (see is_open) if it cannot be read
+     *
+     * @param path
+     */
+    explicit SourceFile(const std::string& path)
+    : m_file(path)
+    {
+        if (m_file.is_open())
+        {
+            m_open = true;
+            return;
+        }
+        // Empty files cannot be mapped, nor can pipes: they are read instead
+        std::ifstream f(path, std::ios::binary);
+        if (f.is_open())
+        {
+            std::ostringstream buffer;
+            buffer << f.rdbuf();
+            m_copy = buffer.str();
+            m_open = true;
+        }
+    }
+
+    bool is_open() const
+    {
+        return m_open;
+    }
+
+    void prefetch() const
+    {
+        m_file.prefetch();
+    }
+
+    std::string_view text() const
+    {
+        return m_file.is_open() ? std::string_view(m_file.data(), m_file.size()) : std::string_view(m_copy);
+    }
+};
+
+#endif // MAPPED_FILE_HPP
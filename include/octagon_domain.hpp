@@ -0,0 +1,493 @@
+#ifndef OCTAGON_DOMAIN_HPP
+#define OCTAGON_DOMAIN_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "abstract_domain.hpp"
+#include "interval.hpp"
+
+/**
+ * @brief Bounds of the matrices of OctagonDomain. A finite bound lies between -FINITE and FINITE, and any
+ * larger one is INF, so that the sum of two bounds never overflows. A bound below -FINITE is raised to it,
+ * which only weakens its constraint.
+ *
+ */
+struct OctagonBounds {
+    using Entry = std::int64_t;
+    static constexpr Entry INF = std::numeric_limits<Entry>::max() / 2;
+    static constexpr Entry FINITE = std::numeric_limits<Entry>::max() / 8;
+
+    static Entry normalize(Entry bound)
+    {
+        return bound > FINITE ? INF : std::max(bound, -FINITE);
+    }
+
+    // Rounds down, as the bounds are on integers
+    static Entry half(Entry bound)
+    {
+        return bound == INF ? INF : bound >> 1;
+    }
+
+    static Entry twice(Entry bound)
+    {
+        return normalize(2 * bound);
+    }
+};
+
+/**
+ * @brief Relaxation kernel of the closure of OctagonDomain, row[j] = min(row[j], through + pivot[j]) over a
+ * row of a matrix, whose length is a multiple of LANES. The sums are normalized as OctagonBounds.
+ *
+ * The generic version is a scalar loop without branches, which the compiler vectorizes. The version for
+ * AVX2 is used when the compiler targets it.
+ *
+ */
+struct OctagonKernels {
+    using Entry = OctagonBounds::Entry;
+    static constexpr std::size_t LANES = 4;
+
+#if defined(__AVX2__)
+    static void relax(Entry* row, Entry through, const Entry* pivot, std::size_t size)
+    {
+        const auto via = _mm256_set1_epi64x(through);
+        const auto lowest = _mm256_set1_epi64x(-OctagonBounds::FINITE);
+        const auto finite = _mm256_set1_epi64x(OctagonBounds::FINITE);
+        const auto inf = _mm256_set1_epi64x(OctagonBounds::INF);
+        for (std::size_t j = 0; j < size; j += LANES)
+        {
+            auto sum = _mm256_add_epi64(via, load(pivot + j));
+            sum = _mm256_blendv_epi8(sum, lowest, _mm256_cmpgt_epi64(lowest, sum));
+            auto bound = load(row + j);
+            bound = _mm256_blendv_epi8(bound, sum, _mm256_cmpgt_epi64(bound, sum));
+            bound = _mm256_blendv_epi8(bound, inf, _mm256_cmpgt_epi64(bound, finite));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(row + j), bound);
+        }
+    }
+
+private:
+    static __m256i load(const Entry* p)
+    {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    }
+#else
+    static void relax(Entry* row, Entry through, const Entry* pivot, std::size_t size)
+    {
+        for (std::size_t j = 0; j < size; ++j)
+        {
+            auto sum = std::max(through + pivot[j], -OctagonBounds::FINITE);
+            auto bound = std::min(row[j], sum);
+            row[j] = bound > OctagonBounds::FINITE ? OctagonBounds::INF : bound;
+        }
+    }
+#endif
+};
+
+/**
+ * @brief Octagons: the constraints ±x ±y <= c between the variables of a pack, as a matrix of bounds
+ * over the terms V_2v = v and V_2v+1 = -v of its variables, where the bound at (i, j) is that of
+ * V_j - V_i. The bounds of a variable are those of V_2v - V_2v+1 = 2v and of its opposite.
+ *
+ * The closure, which derives the tightest bounds, is that of the integer octagons: the shortest paths,
+ * then the bounds of 2v rounded down to an even integer, then the bounds of every V_j - V_i through those
+ * of 2V_j and -2V_i. It is cubic in the size of the pack, so that the packs are kept small; the rows of a
+ * matrix are padded to OctagonKernels::LANES bounds. The assignments of a term plus a constant keep a
+ * closed matrix closed, and only the guards close it again.
+ *
+ * A term plus a constant is assigned or compared exactly only if it does not saturate T, which the
+ * analysis checks (see PackedDomainAnalysis), so that the relations hold for the saturating arithmetic
+ * of the interval analysis.
+ *
+ * @tparam T
+ */
+template <typename T>
+struct OctagonDomain
+{
+    static_assert(std::is_signed_v<T>, "the constraints of an octagon are on differences of values");
+
+    using Bound = T;
+    using Entry = OctagonBounds::Entry;
+
+    static constexpr T min_T = std::numeric_limits<T>::min();
+    static constexpr T max_T = std::numeric_limits<T>::max();
+    static constexpr Entry INF = OctagonBounds::INF;
+
+    struct Value {
+        std::size_t size = 0;
+        std::size_t stride = 0;
+        bool empty = false;
+        bool closed = true;
+        std::vector<Entry> bounds;      // by row, (i, j) at i * stride + j
+
+        Entry& at(std::size_t i, std::size_t j) { return bounds[i * stride + j]; }
+        Entry at(std::size_t i, std::size_t j) const { return bounds[i * stride + j]; }
+        Entry* row(std::size_t i) { return bounds.data() + i * stride; }
+    };
+
+    static Value top(std::size_t size)
+    {
+        Value value;
+        value.size = size;
+        value.stride = (2 * size + OctagonKernels::LANES - 1) / OctagonKernels::LANES * OctagonKernels::LANES;
+        value.bounds.assign(2 * size * value.stride, INF);
+        for (std::size_t i = 0; i < 2 * size; ++i)
+        {
+            value.at(i, i) = 0;
+        }
+        return value;
+    }
+
+    static Value bottom(std::size_t size)
+    {
+        auto value = top(size);
+        value.empty = true;
+        return value;
+    }
+
+    static Value join(Value a, Value b)
+    {
+        close(a);
+        close(b);
+        if (a.empty) return b;
+        if (b.empty) return a;
+        for (std::size_t i = 0; i < a.bounds.size(); ++i)
+        {
+            a.bounds[i] = std::max(a.bounds[i], b.bounds[i]);
+        }
+        return a;
+    }
+
+    // The bounds that grow go to INF. The result is not closed, so that the bounds of a
+    // sequence of widenings only ever grow.
+    static Value widen(Value a, Value b)
+    {
+        close(b);
+        if (a.empty) return b;
+        if (b.empty) return a;
+        for (std::size_t i = 0; i < a.bounds.size(); ++i)
+        {
+            if (b.bounds[i] > a.bounds[i])
+            {
+                a.bounds[i] = INF;
+                a.closed = false;
+            }
+        }
+        return a;
+    }
+
+    static bool leq(Value a, const Value& b)
+    {
+        close(a);
+        if (a.empty) return true;
+        if (b.empty) return false;
+        for (std::size_t i = 0; i < a.bounds.size(); ++i)
+        {
+            if (a.bounds[i] > b.bounds[i])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static bool is_bottom(const Value& a) { return a.empty; }
+
+    static void forget(Value& a, std::size_t variable)
+    {
+        close(a);
+        if (a.empty)
+        {
+            return;
+        }
+        for (std::size_t i = 0; i < 2 * a.size; ++i)
+        {
+            a.at(2 * variable, i) = a.at(2 * variable + 1, i) = INF;
+            a.at(i, 2 * variable) = a.at(i, 2 * variable + 1) = INF;
+        }
+        a.at(2 * variable, 2 * variable) = a.at(2 * variable + 1, 2 * variable + 1) = 0;
+    }
+
+    static void assign(Value& a, std::size_t variable, PackTerm term, T constant)
+    {
+        close(a);
+        if (a.empty)
+        {
+            return;
+        }
+        if (constant > OctagonBounds::FINITE || constant < -OctagonBounds::FINITE)
+        {
+            forget(a, variable);
+            return;
+        }
+        if (term.variable != variable)
+        {
+            forget(a, variable);
+            copy(a, variable, term.variable);
+        }
+        if (term.negated)
+        {
+            negate(a, variable);
+        }
+        shift(a, variable, constant);
+    }
+
+    static void assign_range(Value& a, std::size_t variable, T lb, T ub)
+    {
+        if (lb > ub)
+        {
+            a.empty = true;
+            return;
+        }
+        forget(a, variable);
+        if (a.empty)
+        {
+            return;
+        }
+        // Nothing else bounds the variable, so the strengthening alone closes the matrix again
+        a.at(2 * variable + 1, 2 * variable) = OctagonBounds::twice(upper(ub));
+        a.at(2 * variable, 2 * variable + 1) = OctagonBounds::twice(upper_opposite(lb));
+        strengthen(a);
+    }
+
+    static void constrain(Value& a, PackTerm x, std::optional<PackTerm> y, T bound)
+    {
+        if (a.empty)
+        {
+            return;
+        }
+        auto c = upper(bound);
+        auto i = index(x);
+        if (!y.has_value())
+        {
+            tighten(a, i ^ 1, i, OctagonBounds::twice(c));
+        }
+        else if (y->variable == x.variable)
+        {
+            if (y->negated == x.negated)
+            {
+                tighten(a, i ^ 1, i, c);
+            }
+            else if (c < 0)
+            {
+                a.empty = true;
+                return;
+            }
+        }
+        else
+        {
+            auto j = index(*y);
+            tighten(a, j ^ 1, i, c);
+            tighten(a, i ^ 1, j, c);
+        }
+        close(a);
+    }
+
+    static bool entails(const Value& a, PackTerm x, std::optional<PackTerm> y, T bound)
+    {
+        if (!a.closed)
+        {
+            auto closed = a;
+            close(closed);
+            return entails(closed, x, y, bound);
+        }
+        if (a.empty)
+        {
+            return true;
+        }
+        auto i = index(x);
+        Entry sum = 0;
+        if (!y.has_value())
+        {
+            sum = OctagonBounds::half(a.at(i ^ 1, i));
+        }
+        else if (y->variable == x.variable)
+        {
+            sum = y->negated == x.negated ? a.at(i ^ 1, i) : 0;
+        }
+        else
+        {
+            sum = a.at(index(*y) ^ 1, i);
+        }
+        return sum != INF && sum <= static_cast<Entry>(bound);
+    }
+
+    static Interval<T> range(const Value& a, std::size_t variable)
+    {
+        if (!a.closed)
+        {
+            auto closed = a;
+            close(closed);
+            return range(closed, variable);
+        }
+        if (a.empty)
+        {
+            return Interval<T>::empty();
+        }
+        auto ub = a.at(2 * variable + 1, 2 * variable);
+        auto lb = a.at(2 * variable, 2 * variable + 1);
+        return Interval<T>(lb == INF ? min_T : clamp(-OctagonBounds::half(lb)), ub == INF ? max_T : clamp(OctagonBounds::half(ub)));
+    }
+
+private:
+    static std::size_t index(PackTerm term)
+    {
+        return 2 * term.variable + (term.negated ? 1 : 0);
+    }
+
+    // Entry that bounds a value from above, and the one that bounds its opposite
+    static Entry upper(T value)
+    {
+        return OctagonBounds::normalize(static_cast<Entry>(std::min<std::int64_t>(value, OctagonBounds::INF)));
+    }
+
+    static Entry upper_opposite(T value)
+    {
+        return value < -OctagonBounds::FINITE ? INF : OctagonBounds::normalize(-static_cast<Entry>(value));
+    }
+
+    static T clamp(Entry bound)
+    {
+        return static_cast<T>(std::clamp<Entry>(bound, min_T, max_T));
+    }
+
+    static void tighten(Value& a, std::size_t i, std::size_t j, Entry bound)
+    {
+        if (bound < a.at(i, j))
+        {
+            a.at(i, j) = bound;
+            a.closed = false;
+        }
+    }
+
+    static void close(Value& a)
+    {
+        if (a.empty || a.closed)
+        {
+            return;
+        }
+        auto dimension = 2 * a.size;
+        for (std::size_t k = 0; k < dimension; ++k)
+        {
+            const Entry* pivot = a.row(k);
+            for (std::size_t i = 0; i < dimension; ++i)
+            {
+                auto through = a.at(i, k);
+                if (through != INF)
+                {
+                    OctagonKernels::relax(a.row(i), through, pivot, a.stride);
+                }
+            }
+        }
+        for (std::size_t i = 0; i < dimension; ++i)
+        {
+            auto& bound = a.at(i, i ^ 1);
+            bound = bound == INF ? INF : OctagonBounds::normalize(2 * OctagonBounds::half(bound));
+        }
+        strengthen(a);
+        a.closed = !a.empty;
+    }
+
+    // Bounds every V_j - V_i by the half of the bounds of -2V_i and 2V_j, and checks the diagonal
+    static void strengthen(Value& a)
+    {
+        auto dimension = 2 * a.size;
+        for (std::size_t i = 0; i < dimension; ++i)
+        {
+            auto opposite = a.at(i, i ^ 1);
+            if (opposite == INF)
+            {
+                continue;
+            }
+            for (std::size_t j = 0; j < dimension; ++j)
+            {
+                auto twice = a.at(j ^ 1, j);
+                if (twice != INF)
+                {
+                    a.at(i, j) = std::min(a.at(i, j), OctagonBounds::half(opposite + twice));
+                }
+            }
+        }
+        for (std::size_t i = 0; i < dimension; ++i)
+        {
+            if (a.at(i, i) < 0)
+            {
+                a.empty = true;
+                return;
+            }
+        }
+    }
+
+    // Makes a variable, forgotten before, equal to another one of the pack, which keeps a closed matrix closed
+    static void copy(Value& a, std::size_t to, std::size_t from)
+    {
+        for (std::size_t j = 0; j < 2 * a.size; ++j)
+        {
+            if (j / 2 == to)
+            {
+                continue;
+            }
+            a.at(2 * to, j) = a.at(2 * from, j);
+            a.at(2 * to + 1, j) = a.at(2 * from + 1, j);
+            a.at(j, 2 * to) = a.at(j, 2 * from);
+            a.at(j, 2 * to + 1) = a.at(j, 2 * from + 1);
+        }
+        a.at(2 * to, 2 * to + 1) = a.at(2 * from, 2 * from + 1);
+        a.at(2 * to + 1, 2 * to) = a.at(2 * from + 1, 2 * from);
+    }
+
+    // Swaps the terms of a variable and of its opposite
+    static void negate(Value& a, std::size_t variable)
+    {
+        auto positive = 2 * variable;
+        for (std::size_t j = 0; j < a.stride; ++j)
+        {
+            std::swap(a.at(positive, j), a.at(positive + 1, j));
+        }
+        for (std::size_t i = 0; i < 2 * a.size; ++i)
+        {
+            std::swap(a.at(i, positive), a.at(i, positive + 1));
+        }
+    }
+
+    // x = x + constant moves V_2x by constant and V_2x+1 by -constant
+    static void shift(Value& a, std::size_t variable, Entry constant)
+    {
+        if (constant == 0)
+        {
+            return;
+        }
+        auto positive = 2 * variable;
+        auto move = [&a](Entry& bound, Entry by) {
+            if (bound != INF)
+            {
+                auto moved = OctagonBounds::normalize(bound + by);
+                a.closed = a.closed && moved == bound + by;
+                bound = moved;
+            }
+        };
+        for (std::size_t j = 0; j < 2 * a.size; ++j)
+        {
+            move(a.at(positive, j), -constant);
+            move(a.at(positive + 1, j), constant);
+        }
+        for (std::size_t i = 0; i < 2 * a.size; ++i)
+        {
+            move(a.at(i, positive), constant);
+            move(a.at(i, positive + 1), -constant);
+        }
+    }
+};
+
+static_assert(RelationalDomain<OctagonDomain<std::int64_t>>);
+
+#endif // OCTAGON_DOMAIN_HPP
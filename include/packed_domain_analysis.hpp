@@ -0,0 +1,781 @@
+#ifndef PACKED_DOMAIN_ANALYSIS_HPP
+#define PACKED_DOMAIN_ANALYSIS_HPP
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "abstract_domain.hpp"
+#include "flat_ast.hpp"
+#include "interval.hpp"
+
+/**
+ * @brief Partition of the variables of a program into packs by syntactic co-occurrence: the target and the
+ * variables of the right-hand side of an assignment, and the variables of the condition of an if-else or
+ * while statement, are put in the same pack, unless it would hold more than MAX_SIZE variables. The
+ * occurrences are merged in the order of the nodes, so that a variable that co-occurs with too many others
+ * stays in the pack of the first ones.
+ *
+ */
+class VariablePacks
+{
+public:
+    static constexpr std::size_t MAX_SIZE = 8;
+
+private:
+    std::vector<std::size_t> m_parent;      // union-find over the symbols, then the pack of every symbol
+    std::vector<std::size_t> m_position;    // by symbol, in its pack
+    std::vector<std::size_t> m_sizes;       // by pack
+
+public:
+    explicit VariablePacks(const FlatAST& ast)
+    : m_parent(ast.symbols().size())
+    , m_position(ast.symbols().size(), 0)
+    , m_sizes(ast.symbols().size(), 1)
+    {
+        std::iota(m_parent.begin(), m_parent.end(), 0);
+        std::vector<std::size_t> variables;
+        for (FlatAST::Index index = 0; index < ast.size(); ++index)
+        {
+            auto node = ast.node(index);
+            if (node.type() != NodeType::ASSIGNMENT && node.type() != NodeType::IFELSE && node.type() != NodeType::WHILELOOP)
+            {
+                continue;
+            }
+            variables.clear();
+            collect(node.type() == NodeType::ASSIGNMENT ? node : node.child(0), variables);
+            for (std::size_t i = 1; i < variables.size(); ++i)
+            {
+                merge(variables[0], variables[i]);
+            }
+        }
+
+        // Numbers the packs and the variables in them
+        std::vector<std::size_t> packs(m_parent.size(), m_parent.size());
+        std::vector<std::size_t> pack_of(m_parent.size());
+        std::vector<std::size_t> sizes;
+        for (std::size_t symbol = 0; symbol < m_parent.size(); ++symbol)
+        {
+            auto& pack = packs[find(symbol)];
+            if (pack == m_parent.size())
+            {
+                pack = sizes.size();
+                sizes.push_back(0);
+            }
+            pack_of[symbol] = pack;
+            m_position[symbol] = sizes[pack]++;
+        }
+        m_parent = std::move(pack_of);
+        m_sizes = std::move(sizes);
+    }
+
+    std::size_t count() const
+    {
+        return m_sizes.size();
+    }
+
+    std::size_t size(std::size_t pack) const
+    {
+        return m_sizes[pack];
+    }
+
+    std::size_t pack(std::size_t symbol) const
+    {
+        return m_parent[symbol];
+    }
+
+    std::size_t position(std::size_t symbol) const
+    {
+        return m_position[symbol];
+    }
+
+private:
+    static void collect(FlatAST::Node node, std::vector<std::size_t>& variables)
+    {
+        if (node.type() == NodeType::VARIABLE)
+        {
+            variables.push_back(node.symbol());
+            return;
+        }
+        for (auto child : node.children())
+        {
+            collect(child, variables);
+        }
+    }
+
+    std::size_t find(std::size_t symbol)
+    {
+        while (m_parent[symbol] != symbol)
+        {
+            m_parent[symbol] = m_parent[m_parent[symbol]];
+            symbol = m_parent[symbol];
+        }
+        return symbol;
+    }
+
+    void merge(std::size_t a, std::size_t b)
+    {
+        a = find(a);
+        b = find(b);
+        if (a == b || m_sizes[a] + m_sizes[b] > MAX_SIZE)
+        {
+            return;
+        }
+        if (m_sizes[a] < m_sizes[b])
+        {
+            std::swap(a, b);
+        }
+        m_parent[b] = a;
+        m_sizes[a] += m_sizes[b];
+    }
+};
+
+/**
+ * @brief Structured analysis of a program in a RelationalDomain over the VariablePacks of the program, used
+ * with DomainAnalysis to discharge postconditions before the interval analysis. It goes through the
+ * statements as DomainAnalysis does, with a value of the domain for every pack.
+ *
+ * An assignment x = ±y + c, a guard and a postcondition that compare two such sides are handled by the
+ * domain when their variables are in the same pack, and the variables of different packs are compared
+ * through their ranges. The other expressions are evaluated in the intervals, from the ranges of their
+ * variables. A side ±y + c is only taken as such when it cannot saturate T, so that the relations also
+ * hold for the arithmetic of the interval analysis.
+ *
+ * A postcondition is discharged when it holds every time it is reached, including at the fixpoint of its
+ * loops; postconditions that are never reached are not discharged.
+ *
+ * @tparam D
+ */
+template <RelationalDomain D>
+class PackedDomainAnalysis
+{
+private:
+    using Value = typename D::Value;
+    using Bound = typename D::Bound;
+    using Intervals = IntervalDomain<Bound>;
+    using Arithmetic = BoundArithmetic<Bound>;
+
+    // The values of the packs are shared between the states until they are written, as the pages of the
+    // interval stores, so that the branches and the iterations of a loop only copy what they change
+    struct State {
+        std::vector<std::shared_ptr<Value>> packs;
+        bool bottom = false;
+    };
+
+    // A variable, its opposite or nothing, plus a constant
+    struct Affine {
+        std::optional<std::size_t> symbol;
+        bool negated = false;
+        Bound constant = 0;
+    };
+
+    // Sum of at most two terms, one per side of a comparison
+    struct Sum {
+        std::optional<std::pair<std::size_t, bool>> x;
+        std::optional<std::pair<std::size_t, bool>> y;
+        Bound constant = 0;
+    };
+
+    static constexpr std::size_t WIDENING_DELAY = 3;
+
+    const FlatAST& m_ast;
+    VariablePacks m_packs;
+    std::vector<std::uint8_t> m_checks;     // by node: 0 not reached, 1 held every time, 2 failed once
+    std::size_t m_discharged = 0;
+
+public:
+    explicit PackedDomainAnalysis(const FlatAST& ast)
+    : m_ast(ast)
+    , m_packs(ast)
+    , m_checks(ast.size(), 0)
+    {}
+
+    /**
+     * @brief Analyzes the program
+     *
+     * @return std::vector<bool> the discharged postconditions, by node of the AST
+     */
+    std::vector<bool> run()
+    {
+        std::vector<bool> discharged(m_ast.size(), false);
+        if (m_ast.size() == 0)
+        {
+            return discharged;
+        }
+        for (auto block : m_ast.root().children())
+        {
+            if (block.type() == NodeType::SEQUENCE)
+            {
+                auto sequence = block.children();
+                auto [state, first] = preconditions(sequence);
+                for (std::size_t statement = first; statement < sequence.size(); ++statement)
+                {
+                    state = this->statement(sequence[statement], std::move(state));
+                }
+                break;
+            }
+        }
+        for (std::size_t node = 0; node < m_checks.size(); ++node)
+        {
+            if (m_checks[node] == 1)
+            {
+                discharged[node] = true;
+                m_discharged++;
+            }
+        }
+        return discharged;
+    }
+
+    std::size_t discharged() const
+    {
+        return m_discharged;
+    }
+
+    const VariablePacks& packs() const
+    {
+        return m_packs;
+    }
+
+private:
+    // The statements of the body of an if-else or while statement, given its If-Body, Else-Body or While-Body node
+    static FlatAST::Children body_statements(FlatAST::Node part)
+    {
+        auto block = part.child(0);
+        return block.type() == NodeType::SEQUENCE ? block.children() : part.children();
+    }
+
+    State statements(FlatAST::Children statements, State state)
+    {
+        for (auto statement : statements)
+        {
+            state = this->statement(statement, std::move(state));
+        }
+        return state;
+    }
+
+    State statement(FlatAST::Node statement, State state)
+    {
+        switch (statement.type())
+        {
+            case NodeType::ASSIGNMENT:
+            {
+                assign(statement.child(0).symbol(), statement.child(1), state);
+                return state;
+            }
+            case NodeType::POST_CON:
+            {
+                check(statement, state);
+                return state;
+            }
+            case NodeType::IFELSE:
+            {
+                auto condition = statement.child(0).child(0);
+                auto if_state = statements(body_statements(statement.child(1)), guard(condition, state, false));
+                auto else_state = guard(condition, std::move(state), true);
+                if (statement.size() == 3)
+                {
+                    else_state = statements(body_statements(statement.child(2)), std::move(else_state));
+                }
+                return join(if_state, else_state);
+            }
+            case NodeType::WHILELOOP:
+            {
+                auto condition = statement.child(0).child(0);
+                auto head = state;
+                for (std::size_t iteration = 0;; ++iteration)
+                {
+                    auto body = statements(body_statements(statement.child(1)), guard(condition, head, false));
+                    auto next = join(state, body);
+                    if (leq(next, head))
+                    {
+                        break;
+                    }
+                    head = iteration < WIDENING_DELAY ? std::move(next) : widen(head, next);
+                }
+                return guard(condition, std::move(head), true);
+            }
+            default:
+            {
+                return state;
+            }
+        }
+    }
+
+    PackTerm term(std::size_t symbol, bool negated) const
+    {
+        return {m_packs.position(symbol), negated};
+    }
+
+    const Value& pack_of(std::size_t symbol, const State& state) const
+    {
+        return *state.packs[m_packs.pack(symbol)];
+    }
+
+    // The value of the pack of a symbol, copied first if another state shares it
+    Value& writable(std::size_t symbol, State& state) const
+    {
+        auto& pack = state.packs[m_packs.pack(symbol)];
+        if (pack.use_count() > 1)
+        {
+            pack = std::make_shared<Value>(*pack);
+        }
+        return *pack;
+    }
+
+    Interval<Bound> range(std::size_t symbol, const State& state) const
+    {
+        return D::range(pack_of(symbol, state), m_packs.position(symbol));
+    }
+
+    void assign(std::size_t symbol, FlatAST::Node expression, State& state) const
+    {
+        if (state.bottom)
+        {
+            return;
+        }
+        auto affine = this->affine(expression, state);
+        auto& pack = writable(symbol, state);
+        if (affine.has_value() && affine->symbol.has_value() && m_packs.pack(*affine->symbol) == m_packs.pack(symbol))
+        {
+            D::assign(pack, m_packs.position(symbol), term(*affine->symbol, affine->negated), affine->constant);
+        }
+        else if (auto value = evaluate(expression, state); !value.is_empty())
+        {
+            D::assign_range(pack, m_packs.position(symbol), value.lb(), value.ub());
+        }
+        else
+        {
+            state.bottom = true;
+            return;
+        }
+        state.bottom = D::is_bottom(pack);
+    }
+
+    Interval<Bound> evaluate(FlatAST::Node expression, const State& state) const
+    {
+        switch (expression.type())
+        {
+            case NodeType::INTEGER:
+            {
+                auto value = static_cast<Bound>(expression.integer());
+                return Intervals::abstract(value, value);
+            }
+            case NodeType::VARIABLE:
+            {
+                return range(expression.symbol(), state);
+            }
+            case NodeType::ARITHM_OP:
+            {
+                auto op = arithmetic_op(expression);
+                if (!op.has_value() || expression.size() != 2)
+                {
+                    return Intervals::top();
+                }
+                return Intervals::arithmetic(*op, evaluate(expression.child(0), state), evaluate(expression.child(1), state));
+            }
+            default:
+            {
+                return Intervals::top();
+            }
+        }
+    }
+
+    /**
+     * @brief An integer, a variable, or a variable plus or minus an integer, or an integer minus a variable,
+     * that cannot saturate T for the values of its variable
+     *
+     */
+    std::optional<Affine> affine(FlatAST::Node expression, const State& state) const
+    {
+        if (expression.type() == NodeType::INTEGER)
+        {
+            return Affine{std::nullopt, false, static_cast<Bound>(expression.integer())};
+        }
+        if (expression.type() == NodeType::VARIABLE)
+        {
+            return Affine{expression.symbol(), false, 0};
+        }
+        auto op = expression.type() == NodeType::ARITHM_OP && expression.size() == 2 ? arithmetic_op(expression) : std::nullopt;
+        if (op != BinOp::ADD && op != BinOp::SUB)
+        {
+            return std::nullopt;
+        }
+        auto left = expression.child(0);
+        auto right = expression.child(1);
+        bool variable_on_left = left.type() == NodeType::VARIABLE && right.type() == NodeType::INTEGER;
+        if (!variable_on_left && !(left.type() == NodeType::INTEGER && right.type() == NodeType::VARIABLE))
+        {
+            return std::nullopt;
+        }
+        auto variable = variable_on_left ? left.symbol() : right.symbol();
+        auto constant = static_cast<Bound>((variable_on_left ? right : left).integer());
+        auto values = range(variable, state);
+        if (values.is_empty())
+        {
+            return std::nullopt;
+        }
+        bool overflow = false;
+        if (op == BinOp::ADD)
+        {
+            Arithmetic::add(values.lb(), constant, overflow);
+            Arithmetic::add(values.ub(), constant, overflow);
+            return overflow ? std::nullopt : std::optional<Affine>(Affine{variable, false, constant});
+        }
+        if (variable_on_left)
+        {
+            Arithmetic::sub(values.lb(), constant, overflow);
+            Arithmetic::sub(values.ub(), constant, overflow);
+            auto negated = Arithmetic::sub(0, constant, overflow);
+            return overflow ? std::nullopt : std::optional<Affine>(Affine{variable, false, negated});
+        }
+        Arithmetic::sub(constant, values.lb(), overflow);
+        Arithmetic::sub(constant, values.ub(), overflow);
+        return overflow ? std::nullopt : std::optional<Affine>(Affine{variable, true, constant});
+    }
+
+    /**
+     * @brief The difference `left - right` of the sides of a comparison, or its opposite, as a sum of terms
+     *
+     */
+    std::optional<Sum> difference(FlatAST::Node comparison, bool opposite, const State& state) const
+    {
+        auto left = affine(comparison.child(opposite ? 1 : 0), state);
+        auto right = affine(comparison.child(opposite ? 0 : 1), state);
+        if (!left.has_value() || !right.has_value())
+        {
+            return std::nullopt;
+        }
+        bool overflow = false;
+        Sum sum;
+        sum.constant = Arithmetic::sub(left->constant, right->constant, overflow);
+        if (left->symbol.has_value())
+        {
+            sum.x = std::pair{*left->symbol, left->negated};
+        }
+        if (right->symbol.has_value())
+        {
+            (sum.x.has_value() ? sum.y : sum.x) = std::pair{*right->symbol, !right->negated};
+        }
+        return overflow ? std::nullopt : std::optional<Sum>(sum);
+    }
+
+    // Lowest value of a term, or nothing if it is not bounded below
+    std::optional<Bound> lowest(std::pair<std::size_t, bool> term, const State& state) const
+    {
+        auto values = range(term.first, state);
+        auto bound = term.second ? values.ub() : values.lb();
+        if (bound == (term.second ? Intervals::max_T : Intervals::min_T))
+        {
+            return std::nullopt;
+        }
+        bool overflow = false;
+        auto value = term.second ? Arithmetic::sub(0, bound, overflow) : bound;
+        return overflow ? std::nullopt : std::optional<Bound>(value);
+    }
+
+    /**
+     * @brief Meets the state with `sum <= bound`
+     *
+     */
+    void constrain(const Sum& sum, Bound bound, State& state) const
+    {
+        bool overflow = false;
+        bound = Arithmetic::sub(bound, sum.constant, overflow);
+        if (overflow || state.bottom)
+        {
+            return;
+        }
+        if (!sum.x.has_value())
+        {
+            state.bottom = bound < 0;
+            return;
+        }
+        auto [x, x_negated] = *sum.x;
+        if (sum.y.has_value() && m_packs.pack(sum.y->first) != m_packs.pack(x))
+        {
+            // x + y <= bound bounds each of them by bound minus the lowest value of the other one
+            auto [y, y_negated] = *sum.y;
+            auto y_lowest = lowest(*sum.y, state);
+            auto x_lowest = lowest(*sum.x, state);
+            if (y_lowest.has_value())
+            {
+                bool overflows = false;
+                auto x_bound = Arithmetic::sub(bound, *y_lowest, overflows);
+                if (!overflows)
+                {
+                    D::constrain(writable(x, state), term(x, x_negated), std::nullopt, x_bound);
+                }
+            }
+            if (x_lowest.has_value())
+            {
+                bool overflows = false;
+                auto y_bound = Arithmetic::sub(bound, *x_lowest, overflows);
+                if (!overflows)
+                {
+                    D::constrain(writable(y, state), term(y, y_negated), std::nullopt, y_bound);
+                }
+            }
+            state.bottom = D::is_bottom(pack_of(x, state)) || D::is_bottom(pack_of(y, state));
+            return;
+        }
+        std::optional<PackTerm> y;
+        if (sum.y.has_value())
+        {
+            y = term(sum.y->first, sum.y->second);
+        }
+        D::constrain(writable(x, state), term(x, x_negated), y, bound);
+        state.bottom = D::is_bottom(pack_of(x, state));
+    }
+
+    /**
+     * @brief True if `sum <= bound` holds in the state
+     *
+     */
+    bool entails(const Sum& sum, Bound bound, const State& state) const
+    {
+        bool overflow = false;
+        bound = Arithmetic::sub(bound, sum.constant, overflow);
+        if (overflow)
+        {
+            return false;
+        }
+        if (!sum.x.has_value())
+        {
+            return 0 <= bound;
+        }
+        auto [x, x_negated] = *sum.x;
+        if (sum.y.has_value() && m_packs.pack(sum.y->first) != m_packs.pack(x))
+        {
+            // The highest value of a term is the opposite of the lowest one of its opposite
+            auto x_lowest = lowest({x, !x_negated}, state);
+            auto y_lowest = lowest({sum.y->first, !sum.y->second}, state);
+            if (!x_lowest.has_value() || !y_lowest.has_value())
+            {
+                return false;
+            }
+            bool overflows = false;
+            auto highest = Arithmetic::add(Arithmetic::sub(0, *x_lowest, overflows), Arithmetic::sub(0, *y_lowest, overflows), overflows);
+            return !overflows && highest <= bound;
+        }
+        std::optional<PackTerm> y;
+        if (sum.y.has_value())
+        {
+            y = term(sum.y->first, sum.y->second);
+        }
+        return D::entails(pack_of(x, state), term(x, x_negated), y, bound);
+    }
+
+    // Restricts the state to a condition `left op right`, or to its negation
+    State guard(FlatAST::Node condition, State state, bool negated) const
+    {
+        if (state.bottom || condition.kind() != FlatAST::ValueKind::LOGIC_OP)
+        {
+            return state;
+        }
+        auto op = negated ? complement(condition.logic_op()) : condition.logic_op();
+        auto below = difference(condition, false, state);   // left - right
+        auto above = difference(condition, true, state);    // right - left
+        if (below.has_value() && above.has_value())
+        {
+            switch (op)
+            {
+                case LogicOp::LE: constrain(*below, -1, state); break;
+                case LogicOp::LEQ: constrain(*below, 0, state); break;
+                case LogicOp::GE: constrain(*above, -1, state); break;
+                case LogicOp::GEQ: constrain(*above, 0, state); break;
+                case LogicOp::EQ: constrain(*below, 0, state); constrain(*above, 0, state); break;
+                case LogicOp::NEQ: state.bottom = !below->x.has_value() && below->constant == 0; break;
+            }
+            return state;
+        }
+        // As in the interval analysis, a variable on the left is restricted by the values on the right
+        auto left = condition.child(0);
+        if (left.type() == NodeType::VARIABLE)
+        {
+            auto values = Intervals::filter(op, range(left.symbol(), state), evaluate(condition.child(1), state));
+            if (values.is_empty())
+            {
+                state.bottom = true;
+                return state;
+            }
+            auto& pack = writable(left.symbol(), state);
+            D::constrain(pack, term(left.symbol(), false), std::nullopt, values.ub());
+            if (values.lb() != Intervals::min_T)
+            {
+                D::constrain(pack, term(left.symbol(), true), std::nullopt, -values.lb());
+            }
+            state.bottom = D::is_bottom(pack);
+        }
+        return state;
+    }
+
+    /**
+     * @brief Entry state of the program, from the preconditions that lead its sequence of statements, read
+     * as in DomainAnalysis
+     *
+     * @param sequence
+     * @return the state and the index of the first statement after the preconditions
+     */
+    std::pair<State, std::size_t> preconditions(FlatAST::Children sequence) const
+    {
+        constexpr auto min = std::numeric_limits<Bound>::min();
+        constexpr auto max = std::numeric_limits<Bound>::max();
+        std::vector<std::pair<Bound, Bound>> bounds(m_ast.symbols().size(), {min, max});
+        std::vector<bool> bounded(bounds.size(), false);
+        std::size_t statement = 0;
+        for (; statement < sequence.size() && sequence[statement].type() == NodeType::PRE_CON; ++statement)
+        {
+            for (auto precondition : sequence[statement].children())
+            {
+                auto left = precondition.child(0);
+                auto right = precondition.child(1);
+                bool variable_on_left = left.type() == NodeType::VARIABLE;
+                auto variable = variable_on_left ? left : right;
+                auto constant = variable_on_left ? right : left;
+                const auto& op = precondition.text();
+                if (variable.type() != NodeType::VARIABLE || constant.type() != NodeType::INTEGER
+                    || (op != "<=" && op != ">="))
+                {
+                    continue;
+                }
+                auto value = static_cast<Bound>(constant.integer());
+                auto& [lb, ub] = bounds[variable.symbol()];
+                ((op == "<=") == variable_on_left ? ub : lb) = value;
+                bounded[variable.symbol()] = true;
+            }
+        }
+        State state;
+        for (std::size_t pack = 0; pack < m_packs.count(); ++pack)
+        {
+            state.packs.push_back(std::make_shared<Value>(D::top(m_packs.size(pack))));
+        }
+        for (std::size_t symbol = 0; symbol < bounds.size() && !state.bottom; ++symbol)
+        {
+            if (bounded[symbol])
+            {
+                auto& pack = writable(symbol, state);
+                D::assign_range(pack, m_packs.position(symbol), bounds[symbol].first, bounds[symbol].second);
+                state.bottom = D::is_bottom(pack);
+            }
+        }
+        return {std::move(state), statement};
+    }
+
+    void check(FlatAST::Node postcondition, const State& state)
+    {
+        auto comparison = postcondition.child(0);
+        auto& check = m_checks[postcondition.index()];
+        if (comparison.kind() != FlatAST::ValueKind::LOGIC_OP)
+        {
+            check = 2;
+            return;
+        }
+        if (state.bottom)
+        {
+            return;
+        }
+        auto op = comparison.logic_op();
+        auto below = difference(comparison, false, state);
+        auto above = difference(comparison, true, state);
+        bool holds = false;
+        if (below.has_value() && above.has_value())
+        {
+            switch (op)
+            {
+                case LogicOp::LE: holds = entails(*below, -1, state); break;
+                case LogicOp::LEQ: holds = entails(*below, 0, state); break;
+                case LogicOp::GE: holds = entails(*above, -1, state); break;
+                case LogicOp::GEQ: holds = entails(*above, 0, state); break;
+                case LogicOp::EQ: holds = entails(*below, 0, state) && entails(*above, 0, state); break;
+                case LogicOp::NEQ: holds = entails(*below, -1, state) || entails(*above, -1, state); break;
+            }
+        }
+        holds = holds || Intervals::holds(op, evaluate(comparison.child(0), state), evaluate(comparison.child(1), state));
+        check = holds && check != 2 ? 1 : 2;
+    }
+
+    State join(const State& a, const State& b) const
+    {
+        if (a.bottom) return b;
+        if (b.bottom) return a;
+        State joined;
+        joined.packs.reserve(a.packs.size());
+        for (std::size_t pack = 0; pack < a.packs.size(); ++pack)
+        {
+            const auto& left = a.packs[pack];
+            const auto& right = b.packs[pack];
+            joined.packs.push_back(left == right ? left : std::make_shared<Value>(D::join(*left, *right)));
+        }
+        return joined;
+    }
+
+    State widen(const State& a, const State& b) const
+    {
+        if (a.bottom) return b;
+        if (b.bottom) return a;
+        State widened;
+        widened.packs.reserve(a.packs.size());
+        for (std::size_t pack = 0; pack < a.packs.size(); ++pack)
+        {
+            const auto& left = a.packs[pack];
+            const auto& right = b.packs[pack];
+            widened.packs.push_back(left == right ? left : std::make_shared<Value>(D::widen(*left, *right)));
+        }
+        return widened;
+    }
+
+    static bool leq(const State& a, const State& b)
+    {
+        if (a.bottom) return true;
+        if (b.bottom) return false;
+        for (std::size_t pack = 0; pack < a.packs.size(); ++pack)
+        {
+            if (a.packs[pack] != b.packs[pack] && !D::leq(*a.packs[pack], *b.packs[pack]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static LogicOp complement(LogicOp op)
+    {
+        switch (op)
+        {
+            case LogicOp::LE: return LogicOp::GEQ;
+            case LogicOp::LEQ: return LogicOp::GE;
+            case LogicOp::GE: return LogicOp::LEQ;
+            case LogicOp::GEQ: return LogicOp::LE;
+            case LogicOp::EQ: return LogicOp::NEQ;
+            case LogicOp::NEQ: return LogicOp::EQ;
+        }
+        return op;
+    }
+
+    /**
+     * @brief Operator of an arithmetic node, whether the parser wrote it as a BinOp or as text
+     *
+     */
+    static std::optional<BinOp> arithmetic_op(FlatAST::Node node)
+    {
+        if (node.kind() == FlatAST::ValueKind::BIN_OP)
+        {
+            return node.bin_op();
+        }
+        if (node.kind() == FlatAST::ValueKind::TEXT)
+        {
+            const auto& op = node.text();
+            if (op == "+") return BinOp::ADD;
+            if (op == "-") return BinOp::SUB;
+            if (op == "*") return BinOp::MUL;
+            if (op == "/") return BinOp::DIV;
+        }
+        return std::nullopt;
+    }
+};
+
+#endif // PACKED_DOMAIN_ANALYSIS_HPP
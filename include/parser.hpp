@@ -6,20 +6,55 @@
 
 #include "peglib.h"
 #include <assert.h>
+#include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <sstream>
+#include <limits>
+#include <vector>
 
 #include "ast.hpp"
+#include "ast_builder.hpp"
+#include "descent_parser.hpp"
+#include "flat_ast.hpp"
+#include "logger.hpp"
 
+/**
+ * @brief Parser used by AbstractInterpreterParser::parse_program
+ *
+ */
+enum class ParserKind {
+    DESCENT,        // the recursive-descent parser
+    PEG,            // the PEG parser, which is the reference
+    DIFFERENTIAL    // both, reporting the programs on which their trees differ, and keeping the PEG tree
+};
+
+/**
+ * @brief Parser of the C subset accepted by the interpreters. The grammar is compiled and the
+ * semantic actions are registered once, when the parser is constructed, and the same parser can
+ * then be used for any number of inputs. The actions add the nodes to an arena as they are reduced
+ * and pass their indices up, so no subtree is copied.
+ *
+ */
 class AbstractInterpreterParser{
     using SV = peg::SemanticValues;
-    
+    using Index = FlatAST::Index;
+    using Value = FlatAST::Value;
+
+    static inline ParserKind s_kind = ParserKind::DESCENT;
+    static inline std::atomic<std::size_t> s_disagreements{0};
+
+    peg::parser m_parser;
+    FlatAST m_ast;  // tree being parsed
+    FlatASTBuilder m_builder{m_ast};
+    std::vector<Index> m_items;
+
 public:
-    // ASTNode root;
 
-    ASTNode parse(const std::string& input){
-        peg::parser parser(R"(
+    AbstractInterpreterParser()
+    : m_parser(R"(
             Program     <- Statements*
-            Statements  <- DeclareVar / Assignment / Increment / IfElse / WhileLoop / Block / PreCon / PostCon / Comment
+            Statements  <- FunctionDef / DeclareVar / Assignment / Increment / IfElse / WhileLoop / Block / PreCon / PostCon / Comment
             Integer     <- < [+-]? [0-9]+ >
             Identifier  <- < [a-zA-Z_][a-zA-Z0-9_]* >
             SeqOp       <- '+' / '-'
@@ -28,7 +63,9 @@ public:
             DeclareVar  <- 'int' Identifier ('=' Integer / ',' Identifier)* ';'
             PreCon      <- '/*!npk' Identifier 'between' Integer 'and' Integer '*/'
             PostCon     <- 'assert' '(' Expression ')' ';'
-            Assignment  <- Identifier '=' Expression ';'
+            FunctionDef <- 'int' Identifier '(' ('int' Identifier (',' 'int' Identifier)*)? ')' '{' Statements* 'return' (Call / Expression) ';' '}'
+            Assignment  <- Identifier '=' (Call / Expression) ';'
+            Call        <- Identifier '(' (Expression (',' Expression)*)? ')'
             Increment   <- Identifier '++' ';'
             Block       <- ('void main' '(' ')')? '{' Statements* '}'
             IfElse      <- 'if' '(' Expression ')' (Block / Statements) ('else' (Block / Statements))?
@@ -40,258 +77,265 @@ public:
 
             ~Comment    <- '//' [^\n\r]* [ \n\r\t]*
             %whitespace <- [ \n\r\t]*
-        )");
-        assert(static_cast<bool>(parser) == true);
-
-        // // setup actions
-        parser["Program"] = [this](const SV& sv){return make_program(sv);};
-        parser["Integer"] = [](const SV& sv){return ASTNode(sv.token_to_number<int64_t>());};
-        parser["Identifier"] = [](const SV& sv){return ASTNode(sv.token_to_string());};
-        parser["SeqOp"] = [this](const SV& sv){return make_seq_op(sv);};
-        parser["PreOp"] = [this](const SV& sv){return make_pre_op(sv);};
-        parser["LogicOp"] = [this](const SV& sv){return make_logic_op(sv);};
-        parser["DeclareVar"] = [this](const SV& sv){return make_decl_var(sv);};
-        parser["PreCon"] = [this](const SV& sv){return make_pre_con(sv);};
-        parser["PostCon"] = [this](const SV& sv){return make_post_con(sv);};
-        parser["Assignment"] = [this](const SV& sv){return make_assign(sv);};
-        parser["Increment"] = [this](const SV& sv){return make_increment(sv);};
-        parser["Block"] = [this](const SV& sv){return make_block(sv);};
-        parser["IfElse"] = [this](const SV& sv){return make_ifelse(sv);};
-        parser["WhileLoop"] = [this](const SV& sv){return make_whileloop(sv);};
-        parser["Expression"] = [this](const SV& sv){return make_expr(sv);};
-        parser["Term"] = [this](const SV& sv){return make_term(sv);};
-        parser["Factor"] = [this](const SV& sv){return make_factor(sv);};
-        parser.set_logger([](size_t line, size_t col, const std::string& msg, const std::string &rule) {
-            std::cerr << line << ":" << col << ": " << msg << "\n";
+        )")
+    {
+        assert(static_cast<bool>(m_parser) == true);
+
+        // setup actions
+        m_parser["Program"] = [this](const SV& sv){return make_program(sv);};
+        m_parser["Integer"] = [this](const SV& sv){return m_builder.integer(sv.token_to_number<int64_t>());};
+        m_parser["Identifier"] = [this](const SV& sv){return m_builder.identifier(sv.token_to_string());};
+        m_parser["SeqOp"] = [this](const SV& sv){return m_builder.seq_op(sv.choice() == 1);};
+        m_parser["PreOp"] = [this](const SV& sv){return m_builder.pre_op(sv.choice() == 1);};
+        m_parser["LogicOp"] = [this](const SV& sv){return m_builder.logic_op(sv.choice());};
+        m_parser["DeclareVar"] = [this](const SV& sv){return make_decl_var(sv);};
+        m_parser["PreCon"] = [this](const SV& sv){return make_pre_con(sv);};
+        m_parser["PostCon"] = [this](const SV& sv){return make_post_con(sv);};
+        m_parser["FunctionDef"] = [this](const SV& sv){return make_function(sv);};
+        m_parser["Assignment"] = [this](const SV& sv){return make_assign(sv);};
+        m_parser["Call"] = [this](const SV& sv){return make_call(sv);};
+        m_parser["Increment"] = [this](const SV& sv){return make_increment(sv);};
+        m_parser["Block"] = [this](const SV& sv){return make_block(sv);};
+        m_parser["IfElse"] = [this](const SV& sv){return make_ifelse(sv);};
+        m_parser["WhileLoop"] = [this](const SV& sv){return make_whileloop(sv);};
+        m_parser["Expression"] = [this](const SV& sv){return make_expr(sv);};
+        m_parser["Term"] = [this](const SV& sv){return make_term(sv);};
+        m_parser["Factor"] = [this](const SV& sv){return make_factor(sv);};
+        m_parser.set_logger([](size_t line, size_t col, const std::string& msg, const std::string&) {
+            Logger::err() << line << ":" << col << ": " << msg << "\n";
         });
+    }
 
-        ASTNode root;
-        if (parser.parse(input.c_str(), root)){
-            // std::cout << "Parsing succeeded!" << std::endl;
-        }else{
-            std::cerr << "Parsing failed!" << std::endl;
-        }   
-        return root;
+    // The semantic actions refer to this object, which therefore cannot be copied or moved
+    AbstractInterpreterParser(const AbstractInterpreterParser&) = delete;
+    AbstractInterpreterParser& operator=(const AbstractInterpreterParser&) = delete;
+
+    /**
+     * @brief Returns the parser of the calling thread, which is constructed on first use. Every
+     * thread gets its own instance so that parses running concurrently share no state.
+     *
+     * @return AbstractInterpreterParser&
+     */
+    static AbstractInterpreterParser& instance(){
+        thread_local AbstractInterpreterParser parser;
+        return parser;
     }
 
-private:
-    ASTNode make_program(const SV& sv){
-        if (sv.size() == 1){
-            return std::any_cast<ASTNode>(sv[0]);
+    /**
+     * @brief Parses a program into an arena. On failure, the tree has a single node.
+     *
+     * @param input
+     * @return FlatAST
+     */
+    FlatAST parse_flat(std::string_view input){
+        m_ast = FlatAST();
+        Index root = 0;
+        if (m_parser.parse_n(input.data(), input.size(), root)){
+            m_ast.set_root(root);
+        }else{
+            Logger::err() << "Parsing failed!" << std::endl;
+            m_ast.set_root(m_ast.add(NodeType::INTEGER, Value::integer(0)));
         }
-        else{
-            ASTNode root;
-            for (size_t i = 0; i < sv.size(); ++i){
-                try{
-                    root.children.push_back(std::any_cast<ASTNode>(sv[i]));
-                }
-                catch(std::bad_any_cast){
-                    // for dealing with the comments in the program.
-                    // because I didn't cast the comments as ASTNode, it should be "string".
-                    // then here, I just skip it if there is any comment.
-                    continue;
+        return std::move(m_ast);
+    }
+
+    ASTNode parse(std::string_view input){
+        return parse_flat(input).root().to_tree();
+    }
+
+    /**
+     * @brief Selects the parser of parse_program, for the whole process
+     *
+     * @param kind
+     */
+    static void set_kind(ParserKind kind){
+        s_kind = kind;
+    }
+
+    static ParserKind kind(){
+        return s_kind;
+    }
+
+    /**
+     * @brief Parses the name of a parser (`descent`, `peg` or `differential`)
+     *
+     * @param name
+     * @param kind
+     * @return true if the name is valid
+     */
+    static bool parse_kind(const std::string& name, ParserKind& kind){
+        if (name == "descent") kind = ParserKind::DESCENT;
+        else if (name == "peg") kind = ParserKind::PEG;
+        else if (name == "differential") kind = ParserKind::DIFFERENTIAL;
+        else return false;
+        return true;
+    }
+
+    /**
+     * @brief Parses a program with the selected parser. On failure, the tree has a single node.
+     *
+     * @param input
+     * @return FlatAST
+     */
+    static FlatAST parse_program(std::string_view input){
+        switch (s_kind){
+            case ParserKind::DESCENT:{
+                thread_local DescentParser parser;
+                return parser.parse(input);
+            }
+            case ParserKind::PEG:{
+                return instance().parse_flat(input);
+            }
+            case ParserKind::DIFFERENTIAL:{
+                thread_local DescentParser parser;
+                auto reference = instance().parse_flat(input);
+                auto descent = parser.parse(input);
+                std::ostringstream difference;
+                if (!same_tree(reference.root(), descent.root(), difference)){
+                    s_disagreements++;
+                    Logger::err() << "[ERROR] the recursive-descent parser disagrees with the PEG parser: " << difference.str() << std::endl;
                 }
+                return reference;
             }
-            return root;
         }
+        return FlatAST();
     }
 
-    ASTNode make_decl_var(const SV& sv){
-        ASTNode decl_node(NodeType::DECLARATION, std::string("int"));
-        for (size_t i = 0; i < sv.size(); ++i){
-            decl_node.children.push_back(std::any_cast<ASTNode>(sv[i]));
+    /**
+     * @brief Number of programs on which the parsers disagreed, in differential mode
+     *
+     */
+    static std::size_t disagreements(){
+        return s_disagreements;
+    }
+
+private:
+    /**
+     * @brief Compares two subtrees, describing the path to the first difference
+     *
+     * @param reference the subtree of the PEG parser
+     * @param other
+     * @param difference
+     * @return true if they have the same types, values and children
+     */
+    static bool same_tree(FlatAST::Node reference, FlatAST::Node other, std::ostream& difference){
+        auto describe = [](FlatAST::Node node){
+            std::ostringstream out;
+            out << node.type() << " ";
+            switch (node.kind()){
+                case FlatAST::ValueKind::TEXT: out << "`" << node.text() << "`"; break;
+                case FlatAST::ValueKind::INTEGER: out << node.integer(); break;
+                case FlatAST::ValueKind::BIN_OP: out << node.bin_op(); break;
+                case FlatAST::ValueKind::LOGIC_OP: out << node.logic_op(); break;
+            }
+            out << " (" << node.size() << " children)";
+            return out.str();
+        };
+        bool same_value = reference.kind() == other.kind()
+            && (reference.kind() == FlatAST::ValueKind::TEXT ? reference.text() == other.text() : reference.integer() == other.integer());
+        if (reference.type() != other.type() || !same_value || reference.size() != other.size()){
+            difference << describe(other) << " instead of " << describe(reference);
+            return false;
+        }
+        for (std::size_t i = 0; i < reference.size(); ++i){
+            if (!same_tree(reference.child(i), other.child(i), difference)){
+                difference << ", in child " << i << " of " << describe(reference);
+                return false;
+            }
         }
-        return decl_node;
+        return true;
     }
 
-    ASTNode make_pre_con(const SV& sv){
-        ASTNode pre_con_node(NodeType::PRE_CON, std::string("PreCon"));
-        ASTNode var(std::any_cast<ASTNode>(sv[0]));
+    // The nodes of the values are already in m_ast; a comment has no value
+    static Index node(const std::any& value){
+        return std::any_cast<Index>(value);
+    }
 
-        // LB
-        ASTNode lb(NodeType::LOGIC_OP, std::string("<="));
-        lb.children.push_back(std::any_cast<ASTNode>(sv[1]));
-        lb.children.push_back(var);
+    // The values of a rule, with FlatASTBuilder::COMMENT for the comments
+    const std::vector<Index>& items(const SV& sv, size_t first = 0, size_t last = std::numeric_limits<size_t>::max()){
+        m_items.clear();
+        for (size_t i = first; i < std::min(last, sv.size()); ++i){
+            auto child = std::any_cast<Index>(&sv[i]);
+            m_items.push_back(child != nullptr ? *child : FlatASTBuilder::COMMENT);
+        }
+        return m_items;
+    }
 
-        // UB 
-        ASTNode ub(NodeType::LOGIC_OP, std::string(">="));
-        ub.children.push_back(std::any_cast<ASTNode>(sv[2]));
-        ub.children.push_back(var);
+    Index make_program(const SV& sv){
+        return m_builder.program(items(sv));
+    }
 
-        pre_con_node.children.push_back(lb);
-        pre_con_node.children.push_back(ub);
-        return pre_con_node;
+    Index make_decl_var(const SV& sv){
+        return m_builder.decl_var(items(sv));
     }
 
-    ASTNode make_post_con(const SV& sv){
-        ASTNode post_con_node(NodeType::POST_CON, std::string("PostCon"));
-        ASTNode expr(std::any_cast<ASTNode>(sv[0]));
-        post_con_node.children.push_back(expr);
-        return post_con_node;
+    // Records the line of the statement of a rule
+    Index at_line(const SV& sv, Index statement){
+        m_builder.at_line(statement, sv.line_info().first);
+        return statement;
     }
 
-    ASTNode make_seq_op(const SV& sv){
-        ASTNode op_node(NodeType::ARITHM_OP);
-        std::string op = sv.token_to_string();
-        if (op == "+") op_node.value = BinOp::ADD;
-        else if (op == "-") op_node.value = BinOp::SUB;
-        return op_node;
+    Index make_pre_con(const SV& sv){
+        return m_builder.pre_con(node(sv[0]), node(sv[1]), node(sv[2]));
     }
 
-    ASTNode make_pre_op(const SV& sv){
-        ASTNode op_node(NodeType::ARITHM_OP);
-        std::string op = sv.token_to_string();
-        if (op == "*") op_node.value = BinOp::MUL;
-        else if (op == "/") op_node.value = BinOp::DIV;
-        return op_node;
+    Index make_post_con(const SV& sv){
+        return at_line(sv, m_builder.post_con(node(sv[0])));
     }
 
-    ASTNode make_logic_op(const SV& sv){
-        ASTNode lop_node(NodeType::LOGIC_OP);
-        std::string lop = sv.token_to_string();
-        if (lop == "<") lop_node.value = LogicOp::LE;
-        else if (lop == ">") lop_node.value = LogicOp::GE;
-        else if (lop == "<=") lop_node.value = LogicOp::LEQ;
-        else if (lop == ">=") lop_node.value = LogicOp::GEQ;
-        else if (lop == "==") lop_node.value = LogicOp::EQ;
-        else if (lop == "!=") lop_node.value = LogicOp::NEQ;
-        return lop_node;
+    Index make_expr(const SV& sv){
+        return m_builder.expr(items(sv));
     }
 
-    ASTNode make_expr(const SV& sv){
-        if (sv.size() == 1){
-            return std::any_cast<ASTNode>(sv[0]);
-        }
-        else if (sv.size() == 3){
-            ASTNode op = std::any_cast<ASTNode>(sv[1]);
-            ASTNode expr(op.type, op.value);
-            expr.children.push_back(std::any_cast<ASTNode>(sv[0]));
-            expr.children.push_back(std::any_cast<ASTNode>(sv[2]));
-            return expr;
-        }
-        else{
-            ASTNode expr(NodeType::ARITHM_OP, std::any_cast<ASTNode>(sv[1]).value);
-            expr.children.push_back(std::any_cast<ASTNode>(sv[0]));
-            ASTNode op;
-            size_t i = 3;
-            for (i; i < sv.size(); i+=2){
-                op = std::any_cast<ASTNode>(sv[i]);
-                op.children.push_back(std::any_cast<ASTNode>(sv[i-1]));
-                if (i+2 < sv.size()) 
-                    expr.children.push_back(op);
-            }
-            op.children.push_back(std::any_cast<ASTNode>(sv[i-1]));
-            expr.children.push_back(op);
-            return expr;
-        }
+    Index make_term(const SV& sv){
+        return m_builder.term(items(sv));
     }
 
-    ASTNode make_term(const SV& sv){
-        if (sv.size() == 1){
-            return std::any_cast<ASTNode>(sv[0]);
-        }
-        else if (sv.size() == 3){
-            ASTNode term(NodeType::ARITHM_OP, std::any_cast<ASTNode>(sv[1]).value);
-            term.children.push_back(std::any_cast<ASTNode>(sv[0]));
-            term.children.push_back(std::any_cast<ASTNode>(sv[2]));
-            return term;
-        }
-        else{
-            ASTNode term(NodeType::ARITHM_OP, std::any_cast<ASTNode>(sv[1]).value);
-            term.children.push_back(std::any_cast<ASTNode>(sv[0]));
-            size_t i = 3;
-            for (i; i < sv.size(); i+=2){
-                ASTNode op(NodeType::ARITHM_OP, std::any_cast<ASTNode>(sv[i]).value);
-                term.children.push_back(op);
-                term.children.push_back(std::any_cast<ASTNode>(sv[i-1]));
+    Index make_factor(const SV& sv){
+        return sv.choice() == 0 ? m_builder.negation(node(sv[0])) : node(sv[0]);
+    }
+
+    Index make_function(const SV& sv){
+        // the name, the parameters, the statements of the body, and the returned expression; only the
+        // parameters are bare identifiers
+        size_t i = 1;
+        while (i + 1 < sv.size()){
+            auto child = std::any_cast<Index>(&sv[i]);
+            if (child == nullptr || m_ast.type(*child) != NodeType::VARIABLE){
+                break;
             }
-            term.children.push_back(std::any_cast<ASTNode>(sv[i-1]));
-            return term;
+            ++i;
         }
+        std::vector<Index> parameters = items(sv, 1, i);
+        return m_builder.function(node(sv[0]), parameters, items(sv, i, sv.size() - 1), node(sv[sv.size() - 1]));
     }
 
-    ASTNode make_factor(const SV& sv){
-        if (sv.choice() == 0){
-            // for the case: x = -y; 
-            // we're going to transform it into x = 0 - y;
-            ASTNode sign(NodeType::ARITHM_OP, std::string("-"));
-            sign.children.push_back(ASTNode(0));
-            sign.children.push_back(std::any_cast<ASTNode>(sv[0]));
-            return sign;
-        }
-        else{
-            return std::any_cast<ASTNode>(sv[0]);
-        }
+    Index make_call(const SV& sv){
+        return m_builder.call(node(sv[0]), items(sv, 1));
     }
 
-    ASTNode make_assign(const SV& sv){
-        ASTNode assign_node(NodeType::ASSIGNMENT, std::string("="));
-        ASTNode var = std::any_cast<ASTNode>(sv[0]);
-        ASTNode expr = std::any_cast<ASTNode>(sv[1]);
-        assign_node.children.push_back(var);
-        assign_node.children.push_back(expr);
-        return assign_node;
+    Index make_assign(const SV& sv){
+        return at_line(sv, m_builder.assign(node(sv[0]), node(sv[1])));
     }
-    
-    ASTNode make_increment(const SV& sv){
-        ASTNode increment_node(NodeType::ASSIGNMENT, std::string("="));
-        
-        ASTNode var = std::any_cast<ASTNode>(sv[0]);
-        ASTNode plus_op(NodeType::ARITHM_OP, std::string("+"));
-        plus_op.children.push_back(var);
-        plus_op.children.push_back(ASTNode(1));
-
-        increment_node.children.push_back(var);
-        increment_node.children.push_back(plus_op);
-
-        return increment_node;
+
+    Index make_increment(const SV& sv){
+        return at_line(sv, m_builder.increment(node(sv[0])));
     }
 
-    ASTNode make_block(const SV& sv){
-        if (sv.size() == 1){
-            return std::any_cast<ASTNode>(sv[0]);
-        }
-        else{
-            ASTNode seq(NodeType::SEQUENCE, std::string(";"));
-            for (size_t i = 0; i < sv.size(); ++i){
-                try{
-                    seq.children.push_back(std::any_cast<ASTNode>(sv[i]));
-                }
-                catch(std::bad_any_cast){
-                    // pre-condition in this version is comment, still is string;
-                    // so, we cannot cast it as ASTNode;
-                    continue;
-                }
-            }
-            return seq;
-        }
+    Index make_block(const SV& sv){
+        return m_builder.block(items(sv), sv.sv().starts_with("void main"));
     }
 
-    ASTNode make_ifelse(const SV& sv){
-        ASTNode ifelse_node(NodeType::IFELSE, std::string("IfElse"));
+    Index make_ifelse(const SV& sv){
+        Index parts[3];
         for (size_t i = 0; i < sv.size(); ++i){
-            ASTNode mid_node;
-            if (i == 0) mid_node = ASTNode(NodeType::IFELSE, std::string("Condition")); 
-            else if (i == 1) mid_node = ASTNode(NodeType::IFELSE, std::string("If-Body"));
-            else if (i == 2) mid_node = ASTNode(NodeType::IFELSE, std::string("Else-Body"));
-            ASTNode node = std::any_cast<ASTNode>(sv[i]);
-            mid_node.children.push_back(node);
-            ifelse_node.children.push_back(mid_node);
+            parts[i] = node(sv[i]);
         }
-        return ifelse_node;
+        return at_line(sv, m_builder.ifelse(FlatASTBuilder::Items(parts, sv.size())));
     }
 
-    ASTNode make_whileloop(const SV& sv){
-        ASTNode whileloop_node(NodeType::WHILELOOP, std::string("WhileLoop"));
-        for (size_t i = 0; i < sv.size(); ++i){
-            ASTNode mid_node;
-            if (i == 0) mid_node = ASTNode(NodeType::WHILELOOP, std::string("Condition"));
-            else if (i == 1) mid_node = ASTNode(NodeType::WHILELOOP, std::string("While-Body"));
-            ASTNode node = std::any_cast<ASTNode>(sv[i]);
-            mid_node.children.push_back(node);
-            whileloop_node.children.push_back(mid_node);
-        }
-        return whileloop_node;
+    Index make_whileloop(const SV& sv){
+        return at_line(sv, m_builder.whileloop(node(sv[0]), node(sv[1])));
     }
 };
 
@@ -0,0 +1,395 @@
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+
+/**
+ * @brief Phases of an analysis that are measured by the counters, those of `time_ms` in the metrics. The
+ * solve includes the stability checks.
+ *
+ */
+enum class AnalysisPhase : std::uint8_t {
+    PARSE,
+    BUILD,
+    SOLVE,
+    STABILITY,
+    POSTCONDITIONS
+};
+
+constexpr std::size_t ANALYSIS_PHASES = 5;
+
+inline const char* analysis_phase_name(AnalysisPhase phase)
+{
+    switch (phase)
+    {
+        case AnalysisPhase::PARSE: return "parse";
+        case AnalysisPhase::BUILD: return "build";
+        case AnalysisPhase::SOLVE: return "solve";
+        case AnalysisPhase::STABILITY: return "stability";
+        case AnalysisPhase::POSTCONDITIONS: return "postconditions";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief Where the counters of an analysis come from: the hardware counters of `perf_event_open`, or,
+ * where the kernel does not provide them, the CPU time and the faults of the thread alone
+ *
+ */
+enum class CounterSource : std::uint8_t {
+    NONE,       // not measured
+    CLOCK,
+    PERF
+};
+
+inline const char* counter_source_name(CounterSource source)
+{
+    switch (source)
+    {
+        case CounterSource::NONE: return "none";
+        case CounterSource::CLOCK: return "clock";
+        case CounterSource::PERF: return "perf";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief Hardware events counted by `perf_event_open`, in the order of PhaseCounters::events
+ *
+ */
+enum class HardwareEvent : std::uint8_t {
+    CYCLES,
+    INSTRUCTIONS,
+    L1D_MISSES,         // read misses of the level 1 data cache
+    LLC_MISSES,         // misses of the last level cache
+    BRANCH_MISSES
+};
+
+constexpr std::size_t HARDWARE_EVENTS = 5;
+
+inline const char* hardware_event_name(HardwareEvent event)
+{
+    switch (event)
+    {
+        case HardwareEvent::CYCLES: return "cycles";
+        case HardwareEvent::INSTRUCTIONS: return "instructions";
+        case HardwareEvent::L1D_MISSES: return "l1d_misses";
+        case HardwareEvent::LLC_MISSES: return "llc_misses";
+        case HardwareEvent::BRANCH_MISSES: return "branch_misses";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief Counts of the calling thread, summed over all the measurements of a phase
+ *
+ */
+struct PhaseCounters {
+    std::uint64_t measurements = 0;
+    std::uint64_t cpu_ns = 0;           // CPU time of the thread
+    std::uint64_t page_faults = 0;      // minor and major
+    std::uint64_t context_switches = 0; // voluntary and involuntary
+    std::array<std::uint64_t, HARDWARE_EVENTS> events{};     // scaled when the events were multiplexed
+};
+
+/**
+ * @brief Counters of an analysis, by phase. The hardware events that the kernel cannot count are left out
+ * of `available`, which is empty with the CLOCK source.
+ *
+ */
+struct AnalysisCounters {
+    CounterSource source = CounterSource::NONE;
+    std::uint8_t available = 0;     // bit per HardwareEvent
+    std::array<PhaseCounters, ANALYSIS_PHASES> phases{};
+
+    bool has(HardwareEvent event) const
+    {
+        return (available >> static_cast<int>(event)) & 1;
+    }
+
+    PhaseCounters& operator[](AnalysisPhase phase)
+    {
+        return phases[static_cast<std::size_t>(phase)];
+    }
+
+    const PhaseCounters& operator[](AnalysisPhase phase) const
+    {
+        return phases[static_cast<std::size_t>(phase)];
+    }
+
+    /**
+     * @brief Adds the counters of another analysis, or of another thread of the same one
+     *
+     * @param other
+     */
+    void add(const AnalysisCounters& other)
+    {
+        if (other.source == CounterSource::NONE)
+        {
+            return;
+        }
+        available = source == CounterSource::NONE ? other.available : available & other.available;
+        source = source == CounterSource::NONE ? other.source : std::min(source, other.source);
+        for (std::size_t phase = 0; phase < ANALYSIS_PHASES; ++phase)
+        {
+            auto& total = phases[phase];
+            const auto& counters = other.phases[phase];
+            total.measurements += counters.measurements;
+            total.cpu_ns += counters.cpu_ns;
+            total.page_faults += counters.page_faults;
+            total.context_switches += counters.context_switches;
+            for (std::size_t event = 0; event < HARDWARE_EVENTS; ++event)
+            {
+                total.events[event] += counters.events[event];
+            }
+        }
+    }
+};
+
+/**
+ * @brief Process-wide switch of the counters, and their reading on the calling thread. The hardware
+ * events are a group opened once per thread, on its first measurement, and read with a single system
+ * call at both ends of a phase; a process that may not open them (see `perf_event_paranoid`), or a kernel
+ * without them, as in most virtual machines, falls back to the CPU clock and the resource usage of the
+ * thread. Only the calling thread is counted, so the threads of `--solver=parallel` are not.
+ *
+ */
+class PerfCounters
+{
+public:
+    struct Reading {
+        std::uint64_t cpu_ns = 0;
+        std::uint64_t page_faults = 0;
+        std::uint64_t context_switches = 0;
+        std::uint64_t time_enabled = 0;
+        std::uint64_t time_running = 0;
+        std::array<std::uint64_t, HARDWARE_EVENTS> events{};
+    };
+
+private:
+    // The group of the hardware events of a thread
+    class EventGroup
+    {
+    private:
+        std::array<int, HARDWARE_EVENTS> m_fds;
+        std::array<std::size_t, HARDWARE_EVENTS> m_slots{};     // position of every event in the read buffer
+        std::uint8_t m_available = 0;
+        std::size_t m_count = 0;
+
+    public:
+        EventGroup()
+        {
+            m_fds.fill(-1);
+#if defined(__linux__)
+            for (std::size_t event = 0; event < HARDWARE_EVENTS; ++event)
+            {
+                perf_event_attr attributes;
+                std::memset(&attributes, 0, sizeof(attributes));
+                attributes.size = sizeof(attributes);
+                attributes.type = PERF_TYPE_HARDWARE;
+                attributes.config = config(static_cast<HardwareEvent>(event), attributes.type);
+                attributes.exclude_kernel = 1;
+                attributes.exclude_hv = 1;
+                attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+                int fd = static_cast<int>(::syscall(SYS_perf_event_open, &attributes, 0, -1, m_fds[0], 0));
+                if (fd < 0 && event == 0)
+                {
+                    return;     // without cycles, the leader of the group, nothing is counted
+                }
+                if (fd >= 0)
+                {
+                    m_fds[event] = fd;
+                    m_slots[event] = m_count++;
+                    m_available |= 1 << event;
+                }
+            }
+#endif
+        }
+
+        EventGroup(const EventGroup&) = delete;
+        EventGroup& operator=(const EventGroup&) = delete;
+
+        ~EventGroup()
+        {
+            for (auto fd : m_fds)
+            {
+                if (fd >= 0)
+                {
+                    ::close(fd);
+                }
+            }
+        }
+
+        std::uint8_t available() const
+        {
+            return m_available;
+        }
+
+        void read(Reading& reading) const
+        {
+            if (m_available == 0)
+            {
+                return;
+            }
+            // nr, time enabled, time running, then the values in the order the events were opened
+            std::array<std::uint64_t, 3 + HARDWARE_EVENTS> buffer{};
+            if (::read(m_fds[0], buffer.data(), sizeof(buffer)) < static_cast<ssize_t>((3 + m_count) * sizeof(std::uint64_t)))
+            {
+                return;
+            }
+            reading.time_enabled = buffer[1];
+            reading.time_running = buffer[2];
+            for (std::size_t event = 0; event < HARDWARE_EVENTS; ++event)
+            {
+                if ((m_available >> event) & 1)
+                {
+                    reading.events[event] = buffer[3 + m_slots[event]];
+                }
+            }
+        }
+
+    private:
+#if defined(__linux__)
+        static std::uint64_t config(HardwareEvent event, std::uint32_t& type)
+        {
+            switch (event)
+            {
+                case HardwareEvent::CYCLES: return PERF_COUNT_HW_CPU_CYCLES;
+                case HardwareEvent::INSTRUCTIONS: return PERF_COUNT_HW_INSTRUCTIONS;
+                case HardwareEvent::L1D_MISSES:
+                {
+                    type = PERF_TYPE_HW_CACHE;
+                    return PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+                }
+                case HardwareEvent::LLC_MISSES: return PERF_COUNT_HW_CACHE_MISSES;
+                case HardwareEvent::BRANCH_MISSES: return PERF_COUNT_HW_BRANCH_MISSES;
+            }
+            return PERF_COUNT_HW_CPU_CYCLES;
+        }
+#endif
+    };
+
+    static inline std::atomic<bool> s_enabled{false};
+
+    static const EventGroup& group()
+    {
+        thread_local EventGroup group;
+        return group;
+    }
+
+public:
+    static void set_enabled(bool enabled)
+    {
+        s_enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    static bool enabled()
+    {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Source of the counters of the calling thread, which opens its events if it has not yet
+     *
+     */
+    static CounterSource source()
+    {
+        return group().available() != 0 ? CounterSource::PERF : CounterSource::CLOCK;
+    }
+
+    static std::uint8_t available()
+    {
+        return group().available();
+    }
+
+    static Reading read()
+    {
+        Reading reading;
+        group().read(reading);
+        timespec cpu{};
+        ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu);
+        reading.cpu_ns = static_cast<std::uint64_t>(cpu.tv_sec) * 1000000000 + static_cast<std::uint64_t>(cpu.tv_nsec);
+        rusage usage{};
+#if defined(RUSAGE_THREAD)
+        ::getrusage(RUSAGE_THREAD, &usage);
+#else
+        ::getrusage(RUSAGE_SELF, &usage);
+#endif
+        reading.page_faults = static_cast<std::uint64_t>(usage.ru_minflt + usage.ru_majflt);
+        reading.context_switches = static_cast<std::uint64_t>(usage.ru_nvcsw + usage.ru_nivcsw);
+        return reading;
+    }
+
+    /**
+     * @brief Measures a phase on the calling thread, from its construction to stop or its destruction, and
+     * adds the counts to those of the phase. Does nothing while the counters are disabled.
+     *
+     */
+    class Measurement
+    {
+    private:
+        AnalysisCounters* m_counters = nullptr;
+        AnalysisPhase m_phase;
+        Reading m_start;
+
+    public:
+        Measurement(AnalysisCounters& counters, AnalysisPhase phase)
+        : m_phase(phase)
+        {
+            if (PerfCounters::enabled())
+            {
+                m_counters = &counters;
+                m_counters->source = PerfCounters::source();
+                m_counters->available = PerfCounters::available();
+                m_start = PerfCounters::read();
+            }
+        }
+
+        Measurement(const Measurement&) = delete;
+        Measurement& operator=(const Measurement&) = delete;
+
+        ~Measurement()
+        {
+            stop();
+        }
+
+        void stop()
+        {
+            if (m_counters == nullptr)
+            {
+                return;
+            }
+            auto end = PerfCounters::read();
+            auto& phase = (*m_counters)[m_phase];
+            phase.measurements++;
+            phase.cpu_ns += end.cpu_ns - m_start.cpu_ns;
+            phase.page_faults += end.page_faults - m_start.page_faults;
+            phase.context_switches += end.context_switches - m_start.context_switches;
+            // The kernel multiplexes the events when the group does not fit on the counters of the core
+            auto enabled = end.time_enabled - m_start.time_enabled;
+            auto running = end.time_running - m_start.time_running;
+            for (std::size_t event = 0; event < HARDWARE_EVENTS; ++event)
+            {
+                auto count = end.events[event] - m_start.events[event];
+                phase.events[event] += running > 0 && running < enabled ? static_cast<std::uint64_t>(static_cast<double>(count) * enabled / running)
+                                                                        : count;
+            }
+            m_counters = nullptr;
+        }
+    };
+};
+
+#endif // PERF_COUNTERS_HPP
@@ -0,0 +1,132 @@
+#ifndef PRECONDITION_SWEEP_HPP
+#define PRECONDITION_SWEEP_HPP
+
+#include <charconv>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "flat_ast.hpp"
+#include "interval.hpp"
+
+/**
+ * @brief Preconditions of one configuration of a sweep: an interval for some of the variables, which
+ * replaces the one of the preconditions of the program
+ *
+ * @tparam T
+ */
+template <typename T>
+using PreconditionSet = std::vector<std::pair<std::string, Interval<T>>>;
+
+/**
+ * @brief Reads a table of configurations, one per line, each a list of preconditions separated by `;`
+ * written as in the programs: `x between -5 and 5; y between 0 and 10`. Empty lines and lines starting
+ * with `#` are ignored.
+ *
+ * @tparam T
+ * @param path
+ * @param sets the configurations, in the order of the lines
+ * @param error the first error, with its line
+ * @return true if the whole table was read
+ */
+template <typename T>
+bool read_precondition_sweep(const std::string& path, std::vector<PreconditionSet<T>>& sets, std::string& error)
+{
+    std::ifstream f(path);
+    if (!f.is_open())
+    {
+        error = "cannot open the sweep table `" + path + "`";
+        return false;
+    }
+    auto bound = [](const std::string& token, T& value) {
+        auto first = token.data() + (token.size() > 1 && token[0] == '+' ? 1 : 0);
+        auto [end, ec] = std::from_chars(first, token.data() + token.size(), value);
+        return ec == std::errc() && end == token.data() + token.size();
+    };
+
+    std::string line;
+    for (std::size_t number = 1; std::getline(f, line); ++number)
+    {
+        if (line.empty() || line[0] == '#' || line.find_first_not_of(" \t\r") == std::string::npos)
+        {
+            continue;
+        }
+        PreconditionSet<T> set;
+        std::istringstream preconditions(line);
+        std::string precondition;
+        while (std::getline(preconditions, precondition, ';'))
+        {
+            std::istringstream words(precondition);
+            std::string variable, between, lb, conjunction, ub, rest;
+            if (!(words >> variable))
+            {
+                continue;
+            }
+            T lower, upper;
+            if (!(words >> between >> lb >> conjunction >> ub) || between != "between" || conjunction != "and"
+                || (words >> rest) || !bound(lb, lower) || !bound(ub, upper))
+            {
+                error = "line " + std::to_string(number) + ": expected `VARIABLE between LB and UB`";
+                return false;
+            }
+            set.push_back({variable, Interval<T>(lower, upper)});
+        }
+        sets.push_back(std::move(set));
+    }
+    if (sets.empty())
+    {
+        error = "the sweep table `" + path + "` has no configuration";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Checks that the configurations of a sweep only set variables of a program, which are the
+ * variables it declares or uses outside of its functions, before the program is analyzed
+ *
+ * @tparam T
+ * @param ast
+ * @param sets
+ * @param error the first variable that is not one of the program, with its configuration
+ * @return true if all the variables are
+ */
+template <typename T>
+bool check_precondition_sweep(const FlatAST& ast, const std::vector<PreconditionSet<T>>& sets, std::string& error)
+{
+    std::unordered_set<std::string> variables;
+    std::vector<FlatAST::Node> pending{ast.root()};
+    while (!pending.empty())
+    {
+        auto node = pending.back();
+        pending.pop_back();
+        if (node.type() == NodeType::VARIABLE)
+        {
+            variables.insert(node.text());
+        }
+        for (auto child : node.children())
+        {
+            if (child.type() != NodeType::FUNCTION)
+            {
+                pending.push_back(child);
+            }
+        }
+    }
+    for (std::size_t configuration = 0; configuration < sets.size(); ++configuration)
+    {
+        for (const auto& [name, interval] : sets[configuration])
+        {
+            if (!variables.contains(name))
+            {
+                error = "configuration " + std::to_string(configuration) + " of the sweep sets `" + name + "`, which is not a variable of the program";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+#endif // PRECONDITION_SWEEP_HPP
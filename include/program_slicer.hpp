@@ -0,0 +1,530 @@
+#ifndef PROGRAM_SLICER_HPP
+#define PROGRAM_SLICER_HPP
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "flat_ast.hpp"
+
+/**
+ * @brief Slices a program backwards from its postconditions: keeps only the statements that can change
+ * the values of the variables they assert, and the declarations and preconditions of the variables that
+ * those statements read.
+ *
+ * The slice goes through the statements in reverse order with the set of the variables that are live,
+ * that is, read by a kept statement or a postcondition before being assigned again. An assignment is
+ * kept when its variable is live, an if-else statement when one of its branches keeps a statement, and
+ * a while loop when its body keeps a statement or when its condition restricts a live variable; the
+ * variables of the condition of a kept statement become live. The body of a loop is sliced again until
+ * the variables live at its head are stable.
+ *
+ * An if-else statement without kept statements restricts its condition variable in both branches only to
+ * join them back, so removing it does not change the live variables. Removing a loop without kept
+ * statements may however lose the fact that it never terminates, and the widening thresholds of the
+ * removed loops are lost: the invariants of the slice can only be coarser than those of the whole
+ * program, and its verdicts are sound.
+ *
+ * The postconditions already discharged by another analysis (see DomainAnalysis) are kept, but their
+ * variables are not made live. A slice can also be taken with respect to a single postcondition, in which
+ * case the other ones are removed (see SliceAnalysis). A slicer computes a single slice.
+ *
+ */
+class ProgramSlicer
+{
+private:
+    using Index = FlatAST::Index;
+    // Set of symbols of m_source, a word of 64 of them at a time, so that the joins of the branches and
+    // of the passes over a loop body do not go through the symbols one by one
+    class Live
+    {
+    private:
+        std::vector<std::uint64_t> m_words;
+
+    public:
+        Live() = default;
+
+        explicit Live(std::size_t symbols)
+        : m_words((symbols + 63) / 64, 0)
+        {}
+
+        bool operator[](std::size_t symbol) const
+        {
+            return (m_words[symbol / 64] >> (symbol % 64)) & 1;
+        }
+
+        void insert(std::size_t symbol)
+        {
+            m_words[symbol / 64] |= std::uint64_t{1} << (symbol % 64);
+        }
+
+        void erase(std::size_t symbol)
+        {
+            m_words[symbol / 64] &= ~(std::uint64_t{1} << (symbol % 64));
+        }
+
+        Live& operator|=(const Live& other)
+        {
+            for (std::size_t word = 0; word < m_words.size(); ++word)
+            {
+                m_words[word] |= other.m_words[word];
+            }
+            return *this;
+        }
+
+        bool operator==(const Live& other) const = default;
+    };
+
+    static constexpr Index NONE = std::numeric_limits<Index>::max();
+
+    const FlatAST& m_source;
+    const std::vector<bool>* m_discharged;  // by node of m_source, or null
+    Index m_postcondition = NONE;   // the only postcondition kept, if any
+    std::vector<bool> m_encloses;   // by node of m_source: the statements that contain m_postcondition
+    bool m_reached = false;         // m_postcondition was sliced, so that the statements before it matter
+    FlatAST m_target;
+    std::vector<bool> m_kept;       // by node of m_source
+    Live m_declared;                // variables read or assigned by the slice
+    std::vector<Index> m_copies;    // index in m_target of every node of m_source already copied
+
+    std::size_t m_statements = 0;
+    std::size_t m_kept_statements = 0;
+
+public:
+    explicit ProgramSlicer(const FlatAST& source, const std::vector<bool>* discharged = nullptr)
+    : m_source(source)
+    , m_discharged(discharged)
+    , m_kept(source.size(), false)
+    , m_declared(source.symbols().size())
+    , m_copies(source.size(), NONE)
+    {}
+
+    /**
+     * @brief Computes the slice of the program
+     *
+     * @return std::optional<FlatAST> the slice, or nothing if the program has no postcondition, in which
+     * case all its statements are analyzed
+     */
+    std::optional<FlatAST> slice()
+    {
+        auto body = main_body();
+        if (!body.has_value())
+        {
+            return std::nullopt;
+        }
+
+        auto live = slice_statements(body->children(), Live(m_source.symbols().size()));
+        if (m_kept_statements == 0)
+        {
+            return std::nullopt;
+        }
+        m_declared |= live;
+
+        m_target.reserve(m_source.size());
+        auto sliced_body = copy_main_body(*body, live);
+        std::vector<Index> blocks;
+        for (auto block : m_source.root().children())
+        {
+            if (block.type() == NodeType::DECLARATION)
+            {
+                blocks.push_back(copy_declaration(block));
+            }
+            else if (block.index() == body->index())
+            {
+                blocks.push_back(sliced_body);
+            }
+            else
+            {
+                blocks.push_back(copy(block));
+            }
+        }
+        auto root = m_source.root();
+        m_target.set_root(m_target.add(root.type(), value(root), blocks));
+        return std::move(m_target);
+    }
+
+    /**
+     * @brief Computes the slice of the program with respect to one of its postconditions: the other ones are
+     * removed, together with the statements that only they depend on
+     *
+     * @param postcondition a node of postconditions()
+     * @return std::optional<FlatAST> the slice, which keeps at least the postcondition
+     */
+    std::optional<FlatAST> slice(Index postcondition)
+    {
+        m_postcondition = postcondition;
+        m_encloses.assign(m_source.size(), false);
+        if (auto body = main_body())
+        {
+            enclose(body->children());
+        }
+        return slice();
+    }
+
+    /**
+     * @brief Postconditions of main, nested ones included, in the order of the statements
+     *
+     * @return std::vector<Index> their nodes
+     */
+    std::vector<Index> postconditions() const
+    {
+        std::vector<Index> postconditions;
+        if (auto body = main_body())
+        {
+            collect_postconditions(body->children(), postconditions);
+        }
+        return postconditions;
+    }
+
+    /**
+     * @brief Number of top-level and nested statements of the program, and of those kept by the slice
+     *
+     */
+    std::size_t statements() const
+    {
+        return m_statements;
+    }
+
+    std::size_t kept_statements() const
+    {
+        return m_kept_statements;
+    }
+
+    /**
+     * @brief Index in the slice of a node of the program, if the slice copied it
+     *
+     */
+    std::optional<Index> copy_of(Index node) const
+    {
+        if (m_copies[node] == NONE)
+        {
+            return std::nullopt;
+        }
+        return m_copies[node];
+    }
+
+private:
+    // The sequence of statements of main, after the declarations and the functions, which are copied whole
+    std::optional<FlatAST::Node> main_body() const
+    {
+        if (m_source.size() == 0)
+        {
+            return std::nullopt;
+        }
+        for (auto block : m_source.root().children())
+        {
+            if (block.type() == NodeType::SEQUENCE)
+            {
+                return block;
+            }
+            if (block.type() != NodeType::DECLARATION && block.type() != NodeType::FUNCTION)
+            {
+                return std::nullopt;
+            }
+        }
+        return std::nullopt;
+    }
+
+    // The statements of the body of an if-else or while statement, given its If-Body, Else-Body or While-Body node
+    static FlatAST::Children body_statements(FlatAST::Node part)
+    {
+        auto block = part.child(0);
+        return block.type() == NodeType::SEQUENCE ? block.children() : part.children();
+    }
+
+    static void collect_postconditions(FlatAST::Children statements, std::vector<Index>& postconditions)
+    {
+        for (auto statement : statements)
+        {
+            if (statement.type() == NodeType::POST_CON)
+            {
+                postconditions.push_back(statement.index());
+            }
+            else if (statement.type() == NodeType::IFELSE || statement.type() == NodeType::WHILELOOP)
+            {
+                for (std::size_t part = 1; part < statement.size(); ++part)
+                {
+                    collect_postconditions(body_statements(statement.child(part)), postconditions);
+                }
+            }
+        }
+    }
+
+    // Marks the statements that contain m_postcondition, and tells if one of the sequence does
+    bool enclose(FlatAST::Children statements)
+    {
+        for (auto statement : statements)
+        {
+            bool encloses = statement.index() == m_postcondition;
+            if (statement.type() == NodeType::IFELSE || statement.type() == NodeType::WHILELOOP)
+            {
+                for (std::size_t part = 1; part < statement.size() && !encloses; ++part)
+                {
+                    encloses = enclose(body_statements(statement.child(part)));
+                }
+            }
+            if (encloses)
+            {
+                m_encloses[statement.index()] = true;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static std::size_t count(FlatAST::Node statement)
+    {
+        std::size_t statements = 1;
+        if (statement.type() == NodeType::IFELSE || statement.type() == NodeType::WHILELOOP)
+        {
+            for (std::size_t part = 1; part < statement.size(); ++part)
+            {
+                for (auto nested : body_statements(statement.child(part)))
+                {
+                    statements += count(nested);
+                }
+            }
+        }
+        return statements;
+    }
+
+    // Adds every variable of a subtree to the set
+    static void mark(FlatAST::Node node, Live& variables)
+    {
+        if (node.type() == NodeType::VARIABLE)
+        {
+            variables.insert(node.symbol());
+        }
+        for (auto child : node.children())
+        {
+            mark(child, variables);
+        }
+    }
+
+    void keep(FlatAST::Node statement)
+    {
+        if (!m_kept[statement.index()])
+        {
+            m_kept[statement.index()] = true;
+            m_kept_statements++;
+            bool compound = statement.type() == NodeType::IFELSE || statement.type() == NodeType::WHILELOOP;
+            mark(compound ? statement.child(0) : statement, m_declared);
+        }
+    }
+
+    // Tells if a statement of the body was kept, on this pass or a previous one of the enclosing loops
+    bool keeps_statement(FlatAST::Node statement) const
+    {
+        for (std::size_t part = 1; part < statement.size(); ++part)
+        {
+            for (auto nested : body_statements(statement.child(part)))
+            {
+                if (m_kept[nested.index()])
+                {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Slices a sequence of statements backwards
+     *
+     * @param statements
+     * @param live the variables live after the sequence
+     * @return Live the variables live before the sequence
+     */
+    Live slice_statements(FlatAST::Children statements, Live live)
+    {
+        for (std::size_t i = statements.size(); i-- > 0;)
+        {
+            // Nothing is live after the only postcondition kept, so the statements after it keep nothing
+            if (m_postcondition != NONE && !m_reached && !m_encloses[statements[i].index()])
+            {
+                continue;
+            }
+            live = slice_statement(statements[i], std::move(live));
+        }
+        return live;
+    }
+
+    Live slice_statement(FlatAST::Node statement, Live live)
+    {
+        switch (statement.type())
+        {
+            case NodeType::ASSIGNMENT:
+            {
+                auto variable = statement.child(0).symbol();
+                if (live[variable])
+                {
+                    keep(statement);
+                    live.erase(variable);
+                    mark(statement.child(1), live);
+                }
+                return live;
+            }
+            case NodeType::POST_CON:
+            {
+                if (m_postcondition != NONE && statement.index() != m_postcondition)
+                {
+                    return live;
+                }
+                m_reached = true;
+                keep(statement);
+                if (m_discharged == nullptr || !(*m_discharged)[statement.index()])
+                {
+                    mark(statement, live);
+                }
+                return live;
+            }
+            case NodeType::IFELSE:
+            {
+                auto condition = statement.child(0).child(0);
+                auto before = slice_statements(body_statements(statement.child(1)), live);
+                if (statement.size() == 3)
+                {
+                    before |= slice_statements(body_statements(statement.child(2)), live);
+                }
+                else
+                {
+                    before |= live;
+                }
+                if (keeps_statement(statement))
+                {
+                    keep(statement);
+                    mark(condition, before);
+                }
+                return before;
+            }
+            case NodeType::WHILELOOP:
+            {
+                auto condition = statement.child(0).child(0);
+                auto variable = condition.child(0).symbol();
+                auto head = live;
+                while (true)
+                {
+                    auto body = slice_statements(body_statements(statement.child(1)), head);
+                    auto next = live;
+                    next |= body;
+                    if (keeps_statement(statement) || live[variable] || body[variable])
+                    {
+                        keep(statement);
+                        mark(condition, next);
+                    }
+                    if (next == head)
+                    {
+                        return head;
+                    }
+                    head = std::move(next);
+                }
+            }
+            default:
+            {
+                // Preconditions are sliced with the declarations
+                return live;
+            }
+        }
+    }
+
+    Index copy_declaration(FlatAST::Node declaration)
+    {
+        std::vector<Index> children;
+        bool keep = false;
+        for (auto child : declaration.children())
+        {
+            // An initializer follows its variable
+            if (child.type() == NodeType::VARIABLE)
+            {
+                keep = m_declared[child.symbol()];
+            }
+            if (keep)
+            {
+                children.push_back(copy(child));
+            }
+        }
+        return m_target.add(declaration.type(), value(declaration), children);
+    }
+
+    Index copy_main_body(FlatAST::Node body, const Live& live)
+    {
+        std::vector<Index> children;
+        for (auto statement : body.children())
+        {
+            if (statement.type() == NodeType::PRE_CON)
+            {
+                // Both bounds share the variable, on the right of the comparison
+                if (live[statement.child(0).child(1).symbol()])
+                {
+                    children.push_back(copy(statement));
+                }
+                continue;
+            }
+            m_statements += count(statement);
+            if (m_kept[statement.index()])
+            {
+                children.push_back(copy_statement(statement));
+            }
+        }
+        return m_target.add(body.type(), value(body), children);
+    }
+
+    Index copy_statement(FlatAST::Node statement)
+    {
+        if (statement.type() != NodeType::IFELSE && statement.type() != NodeType::WHILELOOP)
+        {
+            return copy(statement);
+        }
+
+        std::vector<Index> parts{copy(statement.child(0))};
+        for (std::size_t part = 1; part < statement.size(); ++part)
+        {
+            auto node = statement.child(part);
+            std::vector<Index> statements;
+            for (auto nested : body_statements(node))
+            {
+                if (m_kept[nested.index()])
+                {
+                    statements.push_back(copy_statement(nested));
+                }
+            }
+            auto sequence = m_target.add(NodeType::SEQUENCE, m_target.text(";"), statements);
+            parts.push_back(m_target.add(node.type(), value(node), {sequence}));
+        }
+        auto index = m_target.add(statement.type(), value(statement), parts);
+        m_target.set_line(index, m_source.line(statement.index()));
+        return index;
+    }
+
+    Index copy(FlatAST::Node node)
+    {
+        if (m_copies[node.index()] != NONE)
+        {
+            return m_copies[node.index()];
+        }
+        std::vector<Index> children;
+        children.reserve(node.size());
+        for (auto child : node.children())
+        {
+            children.push_back(copy(child));
+        }
+        auto index = m_target.add(node.type(), value(node), children);
+        m_target.set_line(index, m_source.line(node.index()));
+        m_copies[node.index()] = index;
+        return index;
+    }
+
+    // Value of a node of m_source, with its text interned in m_target
+    FlatAST::Value value(FlatAST::Node node)
+    {
+        auto value = m_source.value(node.index());
+        if (value.kind == FlatAST::ValueKind::TEXT)
+        {
+            value = m_target.text(node.text());
+        }
+        return value;
+    }
+};
+
+#endif // PROGRAM_SLICER_HPP
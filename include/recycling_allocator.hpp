@@ -0,0 +1,119 @@
+#ifndef RECYCLING_ALLOCATOR_HPP
+#define RECYCLING_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <memory>
+
+/**
+ * @brief Allocator that keeps the blocks it releases in a free list of the calling thread, and hands them
+ * out again before asking the heap for more. It is meant for the objects that the fixpoint iteration
+ * allocates and releases at a high rate, which all have the same size: the pages of the stores, copied on
+ * write, the canonical stores of the StorePool and the nodes of its table. With std::allocate_shared, the
+ * control block of the shared pointer lives in the same block as the object. The arrays of up to
+ * MAX_ARRAY objects have a free list per length, for the page tables of the stores, which all have as
+ * many pages in an analysis.
+ *
+ * A block may be released by another thread than the one that allocated it, and then joins the free
+ * list of that thread. Every free list keeps at most MAX_CACHED blocks, the others go back to the heap.
+ *
+ * @tparam T
+ */
+template <typename T>
+class RecyclingAllocator
+{
+public:
+    using value_type = T;
+
+    static constexpr std::size_t MAX_CACHED = 4096;
+    static constexpr std::size_t MAX_ARRAY = 64;
+
+    RecyclingAllocator() = default;
+
+    template <typename U>
+    RecyclingAllocator(const RecyclingAllocator<U>&)
+    {}
+
+    T* allocate(std::size_t n)
+    {
+        auto* list = free_list(n);
+        if (list != nullptr && list->head != nullptr)
+        {
+            auto* block = list->head;
+            list->head = block->next;
+            list->count--;
+            return reinterpret_cast<T*>(block);
+        }
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* object, std::size_t n)
+    {
+        auto* list = free_list(n);
+        if (list != nullptr && list->count < MAX_CACHED)
+        {
+            auto* block = reinterpret_cast<Block*>(object);
+            block->next = list->head;
+            list->head = block;
+            list->count++;
+            return;
+        }
+        std::allocator<T>().deallocate(object, n);
+    }
+
+    template <typename U>
+    bool operator==(const RecyclingAllocator<U>&) const
+    {
+        return true;
+    }
+
+private:
+    struct Block {
+        Block* next;
+    };
+
+    static_assert(sizeof(T) >= sizeof(Block) && alignof(T) >= alignof(Block), "a released object holds a link of the free list");
+
+    struct FreeList {
+        Block* head = nullptr;
+        std::size_t count = 0;
+    };
+
+    // The free lists of the blocks of 1 to MAX_ARRAY objects
+    struct FreeLists {
+        FreeList lists[MAX_ARRAY];
+
+        ~FreeLists()
+        {
+            released() = true;
+            for (std::size_t n = 1; n <= MAX_ARRAY; ++n)
+            {
+                auto& list = lists[n - 1];
+                while (list.head != nullptr)
+                {
+                    auto* block = list.head;
+                    list.head = block->next;
+                    std::allocator<T>().deallocate(reinterpret_cast<T*>(block), n);
+                }
+            }
+        }
+    };
+
+    // Set once the free list of the thread is destroyed, objects released later go back to the heap
+    static bool& released()
+    {
+        static thread_local bool flag = false;
+        return flag;
+    }
+
+    static FreeList* free_list(std::size_t n)
+    {
+        if (n == 0 || n > MAX_ARRAY || released())
+        {
+            return nullptr;
+        }
+        static thread_local FreeLists lists;
+        return &lists.lists[n - 1];
+    }
+};
+
+#endif // RECYCLING_ALLOCATOR_HPP
@@ -0,0 +1,646 @@
+#ifndef RESULT_CACHE_HPP
+#define RESULT_CACHE_HPP
+
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "equational_interpreter.hpp"
+#include "logger.hpp"
+#include "mapped_file.hpp"
+
+/**
+ * @brief Version of the analysis, stored in the cache keys. It must be increased whenever a change of the
+ * analyzer can change the invariants or the verdicts it computes, so that older results are not reused.
+ *
+ */
+constexpr std::uint32_t ANALYZER_VERSION = 6;
+
+/**
+ * @brief Everything the result of an analysis depends on. The layout has no implicit padding, so that the
+ * key can be stored as is in the header of a cache file.
+ *
+ */
+struct ResultCacheKey {
+    std::uint64_t source_hash = 0;      // hash of the normalized source, see normalized_source_hash
+    std::uint32_t analyzer_version = ANALYZER_VERSION;
+    std::uint32_t value_size = 0;       // sizeof(T)
+    std::uint32_t value_signed = 0;
+    std::uint32_t solver_mode = 0;
+    std::uint64_t widening_delay = 0;
+    std::uint64_t narrowing_passes = 0;
+    std::uint32_t sparse = 0;
+    std::uint32_t slice = 0;
+    std::uint32_t prefilter = 0;
+    std::uint32_t reserved = 0;
+
+    bool operator==(const ResultCacheKey&) const = default;
+
+    /**
+     * @brief Hashes the source of a program once the line comments are removed and the blanks are dropped,
+     * so that reformatting a file does not invalidate its results. A run of blanks is kept (as one space)
+     * only between two characters that would otherwise form a single token, such as two identifiers or
+     * `<` and `=`. The preconditions are block comments and are kept.
+     *
+     * @param source
+     * @return std::uint64_t
+     */
+    static std::uint64_t normalized_source_hash(std::string_view source)
+    {
+        std::uint64_t h = 0xcbf29ce484222325ull;
+        auto mix = [&h](unsigned char c) {
+            h = (h ^ c) * 0x100000001b3ull;
+        };
+        auto is_word = [](unsigned char c) {
+            return std::isalnum(c) || c == '_';
+        };
+        bool pending_blank = false;
+        unsigned char previous = 0;
+        for (std::size_t i = 0; i < source.size(); ++i)
+        {
+            unsigned char c = source[i];
+            if (c == '/' && i + 1 < source.size() && source[i + 1] == '/')
+            {
+                while (i + 1 < source.size() && source[i + 1] != '\n')
+                {
+                    ++i;
+                }
+                pending_blank = true;
+            }
+            else if (std::isspace(c))
+            {
+                pending_blank = true;
+            }
+            else
+            {
+                if (pending_blank && previous != 0 && is_word(previous) == is_word(c))
+                {
+                    mix(' ');
+                }
+                mix(c);
+                pending_blank = false;
+                previous = c;
+            }
+        }
+        return h;
+    }
+
+    /**
+     * @brief Builds the key of the analysis of a program with the given settings
+     *
+     * @tparam T
+     * @param source
+     * @param solver_mode
+     * @param widening_delay
+     * @param narrowing_passes
+     * @param sparse
+     * @param slice
+     * @param prefilter
+     * @return ResultCacheKey
+     */
+    template <typename T>
+    static ResultCacheKey make(std::string_view source, SolverMode solver_mode, std::size_t widening_delay,
+                               std::size_t narrowing_passes, bool sparse = false, bool slice = false,
+                               bool prefilter = false)
+    {
+        ResultCacheKey key;
+        key.source_hash = normalized_source_hash(source);
+        key.value_size = sizeof(T);
+        key.value_signed = std::is_signed_v<T> ? 1 : 0;
+        // Parallel sweeps compute the result of the Jacobi sweeps, so they share its entries
+        key.solver_mode = static_cast<std::uint32_t>(solver_mode == SolverMode::PARALLEL ? SolverMode::JACOBI : solver_mode);
+        key.widening_delay = widening_delay;
+        key.narrowing_passes = narrowing_passes;
+        key.sparse = sparse ? 1 : 0;
+        key.slice = slice ? 1 : 0;
+        key.prefilter = prefilter ? 1 : 0;
+        return key;
+    }
+
+    /**
+     * @brief Name of the cache file of the key: a hash of all its fields in hexadecimal
+     *
+     * @return std::string
+     */
+    std::string file_name() const
+    {
+        std::uint64_t h = 0xcbf29ce484222325ull;
+        const auto* bytes = reinterpret_cast<const unsigned char*>(this);
+        for (std::size_t i = 0; i < sizeof(ResultCacheKey); ++i)
+        {
+            h = (h ^ bytes[i]) * 0x100000001b3ull;
+        }
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.aic", static_cast<unsigned long long>(h));
+        return name;
+    }
+};
+
+static_assert(sizeof(ResultCacheKey) == 56, "ResultCacheKey must not have padding");
+
+/**
+ * @brief Header of a cache file. The file is laid out so that it can be used in place once mapped in
+ * memory: every section starts at an offset that is a multiple of 8.
+ *
+ * - names: `variables + 1` offsets (uint64) of the names in the characters that follow them
+ * - stores: `stores` records of `store_stride` bytes, each made of the size of the store (uint64) and of
+ *   the bounds (lb, ub) of `variables` slots; an empty interval is stored as (max, min)
+ * - ports: for every location, STORE_PORTS indices (uint32) of its output stores, NO_STORE if it has none
+ * - types: the LocationType of every location (uint8)
+ * - verdicts: one (location, satisfied) pair of uint64 per postcondition, in program order
+ *
+ */
+struct ResultCacheHeader {
+    char magic[8];
+    std::uint32_t format;
+    std::uint32_t reserved;
+    ResultCacheKey key;
+    std::uint64_t locations;
+    std::uint64_t variables;
+    std::uint64_t stores;
+    std::uint64_t store_stride;
+    std::uint64_t verdicts;
+    std::uint64_t final_store;
+    std::uint64_t names_offset;
+    std::uint64_t stores_offset;
+    std::uint64_t ports_offset;
+    std::uint64_t types_offset;
+    std::uint64_t verdicts_offset;
+    std::uint64_t file_size;
+
+    static constexpr char MAGIC[8] = {'A', 'B', 'S', 'I', 'N', 'T', 'R', 'C'};
+    static constexpr std::uint32_t FORMAT = 3;
+    static constexpr std::uint32_t NO_STORE = 0xffffffffu;
+};
+
+/**
+ * @brief Result of an analysis read from a cache file, used in place in the mapping of the file
+ *
+ * @tparam T
+ */
+template <typename T>
+class CachedResult
+{
+private:
+    MappedFile m_file;
+    const ResultCacheHeader* m_header = nullptr;
+
+public:
+    /**
+     * @brief Intervals of one of the stores of the file
+     *
+     */
+    class Store
+    {
+    private:
+        const T* m_bounds = nullptr;
+        std::size_t m_size = 0;
+
+    public:
+        Store(const T* bounds, std::size_t size)
+        : m_bounds(bounds)
+        , m_size(size)
+        {}
+
+        std::size_t size() const
+        {
+            return m_size;
+        }
+
+        Interval<T> get(std::size_t id) const
+        {
+            T lb = m_bounds[2 * id], ub = m_bounds[2 * id + 1];
+            if (lb > ub)
+            {
+                return Interval<T>::empty();
+            }
+            return Interval<T>(lb, ub);
+        }
+    };
+
+    /**
+     * @brief Maps a cache file, and checks that it holds the result of the analysis identified by the key
+     *
+     * @param path
+     * @param key
+     * @return std::optional<CachedResult<T>> nothing if the file is missing, truncated, damaged or for
+     * another key
+     */
+    static std::optional<CachedResult<T>> open(const std::string& path, const ResultCacheKey& key)
+    {
+        CachedResult<T> result;
+        result.m_file = MappedFile(path);
+        if (!result.m_file.is_open() || result.m_file.size() < sizeof(ResultCacheHeader))
+        {
+            return std::nullopt;
+        }
+        const auto* header = reinterpret_cast<const ResultCacheHeader*>(result.m_file.data());
+        if (std::memcmp(header->magic, ResultCacheHeader::MAGIC, sizeof(header->magic)) != 0
+            || header->format != ResultCacheHeader::FORMAT || !(header->key == key)
+            || header->file_size != result.m_file.size())
+        {
+            return std::nullopt;
+        }
+        result.m_header = header;
+        if (!result.valid())
+        {
+            return std::nullopt;
+        }
+        return result;
+    }
+
+    std::size_t location_count() const
+    {
+        return m_header->locations;
+    }
+
+    std::size_t variable_count() const
+    {
+        return m_header->variables;
+    }
+
+    std::string_view name(std::size_t id) const
+    {
+        const auto* offsets = section<std::uint64_t>(m_header->names_offset);
+        const char* characters = reinterpret_cast<const char*>(offsets + m_header->variables + 1);
+        return std::string_view(characters + offsets[id], offsets[id + 1] - offsets[id]);
+    }
+
+    /**
+     * @brief Returns the invariant of an output of a location, or nothing if the location had no such output
+     *
+     * @param location
+     * @param port
+     * @return std::optional<Store>
+     */
+    std::optional<Store> invariant(std::size_t location, StorePort port) const
+    {
+        const auto* ports = section<std::uint32_t>(m_header->ports_offset);
+        auto index = ports[location * STORE_PORTS + static_cast<std::size_t>(port)];
+        if (index == ResultCacheHeader::NO_STORE)
+        {
+            return std::nullopt;
+        }
+        return store(index);
+    }
+
+    /**
+     * @brief Tells if the analysis ran on a slice of the program, whose final store is not the final invariant
+     *
+     */
+    bool sliced() const
+    {
+        return m_header->key.slice != 0 || m_header->key.prefilter != 0;
+    }
+
+    LocationType location_type(std::size_t location) const
+    {
+        return static_cast<LocationType>(section<std::uint8_t>(m_header->types_offset)[location]);
+    }
+
+    Store final_invariant() const
+    {
+        return store(m_header->final_store);
+    }
+
+    std::vector<PostconditionVerdict> verdicts() const
+    {
+        const auto* pairs = section<std::uint64_t>(m_header->verdicts_offset);
+        std::vector<PostconditionVerdict> verdicts;
+        for (std::size_t i = 0; i < m_header->verdicts; ++i)
+        {
+            verdicts.push_back({static_cast<std::size_t>(pairs[2 * i]), pairs[2 * i + 1] != 0});
+        }
+        return verdicts;
+    }
+
+    /**
+     * @brief Measurements of a cache hit: only the number of locations is known
+     *
+     * @return AnalysisStatistics
+     */
+    AnalysisStatistics statistics() const
+    {
+        AnalysisStatistics statistics;
+        statistics.locations = m_header->locations;
+        statistics.cached = true;
+        return statistics;
+    }
+
+    /**
+     * @brief Prints the verdicts and the final invariant as EquationalInterpreter::run does
+     *
+     */
+    void print() const
+    {
+        for (const auto& verdict : verdicts())
+        {
+            if (verdict.satisfied)
+            {
+                LOG_SUMMARY << "Postcondition satisfied" << std::endl;
+            }
+            else
+            {
+                WARN_SUMMARY << "Postcondition not satisfied" << std::endl;
+            }
+        }
+        // The final store of a slice is not the final invariant of the program
+        if (Logger::enabled(LogLevel::SUMMARY) && !sliced())
+        {
+            Logger::out() << "Final invariant:" << std::endl;
+            auto store = final_invariant();
+            for (std::size_t i = 0; i < store.size(); ++i)
+            {
+                auto interval = store.get(i);
+                if (interval.is_empty())
+                {
+                    Logger::out() << name(i) << ": Empty" << std::endl;
+                }
+                else
+                {
+                    Logger::out() << name(i) << ": [" << interval.lb() << ", " << interval.ub() << "]" << std::endl;
+                }
+            }
+        }
+        LOG_SUMMARY << "Result taken from the cache (" << m_header->locations << " locations)" << std::endl;
+    }
+
+private:
+    /**
+     * @brief Checks every section against the size of the file, and every index, size and offset read from
+     * the file against what it addresses, so that a damaged file in a shared directory is a miss
+     *
+     */
+    bool valid() const
+    {
+        const auto& header = *m_header;
+        std::uint64_t file_size = header.file_size;
+        // The section of count elements of the given size at the offset, aligned, lies in the file
+        auto fits = [file_size](std::uint64_t offset, std::uint64_t count, std::uint64_t size) {
+            return offset % 8 == 0 && offset >= sizeof(ResultCacheHeader) && offset <= file_size
+                && count <= (file_size - offset) / size;
+        };
+        if (!fits(header.names_offset, header.variables + 1, sizeof(std::uint64_t))
+            || header.store_stride % 8 != 0 || header.store_stride < sizeof(std::uint64_t)
+            || header.variables > (header.store_stride - sizeof(std::uint64_t)) / (2 * sizeof(T))
+            || !fits(header.stores_offset, header.stores, header.store_stride)
+            || header.locations > std::numeric_limits<std::uint64_t>::max() / STORE_PORTS
+            || !fits(header.ports_offset, header.locations * STORE_PORTS, sizeof(std::uint32_t))
+            || !fits(header.types_offset, header.locations, 1)
+            || !fits(header.verdicts_offset, header.verdicts, 2 * sizeof(std::uint64_t))
+            || header.final_store >= header.stores)
+        {
+            return false;
+        }
+
+        // The characters of the names follow their offsets, up to the stores
+        const auto* offsets = section<std::uint64_t>(header.names_offset);
+        std::uint64_t characters = header.names_offset + (header.variables + 1) * sizeof(std::uint64_t);
+        if (offsets[0] != 0 || header.stores_offset < characters)
+        {
+            return false;
+        }
+        for (std::size_t id = 0; id < header.variables; ++id)
+        {
+            if (offsets[id + 1] < offsets[id] || offsets[id + 1] > header.stores_offset - characters)
+            {
+                return false;
+            }
+        }
+        for (std::size_t index = 0; index < header.stores; ++index)
+        {
+            const char* record = m_file.data() + header.stores_offset + index * header.store_stride;
+            if (*reinterpret_cast<const std::uint64_t*>(record) > header.variables)
+            {
+                return false;
+            }
+        }
+        const auto* ports = section<std::uint32_t>(header.ports_offset);
+        for (std::size_t i = 0; i < header.locations * STORE_PORTS; ++i)
+        {
+            if (ports[i] != ResultCacheHeader::NO_STORE && ports[i] >= header.stores)
+            {
+                return false;
+            }
+        }
+        const auto* types = section<std::uint8_t>(header.types_offset);
+        for (std::size_t location = 0; location < header.locations; ++location)
+        {
+            if (types[location] >= LOCATION_TYPES)
+            {
+                return false;
+            }
+        }
+        const auto* pairs = section<std::uint64_t>(header.verdicts_offset);
+        for (std::size_t i = 0; i < header.verdicts; ++i)
+        {
+            if (pairs[2 * i] >= header.locations)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <typename U>
+    const U* section(std::uint64_t offset) const
+    {
+        return reinterpret_cast<const U*>(m_file.data() + offset);
+    }
+
+    Store store(std::size_t index) const
+    {
+        const char* record = m_file.data() + m_header->stores_offset + index * m_header->store_stride;
+        return Store(reinterpret_cast<const T*>(record + sizeof(std::uint64_t)),
+                     *reinterpret_cast<const std::uint64_t*>(record));
+    }
+};
+
+/**
+ * @brief Directory of analysis results addressed by their ResultCacheKey, one file per result. Files are
+ * written under a temporary name and renamed, so concurrent analyses of the same program never observe a
+ * partial file.
+ *
+ * @tparam T
+ */
+template <typename T>
+class ResultCache
+{
+private:
+    std::filesystem::path m_directory;
+
+public:
+    explicit ResultCache(std::filesystem::path directory)
+    : m_directory(std::move(directory))
+    {}
+
+    /**
+     * @brief Returns the result stored for the key, if any
+     *
+     * @param key
+     * @return std::optional<CachedResult<T>>
+     */
+    std::optional<CachedResult<T>> lookup(const ResultCacheKey& key) const
+    {
+        return CachedResult<T>::open((m_directory / key.file_name()).string(), key);
+    }
+
+    /**
+     * @brief Stores the result of a completed analysis. The results of the analyses that exceeded their
+     * budget are not stored, since the budgets are not part of the key.
+     *
+     * @param key
+     * @param interpreter
+     * @return false if the file could not be written
+     */
+    bool store(const ResultCacheKey& key, EquationalInterpreter<T>& interpreter) const
+    {
+        if (interpreter.statistics().budget_exceeded != BudgetExceeded::NONE)
+        {
+            return true;
+        }
+        std::vector<std::shared_ptr<IntervalStore<T>>> stores;
+        std::unordered_map<const IntervalStore<T>*, std::uint32_t> indices;
+        auto index_of = [&](const std::shared_ptr<IntervalStore<T>>& store) -> std::uint32_t {
+            if (store == nullptr)
+            {
+                return ResultCacheHeader::NO_STORE;
+            }
+            auto [it, inserted] = indices.try_emplace(store.get(), static_cast<std::uint32_t>(stores.size()));
+            if (inserted)
+            {
+                stores.push_back(store);
+            }
+            return it->second;
+        };
+
+        std::vector<std::uint32_t> ports(interpreter.location_count() * STORE_PORTS);
+        std::vector<std::uint8_t> types(interpreter.location_count());
+        for (std::size_t location = 0; location < interpreter.location_count(); ++location)
+        {
+            types[location] = static_cast<std::uint8_t>(interpreter.location_type(location));
+            for (std::size_t port = 0; port < STORE_PORTS; ++port)
+            {
+                ports[location * STORE_PORTS + port] = index_of(interpreter.invariant(location, static_cast<StorePort>(port)));
+            }
+        }
+        auto final_store = index_of(interpreter.final_store());
+
+        // The names come from the largest store, since the others address a prefix of the same table
+        const IntervalStore<T>* largest = stores[final_store].get();
+        for (const auto& store : stores)
+        {
+            if (store->size() > largest->size())
+            {
+                largest = store.get();
+            }
+        }
+        std::size_t variables = largest->size();
+
+        ResultCacheHeader header{};
+        std::memcpy(header.magic, ResultCacheHeader::MAGIC, sizeof(header.magic));
+        header.format = ResultCacheHeader::FORMAT;
+        header.key = key;
+        header.locations = interpreter.location_count();
+        header.variables = variables;
+        header.stores = stores.size();
+        header.store_stride = align(sizeof(std::uint64_t) + 2 * variables * sizeof(T));
+        header.verdicts = interpreter.verdicts().size();
+        header.final_store = final_store;
+
+        std::string names_section;
+        std::vector<std::uint64_t> offsets{0};
+        std::string characters;
+        for (std::size_t id = 0; id < variables; ++id)
+        {
+            characters += largest->name(id);
+            offsets.push_back(characters.size());
+        }
+        names_section.append(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(std::uint64_t));
+        names_section += characters;
+        names_section.resize(align(names_section.size()), '\0');
+
+        header.names_offset = sizeof(ResultCacheHeader);
+        header.stores_offset = header.names_offset + names_section.size();
+        header.ports_offset = header.stores_offset + header.stores * header.store_stride;
+        header.types_offset = header.ports_offset + align(ports.size() * sizeof(std::uint32_t));
+        header.verdicts_offset = header.types_offset + align(types.size());
+        header.file_size = header.verdicts_offset + 2 * header.verdicts * sizeof(std::uint64_t);
+
+        std::string contents(header.file_size, '\0');
+        std::memcpy(contents.data(), &header, sizeof(header));
+        std::memcpy(contents.data() + header.names_offset, names_section.data(), names_section.size());
+        for (std::size_t i = 0; i < stores.size(); ++i)
+        {
+            char* record = contents.data() + header.stores_offset + i * header.store_stride;
+            std::uint64_t size = stores[i]->size();
+            std::memcpy(record, &size, sizeof(size));
+            for (std::size_t id = 0; id < size; ++id)
+            {
+                auto interval = stores[i]->get(id);
+                T bounds[2] = {interval.is_empty() ? std::numeric_limits<T>::max() : interval.lb(),
+                               interval.is_empty() ? std::numeric_limits<T>::min() : interval.ub()};
+                std::memcpy(record + sizeof(size) + 2 * id * sizeof(T), bounds, sizeof(bounds));
+            }
+        }
+        if (!ports.empty())
+        {
+            std::memcpy(contents.data() + header.ports_offset, ports.data(), ports.size() * sizeof(std::uint32_t));
+            std::memcpy(contents.data() + header.types_offset, types.data(), types.size());
+        }
+        std::vector<std::uint64_t> pairs;
+        for (const auto& verdict : interpreter.verdicts())
+        {
+            pairs.push_back(verdict.location);
+            pairs.push_back(verdict.satisfied ? 1 : 0);
+        }
+        if (!pairs.empty())
+        {
+            std::memcpy(contents.data() + header.verdicts_offset, pairs.data(), pairs.size() * sizeof(std::uint64_t));
+        }
+
+        std::error_code error;
+        std::filesystem::create_directories(m_directory, error);
+        auto path = m_directory / key.file_name();
+        std::ostringstream suffix;
+        suffix << ".tmp." << ::getpid() << "." << std::this_thread::get_id();
+        auto temporary = path;
+        temporary += suffix.str();
+        {
+            std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+            if (!out.write(contents.data(), contents.size()))
+            {
+                std::filesystem::remove(temporary, error);
+                return false;
+            }
+        }
+        std::filesystem::rename(temporary, path, error);
+        if (error)
+        {
+            std::filesystem::remove(temporary, error);
+            return false;
+        }
+        return true;
+    }
+
+private:
+    static std::uint64_t align(std::uint64_t size)
+    {
+        return (size + 7) & ~std::uint64_t(7);
+    }
+};
+
+#endif // RESULT_CACHE_HPP
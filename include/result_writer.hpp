@@ -0,0 +1,820 @@
+#ifndef RESULT_WRITER_HPP
+#define RESULT_WRITER_HPP
+
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "analysis_report.hpp"
+#include "diagnostics.hpp"
+#include "equational_interpreter.hpp"
+#include "mapped_file.hpp"
+#include "result_cache.hpp"
+
+/**
+ * @brief Encodings of a stream of results
+ *
+ * - NDJSON: one JSON object per line, whose `record` field is `file`, `error`, `invariant`, `final`,
+ *   `verdict`, `diagnostic` or `metrics`, and whose `file` field is the path of the analyzed file;
+ * - BINARY: a ResultStreamHeader followed by the records described there.
+ */
+enum class ResultFormat {
+    NDJSON,
+    BINARY
+};
+
+inline bool parse_result_format(const std::string& name, ResultFormat& format)
+{
+    if (name == "ndjson")
+    {
+        format = ResultFormat::NDJSON;
+        return true;
+    }
+    if (name == "binary")
+    {
+        format = ResultFormat::BINARY;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Header of a binary stream of results. It is followed by the records of every file, each one
+ * starting with a ResultRecord tag, whose integers are stored in the byte order of the machine. A string is
+ * its size (u32) followed by its bytes, and a store is a number of variables (u32) followed, for every
+ * variable, by an empty flag (u8) and the bounds (two T).
+ * - FILE: path, number of locations (u32), number of variables (u32), then the name of every variable;
+ * - ERROR: path and message, instead of all the records of a file;
+ * - INVARIANT: location (u32), LocationType (u8), StorePort (u8), store;
+ * - FINAL: the store at the end of the program, absent when it was sliced;
+ * - VERDICT: location (u32), satisfied (u8, 2 if undecided);
+ * - DIAGNOSTIC: location (u32), DiagnosticKind (u8), number of evaluations that raised it (u64);
+ * - METRICS: the fields of AnalysisStatistics in their order of declaration, the counters as u64, the
+ *   flag and the budget as u8, and the times as f64;
+ * - END: closes the records of the last FILE.
+ *
+ */
+struct ResultStreamHeader {
+    static constexpr char MAGIC[8] = {'A', 'B', 'S', 'I', 'N', 'T', 'R', 'S'};
+    static constexpr std::uint32_t FORMAT = 2;
+
+    char magic[8];
+    std::uint32_t format;
+    std::uint32_t value_size;
+    std::uint32_t value_signed;
+    std::uint32_t reserved;
+};
+
+enum class ResultRecord : std::uint8_t {
+    FILE = 1,
+    ERROR = 2,
+    INVARIANT = 3,
+    FINAL = 4,
+    VERDICT = 5,
+    DIAGNOSTIC = 6,
+    METRICS = 7,
+    END = 8
+};
+
+/**
+ * @brief Encodes the results of analyses as records, into a buffer that the caller hands to a ResultSink.
+ * The workers of a batch encode their files concurrently, each one with an encoder of its own.
+ *
+ * @tparam T
+ */
+template <typename T>
+class ResultEncoder
+{
+private:
+    ResultFormat m_format;
+    std::string m_bytes;
+    std::string m_prefix;                   // NDJSON: the `file` field of the current file, and the comma
+    std::vector<std::string> m_names;       // NDJSON: the key of every variable, quoted
+
+public:
+    explicit ResultEncoder(ResultFormat format)
+    : m_format(format)
+    {}
+
+    ResultFormat format() const
+    {
+        return m_format;
+    }
+
+    const std::string& bytes() const
+    {
+        return m_bytes;
+    }
+
+    /**
+     * @brief Returns the records encoded so far, and starts a new buffer
+     *
+     */
+    std::string take()
+    {
+        std::string bytes = std::move(m_bytes);
+        m_bytes.clear();
+        return bytes;
+    }
+
+    /**
+     * @brief Starts the records of a file
+     *
+     * @param path
+     * @param locations
+     * @param variables
+     * @param name returns the name of a variable given its id
+     */
+    template <typename Name>
+    void begin(std::string_view path, std::size_t locations, std::size_t variables, Name&& name)
+    {
+        if (m_format == ResultFormat::BINARY)
+        {
+            put(ResultRecord::FILE);
+            put_string(path);
+            put(static_cast<std::uint32_t>(locations));
+            put(static_cast<std::uint32_t>(variables));
+            for (std::size_t id = 0; id < variables; ++id)
+            {
+                put_string(name(id));
+            }
+            return;
+        }
+        m_prefix = ",\"file\":";
+        append_json_string(m_prefix, path);
+        m_names.clear();
+        m_bytes += "{\"record\":\"file\"";
+        m_bytes += m_prefix;
+        m_bytes += ",\"locations\":";
+        append_number(locations);
+        m_bytes += ",\"variables\":[";
+        for (std::size_t id = 0; id < variables; ++id)
+        {
+            m_names.emplace_back();
+            append_json_string(m_names.back(), name(id));
+            m_bytes += id == 0 ? "" : ",";
+            m_bytes += m_names.back();
+        }
+        m_bytes += "]}\n";
+    }
+
+    /**
+     * @brief Records a file that could not be analyzed, instead of all its other records
+     *
+     */
+    void error(std::string_view path, std::string_view message)
+    {
+        if (m_format == ResultFormat::BINARY)
+        {
+            put(ResultRecord::ERROR);
+            put_string(path);
+            put_string(message);
+            return;
+        }
+        m_bytes += "{\"record\":\"error\",\"file\":";
+        append_json_string(m_bytes, path);
+        m_bytes += ",\"message\":";
+        append_json_string(m_bytes, message);
+        m_bytes += "}\n";
+    }
+
+    /**
+     * @brief Records the invariant of an output of a location
+     *
+     * @tparam Store anything with size() and get(id), such as IntervalStore or CachedResult::Store
+     */
+    template <typename Store>
+    void invariant(std::size_t location, LocationType type, StorePort port, const Store& store)
+    {
+        if (m_format == ResultFormat::BINARY)
+        {
+            put(ResultRecord::INVARIANT);
+            put(static_cast<std::uint32_t>(location));
+            put(static_cast<std::uint8_t>(type));
+            put(static_cast<std::uint8_t>(port));
+            put_store(store);
+            return;
+        }
+        m_bytes += "{\"record\":\"invariant\"";
+        m_bytes += m_prefix;
+        m_bytes += ",\"location\":";
+        append_number(location);
+        m_bytes += ",\"type\":\"";
+        m_bytes += location_type_name(type);
+        m_bytes += "\",\"port\":\"";
+        m_bytes += store_port_name(port);
+        m_bytes += "\",\"store\":";
+        append_store(store);
+        m_bytes += "}\n";
+    }
+
+    template <typename Store>
+    void final_invariant(const Store& store)
+    {
+        if (m_format == ResultFormat::BINARY)
+        {
+            put(ResultRecord::FINAL);
+            put_store(store);
+            return;
+        }
+        m_bytes += "{\"record\":\"final\"";
+        m_bytes += m_prefix;
+        m_bytes += ",\"store\":";
+        append_store(store);
+        m_bytes += "}\n";
+    }
+
+    void verdict(std::size_t location, bool satisfied, bool decided = true)
+    {
+        if (m_format == ResultFormat::BINARY)
+        {
+            put(ResultRecord::VERDICT);
+            put(static_cast<std::uint32_t>(location));
+            put(static_cast<std::uint8_t>(!decided ? 2 : satisfied ? 1 : 0));
+            return;
+        }
+        m_bytes += "{\"record\":\"verdict\"";
+        m_bytes += m_prefix;
+        m_bytes += ",\"location\":";
+        append_number(location);
+        m_bytes += satisfied ? ",\"satisfied\":true" : ",\"satisfied\":false";
+        m_bytes += decided ? "}\n" : ",\"decided\":false}\n";
+    }
+
+    void diagnostic(std::size_t location, DiagnosticKind kind, std::uint64_t count)
+    {
+        if (m_format == ResultFormat::BINARY)
+        {
+            put(ResultRecord::DIAGNOSTIC);
+            put(static_cast<std::uint32_t>(location));
+            put(static_cast<std::uint8_t>(kind));
+            put(count);
+            return;
+        }
+        m_bytes += "{\"record\":\"diagnostic\"";
+        m_bytes += m_prefix;
+        m_bytes += ",\"location\":";
+        append_number(location);
+        m_bytes += ",\"kind\":\"";
+        m_bytes += diagnostic_name(kind);
+        m_bytes += "\",\"count\":";
+        append_number(count);
+        m_bytes += "}\n";
+    }
+
+    /**
+     * @brief Records the metrics of the analysis, with the same fields as write_json_metrics
+     *
+     */
+    void metrics(const AnalysisStatistics& statistics)
+    {
+        if (m_format == ResultFormat::BINARY)
+        {
+            put(ResultRecord::METRICS);
+            for (auto counter : {statistics.locations, statistics.iterations, statistics.ascending_iterations,
+                                 statistics.narrowing_iterations, statistics.location_evaluations, statistics.reused_locations,
+                                 statistics.simplifications, statistics.sliced_statements, statistics.accelerated_loops,
+                                 statistics.discharged_postconditions, statistics.function_summaries, statistics.summary_reuses,
+                                 statistics.shared_subterms, statistics.subterm_reuses, statistics.diagnostics})
+            {
+                put(static_cast<std::uint64_t>(counter));
+            }
+            put(static_cast<std::uint8_t>(statistics.cached ? 1 : 0));
+            put(static_cast<std::uint8_t>(statistics.budget_exceeded));
+            for (auto evaluations : statistics.evaluations_by_type)
+            {
+                put(static_cast<std::uint64_t>(evaluations));
+            }
+            for (auto counter : {statistics.widenings, statistics.narrowings, statistics.stores_allocated,
+                                 statistics.page_allocations, statistics.page_copies, statistics.bytes_copied})
+            {
+                put(static_cast<std::uint64_t>(counter));
+            }
+            for (auto time : {statistics.parse_ms, statistics.build_ms, statistics.solve_ms, statistics.stability_ms,
+                              statistics.postconditions_ms})
+            {
+                put(time);
+            }
+            return;
+        }
+        // Once per file, so the stream of write_json_metrics is cheap enough
+        std::ostringstream out;
+        write_json_metrics(out, statistics);
+        m_bytes += "{\"record\":\"metrics\"";
+        m_bytes += m_prefix;
+        m_bytes += ",\"metrics\":";
+        m_bytes += out.str();
+        m_bytes += "}\n";
+    }
+
+    void end()
+    {
+        if (m_format == ResultFormat::BINARY)
+        {
+            put(ResultRecord::END);
+        }
+    }
+
+private:
+    template <typename V>
+    void put(const V& value)
+    {
+        static_assert(std::is_trivially_copyable_v<V>);
+        m_bytes.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void put_string(std::string_view value)
+    {
+        put(static_cast<std::uint32_t>(value.size()));
+        m_bytes += value;
+    }
+
+    template <typename Store>
+    void put_store(const Store& store)
+    {
+        put(static_cast<std::uint32_t>(store.size()));
+        for (std::size_t id = 0; id < store.size(); ++id)
+        {
+            auto interval = store.get(id);
+            put(static_cast<std::uint8_t>(interval.is_empty() ? 1 : 0));
+            put(interval.lb());
+            put(interval.ub());
+        }
+    }
+
+    template <typename V>
+    void append_number(V value)
+    {
+        char digits[24];
+        auto [end, error] = std::to_chars(digits, digits + sizeof(digits), value);
+        m_bytes.append(digits, end);
+    }
+
+    // An object from the names of the variables to their bounds, null when they are empty
+    template <typename Store>
+    void append_store(const Store& store)
+    {
+        m_bytes += '{';
+        for (std::size_t id = 0; id < store.size(); ++id)
+        {
+            m_bytes += id == 0 ? "" : ",";
+            m_bytes += id < m_names.size() ? m_names[id] : "\"?\"";
+            m_bytes += ':';
+            auto interval = store.get(id);
+            if (interval.is_empty())
+            {
+                m_bytes += "null";
+                continue;
+            }
+            m_bytes += '[';
+            append_number(interval.lb());
+            m_bytes += ',';
+            append_number(interval.ub());
+            m_bytes += ']';
+        }
+        m_bytes += '}';
+    }
+};
+
+/**
+ * @brief Encodes the records of a completed analysis: the invariants of every output of every location,
+ * the final invariant unless the program was sliced or analyzed in the anytime mode, the verdicts, the
+ * diagnostics and the metrics
+ *
+ * @tparam T
+ * @param encoder
+ * @param path
+ * @param interpreter
+ * @param statistics the metrics of the analysis, which may add the time of the parse to those of the interpreter
+ */
+template <typename T>
+void encode_results(ResultEncoder<T>& encoder, std::string_view path, EquationalInterpreter<T>& interpreter,
+                    const AnalysisStatistics& statistics)
+{
+    const auto& variables = interpreter.variables();
+    encoder.begin(path, interpreter.location_count(), variables.size(), [&variables](std::size_t id) -> std::string_view {
+        return variables.name(id);
+    });
+    for (std::size_t location = 0; location < interpreter.location_count(); ++location)
+    {
+        for (std::size_t port = 0; port < STORE_PORTS; ++port)
+        {
+            if (auto store = interpreter.invariant(location, static_cast<StorePort>(port)))
+            {
+                encoder.invariant(location, interpreter.location_type(location), static_cast<StorePort>(port), *store);
+            }
+        }
+    }
+    if (interpreter.final_store_complete())
+    {
+        encoder.final_invariant(*interpreter.final_store());
+    }
+    for (const auto& verdict : interpreter.verdicts())
+    {
+        encoder.verdict(verdict.location, verdict.satisfied, verdict.decided);
+    }
+    for (const auto& diagnostic : interpreter.diagnostics())
+    {
+        encoder.diagnostic(diagnostic.location, diagnostic.kind, diagnostic.count);
+    }
+    encoder.metrics(statistics);
+    encoder.end();
+}
+
+/**
+ * @brief Encodes the records of a result read from the cache, which holds no diagnostics
+ *
+ */
+template <typename T>
+void encode_results(ResultEncoder<T>& encoder, std::string_view path, const CachedResult<T>& result)
+{
+    encoder.begin(path, result.location_count(), result.variable_count(), [&result](std::size_t id) {
+        return result.name(id);
+    });
+    for (std::size_t location = 0; location < result.location_count(); ++location)
+    {
+        for (std::size_t port = 0; port < STORE_PORTS; ++port)
+        {
+            if (auto store = result.invariant(location, static_cast<StorePort>(port)))
+            {
+                encoder.invariant(location, result.location_type(location), static_cast<StorePort>(port), *store);
+            }
+        }
+    }
+    if (!result.sliced())
+    {
+        encoder.final_invariant(result.final_invariant());
+    }
+    for (const auto& verdict : result.verdicts())
+    {
+        encoder.verdict(verdict.location, verdict.satisfied);
+    }
+    encoder.metrics(result.statistics());
+    encoder.end();
+}
+
+/**
+ * @brief Buffered output of a stream of results, to a file or to the standard output ("-"). The records
+ * are written in large blocks, and the header of a binary stream first.
+ *
+ * @tparam T
+ */
+template <typename T>
+class ResultSink
+{
+private:
+    static constexpr std::size_t BUFFER_SIZE = 1 << 20;
+
+    std::ofstream m_file;
+    std::ostream* m_out = &std::cout;
+    std::string m_buffer;
+    bool m_failed = false;
+
+public:
+    /**
+     * @brief Creates the output, see good
+     *
+     * @param path
+     * @param format
+     */
+    ResultSink(const std::string& path, ResultFormat format)
+    {
+        if (path != "-")
+        {
+            m_file.open(path, std::ios::binary | std::ios::trunc);
+            m_out = &m_file;
+            m_failed = !m_file.is_open();
+        }
+        m_buffer.reserve(BUFFER_SIZE);
+        if (format == ResultFormat::BINARY)
+        {
+            ResultStreamHeader header{};
+            std::memcpy(header.magic, ResultStreamHeader::MAGIC, sizeof(header.magic));
+            header.format = ResultStreamHeader::FORMAT;
+            header.value_size = sizeof(T);
+            header.value_signed = std::is_signed_v<T> ? 1 : 0;
+            m_buffer.append(reinterpret_cast<const char*>(&header), sizeof(header));
+        }
+    }
+
+    ResultSink(const ResultSink&) = delete;
+    ResultSink& operator=(const ResultSink&) = delete;
+
+    ~ResultSink()
+    {
+        flush();
+    }
+
+    /**
+     * @brief Tells if the results could be written so far
+     *
+     */
+    bool good() const
+    {
+        return !m_failed;
+    }
+
+    void write(std::string_view records)
+    {
+        m_buffer += records;
+        if (m_buffer.size() >= BUFFER_SIZE)
+        {
+            flush();
+        }
+    }
+
+    void flush()
+    {
+        if (!m_buffer.empty() && !m_failed)
+        {
+            m_failed = !m_out->write(m_buffer.data(), m_buffer.size()) || !m_out->flush();
+        }
+        m_buffer.clear();
+    }
+};
+
+/**
+ * @brief Prints a binary stream of results as NDJSON, with the records the NDJSON format would have
+ * written
+ *
+ * @tparam T the type of the bounds the stream was written with
+ */
+template <typename T>
+class ResultStreamPrinter
+{
+private:
+    // The bounds of a store of the stream, in the interface of IntervalStore
+    struct Store {
+        std::vector<Interval<T>> intervals;
+
+        std::size_t size() const
+        {
+            return intervals.size();
+        }
+
+        const Interval<T>& get(std::size_t id) const
+        {
+            return intervals[id];
+        }
+    };
+
+    MappedFile m_file;
+    const char* m_position = nullptr;
+    const char* m_end = nullptr;
+
+public:
+    explicit ResultStreamPrinter(const std::string& path)
+    : m_file(path)
+    {}
+
+    /**
+     * @brief Prints the whole stream
+     *
+     * @param out
+     * @return false if the file is not a stream written with T, or is truncated
+     */
+    bool print(std::ostream& out)
+    {
+        ResultStreamHeader header;
+        m_position = m_file.data();
+        m_end = m_file.data() + m_file.size();
+        if (!m_file.is_open() || !get(header) || std::memcmp(header.magic, ResultStreamHeader::MAGIC, sizeof(header.magic)) != 0
+            || header.format != ResultStreamHeader::FORMAT || header.value_size != sizeof(T)
+            || header.value_signed != (std::is_signed_v<T> ? 1u : 0u))
+        {
+            return false;
+        }
+
+        ResultEncoder<T> encoder(ResultFormat::NDJSON);
+        bool in_file = false;
+        while (m_position < m_end)
+        {
+            ResultRecord tag;
+            if (!get(tag) || !decode(tag, encoder, in_file))
+            {
+                return false;
+            }
+            if (encoder.bytes().size() >= (1 << 20))
+            {
+                out << encoder.take();
+            }
+        }
+        out << encoder.take();
+        out.flush();
+        return !in_file;
+    }
+
+private:
+    template <typename V>
+    bool get(V& value)
+    {
+        if (static_cast<std::size_t>(m_end - m_position) < sizeof(value))
+        {
+            return false;
+        }
+        std::memcpy(&value, m_position, sizeof(value));
+        m_position += sizeof(value);
+        return true;
+    }
+
+    bool get_string(std::string_view& value)
+    {
+        std::uint32_t size;
+        if (!get(size) || static_cast<std::size_t>(m_end - m_position) < size)
+        {
+            return false;
+        }
+        value = std::string_view(m_position, size);
+        m_position += size;
+        return true;
+    }
+
+    bool get_store(Store& store)
+    {
+        std::uint32_t size;
+        if (!get(size))
+        {
+            return false;
+        }
+        store.intervals.clear();
+        for (std::uint32_t id = 0; id < size; ++id)
+        {
+            std::uint8_t empty;
+            T lb, ub;
+            if (!get(empty) || !get(lb) || !get(ub))
+            {
+                return false;
+            }
+            store.intervals.push_back(empty != 0 ? Interval<T>::empty() : Interval<T>(lb, ub));
+        }
+        return true;
+    }
+
+    bool get_statistics(AnalysisStatistics& statistics)
+    {
+        std::uint64_t value;
+        for (auto* counter : {&statistics.locations, &statistics.iterations, &statistics.ascending_iterations,
+                              &statistics.narrowing_iterations, &statistics.location_evaluations, &statistics.reused_locations,
+                              &statistics.simplifications, &statistics.sliced_statements, &statistics.accelerated_loops,
+                              &statistics.discharged_postconditions, &statistics.function_summaries, &statistics.summary_reuses,
+                              &statistics.shared_subterms, &statistics.subterm_reuses, &statistics.diagnostics})
+        {
+            if (!get(value))
+            {
+                return false;
+            }
+            *counter = value;
+        }
+        std::uint8_t cached, budget;
+        if (!get(cached) || !get(budget))
+        {
+            return false;
+        }
+        statistics.cached = cached != 0;
+        statistics.budget_exceeded = static_cast<BudgetExceeded>(budget);
+        for (auto& evaluations : statistics.evaluations_by_type)
+        {
+            if (!get(value))
+            {
+                return false;
+            }
+            evaluations = value;
+        }
+        for (auto* counter : {&statistics.widenings, &statistics.narrowings, &statistics.stores_allocated,
+                              &statistics.page_allocations, &statistics.page_copies, &statistics.bytes_copied})
+        {
+            if (!get(value))
+            {
+                return false;
+            }
+            *counter = value;
+        }
+        for (auto* time : {&statistics.parse_ms, &statistics.build_ms, &statistics.solve_ms, &statistics.stability_ms,
+                           &statistics.postconditions_ms})
+        {
+            if (!get(*time))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Decodes a record into the encoder. The records of a file are only accepted between its FILE
+     * and END records.
+     *
+     */
+    bool decode(ResultRecord tag, ResultEncoder<T>& encoder, bool& in_file)
+    {
+        if ((tag == ResultRecord::FILE || tag == ResultRecord::ERROR) == in_file)
+        {
+            return false;
+        }
+        switch (tag)
+        {
+            case ResultRecord::FILE:
+            {
+                std::string_view path;
+                std::uint32_t locations, variables;
+                if (!get_string(path) || !get(locations) || !get(variables))
+                {
+                    return false;
+                }
+                std::vector<std::string_view> names(variables);
+                for (auto& name : names)
+                {
+                    if (!get_string(name))
+                    {
+                        return false;
+                    }
+                }
+                encoder.begin(path, locations, variables, [&names](std::size_t id) {
+                    return names[id];
+                });
+                in_file = true;
+                return true;
+            }
+            case ResultRecord::ERROR:
+            {
+                std::string_view path, message;
+                if (!get_string(path) || !get_string(message))
+                {
+                    return false;
+                }
+                encoder.error(path, message);
+                return true;
+            }
+            case ResultRecord::INVARIANT:
+            {
+                std::uint32_t location;
+                std::uint8_t type, port;
+                Store store;
+                if (!get(location) || !get(type) || !get(port) || type >= LOCATION_TYPES || port >= STORE_PORTS || !get_store(store))
+                {
+                    return false;
+                }
+                encoder.invariant(location, static_cast<LocationType>(type), static_cast<StorePort>(port), store);
+                return true;
+            }
+            case ResultRecord::FINAL:
+            {
+                Store store;
+                if (!get_store(store))
+                {
+                    return false;
+                }
+                encoder.final_invariant(store);
+                return true;
+            }
+            case ResultRecord::VERDICT:
+            {
+                std::uint32_t location;
+                std::uint8_t satisfied;
+                if (!get(location) || !get(satisfied) || satisfied > 2)
+                {
+                    return false;
+                }
+                encoder.verdict(location, satisfied == 1, satisfied != 2);
+                return true;
+            }
+            case ResultRecord::DIAGNOSTIC:
+            {
+                std::uint32_t location;
+                std::uint8_t kind;
+                std::uint64_t count;
+                if (!get(location) || !get(kind) || !get(count) || kind >= DIAGNOSTIC_KINDS)
+                {
+                    return false;
+                }
+                encoder.diagnostic(location, static_cast<DiagnosticKind>(kind), count);
+                return true;
+            }
+            case ResultRecord::METRICS:
+            {
+                AnalysisStatistics statistics;
+                if (!get_statistics(statistics))
+                {
+                    return false;
+                }
+                encoder.metrics(statistics);
+                return true;
+            }
+            case ResultRecord::END:
+            {
+                in_file = false;
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+#endif // RESULT_WRITER_HPP
@@ -0,0 +1,322 @@
+#ifndef SLICE_ANALYSIS_HPP
+#define SLICE_ANALYSIS_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <sstream>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "ast_simplifier.hpp"
+#include "cost_estimator.hpp"
+#include "domain_analysis.hpp"
+#include "equational_interpreter.hpp"
+#include "logger.hpp"
+#include "octagon_domain.hpp"
+#include "packed_domain_analysis.hpp"
+#include "parser.hpp"
+#include "program_slicer.hpp"
+#include "thread_pool.hpp"
+
+/**
+ * @brief Analyzes every postcondition of a program on its own slice (see ProgramSlicer::slice), one task
+ * per postcondition on a WorkStealingPool. The program is parsed and simplified once, and the tasks slice
+ * it concurrently without modifying it; every slice is then analyzed by its own interpreter, with its own
+ * variables, stores and functions, so that the tasks share nothing while they solve. A program made of
+ * many independent checks is thus solved on all the workers without synchronizing inside a fixpoint.
+ *
+ * The verdicts are merged in the order of the postconditions, with the locations they have in the
+ * equational system of the whole program. A slice only keeps what its postcondition depends on, so the
+ * verdicts are sound, but the invariants of a slice can differ from those of the whole program, and
+ * there is no final invariant. Only the verdicts and the diagnostics of the slices are printed, the
+ * latter by source line, once per line however many slices raise them, with their largest count. The
+ * statistics sum those of the slices, except for the locations, which are those of the whole program,
+ * and `solve_ms`, which is the wall time of the tasks. With the prefilter of the settings, the
+ * postconditions proved in the constant, sign or octagon domain get no task.
+ *
+ * @tparam T
+ */
+template <typename T>
+class SliceAnalysis
+{
+private:
+    // A diagnostic of a slice, by the line of its statement, since the locations differ between the slices
+    struct LineDiagnostic {
+        std::size_t line;
+        LocationType type;
+        DiagnosticKind kind;
+        std::size_t count;
+    };
+
+    struct SliceResult {
+        PostconditionVerdict verdict{0, false};
+        AnalysisStatistics statistics;
+        std::size_t statements = 0;
+        std::size_t kept_statements = 0;
+        std::vector<LineDiagnostic> diagnostics;
+    };
+
+    std::function<void(EquationalInterpreter<T>&)> m_configure;
+    WorkStealingPool m_pool;
+    AnalysisStatistics m_statistics;
+    std::vector<PostconditionVerdict> m_verdicts;
+
+public:
+    /**
+     * @brief Creates an analysis whose slices are all set up by the given function. Its slice and prefilter
+     * settings are not applied to the slices: the prefilter is run once on the whole program.
+     *
+     * @param configure
+     * @param workers
+     */
+    SliceAnalysis(std::function<void(EquationalInterpreter<T>&)> configure, std::size_t workers)
+    : m_configure(std::move(configure))
+    , m_pool(workers)
+    {}
+
+    /**
+     * @brief Analyzes a program and prints its verdicts, its diagnostics and a summary of its slices
+     *
+     * @param input
+     * @return false if the input cannot be parsed
+     */
+    bool analyze(std::string_view input)
+    {
+        m_statistics = {};
+        m_verdicts.clear();
+        EquationalInterpreter<T> settings;
+        if (m_configure)
+        {
+            m_configure(settings);
+        }
+
+        PerfCounters::Measurement measurement(m_statistics.counters, AnalysisPhase::PARSE);
+        auto parse_start = std::chrono::steady_clock::now();
+        FlatAST ast = AbstractInterpreterParser::parse_program(input);
+        auto parse_end = std::chrono::steady_clock::now();
+        measurement.stop();
+        if (ast.size() == 0 || ast.root().size() == 0)
+        {
+            return false;
+        }
+        auto estimated_evaluations = AnalysisCostEstimator::estimate(ast).cost;
+        ASTSimplifier<T> simplifier(ast);
+        ast = simplifier.simplify();
+
+        std::vector<bool> discharged(ast.size(), false);
+        if constexpr (std::is_integral_v<T>)
+        {
+            if (settings.prefilter())
+            {
+                auto constants = DomainAnalysis<ConstantDomain<T>>(ast).run();
+                auto signs = DomainAnalysis<SignDomain<T>>(ast).run();
+                std::vector<bool> octagons(ast.size(), false);
+                if constexpr (std::is_signed_v<T>)
+                {
+                    octagons = PackedDomainAnalysis<OctagonDomain<T>>(ast).run();
+                }
+                for (std::size_t node = 0; node < discharged.size(); ++node)
+                {
+                    discharged[node] = constants[node] || signs[node] || octagons[node];
+                }
+            }
+        }
+
+        ProgramSlicer program(ast);
+        auto postconditions = program.postconditions();
+        std::vector<std::size_t> tasks;     // index in postconditions of the postcondition of every slice
+        for (std::size_t i = 0; i < postconditions.size(); ++i)
+        {
+            if (!discharged[postconditions[i]])
+            {
+                tasks.push_back(i);
+            }
+        }
+
+        // The first task builds the equational system of the whole program, for the locations of the verdicts
+        std::vector<std::size_t> locations;
+        std::size_t whole_locations = 0;
+        std::vector<SliceResult> results(tasks.size());
+        auto solve_start = std::chrono::steady_clock::now();
+        m_pool.run(tasks.size() + 1, [&](std::size_t task) {
+            std::ostringstream discarded;
+            Logger::Capture capture(discarded, discarded);
+            if (task == 0)
+            {
+                EquationalInterpreter<T> whole{FlatAST(ast)};
+                whole.build();
+                whole_locations = whole.location_count();
+                for (std::size_t location = 0; location < whole.location_count(); ++location)
+                {
+                    if (whole.location_type(location) == LocationType::POSTCONDITION)
+                    {
+                        locations.push_back(location);
+                    }
+                }
+                return;
+            }
+            results[task - 1] = analyze_slice(ast, postconditions[tasks[task - 1]]);
+        });
+        auto solve_end = std::chrono::steady_clock::now();
+        assert(locations.size() == postconditions.size() && "a postcondition location per postcondition");
+
+        std::size_t kept_statements = 0;
+        std::size_t exceeded = 0;
+        std::map<std::tuple<std::size_t, LocationType, DiagnosticKind>, std::size_t> diagnostics;
+        for (const auto& result : results)
+        {
+            accumulate(result.statistics);
+            kept_statements += result.kept_statements;
+            exceeded += result.statistics.budget_exceeded != BudgetExceeded::NONE ? 1 : 0;
+            for (const auto& diagnostic : result.diagnostics)
+            {
+                auto& count = diagnostics[{diagnostic.line, diagnostic.type, diagnostic.kind}];
+                count = std::max(count, diagnostic.count);
+            }
+        }
+        m_statistics.locations = whole_locations;
+        m_statistics.estimated_evaluations = estimated_evaluations;
+        m_statistics.simplifications = simplifier.rewrites();
+        m_statistics.discharged_postconditions = postconditions.size() - tasks.size();
+        m_statistics.diagnostics = diagnostics.size();
+        m_statistics.parse_ms = std::chrono::duration<double, std::milli>(parse_end - parse_start).count();
+        m_statistics.solve_ms = std::chrono::duration<double, std::milli>(solve_end - solve_start).count();
+
+        for (std::size_t i = 0, task = 0; i < postconditions.size(); ++i)
+        {
+            if (task < tasks.size() && tasks[task] == i)
+            {
+                m_verdicts.push_back(results[task++].verdict);
+                m_verdicts.back().location = locations[i];
+            }
+            else
+            {
+                m_verdicts.push_back({locations[i], true});
+            }
+            const auto& verdict = m_verdicts.back();
+            if (!verdict.decided)
+            {
+                WARN_SUMMARY << "Postcondition undecided" << std::endl;
+            }
+            else if (verdict.satisfied)
+            {
+                LOG_SUMMARY << "Postcondition satisfied" << std::endl;
+            }
+            else
+            {
+                WARN_SUMMARY << "Postcondition not satisfied" << std::endl;
+            }
+        }
+        for (const auto& [site, count] : diagnostics)
+        {
+            const auto& [line, type, kind] = site;
+            WARN_SUMMARY << "[WARNING] " << diagnostic_message(kind) << " at line " << line << " (" << location_type_name(type) << ", "
+                         << count << (count == 1 ? " evaluation)" : " evaluations)") << std::endl;
+        }
+        if (exceeded > 0)
+        {
+            WARN_SUMMARY << "[WARNING] Budget exceeded (" << budget_name(m_statistics.budget_exceeded) << ") in " << exceeded << " of "
+                         << results.size() << " slices" << std::endl;
+        }
+        LOG_SUMMARY << "Fixpoint iterations: " << m_statistics.iterations << " (" << m_statistics.ascending_iterations << " ascending, "
+                    << m_statistics.narrowing_iterations << " narrowing)" << std::endl;
+        LOG_SUMMARY << "Location evaluations: " << m_statistics.location_evaluations << std::endl;
+        LOG_SUMMARY << "Slices: " << results.size() << " (" << kept_statements << " statements analyzed, of "
+                    << (results.empty() ? 0 : results.front().statements) << " in the program) on " << m_pool.workers()
+                    << (m_pool.workers() == 1 ? " worker" : " workers") << std::endl;
+        if (settings.prefilter())
+        {
+            LOG_SUMMARY << "Discharged postconditions: " << m_statistics.discharged_postconditions << std::endl;
+        }
+        LOG_SUMMARY << "Solve time: " << m_statistics.solve_ms << " ms" << std::endl;
+        return true;
+    }
+
+    /**
+     * @brief Statistics of the last analysis, summed over its slices
+     *
+     */
+    const AnalysisStatistics& statistics() const
+    {
+        return m_statistics;
+    }
+
+    /**
+     * @brief Verdicts of the last analysis, in the order of the postconditions
+     *
+     */
+    const std::vector<PostconditionVerdict>& verdicts() const
+    {
+        return m_verdicts;
+    }
+
+private:
+    SliceResult analyze_slice(const FlatAST& ast, FlatAST::Index postcondition) const
+    {
+        SliceResult result;
+        ProgramSlicer slicer(ast);
+        auto slice = slicer.slice(postcondition);
+        assert(slice.has_value() && "the slice keeps its postcondition");
+
+        EquationalInterpreter<T> EI(std::move(*slice));
+        if (m_configure)
+        {
+            m_configure(EI);
+        }
+        EI.set_slice(false);
+        EI.set_prefilter(false);
+        EI.set_diagnostics(true);
+        EI.run();
+
+        assert(EI.verdicts().size() == 1 && "a slice has a single postcondition");
+        result.verdict = EI.verdicts().front();
+        result.statistics = EI.statistics();
+        result.statistics.sliced_statements = slicer.statements() - slicer.kept_statements();
+        result.statements = slicer.statements();
+        result.kept_statements = slicer.kept_statements();
+        for (const auto& diagnostic : EI.diagnostics())
+        {
+            result.diagnostics.push_back({EI.location_line(diagnostic.location), EI.location_type(diagnostic.location), diagnostic.kind, diagnostic.count});
+        }
+        return result;
+    }
+
+    void accumulate(const AnalysisStatistics& slice)
+    {
+        auto& total = m_statistics;
+        total.iterations += slice.iterations;
+        total.ascending_iterations += slice.ascending_iterations;
+        total.narrowing_iterations += slice.narrowing_iterations;
+        total.location_evaluations += slice.location_evaluations;
+        total.sliced_statements += slice.sliced_statements;
+        total.accelerated_loops += slice.accelerated_loops;
+        total.function_summaries += slice.function_summaries;
+        total.summary_reuses += slice.summary_reuses;
+        total.shared_subterms += slice.shared_subterms;
+        total.subterm_reuses += slice.subterm_reuses;
+        if (total.budget_exceeded == BudgetExceeded::NONE)
+        {
+            total.budget_exceeded = slice.budget_exceeded;
+        }
+        for (std::size_t type = 0; type < LOCATION_TYPES; ++type)
+        {
+            total.evaluations_by_type[type] += slice.evaluations_by_type[type];
+        }
+        total.widenings += slice.widenings;
+        total.narrowings += slice.narrowings;
+        total.stores_allocated += slice.stores_allocated;
+        total.page_allocations += slice.page_allocations;
+        total.page_copies += slice.page_copies;
+        total.bytes_copied += slice.bytes_copied;
+        total.build_ms += slice.build_ms;
+        total.stability_ms += slice.stability_ms;
+        total.postconditions_ms += slice.postconditions_ms;
+        total.counters.add(slice.counters);
+    }
+};
+
+#endif // SLICE_ANALYSIS_HPP
@@ -0,0 +1,155 @@
+#ifndef STORE_POOL_HPP
+#define STORE_POOL_HPP
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "interval_store.hpp"
+#include "recycling_allocator.hpp"
+
+/**
+ * @brief The StorePool class hash-conses interval stores: structurally equal stores are mapped onto
+ * a single canonical, immutable instance. Two stores interned in the same pool are therefore equal
+ * if and only if they are the same object.
+ *
+ * The pool only keeps weak references, so canonical stores are released as soon as no location uses
+ * them anymore, and expired entries are swept when the table grows. The pool can be shared by the threads
+ * of the parallel solver: lookups hold a lock, the hash of the store is computed before taking it.
+ *
+ * @tparam T
+ */
+template <typename T>
+class StorePool
+{
+private:
+    using Entry = std::pair<const std::uint64_t, std::weak_ptr<IntervalStore<T>>>;
+    std::unordered_multimap<std::uint64_t, std::weak_ptr<IntervalStore<T>>, std::hash<std::uint64_t>, std::equal_to<std::uint64_t>,
+                            RecyclingAllocator<Entry>> m_table;
+    std::size_t m_sweep_threshold = 1024;
+    std::size_t m_lookups = 0;
+    std::size_t m_hits = 0;
+    std::mutex m_mutex;
+
+public:
+    StorePool() = default;
+    ~StorePool() = default;
+
+    StorePool(StorePool<T>&& other)
+    : m_table(std::move(other.m_table))
+    , m_sweep_threshold(other.m_sweep_threshold)
+    , m_lookups(other.m_lookups)
+    , m_hits(other.m_hits)
+    {}
+
+    StorePool<T>& operator=(StorePool<T>&& other)
+    {
+        m_table = std::move(other.m_table);
+        m_sweep_threshold = other.m_sweep_threshold;
+        m_lookups = other.m_lookups;
+        m_hits = other.m_hits;
+        return *this;
+    }
+
+    /**
+     * @brief Returns the canonical instance of the given store, registering the store itself as the
+     * canonical instance if no equal store is in the pool.
+     *
+     * @param store
+     * @return std::shared_ptr<IntervalStore<T>>
+     */
+    std::shared_ptr<IntervalStore<T>> intern(IntervalStore<T>&& store)
+    {
+        auto hash = store.hash();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (auto canonical = find(store, hash))
+        {
+            return canonical;
+        }
+        return insert(std::move(store), hash);
+    }
+
+    // The store is only copied if it has no canonical instance yet
+    std::shared_ptr<IntervalStore<T>> intern(const IntervalStore<T>& store)
+    {
+        auto hash = store.hash();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (auto canonical = find(store, hash))
+        {
+            return canonical;
+        }
+        return insert(IntervalStore<T>(store), hash);
+    }
+
+    /**
+     * @brief Number of canonical stores that are still alive
+     *
+     * @return std::size_t
+     */
+    std::size_t size()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        sweep();
+        return m_table.size();
+    }
+
+    std::size_t lookups() const
+    {
+        return m_lookups;
+    }
+
+    std::size_t hits() const
+    {
+        return m_hits;
+    }
+
+private:
+    std::shared_ptr<IntervalStore<T>> find(const IntervalStore<T>& store, std::uint64_t hash)
+    {
+        m_lookups++;
+        auto [begin, end] = m_table.equal_range(hash);
+        for (auto it = begin; it != end; ++it)
+        {
+            if (auto canonical = it->second.lock())
+            {
+                if (canonical->equals(store))
+                {
+                    m_hits++;
+                    return canonical;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    std::shared_ptr<IntervalStore<T>> insert(IntervalStore<T>&& store, std::uint64_t hash)
+    {
+        auto canonical = std::allocate_shared<IntervalStore<T>>(RecyclingAllocator<IntervalStore<T>>(), std::move(store));
+        canonical->mark_interned();
+        m_table.emplace(hash, canonical);
+        if (m_table.size() > m_sweep_threshold)
+        {
+            sweep();
+        }
+        return canonical;
+    }
+
+    void sweep()
+    {
+        for (auto it = m_table.begin(); it != m_table.end();)
+        {
+            if (it->second.expired())
+            {
+                it = m_table.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        m_sweep_threshold = std::max<std::size_t>(1024, 2 * m_table.size());
+    }
+};
+
+#endif // STORE_POOL_HPP
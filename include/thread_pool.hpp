@@ -0,0 +1,310 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Work-stealing pool that runs sets of tasks, identified by their index.
+ *
+ * The tasks ready at the start of a run are dealt round-robin to one queue per worker. A worker takes
+ * tasks from the back of its own queue and, once it is empty, steals from the front of the queues of the
+ * other workers, so that a few long tasks do not leave the other workers idle. The tasks of a run can
+ * depend on each other (see TaskGraph): a task is queued by the worker that completes its last
+ * predecessor, and a task can complete dependencies that are not known in advance (see release) or end
+ * the run early (see stop). The threads are started with the pool and wait between runs, so that a pool
+ * can run many small graphs; the thread calling run is one of the workers. A task that throws stops the
+ * run, and run throws the first exception of its tasks once the tasks already started are done.
+ *
+ */
+class WorkStealingPool
+{
+public:
+    /**
+     * @brief Dependencies between the tasks of a run
+     *
+     */
+    struct TaskGraph {
+        std::vector<std::vector<std::size_t>> successors;   // tasks that wait for every task
+        std::vector<std::size_t> predecessors;              // number of tasks every task waits for
+    };
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::size_t> tasks;
+    };
+
+    std::size_t m_workers;
+    std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+    std::vector<std::thread> m_threads;
+
+    // Current run, published to the threads by m_generation
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    std::condition_variable m_finished;
+    std::size_t m_generation = 0;
+    std::size_t m_running = 0;      // threads that have not left the current run yet
+    bool m_stop = false;
+    const std::function<void(std::size_t)>* m_task = nullptr;
+    const TaskGraph* m_graph = nullptr;
+    std::unique_ptr<std::atomic<std::size_t>[]> m_pending;     // predecessors not completed yet
+    std::atomic<std::size_t> m_queued{0};       // tasks waiting in the queues
+    std::atomic<std::size_t> m_remaining{0};    // tasks not completed yet
+    std::atomic<bool> m_stopped{false};
+    std::exception_ptr m_error;         // first exception of a task of the current run, under m_mutex
+
+public:
+    explicit WorkStealingPool(std::size_t workers)
+    : m_workers(workers == 0 ? 1 : workers)
+    {
+        for (std::size_t i = 0; i < m_workers; ++i)
+        {
+            m_queues.push_back(std::make_unique<WorkerQueue>());
+        }
+        for (std::size_t i = 1; i < m_workers; ++i)
+        {
+            m_threads.emplace_back([this, i]() { wait_for_runs(i); });
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    ~WorkStealingPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wakeup.notify_all();
+        for (auto& thread : m_threads)
+        {
+            thread.join();
+        }
+    }
+
+    std::size_t workers() const
+    {
+        return m_workers;
+    }
+
+    /**
+     * @brief Runs task(0), ..., task(count - 1) on the workers and returns when all of them are done
+     *
+     * @param count
+     * @param task
+     */
+    void run(std::size_t count, const std::function<void(std::size_t)>& task)
+    {
+        execute(count, nullptr, task);
+    }
+
+    /**
+     * @brief Runs one task per node of the graph, each one after all its predecessors, and returns when all
+     * of them are done. What a task writes is visible to its successors.
+     *
+     * @param graph
+     * @param task
+     */
+    void run(const TaskGraph& graph, const std::function<void(std::size_t)>& task)
+    {
+        execute(graph.predecessors.size(), &graph, task);
+    }
+
+    /**
+     * @brief Completes one of the predecessors of a task of the current graph run that is not an edge of
+     * the graph, queueing the task if it was the last one. Called by the tasks of the run: the dependency
+     * is counted in the predecessors of the task in the graph.
+     *
+     * @param index
+     */
+    void release(std::size_t index)
+    {
+        if (m_pending[index].fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            push(*m_queues[index % m_workers], index);
+        }
+    }
+
+    /**
+     * @brief Ends the current run once the tasks already started are done: the other tasks are dropped
+     *
+     */
+    void stop()
+    {
+        m_stopped.store(true, std::memory_order_release);
+    }
+
+private:
+    void execute(std::size_t count, const TaskGraph* graph, const std::function<void(std::size_t)>& task)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+        // A stopped run can leave tasks in the queues
+        for (auto& queue : m_queues)
+        {
+            queue->tasks.clear();
+        }
+        m_stopped.store(false, std::memory_order_relaxed);
+        if (graph != nullptr)
+        {
+            m_pending = std::make_unique<std::atomic<std::size_t>[]>(count);
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                m_pending[i].store(graph->predecessors[i], std::memory_order_relaxed);
+            }
+        }
+        // Dealt in reverse, so that every worker starts from the lowest indices of its queue
+        std::size_t ready = 0;
+        for (std::size_t i = count; i-- > 0;)
+        {
+            if (graph == nullptr || graph->predecessors[i] == 0)
+            {
+                m_queues[ready++ % m_workers]->tasks.push_back(i);
+            }
+        }
+        m_queued.store(ready, std::memory_order_relaxed);
+        m_remaining.store(count, std::memory_order_relaxed);
+        m_task = &task;
+        m_graph = graph;
+
+        if (!m_threads.empty())
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_running = m_threads.size();
+                m_generation++;
+            }
+            m_wakeup.notify_all();
+        }
+        work(0);
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_finished.wait(lock, [this]() { return m_running == 0; });
+        if (m_error != nullptr)
+        {
+            std::rethrow_exception(std::exchange(m_error, nullptr));
+        }
+    }
+
+    void wait_for_runs(std::size_t self)
+    {
+        std::size_t generation = 0;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wakeup.wait(lock, [this, generation]() { return m_stop || m_generation != generation; });
+                if (m_stop)
+                {
+                    return;
+                }
+                generation = m_generation;
+            }
+            work(self);
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_running == 0)
+            {
+                m_finished.notify_one();
+            }
+        }
+    }
+
+    void work(std::size_t self)
+    {
+        while (m_remaining.load(std::memory_order_acquire) > 0 && !m_stopped.load(std::memory_order_acquire))
+        {
+            std::size_t index;
+            if (pop(*m_queues[self], index) || steal(self, index))
+            {
+                try
+                {
+                    (*m_task)(index);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    if (m_error == nullptr)
+                    {
+                        m_error = std::current_exception();
+                    }
+                    stop();
+                }
+                if (m_graph != nullptr)
+                {
+                    for (auto successor : m_graph->successors[index])
+                    {
+                        if (m_pending[successor].fetch_sub(1, std::memory_order_acq_rel) == 1)
+                        {
+                            push(*m_queues[self], successor);
+                        }
+                    }
+                }
+                m_remaining.fetch_sub(1, std::memory_order_release);
+            }
+            else if (m_graph == nullptr)
+            {
+                // Independent tasks are all queued from the start: nothing is left for this worker
+                return;
+            }
+            else
+            {
+                // The tasks still running will queue their successors
+                while (m_queued.load(std::memory_order_relaxed) == 0 && m_remaining.load(std::memory_order_acquire) > 0
+                       && !m_stopped.load(std::memory_order_relaxed))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    }
+
+    void push(WorkerQueue& queue, std::size_t index)
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(index);
+        m_queued.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool pop(WorkerQueue& queue, std::size_t& index)
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+        {
+            return false;
+        }
+        index = queue.tasks.back();
+        queue.tasks.pop_back();
+        m_queued.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool steal(std::size_t self, std::size_t& index)
+    {
+        for (std::size_t offset = 1; offset < m_queues.size(); ++offset)
+        {
+            auto& victim = *m_queues[(self + offset) % m_queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty())
+            {
+                index = victim.tasks.front();
+                victim.tasks.pop_front();
+                m_queued.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+#endif // THREAD_POOL_HPP
@@ -0,0 +1,149 @@
+#ifndef VARIABLE_TABLE_HPP
+#define VARIABLE_TABLE_HPP
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <limits>
+
+/**
+ * @brief The VariableTable class interns variable names, associating to each of them a dense
+ * identifier that is used to address the intervals of a store.
+ *
+ */
+class VariableTable
+{
+private:
+    // Hashes the names and the views of names alike, so that looking a view up does not copy it
+    struct NameHash
+    {
+        using is_transparent = void;
+
+        std::size_t operator()(std::string_view name) const
+        {
+            return std::hash<std::string_view>{}(name);
+        }
+    };
+
+    std::unordered_map<std::string, std::size_t, NameHash, std::equal_to<>> m_ids;
+    std::vector<std::string> m_names;
+
+public:
+    static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+    VariableTable() = default;
+    ~VariableTable() = default;
+
+    /**
+     * @brief Returns the identifier of a variable, registering it if it is not known yet
+     *
+     * @param name
+     * @return std::size_t
+     */
+    std::size_t intern(std::string_view name)
+    {
+        if (auto it = m_ids.find(name); it != m_ids.end())
+        {
+            return it->second;
+        }
+        m_ids.emplace(name, m_names.size());
+        m_names.emplace_back(name);
+        return m_names.size() - 1;
+    }
+
+    /**
+     * @brief Returns the identifier of a variable, or npos if the variable is not known
+     *
+     * @param name
+     * @return std::size_t
+     */
+    std::size_t find(std::string_view name) const
+    {
+        if (auto it = m_ids.find(name); it != m_ids.end())
+        {
+            return it->second;
+        }
+        return npos;
+    }
+
+    const std::string& name(std::size_t id) const
+    {
+        return m_names[id];
+    }
+
+    std::size_t size() const
+    {
+        return m_names.size();
+    }
+
+    /**
+     * @brief Forgets the variables interned after the first `size` ones
+     *
+     * @param size
+     */
+    void truncate(std::size_t size)
+    {
+        while (m_names.size() > size)
+        {
+            m_ids.erase(m_names.back());
+            m_names.pop_back();
+        }
+    }
+};
+
+/**
+ * @brief Set of variable identifiers, as a bitset with one 64-bit word per block of 64 identifiers (the
+ * size of a store page)
+ *
+ */
+class VariableSet
+{
+private:
+    std::vector<std::uint64_t> m_words;
+
+public:
+    void insert(std::size_t id)
+    {
+        if (id / 64 >= m_words.size())
+        {
+            m_words.resize(id / 64 + 1, 0);
+        }
+        m_words[id / 64] |= std::uint64_t(1) << (id % 64);
+    }
+
+    bool contains(std::size_t id) const
+    {
+        return id / 64 < m_words.size() && ((m_words[id / 64] >> (id % 64)) & 1);
+    }
+
+    /**
+     * @brief Identifiers 64 * index to 64 * index + 63 of the set, as a bitmask
+     *
+     * @param index
+     * @return std::uint64_t
+     */
+    std::uint64_t word(std::size_t index) const
+    {
+        return index < m_words.size() ? m_words[index] : 0;
+    }
+
+    std::size_t word_count() const
+    {
+        return m_words.size();
+    }
+
+    std::size_t size() const
+    {
+        std::size_t count = 0;
+        for (auto word : m_words)
+        {
+            count += __builtin_popcountll(word);
+        }
+        return count;
+    }
+};
+
+#endif // VARIABLE_TABLE_HPP
@@ -0,0 +1,76 @@
+#ifndef WIDTH_INFERENCE_HPP
+#define WIDTH_INFERENCE_HPP
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+
+#include "flat_ast.hpp"
+
+/**
+ * @brief Widths of the bounds of the intervals that an analysis can run with. The language only declares
+ * `int` variables, so the width of an analysis is inferred from its integers (see infer_value_width), and
+ * checked by the analysis itself (see EquationalInterpreter::saturated).
+ *
+ */
+enum class ValueWidth : std::uint8_t {
+    W16 = 16,
+    W32 = 32,
+    W64 = 64
+};
+
+// The integers that a width holds strictly inside its range, so that their neighbours and the ends of
+// the range, to which the bounds that leave it go, are distinct from them
+template <typename T>
+constexpr bool holds_strictly(std::int64_t value)
+{
+    return value > std::numeric_limits<T>::min() && value < std::numeric_limits<T>::max();
+}
+
+/**
+ * @brief Narrowest width that holds every integer of the program, those of its preconditions included,
+ * strictly inside its range
+ *
+ * @param ast
+ * @return ValueWidth
+ */
+inline ValueWidth infer_value_width(const FlatAST& ast)
+{
+    auto width = ValueWidth::W16;
+    for (FlatAST::Index index = 0; index < ast.size(); ++index)
+    {
+        if (ast.type(index) != NodeType::INTEGER)
+        {
+            continue;
+        }
+        auto value = ast.value(index).payload;
+        if (!holds_strictly<std::int32_t>(value))
+        {
+            return ValueWidth::W64;
+        }
+        if (!holds_strictly<std::int16_t>(value))
+        {
+            width = ValueWidth::W32;
+        }
+    }
+    return width;
+}
+
+/**
+ * @brief Width with which to analyze again a program whose bounds did not stay inside the given one
+ *
+ * @param width
+ * @return std::optional<ValueWidth> nothing past 64 bits
+ */
+inline std::optional<ValueWidth> wider_value_width(ValueWidth width)
+{
+    switch (width)
+    {
+        case ValueWidth::W16: return ValueWidth::W32;
+        case ValueWidth::W32: return ValueWidth::W64;
+        case ValueWidth::W64: return std::nullopt;
+    }
+    return std::nullopt;
+}
+
+#endif // WIDTH_INFERENCE_HPP
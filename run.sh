@@ -27,3 +27,13 @@ for file in ../tests/*.c; do
     # Run the test
     ./absint "../tests/${filename}.c"
 done
+
+# The worklist and WTO solvers must reach the verdicts and the final invariant of the Jacobi solver
+for file in ../tests/*.c; do
+    reference=$(./absint --solver=jacobi "$file" 2>&1 | grep -E '^[A-Za-z_][A-Za-z0-9_]*: |^Postcondition')
+    for solver in worklist wto; do
+        if [ "$(./absint --solver=$solver "$file" 2>&1 | grep -E '^[A-Za-z_][A-Za-z0-9_]*: |^Postcondition')" != "$reference" ]; then
+            echo "$file: the $solver solver differs from the jacobi solver"
+        fi
+    done
+done
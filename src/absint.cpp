@@ -0,0 +1,7 @@
+#include "absint.hpp"
+
+// The instantiations that libabsint provides to its consumers, declared extern in absint.hpp
+template class EquationalInterpreter<int32_t>;
+template class EquationalInterpreter<int64_t>;
+template class AnalysisContext<int32_t>;
+template class AnalysisContext<int64_t>;
@@ -1,32 +1,705 @@
+#include <chrono>
+#include <filesystem>
 #include <fstream>
+#include <limits>
+#include <optional>
 #include <sstream>
+#include <thread>
+#include <vector>
 
 #include "parser.hpp"
 #include "ast.hpp"
-#include "interpreter.hpp" 
+#include "logger.hpp"
+#include "interpreter.hpp"
 #include "equational_interpreter.hpp"
+#include "batch_analysis.hpp"
+#include "distributed_batch.hpp"
+#include "analysis_report.hpp"
+#include "incremental_analysis.hpp"
+#include "result_cache.hpp"
+#include "result_writer.hpp"
+#include "invariant_index.hpp"
+#include "analysis_server.hpp"
+#include "absint.hpp"
+#include "width_inference.hpp"
+#include "slice_analysis.hpp"
 
-int main(int argc, char** argv) {
-    if(argc != 2) {
-        std::cout << "usage: " << argv[0] << " tests/00.c" << std::endl;
+// A program that is parsed but cannot be analyzed ends the command line with an error (see AnalysisError)
+int main(int argc, char** argv) try {
+    SolverMode solver_mode = SolverMode::WORKLIST;
+    LogLevel log_level = LogLevel::SUMMARY;
+    std::string path;
+    bool batch = false;
+    bool watch = false;
+    bool server = false;
+    std::string socket_path;
+    std::size_t jobs = std::thread::hardware_concurrency();
+    std::string manifest;
+    std::optional<BatchPipeline> pipeline;
+    std::vector<BatchEndpoint> coordinator;
+    std::vector<BatchEndpoint> worker;
+    std::size_t shards = 0;
+    std::size_t retries = 2;
+    std::string metrics_path;
+    std::string cache_path;
+    std::string trace_path;
+    std::string print_trace_path;
+    std::string results_path;
+    std::string print_results_path;
+    std::string index_path;
+    std::string checkpoint_path;
+    double checkpoint_interval_ms = 60000;
+    std::string resume_path;
+    std::string query_index_path;
+    std::vector<std::string> queries;
+    ResultFormat results_format = ResultFormat::NDJSON;
+    std::vector<std::string> inputs;
+    long widening_delay = -1;
+    long narrowing_passes = -1;
+    bool sparse = false;
+    bool slice = false;
+    bool parallel_slices = false;
+    bool prefilter = false;
+    bool anytime = false;
+    bool infer_width = false;
+    bool low_memory = false;
+    bool estimate = false;
+    std::string sweep_path;
+    std::string profile_path;
+    std::string folded_path;
+    AnalysisBudget budget;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg(argv[i]);
+        if (arg == "--solver=worklist") {
+            solver_mode = SolverMode::WORKLIST;
+        }
+        else if (arg == "--solver=jacobi") {
+            solver_mode = SolverMode::JACOBI;
+        }
+        else if (arg == "--solver=wto") {
+            solver_mode = SolverMode::WTO;
+        }
+        else if (arg == "--solver=parallel") {
+            solver_mode = SolverMode::PARALLEL;
+        }
+        else if (arg.rfind("--log=", 0) == 0) {
+            if (!Logger::parse_level(arg.substr(6), log_level)) {
+                std::cerr << "[ERROR] unknown log level `" << arg.substr(6) << "`." << std::endl;
+                return 1;
+            }
+        }
+        else if (arg.rfind("--widening-delay=", 0) == 0) {
+            widening_delay = std::stol(arg.substr(17));
+        }
+        else if (arg.rfind("--narrowing=", 0) == 0) {
+            narrowing_passes = std::stol(arg.substr(12));
+        }
+        else if (arg.rfind("--metrics=", 0) == 0) {
+            metrics_path = arg.substr(10);
+        }
+        else if (arg.rfind("--cache=", 0) == 0) {
+            cache_path = arg.substr(8);
+        }
+        else if (arg.rfind("--trace=", 0) == 0) {
+            trace_path = arg.substr(8);
+        }
+        else if (arg.rfind("--print-trace=", 0) == 0) {
+            print_trace_path = arg.substr(14);
+        }
+        else if (arg.rfind("--results=", 0) == 0) {
+            results_path = arg.substr(10);
+        }
+        else if (arg.rfind("--results-format=", 0) == 0) {
+            if (!parse_result_format(arg.substr(17), results_format)) {
+                std::cerr << "[ERROR] unknown result format `" << arg.substr(17) << "`." << std::endl;
+                return 1;
+            }
+        }
+        else if (arg.rfind("--parser=", 0) == 0) {
+            ParserKind parser_kind;
+            if (!AbstractInterpreterParser::parse_kind(arg.substr(9), parser_kind)) {
+                std::cerr << "[ERROR] unknown parser `" << arg.substr(9) << "`." << std::endl;
+                return 1;
+            }
+            AbstractInterpreterParser::set_kind(parser_kind);
+        }
+        else if (arg.rfind("--print-results=", 0) == 0) {
+            print_results_path = arg.substr(16);
+        }
+        else if (arg.rfind("--checkpoint=", 0) == 0) {
+            checkpoint_path = arg.substr(13);
+        }
+        else if (arg.rfind("--checkpoint-interval=", 0) == 0) {
+            checkpoint_interval_ms = std::stod(arg.substr(22));
+        }
+        else if (arg.rfind("--resume=", 0) == 0) {
+            resume_path = arg.substr(9);
+        }
+        else if (arg.rfind("--index=", 0) == 0) {
+            index_path = arg.substr(8);
+        }
+        else if (arg.rfind("--query-index=", 0) == 0) {
+            query_index_path = arg.substr(14);
+        }
+        else if (arg.rfind("--query=", 0) == 0) {
+            queries.push_back(arg.substr(8));
+        }
+        else if (arg.rfind("--time-budget=", 0) == 0) {
+            budget.time_ms = std::stod(arg.substr(14));
+        }
+        else if (arg.rfind("--iteration-budget=", 0) == 0) {
+            budget.iterations = std::stoull(arg.substr(19));
+        }
+        else if (arg.rfind("--memory-budget=", 0) == 0) {
+            budget.memory_mb = std::stoull(arg.substr(16));
+        }
+        else if (arg == "--sparse") {
+            sparse = true;
+        }
+        else if (arg == "--slice") {
+            slice = true;
+            parallel_slices = false;
+        }
+        else if (arg == "--slice=parallel") {
+            slice = false;
+            parallel_slices = true;
+        }
+        else if (arg == "--prefilter") {
+            prefilter = true;
+        }
+        else if (arg == "--anytime") {
+            anytime = true;
+        }
+        else if (arg == "--low-memory") {
+            low_memory = true;
+        }
+        else if (arg == "--perf-counters") {
+            PerfCounters::set_enabled(true);
+        }
+        else if (arg == "--estimate") {
+            estimate = true;
+        }
+        else if (arg == "--width=auto") {
+            infer_width = true;
+        }
+        else if (arg == "--width=64") {
+            infer_width = false;
+        }
+        else if (arg == "--watch") {
+            watch = true;
+        }
+        else if (arg == "--server") {
+            server = true;
+        }
+        else if (arg.rfind("--server=", 0) == 0) {
+            server = true;
+            socket_path = arg.substr(9);
+        }
+        else if (arg == "--batch") {
+            batch = true;
+        }
+        else if (arg.rfind("--profile=", 0) == 0) {
+            profile_path = arg.substr(10);
+        }
+        else if (arg.rfind("--profile-folded=", 0) == 0) {
+            folded_path = arg.substr(17);
+        }
+        else if (arg.rfind("--sweep=", 0) == 0) {
+            sweep_path = arg.substr(8);
+        }
+        else if (arg.rfind("--jobs=", 0) == 0) {
+            jobs = std::stoull(arg.substr(7));
+        }
+        else if (arg.rfind("--pipeline=", 0) == 0) {
+            auto depth = pipeline ? pipeline->depth : BatchPipeline().depth;
+            pipeline.emplace();
+            pipeline->depth = depth;
+            if (!parse_batch_pipeline(arg.substr(11), *pipeline)) {
+                std::cerr << "[ERROR] expected --pipeline=LOAD,PARSE,BUILD,SOLVE with at least one worker per stage." << std::endl;
+                return 1;
+            }
+            batch = true;
+        }
+        else if (arg.rfind("--pipeline-depth=", 0) == 0) {
+            if (!pipeline) {
+                pipeline.emplace();
+            }
+            pipeline->depth = std::stoull(arg.substr(17));
+            batch = true;
+        }
+        else if (arg.rfind("--coordinator=", 0) == 0) {
+            if (!parse_batch_endpoints(arg.substr(14), coordinator)) {
+                std::cerr << "[ERROR] expected --coordinator=HOST:PORT[,HOST:PORT...]." << std::endl;
+                return 1;
+            }
+            batch = true;
+        }
+        else if (arg.rfind("--worker=", 0) == 0) {
+            if (!parse_batch_endpoints(arg.substr(9), worker, "*") || worker.size() != 1) {
+                std::cerr << "[ERROR] expected --worker=[HOST:]PORT." << std::endl;
+                return 1;
+            }
+        }
+        else if (arg.rfind("--shards=", 0) == 0) {
+            shards = std::stoull(arg.substr(9));
+        }
+        else if (arg.rfind("--retries=", 0) == 0) {
+            retries = std::stoull(arg.substr(10));
+        }
+        else if (arg.rfind("--manifest=", 0) == 0) {
+            manifest = arg.substr(11);
+            batch = true;
+        }
+        else {
+            path = arg;
+            inputs.push_back(arg);
+        }
     }
-    std::ifstream f(argv[1]);
-    if (!f.is_open()){
-        std::cerr << "[ERROR] cannot open the test file `" << argv[1] << "`." << std::endl;
+    if (!print_trace_path.empty()) {
+        FixpointTracePrinter<int64_t> printer(print_trace_path);
+        if (!printer.print(std::cout)) {
+            std::cerr << "[ERROR] `" << print_trace_path << "` is not a complete trace." << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    if (!print_results_path.empty()) {
+        ResultStreamPrinter<int64_t> printer(print_results_path);
+        if (!printer.print(std::cout)) {
+            std::cerr << "[ERROR] `" << print_results_path << "` is not a complete result stream." << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    if (!query_index_path.empty()) {
+        InvariantIndex<int64_t> index(query_index_path);
+        if (!index.good()) {
+            std::cerr << "[ERROR] `" << query_index_path << "` is not a complete invariant index." << std::endl;
+            return 1;
+        }
+        if (queries.empty()) {
+            for (const auto& entry : index.entries()) {
+                index.print(std::cout, entry);
+            }
+            return 0;
+        }
+        // A query is VARIABLE@LINE or VARIABLE@FIRST-LAST, without a variable for all of them and without
+        // lines for the whole program
+        for (const auto& query : queries) {
+            auto at = query.find('@');
+            auto name = query.substr(0, at);
+            std::uint32_t first = 0, last = std::numeric_limits<std::uint32_t>::max();
+            if (at != std::string::npos) {
+                std::istringstream lines(query.substr(at + 1));
+                char dash = 0;
+                if (!(lines >> first) || ((lines >> dash) && (dash != '-' || !(lines >> last))) || !lines.eof()) {
+                    std::cerr << "[ERROR] expected --query=VARIABLE@LINE or VARIABLE@FIRST-LAST, not `" << query << "`." << std::endl;
+                    return 1;
+                }
+                last = dash == 0 ? first : last;
+            }
+            auto variable = index.variable(name);
+            if (!name.empty() && !variable) {
+                std::cerr << "[ERROR] no variable `" << name << "` in the index." << std::endl;
+                return 1;
+            }
+            std::size_t matches = 0;
+            for (std::uint32_t id = variable.value_or(0); id < (variable ? *variable + 1 : index.variables()); ++id) {
+                for (const auto& entry : index.lines(id, first, last)) {
+                    index.print(std::cout, entry);
+                    matches++;
+                }
+            }
+            if (matches == 0) {
+                std::cout << query << ": no invariant" << std::endl;
+            }
+        }
+        std::cout.flush();
+        return 0;
+    }
+    if (estimate && (batch || server || watch || !worker.empty())) {
+        std::cerr << "[ERROR] --estimate cannot be combined with --batch, --coordinator, --worker, --server or --watch." << std::endl;
+        return 1;
+    }
+    // The stores inside the loops of a sparse analysis are stale for the variables that the loops ignore
+    if (sparse && (!results_path.empty() || !index_path.empty() || !cache_path.empty())) {
+        std::cerr << "[ERROR] --sparse cannot be combined with --results, --index or --cache, which export the stores of every location." << std::endl;
+        return 1;
+    }
+    if (!index_path.empty() && (batch || server || watch || !sweep_path.empty())) {
+        std::cerr << "[ERROR] --index cannot be combined with --batch, --server, --watch or --sweep." << std::endl;
+        return 1;
+    }
+    if (!checkpoint_path.empty() || !resume_path.empty()) {
+        if (batch || server || watch || !sweep_path.empty()) {
+            std::cerr << "[ERROR] --checkpoint and --resume cannot be combined with --batch, --server, --watch or --sweep." << std::endl;
+            return 1;
+        }
+        if (solver_mode != SolverMode::WORKLIST && solver_mode != SolverMode::JACOBI) {
+            std::cerr << "[ERROR] --checkpoint and --resume need --solver=worklist or --solver=jacobi." << std::endl;
+            return 1;
+        }
+    }
+    if (anytime) {
+        // The invariants of an anytime analysis are partial, so they are neither cached nor indexed
+        if (batch || server || watch || !sweep_path.empty() || !checkpoint_path.empty() || !resume_path.empty() || !cache_path.empty() || !index_path.empty()) {
+            std::cerr << "[ERROR] --anytime cannot be combined with --batch, --server, --watch, --sweep, --checkpoint, --resume, --cache or --index." << std::endl;
+            return 1;
+        }
+        if (solver_mode != SolverMode::WORKLIST) {
+            std::cerr << "[ERROR] --anytime needs --solver=worklist." << std::endl;
+            return 1;
+        }
+    }
+    if (low_memory) {
+        // The dropped stores are replayed from the final ones, which the other modes do not keep alone
+        if (batch || server || watch || !sweep_path.empty() || !checkpoint_path.empty() || !resume_path.empty()) {
+            std::cerr << "[ERROR] --low-memory cannot be combined with --batch, --server, --watch, --sweep, --checkpoint or --resume." << std::endl;
+            return 1;
+        }
+        if (solver_mode != SolverMode::WORKLIST && solver_mode != SolverMode::WTO) {
+            std::cerr << "[ERROR] --low-memory needs --solver=worklist or --solver=wto." << std::endl;
+            return 1;
+        }
+    }
+    // The results, caches, indexes, traces and checkpoints hold bounds of 64 bits
+    if (infer_width && (batch || server || watch || !sweep_path.empty() || !checkpoint_path.empty() || !resume_path.empty() || !cache_path.empty()
+        || !index_path.empty() || !results_path.empty() || !trace_path.empty())) {
+        std::cerr << "[ERROR] --width=auto cannot be combined with --batch, --server, --watch, --sweep, --checkpoint, --resume, --cache, --index, --results or --trace." << std::endl;
         return 1;
     }
-    std::ostringstream buffer;
-    buffer << f.rdbuf();
-    std::string input = buffer.str();
-    f.close();
+    if (parallel_slices) {
+        // Every postcondition has its own interpreter, none of which holds the invariants of the whole program
+        if (batch || server || watch || !sweep_path.empty() || !checkpoint_path.empty() || !resume_path.empty() || !cache_path.empty()
+            || !index_path.empty() || !results_path.empty() || !trace_path.empty() || !profile_path.empty() || !folded_path.empty() || infer_width) {
+            std::cerr << "[ERROR] --slice=parallel cannot be combined with --batch, --server, --watch, --sweep, --checkpoint, --resume, --cache, --index, --results, --trace, --profile or --width=auto." << std::endl;
+            return 1;
+        }
+        if (solver_mode == SolverMode::PARALLEL) {
+            std::cerr << "[ERROR] --slice=parallel already analyzes the slices in parallel, and cannot be combined with --solver=parallel." << std::endl;
+            return 1;
+        }
+    }
+    std::vector<PreconditionSet<int64_t>> sweep;
+    if (!sweep_path.empty()) {
+        // The configurations share the stores of a single analysis, which the other modes do not know of
+        if (batch || server || watch || sparse || prefilter || !cache_path.empty()) {
+            std::cerr << "[ERROR] --sweep cannot be combined with --batch, --server, --watch, --sparse, --prefilter or --cache." << std::endl;
+            return 1;
+        }
+        std::string error;
+        if (!read_precondition_sweep(sweep_path, sweep, error)) {
+            std::cerr << "[ERROR] " << error << "." << std::endl;
+            return 1;
+        }
+    }
+    if (!worker.empty()) {
+        if (batch || server || watch) {
+            std::cerr << "[ERROR] --worker cannot be combined with --batch, --coordinator, --server or --watch." << std::endl;
+            return 1;
+        }
+        BatchWorker batch_worker(jobs, cache_path);
+        return batch_worker.serve_port(worker.front());
+    }
+    if (batch) {
+        auto paths = collect_batch_inputs(inputs, manifest);
+        if (paths.empty()) {
+            std::cerr << "[ERROR] no file to analyze." << std::endl;
+            return 1;
+        }
+        if (!coordinator.empty()) {
+            // The workers analyze with their own cache and threads
+            if (pipeline || !cache_path.empty()) {
+                std::cerr << "[ERROR] --coordinator cannot be combined with --pipeline or --cache, which are options of the workers." << std::endl;
+                return 1;
+            }
+            ShardSettings settings;
+            settings.solver_mode = solver_mode;
+            settings.budget = budget;
+            return run_distributed_batch(paths, coordinator, shards, retries, settings, jobs, metrics_path, results_path, results_format);
+        }
+        int status = run_batch(paths, jobs, solver_mode, metrics_path, cache_path, budget, results_path, results_format, pipeline);
+        // In differential mode, a disagreement of the parsers fails the run
+        return AbstractInterpreterParser::disagreements() > 0 ? 1 : status;
+    }
+    auto configure = [&](auto& EI) {
+        EI.set_solver_mode(solver_mode);
+        EI.set_solver_threads(jobs);
+        EI.set_sparse(sparse);
+        EI.set_slice(slice);
+        EI.set_prefilter(prefilter);
+        EI.set_low_memory(low_memory);
+        EI.set_trace_path(trace_path);
+        EI.set_budget(budget);
+        if (widening_delay >= 0) {
+            EI.set_widening_delay(widening_delay);
+        }
+        if (narrowing_passes >= 0) {
+            EI.set_narrowing_passes(narrowing_passes);
+        }
+    };
+    if (server) {
+        AnalysisServer<int64_t> analysis_server(configure, cache_path);
+        return socket_path.empty() ? analysis_server.serve_standard_streams() : analysis_server.serve_socket(socket_path);
+    }
+    if(path.empty()) {
+        std::cout << "usage: " << argv[0] << " [--solver=worklist|wto|jacobi|parallel] [--jobs=N] [--log=quiet|summary|trace|debug] [--widening-delay=N] [--narrowing=N] [--sparse] [--slice[=parallel]] [--prefilter] [--anytime] [--low-memory] [--width=auto|64] [--time-budget=MS] [--iteration-budget=N] [--memory-budget=MB] [--metrics=FILE|-] [--perf-counters] [--results=FILE|-] [--results-format=ndjson|binary] [--parser=descent|peg|differential] [--cache=DIR] [--trace=FILE] [--sweep=FILE] [--profile=FILE|-] [--profile-folded=FILE] [--index=FILE] [--checkpoint=FILE [--checkpoint-interval=MS]] [--resume=FILE] [--watch] tests/00.c" << std::endl;
+        std::cout << "       " << argv[0] << " --estimate FILE" << std::endl;
+        std::cout << "       " << argv[0] << " --print-trace=FILE" << std::endl;
+        std::cout << "       " << argv[0] << " --query-index=FILE [--query=[VARIABLE]@LINE[-LAST]]..." << std::endl;
+        std::cout << "       " << argv[0] << " --print-results=FILE" << std::endl;
+        std::cout << "       " << argv[0] << " --server[=SOCKET] [--cache=DIR] [--solver=worklist|wto|jacobi|parallel] [--sparse] [--slice] [--prefilter]" << std::endl;
+        std::cout << "       " << argv[0] << " --batch [--jobs=N | --pipeline=LOAD,PARSE,BUILD,SOLVE [--pipeline-depth=N]] [--manifest=FILE] [--metrics=FILE|-] [--perf-counters] [--cache=DIR] [--solver=worklist|wto|jacobi|parallel] [--time-budget=MS] [--iteration-budget=N] [--memory-budget=MB] [--results=FILE|-] [--results-format=ndjson|binary] [--parser=descent|peg|differential] FILE|DIR..." << std::endl;
+        std::cout << "       " << argv[0] << " --coordinator=HOST:PORT[,HOST:PORT...] [--shards=N] [--retries=N] [--manifest=FILE] [--metrics=FILE|-] [--solver=worklist|wto|jacobi|parallel] [--time-budget=MS] [--iteration-budget=N] [--memory-budget=MB] [--results=FILE|-] [--results-format=ndjson|binary] FILE|DIR..." << std::endl;
+        std::cout << "       " << argv[0] << " --worker=[HOST:]PORT [--jobs=N] [--cache=DIR] [--parser=descent|peg|differential] [--perf-counters]" << std::endl;
+        return 1;
+    }
+    auto read_input = [&path](SourceFile& source) {
+        source = SourceFile(path);
+        return source.is_open();
+    };
+    SourceFile source;
+    if (!read_input(source)) {
+        std::cerr << "[ERROR] cannot open the test file `" << path << "`." << std::endl;
+        return 1;
+    }
+    if (estimate) {
+        auto ast = AbstractInterpreterParser::parse_program(source.text());
+        if (ast.size() == 0 || ast.root().size() == 0) {
+            std::cerr << "[ERROR] cannot parse `" << path << "`." << std::endl;
+            return 1;
+        }
+        print_cost_estimate(std::cout, AnalysisCostEstimator::estimate(ast));
+        return 0;
+    }
 
     // AbstractInterpreter<int64_t> AI(input);
     // // AI.print();
     // std::cout << "Analyzing program `" << argv[1] << "`..." << std::endl;
     // AI.run();
 
-    EquationalInterpreter<int64_t> EI(input);
+    Logger::set_level(log_level);
+    if (watch) {
+        // Analyzes the file again whenever it is saved, reusing the fixpoint of the unchanged statements
+        IncrementalAnalysis<int64_t> session(configure);
+        std::error_code error;
+        auto last_write = std::filesystem::last_write_time(path, error);
+        while (true) {
+            try {
+                if (session.analyze(source.text()) == nullptr) {
+                    std::cerr << "[ERROR] cannot parse `" << path << "`, waiting for the next change." << std::endl;
+                }
+            }
+            catch (const AnalysisError& error) {
+                std::cerr << "[ERROR] " << error.what() << ", waiting for the next change." << std::endl;
+            }
+            std::cout << "Watching `" << path << "` for changes..." << std::endl;
+            while (true) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(200));
+                auto write = std::filesystem::last_write_time(path, error);
+                if (!error && write != last_write && read_input(source)) {
+                    last_write = write;
+                    break;
+                }
+            }
+        }
+    }
+    auto write_metrics = [&](const AnalysisStatistics& statistics, const std::vector<PostconditionVerdict>& verdicts) {
+        std::ofstream metrics_file;
+        if (metrics_path != "-") {
+            metrics_file.open(metrics_path);
+            if (!metrics_file.is_open()) {
+                std::cerr << "[ERROR] cannot open the metrics file `" << metrics_path << "`." << std::endl;
+                return false;
+            }
+        }
+        std::ostream& out = metrics_path == "-" ? std::cout : metrics_file;
+        write_json_report(out, path, statistics, verdicts);
+        out << std::endl;
+        return true;
+    };
+    auto write_results = [&](auto&& encode) {
+        ResultSink<int64_t> sink(results_path, results_format);
+        ResultEncoder<int64_t> encoder(results_format);
+        encode(encoder);
+        sink.write(encoder.bytes());
+        sink.flush();
+        if (!sink.good()) {
+            std::cerr << "[ERROR] cannot write the results file `" << results_path << "`." << std::endl;
+            return false;
+        }
+        return true;
+    };
+
+    // A cached result of the same source with the same settings replaces the whole analysis, unless the
+    // iterations have to be traced or the invariants indexed by line
+    std::optional<ResultCache<int64_t>> cache;
+    ResultCacheKey cache_key;
+    if (!cache_path.empty()) {
+        cache.emplace(cache_path);
+        cache_key = ResultCacheKey::make<int64_t>(source.text(), solver_mode,
+            widening_delay >= 0 ? widening_delay : EquationalInterpreter<int64_t>::DEFAULT_WIDENING_DELAY,
+            narrowing_passes >= 0 ? narrowing_passes : EquationalInterpreter<int64_t>::DEFAULT_NARROWING_PASSES, sparse, slice, prefilter);
+        auto cached = trace_path.empty() && index_path.empty() ? cache->lookup(cache_key) : std::nullopt;
+        if (cached) {
+            cached->print();
+            if (!metrics_path.empty() && !write_metrics(cached->statistics(), cached->verdicts())) {
+                return 1;
+            }
+            if (!results_path.empty() && !write_results([&](auto& encoder) { encode_results(encoder, path, *cached); })) {
+                return 1;
+            }
+            return 0;
+        }
+    }
+
+    auto write_profiles = [&](const auto& EI) {
+        if (!EI.parsed() || (profile_path.empty() && folded_path.empty())) {
+            return true;
+        }
+        auto profile = EI.profile();
+        auto write_profile = [&](const std::string& profile_file, auto&& write) {
+            std::ofstream file;
+            if (profile_file != "-") {
+                file.open(profile_file);
+                if (!file.is_open()) {
+                    std::cerr << "[ERROR] cannot open the profile file `" << profile_file << "`." << std::endl;
+                    return false;
+                }
+            }
+            write(profile_file == "-" ? std::cout : file, profile);
+            return true;
+        };
+        return (profile_path.empty() || write_profile(profile_path, write_profile_report))
+            && (folded_path.empty() || write_profile(folded_path, write_folded_stacks));
+    };
+
+    if (parallel_slices) {
+        SliceAnalysis<int64_t> slices([&](auto& EI) {
+            configure(EI);
+            EI.set_anytime(anytime);
+        }, jobs);
+        if (!slices.analyze(source.text())) {
+            return 1;
+        }
+        if (!metrics_path.empty() && !write_metrics(slices.statistics(), slices.verdicts())) {
+            return 1;
+        }
+        return AbstractInterpreterParser::disagreements() > 0 ? 1 : 0;
+    }
+
+    // With --width=auto, the program is first analyzed with the narrowest bounds that hold its integers, and
+    // its output only printed if no bound reached the range of the type; otherwise with the next width
+    auto analyze_narrow = [&](auto& EI, ValueWidth width) {
+        configure(EI);
+        EI.set_profile(!profile_path.empty() || !folded_path.empty());
+        EI.set_diagnostics(true);
+        EI.set_anytime(anytime);
+        std::ostringstream out;
+        std::ostringstream err;
+        {
+            Logger::Capture capture(out, err);
+            EI.run();
+        }
+        if (EI.parsed() && EI.saturated()) {
+            return false;
+        }
+        std::cout << out.str();
+        std::cerr << err.str();
+        LOG_SUMMARY << "Value width: " << static_cast<int>(width) << " bits" << std::endl;
+        return true;
+    };
+    auto finish_narrow = [&](const auto& EI) {
+        if (!metrics_path.empty() && !write_metrics(EI.statistics(), EI.verdicts())) {
+            return 1;
+        }
+        if (!write_profiles(EI)) {
+            return 1;
+        }
+        return AbstractInterpreterParser::disagreements() > 0 ? 1 : 0;
+    };
+    if (infer_width) {
+        FlatAST ast;
+        {
+            std::ostringstream discarded;
+            Logger::Capture capture(discarded, discarded);
+            ast = AbstractInterpreterParser::parse_program(source.text());
+        }
+        for (auto width = infer_value_width(ast); width != ValueWidth::W64; width = *wider_value_width(width)) {
+            if (width == ValueWidth::W16) {
+                EquationalInterpreter<int16_t> narrow(source.text());
+                if (analyze_narrow(narrow, width)) {
+                    return finish_narrow(narrow);
+                }
+            }
+            else {
+                EquationalInterpreter<int32_t> narrow(source.text());
+                if (analyze_narrow(narrow, width)) {
+                    return finish_narrow(narrow);
+                }
+            }
+        }
+    }
+
+    if (!sweep.empty()) {
+        FlatAST ast;
+        {
+            std::ostringstream discarded;
+            Logger::Capture capture(discarded, discarded);
+            ast = AbstractInterpreterParser::parse_program(source.text());
+        }
+        std::string error;
+        if (ast.size() > 0 && ast.root().size() > 0 && !check_precondition_sweep(ast, sweep, error)) {
+            std::cerr << "[ERROR] " << error << "." << std::endl;
+            return 1;
+        }
+    }
+
+    EquationalInterpreter<int64_t> EI(source.text());
+    configure(EI);
+    EI.set_sweep(std::move(sweep));
+    EI.set_profile(!profile_path.empty() || !folded_path.empty());
+    EI.set_diagnostics(!results_path.empty());
+    EI.set_anytime(anytime);
+    if (!checkpoint_path.empty()) {
+        EI.set_checkpoint(checkpoint_path, checkpoint_interval_ms);
+    }
     // EI.print();
-    EI.run();
-    return 0;
-}
\ No newline at end of file
+    if (!resume_path.empty() && EI.parsed()) {
+        EI.build();
+        if (!EI.resume(resume_path)) {
+            std::cerr << "[ERROR] `" << resume_path << "` is not a checkpoint of this program analyzed with the same settings." << std::endl;
+            return 1;
+        }
+        EI.solve();
+    }
+    else {
+        EI.run();
+    }
+    if (infer_width) {
+        LOG_SUMMARY << "Value width: 64 bits" << std::endl;
+    }
+
+    if (cache && EI.parsed() && !cache->store(cache_key, EI)) {
+        std::cerr << "[ERROR] cannot write the result to the cache `" << cache_path << "`." << std::endl;
+    }
+    if (!metrics_path.empty() && !write_metrics(EI.statistics(), EI.verdicts())) {
+        return 1;
+    }
+    if (!write_profiles(EI)) {
+        return 1;
+    }
+    if (!results_path.empty() && EI.parsed()
+        && !write_results([&](auto& encoder) { encode_results(encoder, path, EI, EI.statistics()); })) {
+        return 1;
+    }
+    if (!index_path.empty() && EI.parsed() && !write_invariant_index(index_path, EI)) {
+        std::cerr << "[ERROR] cannot write the invariant index `" << index_path << "`." << std::endl;
+        return 1;
+    }
+    return AbstractInterpreterParser::disagreements() > 0 ? 1 : 0;
+}
+catch (const AnalysisError& error) {
+    std::cerr << "[ERROR] " << error.what() << "." << std::endl;
+    return 1;
+}
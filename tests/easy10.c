@@ -0,0 +1,8 @@
+int a, b;
+
+void main(){
+    /*!npk a between 1 and 5 */
+    b = -a;
+    a++;
+    assert(b <= 0);
+}
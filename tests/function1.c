@@ -0,0 +1,28 @@
+int x;
+int y;
+int z;
+
+int clamp(int v, int hi) {
+  int r;
+  r = v;
+  if (r > hi) {
+    r = hi;
+  }
+  return r;
+}
+
+int twice(int a) {
+  return clamp(a * 2, 50);
+}
+
+void main() {
+  /*!npk x between 0 and 40 */
+  y = twice(x);
+  z = 0;
+  while (z < 10) {
+    z = z + 1;
+    y = clamp(z, 5);
+  }
+  assert(y <= 50);
+  assert(y >= 0);
+}
@@ -0,0 +1,12 @@
+int i, n, s;
+
+void main() {
+  /*!npk n between 0 and 50 */
+  i = 0;
+  s = 0;
+  while (i < n) {
+    i = i + 1;
+    s = s + 2;
+  }
+  assert(i <= 50);
+}
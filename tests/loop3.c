@@ -0,0 +1,12 @@
+int i, x;
+
+void main() {
+  i = 0;
+  x = 0;
+  while (i < 10) {
+    x = i * 2;
+    assert(x >= 0);
+    i = i + 1;
+  }
+  assert(i >= 10);
+}